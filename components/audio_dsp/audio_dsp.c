@@ -0,0 +1,226 @@
+/**
+ * 音频定点 DSP 内核实现
+ * 
+ * 可移植 C 版本按主机编译器容易自动向量化的形式编写 (无分支饱和、restrict 指针)；
+ * ESP32-S3 上对齐部分交给 audio_dsp_aes3.S，剩余的零头仍走 C 版本。
+ */
+
+#include "audio_dsp.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#if CONFIG_IDF_TARGET_ESP32S3
+// 8 个采样一组，指针需 16 字节对齐
+void audio_dsp_add_sat_s16_aes3(int16_t *dst, const int16_t *src, size_t groups);
+void audio_dsp_gain_s16_aes3(int16_t *buf, size_t groups, const int16_t *gain);
+void audio_dsp_minmax_s16_aes3(const int16_t *src, size_t groups, int16_t *minmax);
+#endif
+
+static inline int16_t sat16(int32_t v) {
+    if (v > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (v < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)v;
+}
+
+static inline bool aligned16(const void *p) {
+    return ((uintptr_t)p & 0xF) == 0;
+}
+
+// ============================================================================
+// 增益与混音
+// ============================================================================
+
+void audio_dsp_add_sat_s16_ansi(int16_t *restrict dst, const int16_t *restrict src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = sat16((int32_t)dst[i] + (int32_t)src[i]);
+    }
+}
+
+void audio_dsp_add_sat_s16(int16_t *dst, const int16_t *src, size_t count) {
+#if CONFIG_IDF_TARGET_ESP32S3
+    if (aligned16(dst) && aligned16(src) && count >= 8) {
+        size_t groups = count / 8;
+        audio_dsp_add_sat_s16_aes3(dst, src, groups);
+        dst += groups * 8;
+        src += groups * 8;
+        count -= groups * 8;
+    }
+#endif
+    audio_dsp_add_sat_s16_ansi(dst, src, count);
+}
+
+void audio_dsp_gain_s16_ansi(int16_t *restrict buf, size_t count, int32_t gain) {
+    for (size_t i = 0; i < count; i++) {
+        buf[i] = sat16(((int32_t)buf[i] * gain + (1 << 14)) >> 15);
+    }
+}
+
+void audio_dsp_gain_s16(int16_t *buf, size_t count, int32_t gain) {
+    if (gain == AUDIO_DSP_GAIN_UNITY) {
+        return;
+    }
+#if CONFIG_IDF_TARGET_ESP32S3
+    if (aligned16(buf) && count >= 8) {
+        int16_t g = (int16_t)gain;
+        size_t groups = count / 8;
+        audio_dsp_gain_s16_aes3(buf, groups, &g);
+        buf += groups * 8;
+        count -= groups * 8;
+    }
+#endif
+    audio_dsp_gain_s16_ansi(buf, count, gain);
+}
+
+void audio_dsp_gain_ramp_s16(int16_t *buf, size_t count, int32_t *gain, int32_t target, int32_t step) {
+    int32_t g = *gain;
+    size_t i = 0;
+    
+    // 斜坡部分逐采样更新增益
+    if (step <= 0) {
+        g = target;
+    }
+    while (i < count && g != target) {
+        if (g < target) {
+            g = (target - g > step) ? g + step : target;
+        } else {
+            g = (g - target > step) ? g - step : target;
+        }
+        buf[i] = sat16(((int32_t)buf[i] * g + (1 << 14)) >> 15);
+        i++;
+    }
+    
+    // 剩余部分为恒定增益
+    if (i < count) {
+        if (g == 0) {
+            for (; i < count; i++) {
+                buf[i] = 0;
+            }
+        } else {
+            audio_dsp_gain_s16(buf + i, count - i, g);
+        }
+    }
+    
+    *gain = g;
+}
+
+// ============================================================================
+// 电平
+// ============================================================================
+
+int16_t audio_dsp_peak_s16_ansi(const int16_t *src, size_t count) {
+    int32_t lo = 0;
+    int32_t hi = 0;
+    for (size_t i = 0; i < count; i++) {
+        int32_t v = src[i];
+        lo = v < lo ? v : lo;
+        hi = v > hi ? v : hi;
+    }
+    int32_t peak = -lo > hi ? -lo : hi;
+    return peak > INT16_MAX ? INT16_MAX : (int16_t)peak;
+}
+
+int16_t audio_dsp_peak_s16(const int16_t *src, size_t count) {
+#if CONFIG_IDF_TARGET_ESP32S3
+    if (aligned16(src) && count >= 8) {
+        int16_t minmax[16] __attribute__((aligned(16)));
+        size_t groups = count / 8;
+        audio_dsp_minmax_s16_aes3(src, groups, minmax);
+        // 前 8 个为各通道最大值，后 8 个为最小值
+        int32_t peak = audio_dsp_peak_s16_ansi(minmax, 16);
+        int32_t tail = audio_dsp_peak_s16_ansi(src + groups * 8, count - groups * 8);
+        return (int16_t)(tail > peak ? tail : peak);
+    }
+#endif
+    return audio_dsp_peak_s16_ansi(src, count);
+}
+
+int16_t audio_dsp_rms_s16(const int16_t *src, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        int32_t v = src[i];
+        sum += (uint32_t)(v * v);
+    }
+    uint64_t mean = sum / count;
+    
+    // 整数平方根 (逐位)
+    uint32_t root = 0;
+    for (uint32_t bit = 1u << 15; bit != 0; bit >>= 1) {
+        uint32_t trial = root | bit;
+        if ((uint64_t)trial * trial <= mean) {
+            root = trial;
+        }
+    }
+    return root > INT16_MAX ? INT16_MAX : (int16_t)root;
+}
+
+uint32_t audio_dsp_abs_sum_s16(const int16_t *src, size_t count) {
+    // 无分支绝对值，便于编译器自动向量化
+    uint32_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        int32_t v = src[i];
+        int32_t m = v >> 31;
+        sum += (uint32_t)((v ^ m) - m);
+    }
+    return sum;
+}
+
+// ============================================================================
+// 软限幅
+// ============================================================================
+
+void audio_dsp_limiter_init(audio_dsp_limiter_t *lim, int16_t ceiling, uint32_t attack_frames, uint32_t release_frames) {
+    lim->gain = AUDIO_DSP_GAIN_UNITY;
+    lim->ceiling = ceiling > 0 ? ceiling : AUDIO_DSP_GAIN_UNITY;
+    lim->attack_step = attack_frames == 0 ? 0 : (int32_t)((AUDIO_DSP_GAIN_UNITY + attack_frames - 1) / attack_frames);
+    lim->release_step = release_frames == 0 ? 0 : (int32_t)((AUDIO_DSP_GAIN_UNITY + release_frames - 1) / release_frames);
+    lim->limited_blocks = 0;
+}
+
+/**
+ * 软拐点：超过 ceiling 的部分 d 映射为 d*k/(d+k)，k = 满幅 - ceiling，
+ * 在 ceiling 处斜率为 1，输入趋于无穷时输出趋于满幅
+ */
+static inline int16_t soft_knee(int32_t v, int32_t ceiling) {
+    int32_t a = v < 0 ? -v : v;
+    if (a <= ceiling) {
+        return (int16_t)v;
+    }
+    int32_t k = INT16_MAX - ceiling;
+    int32_t d = a - ceiling;
+    int32_t y = ceiling + (k == 0 ? 0 : d * k / (d + k));
+    return (int16_t)(v < 0 ? -y : y);
+}
+
+void audio_dsp_limiter_process_s16(audio_dsp_limiter_t *lim, int16_t *buf, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    
+    // 使本块峰值不超过 ceiling 的增益
+    int32_t peak = audio_dsp_peak_s16(buf, count);
+    int32_t target = AUDIO_DSP_GAIN_UNITY;
+    if (peak > lim->ceiling) {
+        target = lim->ceiling * AUDIO_DSP_GAIN_UNITY / peak;
+    }
+    int32_t step = target < lim->gain ? lim->attack_step : lim->release_step;
+    audio_dsp_gain_ramp_s16(buf, count, &lim->gain, target, step);
+    if (lim->gain < AUDIO_DSP_GAIN_UNITY) {
+        lim->limited_blocks++;
+    }
+    
+    // attack 斜坡尚未压到位的采样走软拐点
+    if (peak > lim->ceiling) {
+        for (size_t i = 0; i < count; i++) {
+            buf[i] = soft_knee(buf[i], lim->ceiling);
+        }
+    }
+}
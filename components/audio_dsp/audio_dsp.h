@@ -0,0 +1,256 @@
+/**
+ * 音频定点 DSP 内核
+ * 
+ * 16 位 PCM 的 Q15 增益 (含线性斜坡)、饱和混音、峰值/RMS 电平、软限幅、多相重采样和 WSOLA 变速。
+ * 每个内核都有可移植的 C 参考实现 (_ansi)；ESP32-S3 上可按通道并行的内核
+ * (饱和加法、恒定增益、峰值) 在 16 字节对齐时走 PIE SIMD 指令 (_aes3)。
+ * 不依赖 FreeRTOS，可在主机上编译。
+ */
+
+#ifndef AUDIO_DSP_H
+#define AUDIO_DSP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Q15 单位增益 (1.0)
+ */
+#define AUDIO_DSP_GAIN_UNITY    32767
+
+// ============================================================================
+// 增益与混音
+// ============================================================================
+
+/**
+ * 饱和加法：dst[i] = sat16(dst[i] + src[i])
+ * 
+ * dst 和 src 均 16 字节对齐时 ESP32-S3 走 SIMD 路径，每次处理 8 个采样。
+ * 
+ * @param dst 累加目标 (输入输出)
+ * @param src 叠加源
+ * @param count 采样数
+ */
+void audio_dsp_add_sat_s16(int16_t *dst, const int16_t *src, size_t count);
+
+/**
+ * Q15 恒定增益：buf[i] = buf[i] * gain >> 15
+ * 
+ * C 版本四舍五入，SIMD 版本截断，两者最多相差 1 LSB。
+ * 
+ * @param buf 采样 (原地处理)
+ * @param count 采样数
+ * @param gain 增益 (Q15，0 到 AUDIO_DSP_GAIN_UNITY)
+ */
+void audio_dsp_gain_s16(int16_t *buf, size_t count, int32_t gain);
+
+/**
+ * Q15 增益，带线性斜坡
+ * 
+ * 从 *gain 开始，每个采样增益加 step，直到达到 target 后保持不变。
+ * 返回时 *gain 更新为最后一个采样使用的增益，便于下一块延续斜坡。
+ * 
+ * @param buf 采样 (原地处理)
+ * @param count 采样数
+ * @param gain 当前增益 (Q15，输入输出)
+ * @param target 目标增益 (Q15)
+ * @param step 每个采样的增益变化量 (绝对值，0 表示立即跳到目标)
+ */
+void audio_dsp_gain_ramp_s16(int16_t *buf, size_t count, int32_t *gain, int32_t target, int32_t step);
+
+// ============================================================================
+// 电平
+// ============================================================================
+
+/**
+ * 峰值：max(|src[i]|)，-32768 按 32767 计
+ * 
+ * @param src 采样
+ * @param count 采样数
+ * @return 峰值 (0-32767)
+ */
+int16_t audio_dsp_peak_s16(const int16_t *src, size_t count);
+
+/**
+ * 均方根电平
+ * 
+ * @param src 采样
+ * @param count 采样数
+ * @return RMS (0-32767)
+ */
+int16_t audio_dsp_rms_s16(const int16_t *src, size_t count);
+
+/**
+ * 绝对值和：sum(|src[i]|)，用作廉价的能量门限
+ * 
+ * @param src 采样
+ * @param count 采样数 (不超过 65536，保证结果不溢出)
+ * @return 绝对值和
+ */
+uint32_t audio_dsp_abs_sum_s16(const int16_t *src, size_t count);
+
+// ============================================================================
+// 软限幅
+// ============================================================================
+
+/**
+ * 限幅器状态
+ * 
+ * 按块测峰值求出使峰值不超过 ceiling 的增益，压低时用 attack 斜坡、恢复时用 release 斜坡；
+ * attack 斜坡期间仍超过 ceiling 的采样按软拐点曲线压向满幅，不会硬削波。
+ */
+typedef struct {
+    int32_t gain;               ///< 当前增益 (Q15)
+    int32_t ceiling;            ///< 输出上限
+    int32_t attack_step;        ///< 压低时每采样的增益变化量
+    int32_t release_step;       ///< 恢复时每采样的增益变化量
+    uint32_t limited_blocks;    ///< 增益低于 1.0 的块数
+} audio_dsp_limiter_t;
+
+/**
+ * 初始化限幅器
+ * 
+ * @param lim 限幅器
+ * @param ceiling 输出上限 (如 29204 约为 -1dBFS)
+ * @param attack_frames 增益从 1.0 压到 0 所需的帧数
+ * @param release_frames 增益从 0 恢复到 1.0 所需的帧数
+ */
+void audio_dsp_limiter_init(audio_dsp_limiter_t *lim, int16_t ceiling, uint32_t attack_frames, uint32_t release_frames);
+
+/**
+ * 限幅一块采样 (原地处理)
+ * 
+ * @param lim 限幅器
+ * @param buf 采样
+ * @param count 采样数
+ */
+void audio_dsp_limiter_process_s16(audio_dsp_limiter_t *lim, int16_t *buf, size_t count);
+
+// ============================================================================
+// 多相重采样
+// ============================================================================
+
+#define AUDIO_DSP_RESAMPLER_TAPS        16  ///< 每相抽头数
+#define AUDIO_DSP_RESAMPLER_MAX_PHASES  3   ///< 最大插值倍数 (16k→24k 为 3)
+
+/**
+ * 重采样器状态
+ * 
+ * 有理比例 up/down (约分后均不超过 3)，支持 8k/16k/24k 之间互转。
+ * 窗函数 sinc 原型滤波器在初始化时生成，分解为 up 相，每相 16 个 Q15 抽头。
+ */
+typedef struct {
+    uint16_t up;
+    uint16_t down;
+    uint16_t phase;             ///< 下一个输出相对最新输入的相位 (以 1/up 个输入采样为单位)
+    uint16_t pos;               ///< 历史缓冲写入位置
+    int16_t taps[AUDIO_DSP_RESAMPLER_MAX_PHASES][AUDIO_DSP_RESAMPLER_TAPS];
+    int16_t history[2 * AUDIO_DSP_RESAMPLER_TAPS];  ///< 双份存储，使最近 16 个采样总是连续
+} audio_dsp_resampler_t;
+
+/**
+ * 初始化重采样器
+ * 
+ * @param rs 重采样器
+ * @param in_rate 输入采样率
+ * @param out_rate 输出采样率
+ * @return false 比例不受支持
+ */
+bool audio_dsp_resampler_init(audio_dsp_resampler_t *rs, uint32_t in_rate, uint32_t out_rate);
+
+/**
+ * count 个输入最多产生的输出采样数
+ */
+size_t audio_dsp_resampler_max_out(const audio_dsp_resampler_t *rs, size_t count);
+
+/**
+ * 重采样，输入全部消耗，滤波器状态跨调用保留
+ * 
+ * @param rs 重采样器
+ * @param in 输入采样
+ * @param count 输入采样数
+ * @param out 输出，至少 audio_dsp_resampler_max_out(rs, count) 个采样
+ * @return 输出采样数
+ */
+size_t audio_dsp_resample_s16(audio_dsp_resampler_t *rs, const int16_t *in, size_t count, int16_t *out);
+
+// ============================================================================
+// WSOLA 变速 (不变调)
+// ============================================================================
+
+#define AUDIO_DSP_WSOLA_FRAME       320     ///< 帧长 (16kHz 下 20ms)，Hann 窗
+#define AUDIO_DSP_WSOLA_HOP         160     ///< 合成跳步 (帧长一半)
+#define AUDIO_DSP_WSOLA_SEEK        64      ///< 相似度搜索范围 ±4ms
+#define AUDIO_DSP_WSOLA_IN_CAP      1024    ///< 输入缓冲区 (采样)
+#define AUDIO_DSP_RATE_UNITY        256     ///< Q8 速率 1.0
+#define AUDIO_DSP_RATE_MAX          512     ///< Q8 速率上限 2.0
+
+/**
+ * WSOLA 状态
+ * 
+ * 每次输出一个跳步：在名义分析位置附近 ±SEEK 内找与上一帧自然延续最相似的帧，
+ * 与上一帧后半部分重叠相加。搜索先按 2 采样步长、隔点求相关，再在最优点 ±1 细化。
+ * 只支持加速 (速率 1.0 到 2.0)。
+ */
+typedef struct {
+    uint16_t rate_q8;
+    bool started;
+    int16_t buf[AUDIO_DSP_WSOLA_IN_CAP];
+    size_t len;                 ///< buf 中的有效采样数
+    uint32_t ana_q8;            ///< 下一帧名义起点 (相对 buf[0]，Q8)
+    size_t prev;                ///< 上一帧实际起点 (相对 buf[0])
+    int16_t tail[AUDIO_DSP_WSOLA_HOP];      ///< 上一帧后半部分 (已加窗)
+    int16_t win[AUDIO_DSP_WSOLA_HOP];       ///< 上升半窗 (Q15)，下降半窗为其补
+} audio_dsp_wsola_t;
+
+/**
+ * 初始化 (每段独立的音频调用一次)
+ * 
+ * @param ws 状态
+ * @param rate_q8 速率 (Q8，AUDIO_DSP_RATE_UNITY 到 AUDIO_DSP_RATE_MAX)
+ */
+void audio_dsp_wsola_init(audio_dsp_wsola_t *ws, uint16_t rate_q8);
+
+/**
+ * 调整速率，从下一帧开始生效
+ */
+void audio_dsp_wsola_set_rate(audio_dsp_wsola_t *ws, uint16_t rate_q8);
+
+/**
+ * 变速处理，输入全部消耗
+ * 
+ * @param ws 状态
+ * @param in 输入采样
+ * @param count 输入采样数
+ * @param out 输出，至少 count + AUDIO_DSP_WSOLA_FRAME 个采样
+ * @return 输出采样数
+ */
+size_t audio_dsp_wsola_process(audio_dsp_wsola_t *ws, const int16_t *in, size_t count, int16_t *out);
+
+/**
+ * 输入结束，按原速输出剩余部分
+ * 
+ * @param ws 状态
+ * @param out 输出，至少 AUDIO_DSP_WSOLA_IN_CAP 个采样
+ * @return 输出采样数
+ */
+size_t audio_dsp_wsola_flush(audio_dsp_wsola_t *ws, int16_t *out);
+
+// ============================================================================
+// 参考实现 (供主机测试与优化版本对比)
+// ============================================================================
+
+void audio_dsp_add_sat_s16_ansi(int16_t *dst, const int16_t *src, size_t count);
+void audio_dsp_gain_s16_ansi(int16_t *buf, size_t count, int32_t gain);
+int16_t audio_dsp_peak_s16_ansi(const int16_t *src, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_DSP_H
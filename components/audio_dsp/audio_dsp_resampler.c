@@ -0,0 +1,108 @@
+/**
+ * 多相重采样实现
+ * 
+ * 原型滤波器为 Blackman 窗 sinc，截止频率取输入、输出奈奎斯特频率中较低者的 90%，
+ * 长度 up * 16，按相位分解后每相归一化为单位直流增益。
+ * 系数在初始化时用浮点生成，运行时只有 Q15 乘加。
+ */
+
+#include "audio_dsp.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+bool audio_dsp_resampler_init(audio_dsp_resampler_t *rs, uint32_t in_rate, uint32_t out_rate) {
+    if (in_rate == 0 || out_rate == 0) {
+        return false;
+    }
+    uint32_t g = gcd(in_rate, out_rate);
+    uint32_t up = out_rate / g;
+    uint32_t down = in_rate / g;
+    if (up > AUDIO_DSP_RESAMPLER_MAX_PHASES || down > AUDIO_DSP_RESAMPLER_MAX_PHASES) {
+        return false;
+    }
+    
+    memset(rs, 0, sizeof(*rs));
+    rs->up = (uint16_t)up;
+    rs->down = (uint16_t)down;
+    
+    // 截止频率 (以插值后的采样率为单位，每采样周期数)
+    const int n = (int)up * AUDIO_DSP_RESAMPLER_TAPS;
+    const float fc = 0.45f / (float)(up > down ? up : down);
+    float proto[AUDIO_DSP_RESAMPLER_MAX_PHASES * AUDIO_DSP_RESAMPLER_TAPS];
+    for (int i = 0; i < n; i++) {
+        float t = (float)i - (float)(n - 1) / 2.0f;
+        float x = 2.0f * (float)M_PI * fc * t;
+        float sinc = t == 0.0f ? 1.0f : sinf(x) / x;
+        float w = 0.42f - 0.5f * cosf(2.0f * (float)M_PI * (float)i / (float)(n - 1))
+                  + 0.08f * cosf(4.0f * (float)M_PI * (float)i / (float)(n - 1));
+        proto[i] = sinc * w;
+    }
+    
+    // 分解为 up 相：taps[p][k] = proto[k * up + p]，每相归一化
+    for (uint32_t p = 0; p < up; p++) {
+        float sum = 0.0f;
+        for (int k = 0; k < AUDIO_DSP_RESAMPLER_TAPS; k++) {
+            sum += proto[k * up + p];
+        }
+        for (int k = 0; k < AUDIO_DSP_RESAMPLER_TAPS; k++) {
+            float c = proto[k * up + p] / sum * 32768.0f;
+            rs->taps[p][k] = (int16_t)lrintf(c > 32767.0f ? 32767.0f : c);
+        }
+    }
+    return true;
+}
+
+size_t audio_dsp_resampler_max_out(const audio_dsp_resampler_t *rs, size_t count) {
+    return (count * rs->up + rs->down - 1) / rs->down + 1;
+}
+
+static inline int16_t dot_taps(const int16_t *restrict hist, const int16_t *restrict taps) {
+    int32_t acc = 1 << 14;
+    for (int k = 0; k < AUDIO_DSP_RESAMPLER_TAPS; k++) {
+        acc += (int32_t)hist[k] * taps[k];
+    }
+    acc >>= 15;
+    if (acc > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (acc < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)acc;
+}
+
+size_t audio_dsp_resample_s16(audio_dsp_resampler_t *rs, const int16_t *in, size_t count, int16_t *out) {
+    size_t produced = 0;
+    uint32_t phase = rs->phase;
+    uint32_t pos = rs->pos;
+    
+    for (size_t i = 0; i < count; i++) {
+        // 最新采样写在 pos，history[pos + k] 即 x[n - k]
+        pos = pos == 0 ? AUDIO_DSP_RESAMPLER_TAPS - 1 : pos - 1;
+        rs->history[pos] = in[i];
+        rs->history[pos + AUDIO_DSP_RESAMPLER_TAPS] = in[i];
+        
+        while (phase < rs->up) {
+            out[produced++] = dot_taps(&rs->history[pos], rs->taps[phase]);
+            phase += rs->down;
+        }
+        phase -= rs->up;
+    }
+    
+    rs->phase = (uint16_t)phase;
+    rs->pos = (uint16_t)pos;
+    return produced;
+}
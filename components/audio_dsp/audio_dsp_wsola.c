@@ -0,0 +1,192 @@
+/**
+ * WSOLA 变速实现
+ * 
+ * 名义分析位置按 HOP * rate 前进，输出按 HOP 前进；实际取帧位置在名义位置 ±SEEK 内，
+ * 取与上一帧自然延续 (上一帧起点 + HOP) 互相关最大的一处，因此拼接处波形相位连续，音调不变。
+ * Hann 半窗与其补相加恒为 1，速率为 1.0 时输出等于输入。
+ */
+
+#include "audio_dsp.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define FRAME   AUDIO_DSP_WSOLA_FRAME
+#define HOP     AUDIO_DSP_WSOLA_HOP
+#define SEEK    AUDIO_DSP_WSOLA_SEEK
+
+static uint16_t clamp_rate(uint16_t rate_q8) {
+    if (rate_q8 < AUDIO_DSP_RATE_UNITY) {
+        return AUDIO_DSP_RATE_UNITY;
+    }
+    if (rate_q8 > AUDIO_DSP_RATE_MAX) {
+        return AUDIO_DSP_RATE_MAX;
+    }
+    return rate_q8;
+}
+
+void audio_dsp_wsola_init(audio_dsp_wsola_t *ws, uint16_t rate_q8) {
+    ws->rate_q8 = clamp_rate(rate_q8);
+    ws->started = false;
+    ws->len = 0;
+    ws->ana_q8 = 0;
+    ws->prev = 0;
+    for (int i = 0; i < HOP; i++) {
+        float w = 0.5f - 0.5f * cosf((float)M_PI * (float)i / (float)HOP);
+        ws->win[i] = (int16_t)lrintf(w * 32767.0f);
+    }
+}
+
+void audio_dsp_wsola_set_rate(audio_dsp_wsola_t *ws, uint16_t rate_q8) {
+    ws->rate_q8 = clamp_rate(rate_q8);
+}
+
+/**
+ * 互相关 (隔点，预先右移避免溢出)
+ */
+static int32_t xcorr(const int16_t *restrict a, const int16_t *restrict b, int stride) {
+    int32_t acc = 0;
+    for (int i = 0; i < HOP; i += stride) {
+        acc += ((int32_t)a[i] >> 4) * ((int32_t)b[i] >> 4);
+    }
+    return acc;
+}
+
+/**
+ * 在 [lo, hi] 内搜索与 tmpl 最相似的帧起点
+ */
+static size_t seek_best(const int16_t *buf, const int16_t *tmpl, size_t lo, size_t hi, size_t nominal) {
+    size_t best = nominal;
+    int32_t best_c = INT32_MIN;
+    for (size_t s = lo; s <= hi; s += 2) {
+        int32_t c = xcorr(buf + s, tmpl, 2);
+        if (c > best_c) {
+            best_c = c;
+            best = s;
+        }
+    }
+    
+    // 在粗搜索最优点 ±1 内细化
+    size_t center = best;
+    best_c = xcorr(buf + center, tmpl, 1);
+    for (int d = -1; d <= 1; d += 2) {
+        if ((d < 0 && center == lo) || (d > 0 && center + 1 > hi)) {
+            continue;
+        }
+        size_t s = center + d;
+        int32_t c = xcorr(buf + s, tmpl, 1);
+        if (c > best_c) {
+            best_c = c;
+            best = s;
+        }
+    }
+    return best;
+}
+
+/**
+ * 缓冲区足够时合成一个跳步
+ * 
+ * @return 输出的采样数 (0 或 HOP)
+ */
+static size_t synth_hop(audio_dsp_wsola_t *ws, int16_t *out) {
+    if (!ws->started) {
+        // 第一帧直接作为起点，前半部分原样输出
+        if (ws->len < FRAME) {
+            return 0;
+        }
+        memcpy(out, ws->buf, HOP * sizeof(int16_t));
+        for (int i = 0; i < HOP; i++) {
+            ws->tail[i] = (int16_t)(((int32_t)ws->buf[HOP + i] * (32767 - ws->win[i]) + (1 << 14)) >> 15);
+        }
+        ws->prev = 0;
+        ws->ana_q8 = (uint32_t)HOP * ws->rate_q8;
+        ws->started = true;
+        return HOP;
+    }
+    
+    size_t nominal = ws->ana_q8 >> 8;
+    if (nominal + SEEK + FRAME > ws->len) {
+        return 0;
+    }
+    size_t natural = ws->prev + HOP;
+    size_t lo = nominal > SEEK ? nominal - SEEK : 0;
+    size_t s = seek_best(ws->buf, ws->buf + natural, lo, nominal + SEEK, nominal);
+    
+    // 上一帧后半 (下降窗) + 本帧前半 (上升窗)
+    const int16_t *x = ws->buf + s;
+    for (int i = 0; i < HOP; i++) {
+        int32_t v = ws->tail[i] + (((int32_t)x[i] * ws->win[i] + (1 << 14)) >> 15);
+        out[i] = (int16_t)(v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : v));
+        ws->tail[i] = (int16_t)(((int32_t)x[HOP + i] * (32767 - ws->win[i]) + (1 << 14)) >> 15);
+    }
+    ws->prev = s;
+    ws->ana_q8 += (uint32_t)HOP * ws->rate_q8;
+    return HOP;
+}
+
+/**
+ * 丢弃已不再需要的输入 (上一帧自然延续之前、名义位置 - SEEK 之前)
+ */
+static void compact(audio_dsp_wsola_t *ws) {
+    if (!ws->started) {
+        return;
+    }
+    size_t keep = ws->prev + HOP;
+    size_t nominal = ws->ana_q8 >> 8;
+    if (nominal >= SEEK && nominal - SEEK < keep) {
+        keep = nominal - SEEK;
+    }
+    if (keep == 0) {
+        return;
+    }
+    if (keep > ws->len) {
+        keep = ws->len;
+    }
+    memmove(ws->buf, ws->buf + keep, (ws->len - keep) * sizeof(int16_t));
+    ws->len -= keep;
+    ws->prev -= keep;
+    ws->ana_q8 -= (uint32_t)keep << 8;
+}
+
+size_t audio_dsp_wsola_process(audio_dsp_wsola_t *ws, const int16_t *in, size_t count, int16_t *out) {
+    size_t produced = 0;
+    while (count > 0) {
+        size_t n = AUDIO_DSP_WSOLA_IN_CAP - ws->len;
+        if (n > count) {
+            n = count;
+        }
+        memcpy(ws->buf + ws->len, in, n * sizeof(int16_t));
+        ws->len += n;
+        in += n;
+        count -= n;
+        
+        size_t got;
+        while ((got = synth_hop(ws, out + produced)) > 0) {
+            produced += got;
+        }
+        compact(ws);
+    }
+    return produced;
+}
+
+size_t audio_dsp_wsola_flush(audio_dsp_wsola_t *ws, int16_t *out) {
+    size_t produced;
+    if (!ws->started) {
+        // 不足一帧，原样输出
+        produced = ws->len;
+        memcpy(out, ws->buf, produced * sizeof(int16_t));
+    } else {
+        // 用上一帧的自然延续代替加窗的后半部分，保证结尾连续
+        size_t from = ws->prev + HOP;
+        produced = ws->len > from ? ws->len - from : 0;
+        memcpy(out, ws->buf + from, produced * sizeof(int16_t));
+    }
+    ws->len = 0;
+    ws->started = false;
+    ws->ana_q8 = 0;
+    ws->prev = 0;
+    return produced;
+}
@@ -0,0 +1,125 @@
+/**
+ * WSOLA 变速主机基准
+ * 
+ * 在 16kHz 合成信号上检查 audio_dsp_wsola 并测量耗时：
+ * - 1.0 倍是否原样输出 (与输入的信噪比)
+ * - 1.1/1.2/1.3/1.5 倍的输出长度与目标比例的偏差，以及音高 (过零率估计) 是否不变
+ * - 输入按 256 和 37 个采样分块时输出是否逐位一致
+ * - 每秒音频的 CPU 耗时 (带颤音和幅度调制的谐波信号，近似语音)
+ * 
+ * 编译运行：
+ *   gcc -O2 -I.. ../audio_dsp_wsola.c wsola_bench.c -lm -o wsola_bench && ./wsola_bench
+ */
+
+#include "audio_dsp.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SAMPLE_RATE     16000
+#define SAMPLES         (10 * SAMPLE_RATE)
+#define CHUNK           256     // 与 streaming_tts 每次解码的采样数相同
+#define RUNS            10
+
+static int16_t s_in[SAMPLES];
+static int16_t s_out[SAMPLES + AUDIO_DSP_WSOLA_IN_CAP];
+static int16_t s_ref[SAMPLES + AUDIO_DSP_WSOLA_IN_CAP];
+static audio_dsp_wsola_t s_ws;
+
+static const uint16_t s_rates[] = {256, 282, 307, 333, 384};
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+ * 过零率估计的基频
+ */
+static double zero_cross_hz(const int16_t *x, size_t n) {
+    size_t zc = 0;
+    for (size_t i = 1; i < n; i++) {
+        if ((x[i - 1] < 0) != (x[i] < 0)) {
+            zc++;
+        }
+    }
+    return zc / 2.0 / ((double)n / SAMPLE_RATE);
+}
+
+/**
+ * 按 chunk 分块变速处理整段输入
+ */
+static size_t stretch(uint16_t rate_q8, size_t chunk, int16_t *out) {
+    audio_dsp_wsola_init(&s_ws, rate_q8);
+    size_t produced = 0;
+    for (size_t i = 0; i < SAMPLES; i += chunk) {
+        size_t n = SAMPLES - i < chunk ? SAMPLES - i : chunk;
+        produced += audio_dsp_wsola_process(&s_ws, s_in + i, n, out + produced);
+    }
+    produced += audio_dsp_wsola_flush(&s_ws, out + produced);
+    return produced;
+}
+
+int main(void) {
+    // 三个谐波的稳定音 (220Hz 基频)
+    for (int i = 0; i < SAMPLES; i++) {
+        double t = (double)i / SAMPLE_RATE;
+        s_in[i] = (int16_t)(9000 * sin(2 * M_PI * 220 * t) + 4000 * sin(2 * M_PI * 660 * t + 1) +
+                            2000 * sin(2 * M_PI * 1320 * t));
+    }
+    
+    printf("rate | out/in  target | pitch in -> out | note\n");
+    for (size_t k = 0; k < sizeof(s_rates) / sizeof(s_rates[0]); k++) {
+        size_t n = stretch(s_rates[k], CHUNK, s_out);
+        double target = s_rates[k] / 256.0;
+        printf("%.2f | %.4f  %.4f | %5.1f -> %5.1f Hz |", target, (double)SAMPLES / n, target,
+               zero_cross_hz(s_in + 1000, SAMPLES - 2000), zero_cross_hz(s_out + 1000, n - 2000));
+        if (s_rates[k] == AUDIO_DSP_RATE_UNITY) {
+            double sig = 0;
+            double err = 0;
+            for (size_t i = 0; i < n && i < SAMPLES; i++) {
+                double d = s_in[i] - s_out[i];
+                sig += (double)s_in[i] * s_in[i];
+                err += d * d;
+            }
+            printf(" SNR vs input %.1f dB", err > 0 ? 10 * log10(sig / err) : INFINITY);
+        }
+        printf("\n");
+    }
+    
+    // 分块大小不影响输出
+    size_t a = stretch(333, CHUNK, s_ref);
+    size_t b = stretch(333, 37, s_out);
+    bool same = a == b && memcmp(s_ref, s_out, a * sizeof(int16_t)) == 0;
+    printf("chunking 256 vs 37 at 1.30x: %zu vs %zu samples, %s\n", a, b, same ? "identical" : "DIFFERENT");
+    
+    // 近似语音：带颤音的 12 次谐波，4Hz 幅度调制
+    for (int i = 0; i < SAMPLES; i++) {
+        double t = (double)i / SAMPLE_RATE;
+        double f0 = 140 + 20 * sin(2 * M_PI * 3 * t);
+        double v = 0;
+        for (int h = 1; h <= 12; h++) {
+            v += sin(2 * M_PI * f0 * h * t) / h;
+        }
+        s_in[i] = (int16_t)(7000 * v * (0.6 + 0.4 * sin(2 * M_PI * 4 * t)));
+    }
+    
+    printf("\nrate | CPU per second of input (best of %d)\n", RUNS);
+    for (size_t k = 0; k < sizeof(s_rates) / sizeof(s_rates[0]); k++) {
+        double best = 1e18;
+        for (int r = 0; r < RUNS; r++) {
+            double t0 = now_us();
+            stretch(s_rates[k], CHUNK, s_out);
+            double t = now_us() - t0;
+            if (t < best) {
+                best = t;
+            }
+        }
+        double per_second_ms = best / ((double)SAMPLES / SAMPLE_RATE) / 1000.0;
+        printf("%.2f | %.2f ms (%.0fx realtime)\n", s_rates[k] / 256.0, per_second_ms, 1000.0 / per_second_ms);
+    }
+    return same ? 0 : 1;
+}
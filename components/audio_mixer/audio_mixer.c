@@ -0,0 +1,201 @@
+/**
+ * 多路软件混音器实现
+ */
+
+#include "audio_mixer.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/stream_buffer.h"
+#include <string.h>
+#include <stdlib.h>
+
+static const char *TAG = "AUDIO_MIXER";
+
+/**
+ * 单路状态
+ */
+typedef struct {
+    StreamBufferHandle_t buffer;
+    int32_t gain;                       // 当前增益 (Q15)，仅馈送任务修改
+    volatile int32_t target_gain;       // 目标增益 (Q15)
+    volatile int32_t gain_step;         // 每帧增益变化量
+    uint32_t fade_in_frames;            // 从空闲恢复时的淡入帧数
+    bool idle;                          // 上一次 render 时是否没有数据
+} mixer_voice_t;
+
+struct audio_mixer {
+    size_t max_block_frames;
+    mixer_voice_t voices[AUDIO_MIXER_MAX_VOICES];   // buffer 为 NULL 表示该路未打开
+    int16_t *scratch;                   // 单路读取缓冲区 (16 字节对齐)
+};
+
+static inline bool voice_valid(audio_mixer_handle_t mixer, int voice) {
+    return mixer != NULL && voice >= 0 && voice < AUDIO_MIXER_MAX_VOICES && mixer->voices[voice].buffer != NULL;
+}
+
+esp_err_t audio_mixer_create(const audio_mixer_config_t *config, audio_mixer_handle_t *out_handle) {
+    if (config == NULL || out_handle == NULL || config->max_block_frames == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    struct audio_mixer *mixer = calloc(1, sizeof(struct audio_mixer));
+    if (mixer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    mixer->max_block_frames = config->max_block_frames;
+    
+    mixer->scratch = heap_caps_aligned_alloc(16, config->max_block_frames * sizeof(int16_t),
+                                             MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (mixer->scratch == NULL) {
+        free(mixer);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    ESP_LOGI(TAG, "Mixer created (block %d frames)", (int)mixer->max_block_frames);
+    *out_handle = mixer;
+    return ESP_OK;
+}
+
+void audio_mixer_destroy(audio_mixer_handle_t mixer) {
+    if (mixer == NULL) {
+        return;
+    }
+    for (int i = 0; i < AUDIO_MIXER_MAX_VOICES; i++) {
+        audio_mixer_voice_close(mixer, i);
+    }
+    heap_caps_free(mixer->scratch);
+    free(mixer);
+}
+
+esp_err_t audio_mixer_voice_open(audio_mixer_handle_t mixer, const audio_mixer_voice_config_t *config, int *out_voice) {
+    if (mixer == NULL || config == NULL || out_voice == NULL || config->buffer_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    for (int i = 0; i < AUDIO_MIXER_MAX_VOICES; i++) {
+        mixer_voice_t *voice = &mixer->voices[i];
+        if (voice->buffer != NULL) {
+            continue;
+        }
+        voice->buffer = xStreamBufferCreate(config->buffer_size, sizeof(int16_t));
+        if (voice->buffer == NULL) {
+            ESP_LOGE(TAG, "Failed to create voice %d buffer (%d bytes)", i, (int)config->buffer_size);
+            return ESP_ERR_NO_MEM;
+        }
+        voice->gain = AUDIO_MIXER_GAIN_UNITY;
+        voice->target_gain = AUDIO_MIXER_GAIN_UNITY;
+        voice->gain_step = 0;
+        voice->fade_in_frames = config->fade_in_frames;
+        voice->idle = true;
+        *out_voice = i;
+        return ESP_OK;
+    }
+    
+    ESP_LOGE(TAG, "No free mixer voice");
+    return ESP_ERR_NO_MEM;
+}
+
+void audio_mixer_voice_close(audio_mixer_handle_t mixer, int voice) {
+    if (!voice_valid(mixer, voice)) {
+        return;
+    }
+    vStreamBufferDelete(mixer->voices[voice].buffer);
+    mixer->voices[voice].buffer = NULL;
+}
+
+size_t audio_mixer_write(audio_mixer_handle_t mixer, int voice, const int16_t *samples, size_t count,
+                         TickType_t timeout) {
+    if (!voice_valid(mixer, voice) || samples == NULL) {
+        return 0;
+    }
+    size_t sent = xStreamBufferSend(mixer->voices[voice].buffer, samples, count * sizeof(int16_t), timeout);
+    return sent / sizeof(int16_t);
+}
+
+void audio_mixer_set_gain(audio_mixer_handle_t mixer, int voice, int32_t gain_q15, uint32_t ramp_frames) {
+    if (!voice_valid(mixer, voice)) {
+        return;
+    }
+    if (gain_q15 < 0) {
+        gain_q15 = 0;
+    } else if (gain_q15 > AUDIO_MIXER_GAIN_UNITY) {
+        gain_q15 = AUDIO_MIXER_GAIN_UNITY;
+    }
+    
+    mixer_voice_t *v = &mixer->voices[voice];
+    int32_t delta = gain_q15 - v->gain;
+    if (delta < 0) {
+        delta = -delta;
+    }
+    // 斜坡步长至少为 1，保证在 ramp_frames 帧内到达目标
+    v->gain_step = ramp_frames == 0 ? 0 : (int32_t)((delta + ramp_frames - 1) / ramp_frames);
+    v->target_gain = gain_q15;
+}
+
+size_t audio_mixer_pending(audio_mixer_handle_t mixer, int voice) {
+    if (!voice_valid(mixer, voice)) {
+        return 0;
+    }
+    return xStreamBufferBytesAvailable(mixer->voices[voice].buffer) / sizeof(int16_t);
+}
+
+size_t audio_mixer_render(audio_mixer_handle_t mixer, int16_t *out, size_t frames,
+                          size_t consumed[AUDIO_MIXER_MAX_VOICES]) {
+    if (mixer == NULL || out == NULL) {
+        return 0;
+    }
+    if (frames > mixer->max_block_frames) {
+        frames = mixer->max_block_frames;
+    }
+    
+    memset(out, 0, frames * sizeof(int16_t));
+    size_t produced = 0;
+    
+    for (int i = 0; i < AUDIO_MIXER_MAX_VOICES; i++) {
+        mixer_voice_t *v = &mixer->voices[i];
+        size_t got = 0;
+        
+        if (v->buffer != NULL && xStreamBufferBytesAvailable(v->buffer) > 0) {
+            got = xStreamBufferReceive(v->buffer, mixer->scratch, frames * sizeof(int16_t), 0) / sizeof(int16_t);
+        }
+        if (consumed != NULL) {
+            consumed[i] = got;
+        }
+        if (got == 0) {
+            // 空闲时增益直接到位，下次有数据时不再从旧值开始过渡
+            v->gain = v->target_gain;
+            v->idle = true;
+            continue;
+        }
+        
+        if (v->idle && v->fade_in_frames > 0) {
+            // 从空闲恢复：由 0 淡入到目标增益
+            v->gain = 0;
+            v->gain_step = (int32_t)((v->target_gain + v->fade_in_frames - 1) / v->fade_in_frames);
+        }
+        v->idle = false;
+        
+        audio_dsp_gain_ramp_s16(mixer->scratch, got, &v->gain, v->target_gain, v->gain_step);
+        audio_dsp_add_sat_s16(out, mixer->scratch, got);
+        if (got > produced) {
+            produced = got;
+        }
+    }
+    
+    return produced;
+}
+
+size_t audio_mixer_discard(audio_mixer_handle_t mixer, int voice) {
+    if (!voice_valid(mixer, voice)) {
+        return 0;
+    }
+    
+    mixer_voice_t *v = &mixer->voices[voice];
+    size_t dropped = 0;
+    size_t chunk;
+    while ((chunk = xStreamBufferReceive(v->buffer, mixer->scratch,
+                                         mixer->max_block_frames * sizeof(int16_t), 0)) > 0) {
+        dropped += chunk / sizeof(int16_t);
+    }
+    return dropped;
+}
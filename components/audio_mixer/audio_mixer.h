@@ -0,0 +1,130 @@
+/**
+ * 多路软件混音器
+ * 
+ * 每一路 (voice) 拥有独立的 PCM 环形缓冲区和 Q15 增益斜坡，
+ * 由音频馈送任务周期性调用 audio_mixer_render 混合成一块后写入 I2S。
+ * 
+ * 线程模型：每一路只允许一个写入任务；render/discard 只能在馈送任务中调用；
+ * 打开/关闭路与 render 之间由调用者互斥。
+ */
+
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "audio_dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_MIXER_MAX_VOICES  4
+#define AUDIO_MIXER_GAIN_UNITY  AUDIO_DSP_GAIN_UNITY
+
+/**
+ * 混音器句柄
+ */
+typedef struct audio_mixer *audio_mixer_handle_t;
+
+/**
+ * 混音器配置
+ */
+typedef struct {
+    size_t max_block_frames;            ///< 单次 render 的最大帧数
+} audio_mixer_config_t;
+
+/**
+ * 单路配置
+ */
+typedef struct {
+    size_t buffer_size;                 ///< 环形缓冲区字节数
+    uint32_t fade_in_frames;            ///< 从空闲恢复时的淡入帧数 (0 为不淡入)
+} audio_mixer_voice_config_t;
+
+/**
+ * 创建混音器
+ * 
+ * 创建后没有任何路，需通过 audio_mixer_voice_open 按需打开。
+ * 
+ * @param config 配置
+ * @param out_handle 输出句柄
+ * @return ESP_OK 成功
+ */
+esp_err_t audio_mixer_create(const audio_mixer_config_t *config, audio_mixer_handle_t *out_handle);
+
+/**
+ * 打开一路
+ * 
+ * 与 render 不可并发，调用者需自行互斥。
+ * 
+ * @param config 单路配置
+ * @param out_voice 输出路编号
+ * @return ESP_OK 成功，ESP_ERR_NO_MEM 无空闲路或内存不足
+ */
+esp_err_t audio_mixer_voice_open(audio_mixer_handle_t mixer, const audio_mixer_voice_config_t *config, int *out_voice);
+
+/**
+ * 关闭一路并释放其缓冲区
+ * 
+ * 与 render 及该路的写入不可并发，调用者需自行互斥。
+ */
+void audio_mixer_voice_close(audio_mixer_handle_t mixer, int voice);
+
+/**
+ * 销毁混音器
+ */
+void audio_mixer_destroy(audio_mixer_handle_t mixer);
+
+/**
+ * 向某一路写入 PCM
+ * 
+ * 缓冲区满时最多阻塞 timeout。
+ * 
+ * @return 实际写入的采样数
+ */
+size_t audio_mixer_write(audio_mixer_handle_t mixer, int voice, const int16_t *samples, size_t count,
+                         TickType_t timeout);
+
+/**
+ * 设置某一路的目标增益
+ * 
+ * @param gain_q15 目标增益 (Q15，AUDIO_MIXER_GAIN_UNITY 为 1.0)
+ * @param ramp_frames 从当前增益过渡到目标增益所用帧数 (0 为立即生效)
+ */
+void audio_mixer_set_gain(audio_mixer_handle_t mixer, int voice, int32_t gain_q15, uint32_t ramp_frames);
+
+/**
+ * 查询某一路缓冲区中待混音的采样数
+ */
+size_t audio_mixer_pending(audio_mixer_handle_t mixer, int voice);
+
+/**
+ * 混合一块音频 (仅馈送任务调用)
+ * 
+ * 各路按各自增益斜坡叠加，结果饱和到 16 位；不足部分补零。
+ * 空闲的路在下次有数据时从当前目标增益开始 (配置了淡入时从 0 开始)。
+ * 
+ * @param out 输出缓冲区 (建议 16 字节对齐)，长度至少 frames
+ * @param frames 请求帧数 (不超过 max_block_frames)
+ * @param consumed 可选，输出每一路本次消耗的帧数
+ * @return 有效帧数 (所有路中消耗帧数的最大值)，0 表示全部空闲
+ */
+size_t audio_mixer_render(audio_mixer_handle_t mixer, int16_t *out, size_t frames,
+                          size_t consumed[AUDIO_MIXER_MAX_VOICES]);
+
+/**
+ * 丢弃某一路缓冲区中的全部数据 (仅馈送任务调用)
+ * 
+ * @return 丢弃的采样数
+ */
+size_t audio_mixer_discard(audio_mixer_handle_t mixer, int voice);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_MIXER_H
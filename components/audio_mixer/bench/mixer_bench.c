@@ -0,0 +1,259 @@
+/**
+ * 多路混音器主机基准
+ * 
+ * 按 audio_output 的用法 (16kHz，每次混合一个 240 帧的 DMA 缓冲区) 驱动 audio_mixer 并检查：
+ * - 单路单位增益时输出与输入的偏差
+ * - 4 路叠加 (每路峰值约为满幅的 0.6) 时输出是否与逐路增益、逐路饱和相加的参考结果逐位一致，以及削波的采样比例
+ * - 压低 (-6dB，10ms 斜坡) 后的增益是否在斜坡帧数内到位，空闲后恢复时的淡入是否从 0 开始
+ * - 各路数据量不同时有效帧数取最大值、不足部分补零
+ * - 1 到 4 路时每秒音频的 CPU 耗时 (增益恒定，以及每块都在斜坡中)
+ * 
+ * FreeRTOS 的流缓冲区使用 host/compat 中的单线程替身，耗时不含任务切换和加锁。
+ * 
+ * 编译运行：
+ *   gcc -O2 -I.. -I../../audio_dsp -I../../../host/compat ../audio_mixer.c ../../audio_dsp/audio_dsp.c \
+ *       mixer_bench.c -lm -o mixer_bench && ./mixer_bench 2>/dev/null
+ */
+
+#include "audio_mixer.h"
+#include "audio_dsp.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SAMPLE_RATE     16000
+#define BLOCK_FRAMES    240     // 与 MIX_BLOCK_FRAMES 相同
+#define VOICE_BUFFER    8192    // 单路缓冲区字节数
+#define DUCK_GAIN       (AUDIO_MIXER_GAIN_UNITY / 2)
+#define DUCK_RAMP       160     // 与 DUCK_RAMP_FRAMES 相同
+#define FADE_IN         80
+#define SECONDS         12      // 整数个块
+#define SAMPLES         (SECONDS * SAMPLE_RATE)
+#define RUNS            20
+
+static int16_t s_voice[AUDIO_MIXER_MAX_VOICES][SAMPLES];
+static int16_t s_out[SAMPLES];
+static int16_t s_ref[SAMPLES];
+static int16_t s_block[BLOCK_FRAMES] __attribute__((aligned(16)));
+static int16_t s_tmp[BLOCK_FRAMES] __attribute__((aligned(16)));
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static audio_mixer_handle_t open_mixer(int voices, uint32_t fade_in_frames) {
+    audio_mixer_config_t config = {.max_block_frames = BLOCK_FRAMES};
+    audio_mixer_handle_t mixer = NULL;
+    if (audio_mixer_create(&config, &mixer) != ESP_OK) {
+        return NULL;
+    }
+    audio_mixer_voice_config_t voice_config = {.buffer_size = VOICE_BUFFER, .fade_in_frames = fade_in_frames};
+    for (int i = 0; i < voices; i++) {
+        int voice = -1;
+        if (audio_mixer_voice_open(mixer, &voice_config, &voice) != ESP_OK || voice != i) {
+            audio_mixer_destroy(mixer);
+            return NULL;
+        }
+    }
+    return mixer;
+}
+
+/**
+ * 每块先给每一路写入一块再混合，直到所有路的数据都已混合
+ * 
+ * @param count 每一路的采样数
+ * @return 输出的有效帧数
+ */
+static size_t mix_all(audio_mixer_handle_t mixer, int voices, const size_t count[], int16_t *out) {
+    size_t written[AUDIO_MIXER_MAX_VOICES] = {0};
+    size_t produced = 0;
+    for (;;) {
+        for (int i = 0; i < voices; i++) {
+            size_t n = count[i] - written[i] < BLOCK_FRAMES ? count[i] - written[i] : BLOCK_FRAMES;
+            written[i] += audio_mixer_write(mixer, i, s_voice[i] + written[i], n, 0);
+        }
+        size_t frames = audio_mixer_render(mixer, s_block, BLOCK_FRAMES, NULL);
+        if (frames == 0) {
+            return produced;
+        }
+        memcpy(out + produced, s_block, frames * sizeof(int16_t));
+        produced += frames;
+    }
+}
+
+static int max_diff(const int16_t *a, const int16_t *b, size_t n) {
+    int d = 0;
+    for (size_t i = 0; i < n; i++) {
+        int v = abs(a[i] - b[i]);
+        if (v > d) {
+            d = v;
+        }
+    }
+    return d;
+}
+
+static bool check_passthrough(void) {
+    audio_mixer_handle_t mixer = open_mixer(1, 0);
+    size_t count[1] = {SAMPLES};
+    size_t n = mix_all(mixer, 1, count, s_out);
+    int d = max_diff(s_out, s_voice[0], SAMPLES);
+    audio_mixer_destroy(mixer);
+    printf("1 voice at unity: %zu frames, max |out - in| %d LSB\n", n, d);
+    return n == SAMPLES && d <= 1;
+}
+
+static bool check_sum(void) {
+    audio_mixer_handle_t mixer = open_mixer(AUDIO_MIXER_MAX_VOICES, 0);
+    size_t count[AUDIO_MIXER_MAX_VOICES] = {SAMPLES, SAMPLES, SAMPLES, SAMPLES};
+    size_t n = mix_all(mixer, AUDIO_MIXER_MAX_VOICES, count, s_out);
+    audio_mixer_destroy(mixer);
+    
+    // 参考：逐路单位增益，按路的顺序饱和相加
+    memset(s_ref, 0, sizeof(s_ref));
+    for (int i = 0; i < AUDIO_MIXER_MAX_VOICES; i++) {
+        for (size_t k = 0; k < SAMPLES; k += BLOCK_FRAMES) {
+            memcpy(s_tmp, s_voice[i] + k, BLOCK_FRAMES * sizeof(int16_t));
+            audio_dsp_gain_s16(s_tmp, BLOCK_FRAMES, AUDIO_MIXER_GAIN_UNITY);
+            audio_dsp_add_sat_s16(s_ref + k, s_tmp, BLOCK_FRAMES);
+        }
+    }
+    size_t clipped = 0;
+    for (size_t k = 0; k < SAMPLES; k++) {
+        clipped += s_out[k] == INT16_MAX || s_out[k] == INT16_MIN;
+    }
+    bool same = n == SAMPLES && memcmp(s_out, s_ref, sizeof(s_ref)) == 0;
+    printf("4 voices summed: %s the saturating reference, %.1f%% of samples clipped\n",
+           same ? "identical to" : "DIFFERENT from", 100.0 * clipped / SAMPLES);
+    return same;
+}
+
+static bool check_duck(void) {
+    audio_mixer_handle_t mixer = open_mixer(1, 0);
+    size_t frames = 0;
+    int ramp_end = -1;
+    int d = 0;
+    for (size_t k = 0; k < 4 * BLOCK_FRAMES; k += BLOCK_FRAMES) {
+        if (k == BLOCK_FRAMES) {
+            audio_mixer_set_gain(mixer, 0, DUCK_GAIN, DUCK_RAMP);
+        }
+        audio_mixer_write(mixer, 0, s_voice[0] + k, BLOCK_FRAMES, 0);
+        frames += audio_mixer_render(mixer, s_out + k, BLOCK_FRAMES, NULL);
+    }
+    // 斜坡结束后的输出应为输入的一半
+    for (size_t k = BLOCK_FRAMES + DUCK_RAMP; k < frames; k++) {
+        int expect = (int)lrint(s_voice[0][k] * (double)DUCK_GAIN / 32768);
+        int v = abs(s_out[k] - expect);
+        if (v > d) {
+            d = v;
+        }
+    }
+    // 斜坡中最后一个仍高于目标的采样
+    for (size_t k = BLOCK_FRAMES; k < BLOCK_FRAMES + DUCK_RAMP + 20; k++) {
+        if (abs(s_voice[0][k]) > 1000 && abs(s_out[k]) * 2 > abs(s_voice[0][k]) + 2) {
+            ramp_end = (int)(k - BLOCK_FRAMES);
+        }
+    }
+    bool duck_ok = frames == 4 * BLOCK_FRAMES && d <= 1 && ramp_end < DUCK_RAMP;
+    printf("duck to -6 dB over %d frames: above target until frame %d, then max error %d LSB -> %s\n",
+           DUCK_RAMP, ramp_end, d, duck_ok ? "ok" : "WRONG");
+    audio_mixer_destroy(mixer);
+    
+    // 空闲一块后恢复：从 0 淡入到目标增益 (第 2 路的信号在起点不为 0)
+    const int16_t *in = s_voice[1];
+    mixer = open_mixer(1, FADE_IN);
+    audio_mixer_write(mixer, 0, in, BLOCK_FRAMES, 0);
+    audio_mixer_render(mixer, s_out, BLOCK_FRAMES, NULL);
+    audio_mixer_render(mixer, s_out, BLOCK_FRAMES, NULL);
+    audio_mixer_write(mixer, 0, in, BLOCK_FRAMES, 0);
+    audio_mixer_render(mixer, s_out, BLOCK_FRAMES, NULL);
+    audio_mixer_destroy(mixer);
+    double mid = (double)s_out[FADE_IN / 2] / in[FADE_IN / 2];
+    int after = max_diff(s_out + FADE_IN, in + FADE_IN, BLOCK_FRAMES - FADE_IN);
+    bool fade_ok = abs(s_out[0]) * 50 < abs(in[0]) && fabs(mid - 0.5) < 0.05 && after <= 1;
+    printf("fade in over %d frames after idle: first sample %d (input %d), gain %.3f at frame %d, "
+           "max error after fade %d LSB -> %s\n", FADE_IN, s_out[0], in[0], mid, FADE_IN / 2, after,
+           fade_ok ? "ok" : "WRONG");
+    return duck_ok && fade_ok;
+}
+
+static bool check_uneven(void) {
+    audio_mixer_handle_t mixer = open_mixer(2, 0);
+    audio_mixer_write(mixer, 0, s_voice[0], 100, 0);
+    audio_mixer_write(mixer, 1, s_voice[1], 37, 0);
+    memset(s_block, 0x55, sizeof(s_block));
+    size_t consumed[AUDIO_MIXER_MAX_VOICES] = {0};
+    size_t frames = audio_mixer_render(mixer, s_block, BLOCK_FRAMES, consumed);
+    audio_mixer_destroy(mixer);
+    bool zero = true;
+    for (size_t k = frames; k < BLOCK_FRAMES; k++) {
+        zero = zero && s_block[k] == 0;
+    }
+    bool ok = frames == 100 && consumed[0] == 100 && consumed[1] == 37 && zero;
+    printf("100 + 37 frames queued: render returned %zu (consumed %zu / %zu), tail %s -> %s\n",
+           frames, consumed[0], consumed[1], zero ? "zeroed" : "NOT ZEROED", ok ? "ok" : "WRONG");
+    return ok;
+}
+
+/**
+ * 按 audio_output 馈送任务的节奏混合 SECONDS 秒音频
+ * 
+ * @param ramp 每块都让每一路在单位增益和 -6dB 之间切换 (斜坡覆盖整块)
+ */
+static double time_mix(int voices, bool ramp) {
+    audio_mixer_handle_t mixer = open_mixer(voices, 0);
+    double t0 = now_us();
+    for (size_t k = 0; k < SAMPLES; k += BLOCK_FRAMES) {
+        for (int i = 0; i < voices; i++) {
+            if (ramp) {
+                audio_mixer_set_gain(mixer, i, (k / BLOCK_FRAMES) & 1 ? AUDIO_MIXER_GAIN_UNITY : DUCK_GAIN,
+                                     BLOCK_FRAMES);
+            }
+            audio_mixer_write(mixer, i, s_voice[i] + k, BLOCK_FRAMES, 0);
+        }
+        audio_mixer_render(mixer, s_out + k, BLOCK_FRAMES, NULL);
+    }
+    double dt = now_us() - t0;
+    audio_mixer_destroy(mixer);
+    return dt;
+}
+
+int main(void) {
+    // 每一路为不同基频的谐波信号，峰值约为满幅的 0.6
+    for (int i = 0; i < AUDIO_MIXER_MAX_VOICES; i++) {
+        for (int k = 0; k < SAMPLES; k++) {
+            double t = (double)k / SAMPLE_RATE;
+            double f0 = 140 + 70 * i;
+            double v = 0;
+            for (int h = 1; h <= 6; h++) {
+                v += sin(2 * M_PI * f0 * h * t + i) / h;
+            }
+            s_voice[i][k] = (int16_t)(8000 * v * (0.7 + 0.3 * sin(2 * M_PI * (2 + i) * t)));
+        }
+    }
+    
+    bool ok = check_passthrough();
+    ok = check_sum() && ok;
+    ok = check_duck() && ok;
+    ok = check_uneven() && ok;
+    
+    printf("\nvoices | CPU per second of audio, constant gain | with gain ramps (best of %d)\n", RUNS);
+    for (int voices = 1; voices <= AUDIO_MIXER_MAX_VOICES; voices++) {
+        double best[2] = {1e18, 1e18};
+        for (int r = 0; r < RUNS; r++) {
+            for (int m = 0; m < 2; m++) {
+                double dt = time_mix(voices, m == 1);
+                if (dt < best[m]) {
+                    best[m] = dt;
+                }
+            }
+        }
+        printf("%6d | %7.1f us (%.2f us per block) | %7.1f us (%.2f us per block)\n", voices,
+               best[0] / SECONDS, best[0] / (SAMPLES / BLOCK_FRAMES),
+               best[1] / SECONDS, best[1] / (SAMPLES / BLOCK_FRAMES));
+    }
+    return ok ? 0 : 1;
+}
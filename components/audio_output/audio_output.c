@@ -0,0 +1,1066 @@
+/**
+ * 共享音频输出实现
+ * 
+ * 馈送任务是唯一调用 esp_codec_dev_write 的任务：每次从混音器取一个
+ * DMA 缓冲区大小的块写入 I2S。I2S on_sent 回调按写入时间戳推进各流的输出位置。
+ */
+
+#include "audio_output.h"
+#include "pca9557.h"
+#include "audio_dsp.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_sys.h"
+#include "esp_codec_dev.h"
+#include "esp_codec_dev_defaults.h"
+#include "driver/i2s_std.h"
+#include "driver/i2c_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <stdlib.h>
+
+static const char *TAG = "AUDIO_OUTPUT";
+
+// 硬件配置
+#define ES8311_ADDR             0x30
+#define OUTPUT_VOLUME           80
+#define I2S_DMA_DESC_NUM        6
+#define I2S_DMA_FRAME_NUM       240
+#define PA_SETTLE_MS            50
+
+// 功放电源
+#define PA_IDLE_OFF_MS          5000    // 默认：无音频且预热保持期结束后关闭功放的时间
+#define PA_PREWARM_HOLD_MS      10000   // 预热后即使没有音频也保持打开的时间
+#define PA_WAIT_TIMEOUT_MS      200     // set_pa 等待馈送任务打开功放的上限
+
+// 馈送任务
+#define MIX_BLOCK_FRAMES        I2S_DMA_FRAME_NUM   // 每次混合一个 DMA 缓冲区
+#define FEEDER_IDLE_WAIT_MS     20      // 所有流空闲时的休眠上限
+#define FEEDER_TASK_STACK       3072
+#define FEEDER_TASK_PRIORITY    7       // 高于各前端任务，保证 DMA 不断流
+#define FLUSH_TIMEOUT_MS        50
+
+// 淡出与压低
+#define FADE_OUT_STEPS          4       // 淡出音量台阶数
+#define FADE_OUT_STEP_US        1000    // 每个台阶的持续时间
+#define DUCK_GAIN_Q15           (AUDIO_MIXER_GAIN_UNITY / 2)  // -6dB
+#define DUCK_RAMP_FRAMES        160     // 压低斜坡 10ms
+#define UNDUCK_RAMP_FRAMES      800     // 恢复斜坡 50ms
+
+// 输出限幅：多路叠加时压到 -1dBFS 以下，代替饱和削波
+#define LIMITER_CEILING         29204   // -1dBFS
+#define LIMITER_ATTACK_FRAMES   16      // 1ms
+#define LIMITER_RELEASE_FRAMES  8000    // 500ms
+
+// 输出时钟
+#define MARK_RING_SIZE          16      // 写入时间戳环形缓冲区大小 (需为 2 的幂)
+#define LATENCY_EWMA_SHIFT      3       // 输出延迟滑动平均系数 1/8
+
+/**
+ * 写入时间戳：某次 esp_codec_dev_write 写完时的累计输出帧数、
+ * 各流累计混音帧数和写入时刻
+ */
+typedef struct {
+    uint64_t end_frame;
+    uint64_t stream_end[AUDIO_OUTPUT_MAX_STREAMS];
+    int64_t write_us;
+} output_mark_t;
+
+/**
+ * 流状态，槽位下标即混音器的路编号
+ * 
+ * 帧计数依次经过 已排队 (写入者) → 已混音 (馈送任务) → 已输出 (on_sent)，
+ * 由 s_clock_lock 保护；槽位复用时计数延续，保证旧时间戳不会让位置回退。
+ */
+struct audio_output_stream {
+    bool in_use;
+    int voice;
+    bool duck_others;
+    int32_t gain;                       // 调用者设置的增益 (Q15)
+    uint64_t frames_queued;
+    uint64_t frames_mixed;
+    uint64_t frames_played;
+    uint64_t wait_frame;                // 非 0 时到达该位置释放 played_sem
+    SemaphoreHandle_t played_sem;
+    SemaphoreHandle_t flush_sem;
+    volatile bool flush_requested;
+};
+
+/**
+ * 音频输出内部状态
+ */
+typedef struct {
+    audio_output_config_t config;
+    uint32_t ref_count;
+    
+    // I2S 和编解码器
+    i2s_chan_handle_t i2s_tx_handle;
+    const audio_codec_data_if_t *data_if;
+    const audio_codec_ctrl_if_t *ctrl_if;
+    const audio_codec_gpio_if_t *gpio_if;
+    const audio_codec_if_t *codec_if;
+    esp_codec_dev_handle_t codec_dev;
+    
+    // 功放电源：只由馈送任务切换 (acquire/teardown 除外)，时间字段由 s_clock_lock 保护
+    bool pa_enabled;
+    int64_t pa_ready_us;                // 打开后稳定可用的时刻
+    int64_t pa_hold_until_us;           // 在此之前保持打开 (预热或 set_pa 请求)
+    int64_t pa_last_audio_us;           // 最近一次输出音频的时刻
+    bool pa_off_requested;              // set_pa(false)：无音频时立即关闭
+    int64_t pa_idle_off_us;
+    uint32_t pa_power_ups;
+    uint32_t pa_cold_starts;
+    uint32_t pa_idle_offs;
+    uint32_t pa_wait_ms_total;
+    
+    // 混音
+    audio_mixer_handle_t mixer;
+    int16_t *mix_block;                 // 混音输出块 (16 字节对齐)
+    audio_dsp_limiter_t limiter;        // 仅馈送任务访问
+    SemaphoreHandle_t lock;             // 流打开/关闭与 render 互斥
+    struct audio_output_stream streams[AUDIO_OUTPUT_MAX_STREAMS];
+    bool ducked;
+    
+    // 馈送任务
+    TaskHandle_t feeder_task;
+    volatile bool should_stop;
+    SemaphoreHandle_t feeder_exit_sem;
+    volatile bool flush_pending;
+    
+    // 输出时钟
+    uint64_t frames_written;
+    uint64_t frames_played;
+    output_mark_t marks[MARK_RING_SIZE];
+    uint32_t mark_head;
+    uint32_t mark_tail;
+    uint32_t last_latency_us;
+    uint32_t avg_latency_us;
+    uint32_t flushes;
+    int16_t output_peak;
+} audio_output_t;
+
+static audio_output_t *s_out = NULL;
+static portMUX_TYPE s_clock_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// acquire/release 互斥锁，第一次使用时创建
+static StaticSemaphore_t s_ref_lock_buf;
+static SemaphoreHandle_t s_ref_lock = NULL;
+static bool s_ref_lock_created = false;
+
+static void feeder_task(void *arg);
+
+// ============================================================================
+// I2S 事件回调
+// ============================================================================
+
+/**
+ * I2S TX 发送完成回调
+ * 
+ * 推进输出帧数，越过的写入时间戳用于更新各流的输出位置和测量输出延迟；
+ * 流到达等待位置时释放其信号量。
+ */
+static IRAM_ATTR bool i2s_tx_sent_callback(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx) {
+    BaseType_t high_task_wakeup = pdFALSE;
+    audio_output_t *out = s_out;
+    
+    if (out == NULL) {
+        return false;
+    }
+    
+    SemaphoreHandle_t wake[AUDIO_OUTPUT_MAX_STREAMS];
+    int wake_count = 0;
+    int64_t now_us = esp_timer_get_time();
+    
+    portENTER_CRITICAL_ISR(&s_clock_lock);
+    // 本次发送中属于有效音频的帧数（其余为 DMA 自动填充的静音）
+    uint64_t pending = out->frames_written - out->frames_played;
+    uint64_t sent_frames = event->size / sizeof(int16_t);
+    if (sent_frames > pending) {
+        sent_frames = pending;
+    }
+    
+    if (sent_frames > 0) {
+        out->frames_played += sent_frames;
+        while (out->mark_tail != out->mark_head) {
+            output_mark_t *mark = &out->marks[out->mark_tail % MARK_RING_SIZE];
+            if (mark->end_frame > out->frames_played) {
+                break;
+            }
+            for (int i = 0; i < AUDIO_OUTPUT_MAX_STREAMS; i++) {
+                if (mark->stream_end[i] > out->streams[i].frames_played) {
+                    out->streams[i].frames_played = mark->stream_end[i];
+                }
+            }
+            uint32_t latency_us = (uint32_t)(now_us - mark->write_us);
+            out->last_latency_us = latency_us;
+            if (out->avg_latency_us == 0) {
+                out->avg_latency_us = latency_us;
+            } else {
+                out->avg_latency_us += ((int32_t)latency_us - (int32_t)out->avg_latency_us) >> LATENCY_EWMA_SHIFT;
+            }
+            out->mark_tail++;
+        }
+        
+        for (int i = 0; i < AUDIO_OUTPUT_MAX_STREAMS; i++) {
+            struct audio_output_stream *stream = &out->streams[i];
+            if (stream->in_use && stream->wait_frame != 0 && stream->frames_played >= stream->wait_frame) {
+                stream->wait_frame = 0;
+                wake[wake_count++] = stream->played_sem;
+            }
+        }
+    }
+    portEXIT_CRITICAL_ISR(&s_clock_lock);
+    
+    for (int i = 0; i < wake_count; i++) {
+        xSemaphoreGiveFromISR(wake[i], &high_task_wakeup);
+    }
+    
+    return high_task_wakeup == pdTRUE;
+}
+
+// ============================================================================
+// 硬件初始化
+// ============================================================================
+
+static esp_err_t init_es8311_codec(void) {
+    ESP_LOGI(TAG, "Initializing ES8311 codec...");
+    
+    // 创建 I2S 通道
+    i2s_chan_config_t chan_cfg = {
+        .id = I2S_NUM_0,
+        .role = I2S_ROLE_MASTER,
+        .dma_desc_num = I2S_DMA_DESC_NUM,
+        .dma_frame_num = I2S_DMA_FRAME_NUM,
+        .auto_clear_after_cb = true,
+        .auto_clear_before_cb = false,
+        .intr_priority = 0,
+    };
+    
+    esp_err_t ret = i2s_new_channel(&chan_cfg, &s_out->i2s_tx_handle, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create I2S channel");
+        return ret;
+    }
+    
+    // 配置 I2S 标准模式
+    i2s_std_config_t std_cfg = {
+        .clk_cfg = {
+            .sample_rate_hz = AUDIO_OUTPUT_SAMPLE_RATE,
+            .clk_src = I2S_CLK_SRC_DEFAULT,
+            .mclk_multiple = I2S_MCLK_MULTIPLE_256,
+        },
+        .slot_cfg = {
+            .data_bit_width = I2S_DATA_BIT_WIDTH_16BIT,
+            .slot_bit_width = I2S_SLOT_BIT_WIDTH_AUTO,
+            .slot_mode = I2S_SLOT_MODE_MONO,
+            .slot_mask = I2S_STD_SLOT_LEFT,
+            .ws_width = I2S_DATA_BIT_WIDTH_16BIT,
+            .ws_pol = false,
+            .bit_shift = true,
+        },
+        .gpio_cfg = {
+            .mclk = s_out->config.i2s_mclk_pin,
+            .bclk = s_out->config.i2s_bclk_pin,
+            .ws = s_out->config.i2s_ws_pin,
+            .dout = s_out->config.i2s_dout_pin,
+            .din = I2S_GPIO_UNUSED,
+            .invert_flags = {
+                .mclk_inv = false,
+                .bclk_inv = false,
+                .ws_inv = false,
+            },
+        },
+    };
+    
+    ret = i2s_channel_init_std_mode(s_out->i2s_tx_handle, &std_cfg);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // 注册 I2S TX 发送完成回调
+    i2s_event_callbacks_t cbs = {
+        .on_recv = NULL,
+        .on_recv_q_ovf = NULL,
+        .on_sent = i2s_tx_sent_callback,
+        .on_send_q_ovf = NULL,
+    };
+    ret = i2s_channel_register_event_callback(s_out->i2s_tx_handle, &cbs, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to register I2S callback: %s", esp_err_to_name(ret));
+        // 继续执行，回调失败时播放位置不会推进
+    }
+    
+    // 创建 I2S 数据接口
+    audio_codec_i2s_cfg_t i2s_cfg = {
+        .port = I2S_NUM_0,
+        .rx_handle = NULL,
+        .tx_handle = s_out->i2s_tx_handle,
+    };
+    s_out->data_if = audio_codec_new_i2s_data(&i2s_cfg);
+    if (s_out->data_if == NULL) {
+        return ESP_FAIL;
+    }
+    
+    // 创建 I2C 控制接口
+    audio_codec_i2c_cfg_t i2c_cfg = {
+        .port = I2C_NUM_1,
+        .addr = ES8311_ADDR,
+        .bus_handle = s_out->config.i2c_bus_handle,
+    };
+    s_out->ctrl_if = audio_codec_new_i2c_ctrl(&i2c_cfg);
+    if (s_out->ctrl_if == NULL) {
+        return ESP_FAIL;
+    }
+    
+    // 创建 GPIO 接口
+    s_out->gpio_if = audio_codec_new_gpio();
+    if (s_out->gpio_if == NULL) {
+        return ESP_FAIL;
+    }
+    
+    // 创建 ES8311 编解码器
+    es8311_codec_cfg_t es8311_cfg = {
+        .ctrl_if = s_out->ctrl_if,
+        .gpio_if = s_out->gpio_if,
+        .codec_mode = ESP_CODEC_DEV_WORK_MODE_DAC,
+        .pa_pin = -1,
+        .use_mclk = true,
+        .hw_gain = {
+            .pa_voltage = 5.0,
+            .codec_dac_voltage = 3.3,
+        },
+    };
+    s_out->codec_if = es8311_codec_new(&es8311_cfg);
+    if (s_out->codec_if == NULL) {
+        return ESP_FAIL;
+    }
+    
+    // 创建编解码器设备
+    esp_codec_dev_cfg_t dev_cfg = {
+        .dev_type = ESP_CODEC_DEV_TYPE_OUT,
+        .codec_if = s_out->codec_if,
+        .data_if = s_out->data_if,
+    };
+    s_out->codec_dev = esp_codec_dev_new(&dev_cfg);
+    if (s_out->codec_dev == NULL) {
+        return ESP_FAIL;
+    }
+    
+    // 打开编解码器
+    esp_codec_dev_sample_info_t fs = {
+        .bits_per_sample = 16,
+        .channel = 1,
+        .channel_mask = 0,
+        .sample_rate = AUDIO_OUTPUT_SAMPLE_RATE,
+        .mclk_multiple = 0,
+    };
+    ret = esp_codec_dev_open(s_out->codec_dev, &fs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // 设置音量
+    esp_codec_dev_set_out_vol(s_out->codec_dev, OUTPUT_VOLUME);
+    
+    ESP_LOGI(TAG, "ES8311 codec initialized");
+    return ESP_OK;
+}
+
+static void deinit_es8311_codec(void) {
+    if (s_out->codec_dev != NULL) {
+        esp_codec_dev_close(s_out->codec_dev);
+        esp_codec_dev_delete(s_out->codec_dev);
+        s_out->codec_dev = NULL;
+    }
+    if (s_out->codec_if != NULL) {
+        audio_codec_delete_codec_if(s_out->codec_if);
+        s_out->codec_if = NULL;
+    }
+    if (s_out->gpio_if != NULL) {
+        audio_codec_delete_gpio_if(s_out->gpio_if);
+        s_out->gpio_if = NULL;
+    }
+    if (s_out->ctrl_if != NULL) {
+        audio_codec_delete_ctrl_if(s_out->ctrl_if);
+        s_out->ctrl_if = NULL;
+    }
+    if (s_out->data_if != NULL) {
+        audio_codec_delete_data_if(s_out->data_if);
+        s_out->data_if = NULL;
+    }
+    if (s_out->i2s_tx_handle != NULL) {
+        i2s_del_channel(s_out->i2s_tx_handle);
+        s_out->i2s_tx_handle = NULL;
+    }
+}
+
+static esp_err_t set_pa_locked(bool enable) {
+    if (!pca9557_is_ready()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = pca9557_set_output(PCA9557_PIN_PA_EN, enable ? 1 : 0);
+    if (ret == ESP_OK) {
+        int64_t now_us = esp_timer_get_time();
+        portENTER_CRITICAL(&s_clock_lock);
+        s_out->pa_enabled = enable;
+        if (enable) {
+            s_out->pa_ready_us = now_us + PA_SETTLE_MS * 1000;
+            s_out->pa_last_audio_us = now_us;
+            s_out->pa_power_ups++;
+        }
+        portEXIT_CRITICAL(&s_clock_lock);
+        ESP_LOGI(TAG, "Audio PA %s", enable ? "enabled" : "disabled");
+    }
+    return ret;
+}
+
+/**
+ * 功放电源状态机 (馈送任务每轮调用)
+ * 
+ * 有音频或处于预热保持期时打开；之后无音频超过空闲时间 (或收到关闭请求) 时关闭。
+ * 句间停顿远短于空闲时间，功放在整轮对话中保持打开。
+ */
+static void pa_update(bool audio) {
+    if (!pca9557_is_ready()) {
+        return;
+    }
+    
+    int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&s_clock_lock);
+    bool enabled = s_out->pa_enabled;
+    bool held = now_us < s_out->pa_hold_until_us;
+    if (audio) {
+        s_out->pa_last_audio_us = now_us;
+    }
+    int64_t active_us = s_out->pa_last_audio_us > s_out->pa_hold_until_us ?
+                        s_out->pa_last_audio_us : s_out->pa_hold_until_us;
+    bool want;
+    if (audio || held) {
+        want = true;
+        s_out->pa_off_requested = false;
+    } else {
+        want = enabled && !s_out->pa_off_requested && now_us - active_us < s_out->pa_idle_off_us;
+    }
+    bool idle_off = enabled && !want && !s_out->pa_off_requested;
+    if (!want) {
+        s_out->pa_off_requested = false;
+    }
+    portEXIT_CRITICAL(&s_clock_lock);
+    
+    if (want && !enabled) {
+        // 没有预热就来了音频：开头一段会在功放稳定前输出
+        if (set_pa_locked(true) == ESP_OK && !held) {
+            s_out->pa_cold_starts++;
+        }
+    } else if (!want && enabled) {
+        if (set_pa_locked(false) == ESP_OK && idle_off) {
+            s_out->pa_idle_offs++;
+        }
+    }
+}
+
+// ============================================================================
+// 馈送任务
+// ============================================================================
+
+/**
+ * 淡出并丢弃 DMA 中已排队的音频
+ * 
+ * 先通过编解码器音量台阶做一个几毫秒的淡出，避免截断处产生爆音；
+ * 再停止 I2S 通道、预载静音后重新启动，丢弃 DMA 描述符中尚未发送的数据
+ * (最多 I2S_DMA_DESC_NUM * I2S_DMA_FRAME_NUM 帧，约 90ms)。
+ * 只能在馈送任务中调用，保证与 esp_codec_dev_write 不并发。
+ */
+static void fade_out_and_flush(void) {
+    for (int step = FADE_OUT_STEPS - 1; step >= 0; step--) {
+        esp_codec_dev_set_out_vol(s_out->codec_dev, OUTPUT_VOLUME * step / FADE_OUT_STEPS);
+        esp_rom_delay_us(FADE_OUT_STEP_US);
+    }
+    
+    if (i2s_channel_disable(s_out->i2s_tx_handle) == ESP_OK) {
+        static const uint8_t silence[256] = {0};
+        size_t loaded = 0;
+        do {
+            if (i2s_channel_preload_data(s_out->i2s_tx_handle, silence, sizeof(silence), &loaded) != ESP_OK) {
+                break;
+            }
+        } while (loaded == sizeof(silence));
+        i2s_channel_enable(s_out->i2s_tx_handle);
+    }
+    
+    esp_codec_dev_set_out_vol(s_out->codec_dev, OUTPUT_VOLUME);
+}
+
+/**
+ * 处理各流的清空请求
+ * 
+ * 丢弃请求清空的流在混音器中的数据，清空 DMA 后把所有流的输出位置对齐：
+ * 请求清空的流视为全部已输出，其它流已进入 DMA 的数据视为已输出。
+ */
+static void process_flush_requests(void) {
+    bool flushed[AUDIO_OUTPUT_MAX_STREAMS] = {false};
+    bool any = false;
+    
+    for (int i = 0; i < AUDIO_OUTPUT_MAX_STREAMS; i++) {
+        struct audio_output_stream *stream = &s_out->streams[i];
+        if (stream->in_use && stream->flush_requested) {
+            audio_mixer_discard(s_out->mixer, stream->voice);
+            flushed[i] = true;
+            any = true;
+        }
+    }
+    if (!any) {
+        return;
+    }
+    
+    fade_out_and_flush();
+    
+    SemaphoreHandle_t wake[AUDIO_OUTPUT_MAX_STREAMS];
+    int wake_count = 0;
+    
+    portENTER_CRITICAL(&s_clock_lock);
+    s_out->frames_written = s_out->frames_played;
+    s_out->mark_tail = s_out->mark_head;
+    for (int i = 0; i < AUDIO_OUTPUT_MAX_STREAMS; i++) {
+        struct audio_output_stream *stream = &s_out->streams[i];
+        if (flushed[i]) {
+            stream->frames_mixed = stream->frames_queued;
+        }
+        stream->frames_played = stream->frames_mixed;
+        if (stream->in_use && stream->wait_frame != 0 && stream->frames_played >= stream->wait_frame) {
+            stream->wait_frame = 0;
+            wake[wake_count++] = stream->played_sem;
+        }
+    }
+    s_out->flushes++;
+    portEXIT_CRITICAL(&s_clock_lock);
+    
+    for (int i = 0; i < wake_count; i++) {
+        xSemaphoreGive(wake[i]);
+    }
+    for (int i = 0; i < AUDIO_OUTPUT_MAX_STREAMS; i++) {
+        if (flushed[i]) {
+            s_out->streams[i].flush_requested = false;
+            xSemaphoreGive(s_out->streams[i].flush_sem);
+        }
+    }
+}
+
+/**
+ * 根据提示音类流是否有数据压低或恢复其它流
+ */
+static void update_ducking(const size_t consumed[AUDIO_MIXER_MAX_VOICES]) {
+    bool duck = false;
+    for (int i = 0; i < AUDIO_OUTPUT_MAX_STREAMS; i++) {
+        if (s_out->streams[i].in_use && s_out->streams[i].duck_others && consumed[i] > 0) {
+            duck = true;
+            break;
+        }
+    }
+    if (duck == s_out->ducked) {
+        return;
+    }
+    
+    for (int i = 0; i < AUDIO_OUTPUT_MAX_STREAMS; i++) {
+        struct audio_output_stream *stream = &s_out->streams[i];
+        if (!stream->in_use || stream->duck_others) {
+            continue;
+        }
+        if (duck) {
+            audio_mixer_set_gain(s_out->mixer, i, (stream->gain * DUCK_GAIN_Q15) >> 15, DUCK_RAMP_FRAMES);
+        } else {
+            audio_mixer_set_gain(s_out->mixer, i, stream->gain, UNDUCK_RAMP_FRAMES);
+        }
+    }
+    s_out->ducked = duck;
+}
+
+/**
+ * 记录一次写入：累加输出帧数和各流混音帧数，并登记写入时刻
+ */
+static void clock_on_write(size_t frames, const size_t consumed[AUDIO_MIXER_MAX_VOICES], int64_t write_us) {
+    portENTER_CRITICAL(&s_clock_lock);
+    s_out->frames_written += frames;
+    for (int i = 0; i < AUDIO_OUTPUT_MAX_STREAMS; i++) {
+        s_out->streams[i].frames_mixed += consumed[i];
+    }
+    if (s_out->mark_head - s_out->mark_tail < MARK_RING_SIZE) {
+        output_mark_t *mark = &s_out->marks[s_out->mark_head % MARK_RING_SIZE];
+        mark->end_frame = s_out->frames_written;
+        for (int i = 0; i < AUDIO_OUTPUT_MAX_STREAMS; i++) {
+            mark->stream_end[i] = s_out->streams[i].frames_mixed;
+        }
+        mark->write_us = write_us;
+        s_out->mark_head++;
+    }
+    portEXIT_CRITICAL(&s_clock_lock);
+}
+
+/**
+ * 音频馈送任务
+ * 
+ * esp_codec_dev_write 在 DMA 满时阻塞，因此任务天然以播放速率运行；
+ * 所有流空闲时休眠，等待写入者通知。
+ */
+static void feeder_task(void *arg) {
+    ESP_LOGI(TAG, "Feeder task started");
+    
+    size_t consumed[AUDIO_MIXER_MAX_VOICES];
+    
+    while (!s_out->should_stop) {
+        xSemaphoreTake(s_out->lock, portMAX_DELAY);
+        if (s_out->flush_pending) {
+            s_out->flush_pending = false;
+            process_flush_requests();
+        }
+        size_t frames = audio_mixer_render(s_out->mixer, s_out->mix_block, MIX_BLOCK_FRAMES, consumed);
+        update_ducking(consumed);
+        xSemaphoreGive(s_out->lock);
+        
+        pa_update(frames > 0);
+        if (frames == 0) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FEEDER_IDLE_WAIT_MS));
+            continue;
+        }
+        
+        audio_dsp_limiter_process_s16(&s_out->limiter, s_out->mix_block, frames);
+        s_out->output_peak = audio_dsp_peak_s16(s_out->mix_block, frames);
+        
+        int64_t write_us = esp_timer_get_time();
+        esp_err_t ret = esp_codec_dev_write(s_out->codec_dev, s_out->mix_block, frames * sizeof(int16_t));
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to write audio data");
+        }
+        clock_on_write(frames, consumed, write_us);
+    }
+    
+    ESP_LOGI(TAG, "Feeder task stopped");
+    xSemaphoreGive(s_out->feeder_exit_sem);
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// 引用计数
+// ============================================================================
+
+static SemaphoreHandle_t get_ref_lock(void) {
+    static portMUX_TYPE create_lock = portMUX_INITIALIZER_UNLOCKED;
+    
+    portENTER_CRITICAL(&create_lock);
+    bool first = !s_ref_lock_created;
+    s_ref_lock_created = true;
+    portEXIT_CRITICAL(&create_lock);
+    
+    if (first) {
+        s_ref_lock = xSemaphoreCreateMutexStatic(&s_ref_lock_buf);
+    }
+    while (s_ref_lock == NULL) {
+        vTaskDelay(1);
+    }
+    return s_ref_lock;
+}
+
+/**
+ * 释放全部资源 (ref_lock 持有期间调用)
+ * 
+ * 先停止馈送任务并删除 I2S 通道，保证回调不再访问 s_out 后再释放。
+ */
+static void audio_output_teardown(void) {
+    if (s_out->feeder_task != NULL) {
+        s_out->should_stop = true;
+        xTaskNotifyGive(s_out->feeder_task);
+        xSemaphoreTake(s_out->feeder_exit_sem, portMAX_DELAY);
+    }
+    if (s_out->pa_enabled) {
+        set_pa_locked(false);
+    }
+    deinit_es8311_codec();
+    
+    audio_mixer_destroy(s_out->mixer);
+    if (s_out->mix_block != NULL) {
+        heap_caps_free(s_out->mix_block);
+    }
+    if (s_out->lock != NULL) {
+        vSemaphoreDelete(s_out->lock);
+    }
+    if (s_out->feeder_exit_sem != NULL) {
+        vSemaphoreDelete(s_out->feeder_exit_sem);
+    }
+    free(s_out);
+    s_out = NULL;
+}
+
+esp_err_t audio_output_acquire(const audio_output_config_t *config) {
+    if (config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    SemaphoreHandle_t ref_lock = get_ref_lock();
+    xSemaphoreTake(ref_lock, portMAX_DELAY);
+    
+    if (s_out != NULL) {
+        s_out->ref_count++;
+        ESP_LOGI(TAG, "Audio output acquired (refs: %lu)", (unsigned long)s_out->ref_count);
+        xSemaphoreGive(ref_lock);
+        return ESP_OK;
+    }
+    
+    ESP_LOGI(TAG, "Initializing audio output...");
+    
+    s_out = calloc(1, sizeof(audio_output_t));
+    if (s_out == NULL) {
+        xSemaphoreGive(ref_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    s_out->config = *config;
+    s_out->pa_idle_off_us = (int64_t)(config->pa_idle_off_ms ? config->pa_idle_off_ms : PA_IDLE_OFF_MS) * 1000;
+    
+    // 设置默认 I2S 引脚 (立创实战派 ESP32-S3 默认值)
+    if (s_out->config.i2s_mclk_pin == 0) s_out->config.i2s_mclk_pin = 38;
+    if (s_out->config.i2s_bclk_pin == 0) s_out->config.i2s_bclk_pin = 14;
+    if (s_out->config.i2s_ws_pin == 0) s_out->config.i2s_ws_pin = 13;
+    if (s_out->config.i2s_dout_pin == 0) s_out->config.i2s_dout_pin = 45;
+    
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    s_out->lock = xSemaphoreCreateMutex();
+    s_out->feeder_exit_sem = xSemaphoreCreateBinary();
+    if (s_out->lock == NULL || s_out->feeder_exit_sem == NULL) {
+        goto fail;
+    }
+    
+    audio_mixer_config_t mixer_cfg = {
+        .max_block_frames = MIX_BLOCK_FRAMES,
+    };
+    ret = audio_mixer_create(&mixer_cfg, &s_out->mixer);
+    if (ret != ESP_OK) {
+        goto fail;
+    }
+    s_out->mix_block = heap_caps_aligned_alloc(16, MIX_BLOCK_FRAMES * sizeof(int16_t),
+                                               MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (s_out->mix_block == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+    audio_dsp_limiter_init(&s_out->limiter, LIMITER_CEILING, LIMITER_ATTACK_FRAMES, LIMITER_RELEASE_FRAMES);
+    
+    // PCA9557 通常已由 main 初始化，这里保证音频单独使用时也可用
+    if (s_out->config.i2c_bus_handle != NULL && !pca9557_is_ready()) {
+        if (pca9557_init((i2c_master_bus_handle_t)s_out->config.i2c_bus_handle,
+                         PCA9557_DEFAULT_OUTPUT, PCA9557_DEFAULT_CONFIG) != ESP_OK) {
+            ESP_LOGW(TAG, "PCA9557 not found, PA control disabled");
+        }
+    }
+    
+    ret = init_es8311_codec();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to init ES8311 codec");
+        goto fail;
+    }
+    
+    if (pca9557_is_ready()) {
+        set_pa_locked(true);
+    }
+    
+    if (xTaskCreate(feeder_task, "audio_feeder", FEEDER_TASK_STACK, NULL, FEEDER_TASK_PRIORITY,
+                    &s_out->feeder_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create feeder task");
+        ret = ESP_FAIL;
+        goto fail;
+    }
+    
+    s_out->ref_count = 1;
+    ESP_LOGI(TAG, "Audio output initialized");
+    xSemaphoreGive(ref_lock);
+    return ESP_OK;
+
+fail:
+    audio_output_teardown();
+    xSemaphoreGive(ref_lock);
+    return ret;
+}
+
+void audio_output_release(void) {
+    SemaphoreHandle_t ref_lock = get_ref_lock();
+    xSemaphoreTake(ref_lock, portMAX_DELAY);
+    
+    if (s_out == NULL) {
+        xSemaphoreGive(ref_lock);
+        return;
+    }
+    
+    if (--s_out->ref_count > 0) {
+        ESP_LOGI(TAG, "Audio output released (refs: %lu)", (unsigned long)s_out->ref_count);
+        xSemaphoreGive(ref_lock);
+        return;
+    }
+    
+    for (int i = 0; i < AUDIO_OUTPUT_MAX_STREAMS; i++) {
+        if (s_out->streams[i].in_use) {
+            ESP_LOGW(TAG, "Stream %d still open at release", i);
+        }
+    }
+    audio_output_teardown();
+    ESP_LOGI(TAG, "Audio output destroyed");
+    xSemaphoreGive(ref_lock);
+}
+
+/**
+ * 延长功放保持期并唤醒馈送任务
+ */
+static void pa_hold(int64_t until_us) {
+    portENTER_CRITICAL(&s_clock_lock);
+    if (until_us > s_out->pa_hold_until_us) {
+        s_out->pa_hold_until_us = until_us;
+    }
+    s_out->pa_off_requested = false;
+    portEXIT_CRITICAL(&s_clock_lock);
+    xTaskNotifyGive(s_out->feeder_task);
+}
+
+esp_err_t audio_output_pa_prewarm(void) {
+    if (s_out == NULL || !pca9557_is_ready()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pa_hold(esp_timer_get_time() + PA_PREWARM_HOLD_MS * 1000);
+    return ESP_OK;
+}
+
+esp_err_t audio_output_set_pa(bool enable) {
+    if (s_out == NULL || !pca9557_is_ready()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (!enable) {
+        portENTER_CRITICAL(&s_clock_lock);
+        s_out->pa_hold_until_us = 0;
+        s_out->pa_off_requested = true;
+        portEXIT_CRITICAL(&s_clock_lock);
+        xTaskNotifyGive(s_out->feeder_task);
+        return ESP_OK;
+    }
+    
+    // 请求打开，只等待功放剩余的稳定时间；已预热时通常无需等待
+    int64_t start_us = esp_timer_get_time();
+    pa_hold(start_us + PA_PREWARM_HOLD_MS * 1000);
+    while (true) {
+        int64_t now_us = esp_timer_get_time();
+        portENTER_CRITICAL(&s_clock_lock);
+        bool enabled = s_out->pa_enabled;
+        int64_t ready_us = s_out->pa_ready_us;
+        portEXIT_CRITICAL(&s_clock_lock);
+        
+        if (enabled && now_us >= ready_us) {
+            break;
+        }
+        if (now_us - start_us >= PA_WAIT_TIMEOUT_MS * 1000) {
+            ESP_LOGW(TAG, "PA not ready after %d ms", PA_WAIT_TIMEOUT_MS);
+            return ESP_ERR_TIMEOUT;
+        }
+        TickType_t ticks = enabled ? pdMS_TO_TICKS((ready_us - now_us + 999) / 1000) : 1;
+        vTaskDelay(ticks > 0 ? ticks : 1);
+    }
+    
+    uint32_t waited_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+    portENTER_CRITICAL(&s_clock_lock);
+    s_out->pa_wait_ms_total += waited_ms;
+    portEXIT_CRITICAL(&s_clock_lock);
+    return ESP_OK;
+}
+
+// ============================================================================
+// 流
+// ============================================================================
+
+esp_err_t audio_output_stream_open(const audio_output_stream_config_t *config, audio_output_stream_t *out_stream) {
+    if (config == NULL || out_stream == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_out == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    SemaphoreHandle_t played_sem = xSemaphoreCreateBinary();
+    SemaphoreHandle_t flush_sem = xSemaphoreCreateBinary();
+    if (played_sem == NULL || flush_sem == NULL) {
+        goto no_mem;
+    }
+    
+    audio_mixer_voice_config_t voice_cfg = {
+        .buffer_size = config->buffer_size,
+        .fade_in_frames = config->fade_in_frames,
+    };
+    
+    xSemaphoreTake(s_out->lock, portMAX_DELAY);
+    int voice = -1;
+    esp_err_t ret = audio_mixer_voice_open(s_out->mixer, &voice_cfg, &voice);
+    if (ret != ESP_OK) {
+        xSemaphoreGive(s_out->lock);
+        vSemaphoreDelete(played_sem);
+        vSemaphoreDelete(flush_sem);
+        return ret;
+    }
+    
+    struct audio_output_stream *stream = &s_out->streams[voice];
+    portENTER_CRITICAL(&s_clock_lock);
+    uint64_t base = stream->frames_queued;
+    if (stream->frames_mixed > base) base = stream->frames_mixed;
+    if (stream->frames_played > base) base = stream->frames_played;
+    stream->frames_queued = base;
+    stream->frames_mixed = base;
+    stream->frames_played = base;
+    stream->wait_frame = 0;
+    portEXIT_CRITICAL(&s_clock_lock);
+    
+    stream->voice = voice;
+    stream->duck_others = config->duck_others;
+    stream->gain = AUDIO_MIXER_GAIN_UNITY;
+    stream->played_sem = played_sem;
+    stream->flush_sem = flush_sem;
+    stream->flush_requested = false;
+    stream->in_use = true;
+    if (s_out->ducked && !stream->duck_others) {
+        audio_mixer_set_gain(s_out->mixer, voice, DUCK_GAIN_Q15, 0);
+    }
+    xSemaphoreGive(s_out->lock);
+    
+    ESP_LOGI(TAG, "Stream %d opened (%d bytes)", voice, (int)config->buffer_size);
+    *out_stream = stream;
+    return ESP_OK;
+
+no_mem:
+    if (played_sem != NULL) {
+        vSemaphoreDelete(played_sem);
+    }
+    if (flush_sem != NULL) {
+        vSemaphoreDelete(flush_sem);
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+void audio_output_stream_close(audio_output_stream_t stream) {
+    if (stream == NULL || s_out == NULL || !stream->in_use) {
+        return;
+    }
+    
+    xSemaphoreTake(s_out->lock, portMAX_DELAY);
+    portENTER_CRITICAL(&s_clock_lock);
+    stream->in_use = false;
+    stream->wait_frame = 0;
+    portEXIT_CRITICAL(&s_clock_lock);
+    audio_mixer_voice_close(s_out->mixer, stream->voice);
+    vSemaphoreDelete(stream->played_sem);
+    vSemaphoreDelete(stream->flush_sem);
+    stream->played_sem = NULL;
+    stream->flush_sem = NULL;
+    xSemaphoreGive(s_out->lock);
+    
+    ESP_LOGI(TAG, "Stream %d closed", stream->voice);
+}
+
+size_t audio_output_stream_write(audio_output_stream_t stream, const int16_t *samples, size_t count,
+                                 TickType_t timeout) {
+    if (stream == NULL || s_out == NULL || !stream->in_use || samples == NULL) {
+        return 0;
+    }
+    
+    size_t written = audio_mixer_write(s_out->mixer, stream->voice, samples, count, timeout);
+    if (written > 0) {
+        portENTER_CRITICAL(&s_clock_lock);
+        stream->frames_queued += written;
+        portEXIT_CRITICAL(&s_clock_lock);
+        xTaskNotifyGive(s_out->feeder_task);
+    }
+    return written;
+}
+
+void audio_output_stream_set_gain(audio_output_stream_t stream, int32_t gain_q15, uint32_t ramp_frames) {
+    if (stream == NULL || s_out == NULL || !stream->in_use) {
+        return;
+    }
+    
+    xSemaphoreTake(s_out->lock, portMAX_DELAY);
+    stream->gain = gain_q15;
+    if (s_out->ducked && !stream->duck_others) {
+        gain_q15 = (gain_q15 * DUCK_GAIN_Q15) >> 15;
+    }
+    audio_mixer_set_gain(s_out->mixer, stream->voice, gain_q15, ramp_frames);
+    xSemaphoreGive(s_out->lock);
+}
+
+bool audio_output_stream_wait(audio_output_stream_t stream, uint64_t frame, TickType_t timeout) {
+    if (stream == NULL || s_out == NULL || !stream->in_use) {
+        return false;
+    }
+    
+    xSemaphoreTake(stream->played_sem, 0);
+    portENTER_CRITICAL(&s_clock_lock);
+    bool reached = stream->frames_played >= frame;
+    stream->wait_frame = reached ? 0 : frame;
+    portEXIT_CRITICAL(&s_clock_lock);
+    
+    if (reached) {
+        return true;
+    }
+    xSemaphoreTake(stream->played_sem, timeout);
+    
+    portENTER_CRITICAL(&s_clock_lock);
+    reached = stream->frames_played >= frame;
+    stream->wait_frame = 0;
+    portEXIT_CRITICAL(&s_clock_lock);
+    return reached;
+}
+
+esp_err_t audio_output_stream_flush(audio_output_stream_t stream) {
+    if (stream == NULL || s_out == NULL || !stream->in_use) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    xSemaphoreTake(stream->flush_sem, 0);
+    stream->flush_requested = true;
+    s_out->flush_pending = true;
+    xTaskNotifyGive(s_out->feeder_task);
+    if (xSemaphoreTake(stream->flush_sem, pdMS_TO_TICKS(FLUSH_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "Feeder did not flush within %d ms", FLUSH_TIMEOUT_MS);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+void audio_output_stream_get_position(audio_output_stream_t stream, audio_output_position_t *position) {
+    if (stream == NULL || position == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_clock_lock);
+    position->frames_queued = stream->frames_queued;
+    position->frames_played = stream->frames_played;
+    portEXIT_CRITICAL(&s_clock_lock);
+}
+
+esp_err_t audio_output_get_stats(audio_output_stats_t *stats) {
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_out == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    portENTER_CRITICAL(&s_clock_lock);
+    stats->frames_written = s_out->frames_written;
+    stats->frames_played = s_out->frames_played;
+    stats->last_latency_us = s_out->last_latency_us;
+    stats->avg_latency_us = s_out->avg_latency_us;
+    stats->flushes = s_out->flushes;
+    stats->ref_count = s_out->ref_count;
+    stats->output_peak = s_out->output_peak;
+    stats->limited_blocks = s_out->limiter.limited_blocks;
+    stats->pa_enabled = s_out->pa_enabled;
+    stats->pa_power_ups = s_out->pa_power_ups;
+    stats->pa_cold_starts = s_out->pa_cold_starts;
+    stats->pa_idle_offs = s_out->pa_idle_offs;
+    stats->pa_wait_ms_total = s_out->pa_wait_ms_total;
+    portEXIT_CRITICAL(&s_clock_lock);
+    return ESP_OK;
+}
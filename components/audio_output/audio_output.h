@@ -0,0 +1,186 @@
+/**
+ * 共享音频输出
+ * 
+ * 统一管理立创实战派 ESP32-S3 的音频输出链路：I2S_NUM_0 通道及其 DMA、
+ * ES8311 编解码器、PCA9557 控制的功放。多个前端 (tts_service、streaming_tts)
+ * 通过引用计数共享同一套硬件，各自打开一路流 (stream) 写入 PCM，
+ * 由内部馈送任务经软件混音器叠加后写入 I2S。
+ * 
+ * 音频格式固定为 16kHz 单声道 16 位 PCM。
+ */
+
+#ifndef AUDIO_OUTPUT_H
+#define AUDIO_OUTPUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "audio_mixer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_OUTPUT_SAMPLE_RATE    16000
+#define AUDIO_OUTPUT_MAX_STREAMS    AUDIO_MIXER_MAX_VOICES
+
+/**
+ * 硬件配置 (仅第一次 acquire 时生效，引脚为 0 时使用开发板默认值)
+ */
+typedef struct {
+    int i2s_mclk_pin;           ///< I2S MCLK 引脚 (默认 38)
+    int i2s_bclk_pin;           ///< I2S BCLK 引脚 (默认 14)
+    int i2s_ws_pin;             ///< I2S WS/LRCK 引脚 (默认 13)
+    int i2s_dout_pin;           ///< I2S DOUT 引脚 (默认 45)
+    void *i2c_bus_handle;       ///< i2c_master_bus_handle_t，用于 ES8311 和 PCA9557
+    uint32_t pa_idle_off_ms;    ///< 无音频多久后关闭功放 (0 使用默认 5000ms)
+} audio_output_config_t;
+
+/**
+ * 流句柄
+ */
+typedef struct audio_output_stream *audio_output_stream_t;
+
+/**
+ * 流配置
+ */
+typedef struct {
+    size_t buffer_size;         ///< 流缓冲区字节数
+    uint32_t fade_in_frames;    ///< 从空闲恢复时的淡入帧数 (0 为不淡入)
+    bool duck_others;           ///< 本流有数据时把其它流压低 6dB (用于提示音)
+} audio_output_stream_config_t;
+
+/**
+ * 流播放位置 (帧)
+ * 
+ * 计数自流所在槽位创建起单调递增，调用者应使用差值。
+ */
+typedef struct {
+    uint64_t frames_queued;     ///< 已写入流的帧数
+    uint64_t frames_played;     ///< 已确认从 I2S 输出 (或被丢弃) 的帧数
+} audio_output_position_t;
+
+/**
+ * 输出统计
+ */
+typedef struct {
+    uint64_t frames_written;    ///< 累计写入 I2S 的帧数 (混音后)
+    uint64_t frames_played;     ///< 累计经 on_sent 确认输出的帧数
+    uint32_t last_latency_us;   ///< 最近一次测得的写入到 DMA 发送完成的延迟
+    uint32_t avg_latency_us;    ///< 输出延迟的滑动平均
+    uint32_t flushes;           ///< DMA 清空次数
+    uint32_t ref_count;         ///< 当前引用数
+    int16_t output_peak;        ///< 最近一块输出的峰值
+    uint32_t limited_blocks;    ///< 输出限幅器压低增益的块数
+    bool pa_enabled;            ///< 功放当前是否打开
+    uint32_t pa_power_ups;      ///< 功放打开次数
+    uint32_t pa_cold_starts;    ///< 未经预热、由音频到达触发的打开次数
+    uint32_t pa_idle_offs;      ///< 空闲超时关闭次数
+    uint32_t pa_wait_ms_total;  ///< 调用者在 set_pa 中等待功放稳定的累计时间
+} audio_output_stats_t;
+
+/**
+ * 获取音频输出 (引用计数 +1)
+ * 
+ * 第一次调用时初始化 I2S、编解码器并打开功放，之后的调用只增加引用计数。
+ * 
+ * @param config 硬件配置
+ * @return ESP_OK 成功
+ */
+esp_err_t audio_output_acquire(const audio_output_config_t *config);
+
+/**
+ * 释放音频输出 (引用计数 -1)
+ * 
+ * 引用计数归零时关闭功放并释放全部硬件资源。调用前需关闭自己打开的流。
+ */
+void audio_output_release(void);
+
+/**
+ * 预热功放 (不阻塞)
+ * 
+ * 在预计很快会有音频时调用 (如智能体连接建立、第一句进入合成队列)：
+ * 馈送任务立即打开功放，并在之后 10 秒内即使没有音频也保持打开，
+ * 等到真正播放时功放早已稳定。无音频且保持期结束后按空闲时间自动关闭。
+ * 
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化或没有功放控制
+ */
+esp_err_t audio_output_pa_prewarm(void);
+
+/**
+ * 打开/关闭功放
+ * 
+ * 打开：等同于预热，并阻塞到功放稳定 (打开后 50ms)；已预热时只等待剩余的稳定时间，通常立即返回。
+ * 关闭：请求馈送任务在没有音频时关闭功放，不阻塞。
+ * 不调用本函数时功放也会随音频自动打开、空闲后自动关闭。
+ */
+esp_err_t audio_output_set_pa(bool enable);
+
+/**
+ * 打开一路流
+ * 
+ * @param config 流配置
+ * @param out_stream 输出流句柄
+ * @return ESP_OK 成功，ESP_ERR_NO_MEM 无空闲流
+ */
+esp_err_t audio_output_stream_open(const audio_output_stream_config_t *config, audio_output_stream_t *out_stream);
+
+/**
+ * 关闭流，丢弃其中未播放的数据
+ */
+void audio_output_stream_close(audio_output_stream_t stream);
+
+/**
+ * 写入 PCM
+ * 
+ * 每一路流只允许一个写入任务。缓冲区满时最多阻塞 timeout。
+ * 
+ * @return 实际写入的采样数
+ */
+size_t audio_output_stream_write(audio_output_stream_t stream, const int16_t *samples, size_t count,
+                                 TickType_t timeout);
+
+/**
+ * 设置流增益
+ * 
+ * @param gain_q15 增益 (Q15，AUDIO_MIXER_GAIN_UNITY 为 1.0)
+ * @param ramp_frames 过渡帧数
+ */
+void audio_output_stream_set_gain(audio_output_stream_t stream, int32_t gain_q15, uint32_t ramp_frames);
+
+/**
+ * 等待流的输出位置到达 frame
+ * 
+ * @param frame 目标位置 (与 frames_played 同一计数)
+ * @param timeout 最长等待时间
+ * @return true 已到达
+ */
+bool audio_output_stream_wait(audio_output_stream_t stream, uint64_t frame, TickType_t timeout);
+
+/**
+ * 丢弃流中未播放的数据并清空 DMA
+ * 
+ * 先通过编解码器音量淡出几毫秒再清空，避免爆音。DMA 为各流共享，
+ * 其它流已进入 DMA 的数据也会被丢弃。函数在清空完成后返回 (最多等待 50ms)。
+ */
+esp_err_t audio_output_stream_flush(audio_output_stream_t stream);
+
+/**
+ * 获取流播放位置
+ */
+void audio_output_stream_get_position(audio_output_stream_t stream, audio_output_position_t *position);
+
+/**
+ * 获取输出统计
+ * 
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t audio_output_get_stats(audio_output_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_OUTPUT_H
@@ -7,6 +7,7 @@
 #include "baidu_agent_types.h"
 #include "baidu_agent_sse.h"
 #include "baidu_agent_json.h"
+#include "streaming_tts.h"
 #include "esp_http_client.h"
 #include "esp_log.h"
 #include "esp_tls.h"
@@ -29,6 +30,8 @@ static void http_client_task(void *arg) {
     while (!client->should_stop) {
         if (client->http_client != NULL) {
             ESP_LOGI(TAG, "开始执行 HTTP 请求...");
+            // 本次请求的事件都属于发送时的 TTS 轮次，之后再发送的消息不影响这里
+            client->tts_turn = client->pending_turn;
             // 执行 HTTP 请求
             esp_err_t err = esp_http_client_perform(client->http_client);
             ESP_LOGI(TAG, "HTTP 请求完成，结果: %s", esp_err_to_name(err));
@@ -251,6 +254,9 @@ esp_err_t baidu_agent_send_message(
     // 设置 POST 数据
     esp_http_client_set_post_field(client->http_client, post_data, strlen(post_data));
 
+    // 停止上一轮的流式播报并开始新的轮次；上一个请求迟到的 SSE 文本带着旧轮次，推送时被丢弃
+    client->pending_turn = streaming_tts_begin_turn();
+
     // 重置缓冲区
     client->sse_buffer_pos = 0;
     client->sse_buffer[0] = '\0';
@@ -38,9 +38,9 @@ static void process_content_item(baidu_agent_client_t *client, cJSON *content_it
             const char *text = text_field->valuestring;
             ESP_LOGI(TAG, "AI回复 [markdown]: %s", text);
 
-            // 将文本推送到流式 TTS 处理流程
+            // 将文本推送到流式 TTS 处理流程，上一轮迟到的文本由 TTS 丢弃
             // Requirements: 1.1 - SSE 接收到文本数据时将文本追加到原始文本队列
-            esp_err_t tts_ret = streaming_tts_push_text(text);
+            esp_err_t tts_ret = streaming_tts_push_text_turn(text, client->tts_turn);
             if (tts_ret != ESP_OK) {
                 ESP_LOGW(TAG, "推送文本到 TTS 失败: %s", esp_err_to_name(tts_ret));
             }
@@ -62,9 +62,9 @@ static void process_content_item(baidu_agent_client_t *client, cJSON *content_it
             const char *text = text_field->valuestring;
             ESP_LOGI(TAG, "AI回复 [uiData.text]: %s", text);
             
-            // 将文本推送到流式 TTS 处理流程
+            // 将文本推送到流式 TTS 处理流程，上一轮迟到的文本由 TTS 丢弃
             // Requirements: 1.1 - SSE 接收到文本数据时将文本追加到原始文本队列
-            esp_err_t tts_ret = streaming_tts_push_text(text);
+            esp_err_t tts_ret = streaming_tts_push_text_turn(text, client->tts_turn);
             if (tts_ret != ESP_OK) {
                 ESP_LOGW(TAG, "推送文本到 TTS 失败: %s", esp_err_to_name(tts_ret));
             }
@@ -136,7 +136,7 @@ static void process_message_content(baidu_agent_client_t *client, cJSON *message
         
         // 标记文本流结束，触发剩余文本处理
         // Requirements: 1.3 - SSE 连接断开时标记文本流结束
-        esp_err_t tts_ret = streaming_tts_end_stream();
+        esp_err_t tts_ret = streaming_tts_end_stream_turn(client->tts_turn);
         if (tts_ret != ESP_OK) {
             ESP_LOGW(TAG, "标记 TTS 流结束失败: %s", esp_err_to_name(tts_ret));
         }
@@ -35,6 +35,8 @@ typedef struct {
     int retry_count;
     char *thread_id;  // 动态存储的会话ID
     char *post_data;  // POST请求数据，需要在请求完成后释放
+    uint32_t pending_turn;  // 发送消息时的 TTS 轮次，请求开始执行时生效
+    uint32_t tts_turn;      // 正在执行的请求所属的 TTS 轮次，推送的文本都带上它
 } baidu_agent_client_t;
 
 #ifdef __cplusplus
@@ -0,0 +1,692 @@
+/**
+ * 百度开放平台 access_token 提供者实现
+ * 
+ * token 的所有网络刷新都在一个后台任务中执行：调用者只设置请求标志并唤醒任务，
+ * 然后等待刷新序号变化，因此并发请求天然合并为一次 HTTPS 往返。
+ */
+
+#include "baidu_auth.h"
+#include "esp_log.h"
+#include "esp_http_client.h"
+#include "esp_crt_bundle.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "cJSON.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static const char *TAG = "BAIDU_AUTH";
+
+#define BAIDU_TOKEN_URL             "https://aip.baidubce.com/oauth/2.0/token"
+
+#define AUTH_NVS_NAMESPACE          "baidu_auth"
+#define AUTH_NVS_KEY                "token"
+#define AUTH_NVS_VERSION            1
+
+#define AUTH_TASK_STACK_SIZE        8192
+#define AUTH_TASK_PRIORITY          4
+#define AUTH_RESPONSE_BUFFER_SIZE   2048
+#define AUTH_HTTP_TIMEOUT_MS        10000
+
+#define AUTH_DEFAULT_LIFETIME_S     (30 * 24 * 3600)    // 响应缺少 expires_in 时按 30 天处理
+#define AUTH_EXPIRY_SAFETY_S        60                  // 过期前 60 秒即视为不可用
+#define AUTH_MAX_SLEEP_MS           (3600 * 1000)       // 后台任务最长睡眠 1 小时后重新计算
+#define AUTH_RETRY_MIN_MS           2000
+#define AUTH_RETRY_MAX_MS           (5 * 60 * 1000)
+
+#define AUTH_MIN_VALID_TIME         1704067200          // 2024-01-01，早于此的系统时间视为未对时
+
+/**
+ * 刷新完成事件位
+ * 
+ * 第 seq 次刷新完成时置位 AUTH_EVENT_DONE(seq)、清除 AUTH_EVENT_DONE(seq + 1)，
+ * 等待者只等自己记下的 seq 的下一位，不清除任何位，因此不会吞掉别人的完成通知。
+ * 某一位要在 AUTH_EVENT_SLOTS - 1 次刷新之后才会被再次清除。
+ */
+#define AUTH_EVENT_SLOTS            8
+#define AUTH_EVENT_DONE(seq)        ((EventBits_t)1 << ((seq) % AUTH_EVENT_SLOTS))
+
+/**
+ * NVS 中保存的 token 记录
+ */
+typedef struct {
+    uint32_t version;
+    uint32_t key_hash;          ///< API Key 的 FNV-1a 哈希，换 Key 后缓存失效
+    int64_t expires_at;         ///< 过期的 UNIX 时间 (秒，未知为 0)
+    int32_t lifetime;           ///< 服务器给出的 expires_in (秒)
+    char token[BAIDU_AUTH_TOKEN_MAX_LEN];
+} auth_nvs_record_t;
+
+typedef struct {
+    char *api_key;
+    char *secret_key;
+    uint32_t key_hash;
+    uint32_t ref_count;
+    
+    SemaphoreHandle_t lock;
+    EventGroupHandle_t events;
+    SemaphoreHandle_t exit_sem;
+    TaskHandle_t task;
+    volatile bool should_stop;
+    
+    // 当前 token (lock 保护)
+    char token[BAIDU_AUTH_TOKEN_MAX_LEN];
+    bool has_token;
+    int64_t expires_at;         ///< UNIX 时间，0 为未知
+    int32_t lifetime;
+    int64_t hard_expire_us;     ///< esp_timer 时间，超过后不再返回该 token
+    int64_t refresh_at_us;      ///< esp_timer 时间，到达后后台主动刷新
+    
+    // 刷新状态 (lock 保护)
+    bool refresh_requested;
+    bool refreshing;
+    uint32_t refresh_seq;       ///< 每完成一次刷新尝试加 1
+    esp_err_t last_result;
+    uint32_t retry_delay_ms;
+    
+    baidu_auth_stats_t stats;
+} baidu_auth_t;
+
+static baidu_auth_t *s_auth = NULL;
+static SemaphoreHandle_t s_ref_lock = NULL;
+static StaticSemaphore_t s_ref_lock_buf;
+static bool s_ref_lock_created = false;
+
+// ============================================================================
+// 工具函数
+// ============================================================================
+
+static uint32_t fnv1a_hash(const char *str) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)str; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * 当前 UNIX 时间，系统未对时返回 0
+ */
+static int64_t wall_now(void) {
+    time_t now = time(NULL);
+    return now >= AUTH_MIN_VALID_TIME ? (int64_t)now : 0;
+}
+
+/**
+ * 公历日期转 UNIX 天数 (Howard Hinnant 的 days_from_civil)
+ */
+static int64_t days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (int64_t)era * 146097 + doe - 719468;
+}
+
+/**
+ * 解析 HTTP Date 头 (RFC 7231 IMF-fixdate，如 "Wed, 21 Oct 2015 07:28:00 GMT")
+ * 
+ * @return UNIX 时间，格式不符返回 0
+ */
+static int64_t parse_http_date(const char *value) {
+    static const char *months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    int day, year, hour, min, sec;
+    char mon[4] = {0};
+    
+    if (value == NULL ||
+        sscanf(value, "%*3s, %d %3s %d %d:%d:%d", &day, mon, &year, &hour, &min, &sec) != 6) {
+        return 0;
+    }
+    const char *pos = strstr(months, mon);
+    if (pos == NULL || strlen(mon) != 3 || (pos - months) % 3 != 0) {
+        return 0;
+    }
+    int month = (int)(pos - months) / 3 + 1;
+    return days_from_civil(year, month, day) * 86400 + hour * 3600 + min * 60 + sec;
+}
+
+// ============================================================================
+// NVS 缓存
+// ============================================================================
+
+static void nvs_load_token(void) {
+    nvs_handle_t nvs;
+    if (nvs_open(AUTH_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return;
+    }
+    
+    auth_nvs_record_t record;
+    size_t size = sizeof(record);
+    esp_err_t ret = nvs_get_blob(nvs, AUTH_NVS_KEY, &record, &size);
+    nvs_close(nvs);
+    
+    if (ret != ESP_OK || size != sizeof(record) || record.version != AUTH_NVS_VERSION) {
+        return;
+    }
+    if (record.key_hash != s_auth->key_hash) {
+        ESP_LOGI(TAG, "Cached token belongs to another API key, ignored");
+        return;
+    }
+    record.token[sizeof(record.token) - 1] = '\0';
+    if (record.token[0] == '\0') {
+        return;
+    }
+    
+    int64_t now_us = esp_timer_get_time();
+    int64_t now = wall_now();
+    int64_t margin = record.lifetime > 0 ? record.lifetime / 10 : AUTH_DEFAULT_LIFETIME_S / 10;
+    
+    if (now != 0 && record.expires_at != 0) {
+        // 已对时：按真实剩余寿命安排刷新
+        int64_t remaining = record.expires_at - now;
+        if (remaining <= AUTH_EXPIRY_SAFETY_S) {
+            ESP_LOGI(TAG, "Cached token expired");
+            return;
+        }
+        s_auth->hard_expire_us = now_us + (remaining - AUTH_EXPIRY_SAFETY_S) * 1000000LL;
+        s_auth->refresh_at_us = remaining > margin ? now_us + (remaining - margin) * 1000000LL : now_us;
+        ESP_LOGI(TAG, "Loaded cached token, expires in %lld s", (long long)remaining);
+    } else {
+        // 未对时：无法判断剩余寿命，先按有效使用，被服务端拒绝后再刷新
+        s_auth->hard_expire_us = INT64_MAX;
+        s_auth->refresh_at_us = INT64_MAX;
+        ESP_LOGI(TAG, "Loaded cached token (clock not set, expiry unverified)");
+    }
+    
+    strcpy(s_auth->token, record.token);
+    s_auth->has_token = true;
+    s_auth->expires_at = record.expires_at;
+    s_auth->lifetime = record.lifetime;
+    s_auth->stats.expires_at = record.expires_at;
+    s_auth->stats.loaded_from_nvs = true;
+}
+
+static void nvs_store_token(const char *token, int64_t expires_at, int32_t lifetime) {
+    nvs_handle_t nvs;
+    if (nvs_open(AUTH_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        ESP_LOGW(TAG, "NVS unavailable, token kept in memory only");
+        return;
+    }
+    
+    auth_nvs_record_t record = {
+        .version = AUTH_NVS_VERSION,
+        .key_hash = s_auth->key_hash,
+        .expires_at = expires_at,
+        .lifetime = lifetime,
+    };
+    strncpy(record.token, token, sizeof(record.token) - 1);
+    
+    esp_err_t ret = nvs_set_blob(nvs, AUTH_NVS_KEY, &record, sizeof(record));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to persist token: %s", esp_err_to_name(ret));
+    }
+}
+
+static void nvs_erase_token(void) {
+    nvs_handle_t nvs;
+    if (nvs_open(AUTH_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    if (nvs_erase_key(nvs, AUTH_NVS_KEY) == ESP_OK) {
+        nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+}
+
+// ============================================================================
+// 网络刷新
+// ============================================================================
+
+/**
+ * Token HTTP 响应上下文
+ */
+typedef struct {
+    char *buffer;
+    size_t buffer_size;
+    size_t data_len;
+    int64_t server_time;        ///< 响应 Date 头，未提供为 0
+} token_response_t;
+
+static esp_err_t token_http_event_handler(esp_http_client_event_t *evt) {
+    token_response_t *ctx = (token_response_t *)evt->user_data;
+    
+    switch (evt->event_id) {
+        case HTTP_EVENT_ON_HEADER:
+            if (ctx != NULL && evt->header_key != NULL && strcasecmp(evt->header_key, "Date") == 0) {
+                ctx->server_time = parse_http_date(evt->header_value);
+            }
+            break;
+        case HTTP_EVENT_ON_DATA:
+            // 接收所有数据，包括 chunked 响应
+            if (ctx != NULL && ctx->buffer != NULL) {
+                if (ctx->data_len + evt->data_len < ctx->buffer_size) {
+                    memcpy(ctx->buffer + ctx->data_len, evt->data, evt->data_len);
+                    ctx->data_len += evt->data_len;
+                    ctx->buffer[ctx->data_len] = '\0';
+                }
+            }
+            break;
+        default:
+            break;
+    }
+    return ESP_OK;
+}
+
+/**
+ * 向百度 OAuth 接口请求新 token (后台任务中调用，不持有 lock)
+ * 
+ * @param token 输出 token
+ * @param lifetime 输出 expires_in (秒)
+ * @param server_time 输出响应 Date 头的 UNIX 时间 (未提供为 0)
+ */
+static esp_err_t fetch_token(char *token, int32_t *lifetime, int64_t *server_time) {
+    token_response_t response_ctx = {
+        .buffer = malloc(AUTH_RESPONSE_BUFFER_SIZE),
+        .buffer_size = AUTH_RESPONSE_BUFFER_SIZE,
+        .data_len = 0,
+        .server_time = 0,
+    };
+    if (response_ctx.buffer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    response_ctx.buffer[0] = '\0';
+    
+    char url[512];
+    snprintf(url, sizeof(url),
+             "%s?grant_type=client_credentials&client_id=%s&client_secret=%s",
+             BAIDU_TOKEN_URL, s_auth->api_key, s_auth->secret_key);
+    
+    esp_http_client_config_t config = {
+        .url = url,
+        .method = HTTP_METHOD_POST,
+        .timeout_ms = AUTH_HTTP_TIMEOUT_MS,
+        .event_handler = token_http_event_handler,
+        .user_data = &response_ctx,
+        .crt_bundle_attach = esp_crt_bundle_attach,
+    };
+    
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (client == NULL) {
+        free(response_ctx.buffer);
+        return ESP_FAIL;
+    }
+    
+    esp_err_t err = esp_http_client_perform(client);
+    int status_code = esp_http_client_get_status_code(client);
+    esp_http_client_cleanup(client);
+    
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Token request failed: %s", esp_err_to_name(err));
+        free(response_ctx.buffer);
+        return err;
+    }
+    
+    cJSON *json = cJSON_Parse(response_ctx.buffer);
+    if (json == NULL) {
+        ESP_LOGE(TAG, "Token response is not JSON (status %d)", status_code);
+        free(response_ctx.buffer);
+        return ESP_FAIL;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    cJSON *access_token = cJSON_GetObjectItem(json, "access_token");
+    cJSON *expires_in = cJSON_GetObjectItem(json, "expires_in");
+    
+    if (access_token == NULL || !cJSON_IsString(access_token)) {
+        cJSON *error_desc = cJSON_GetObjectItem(json, "error_description");
+        ESP_LOGE(TAG, "Token request rejected (status %d): %s", status_code,
+                 (error_desc && cJSON_IsString(error_desc)) ? error_desc->valuestring : "unknown");
+        ret = ESP_FAIL;
+    } else if (strlen(access_token->valuestring) >= BAIDU_AUTH_TOKEN_MAX_LEN) {
+        ESP_LOGE(TAG, "Token too long: %d bytes", (int)strlen(access_token->valuestring));
+        ret = ESP_ERR_INVALID_SIZE;
+    } else {
+        strcpy(token, access_token->valuestring);
+        *lifetime = (expires_in && cJSON_IsNumber(expires_in) && expires_in->valuedouble > 0)
+                        ? (int32_t)expires_in->valuedouble
+                        : AUTH_DEFAULT_LIFETIME_S;
+        *server_time = response_ctx.server_time;
+    }
+    
+    cJSON_Delete(json);
+    free(response_ctx.buffer);
+    return ret;
+}
+
+/**
+ * 执行一次刷新并发布结果
+ */
+static void refresh_token(void) {
+    xSemaphoreTake(s_auth->lock, portMAX_DELAY);
+    s_auth->refreshing = true;
+    s_auth->refresh_requested = false;
+    xSemaphoreGive(s_auth->lock);
+    
+    ESP_LOGI(TAG, "Refreshing Baidu access_token...");
+    
+    char token[BAIDU_AUTH_TOKEN_MAX_LEN];
+    int32_t lifetime = 0;
+    int64_t server_time = 0;
+    esp_err_t ret = fetch_token(token, &lifetime, &server_time);
+    
+    int64_t now_us = esp_timer_get_time();
+    int64_t expires_at = 0;
+    
+    xSemaphoreTake(s_auth->lock, portMAX_DELAY);
+    if (ret == ESP_OK) {
+        // 优先使用本地时间，未对时则用服务器 Date 头换算绝对过期时间
+        int64_t now = wall_now();
+        if (now == 0) {
+            now = server_time;
+        }
+        expires_at = now != 0 ? now + lifetime : 0;
+        
+        strcpy(s_auth->token, token);
+        s_auth->has_token = true;
+        s_auth->expires_at = expires_at;
+        s_auth->lifetime = lifetime;
+        s_auth->hard_expire_us = now_us + (int64_t)(lifetime - AUTH_EXPIRY_SAFETY_S) * 1000000LL;
+        s_auth->refresh_at_us = now_us + (int64_t)(lifetime - lifetime / 10) * 1000000LL;
+        s_auth->retry_delay_ms = AUTH_RETRY_MIN_MS;
+        s_auth->stats.refreshes++;
+        s_auth->stats.expires_at = expires_at;
+        s_auth->stats.loaded_from_nvs = false;
+    } else {
+        // 失败后退避重试；旧 token 仍未过期时继续使用
+        s_auth->refresh_at_us = now_us + (int64_t)s_auth->retry_delay_ms * 1000;
+        s_auth->retry_delay_ms *= 2;
+        if (s_auth->retry_delay_ms > AUTH_RETRY_MAX_MS) {
+            s_auth->retry_delay_ms = AUTH_RETRY_MAX_MS;
+        }
+        s_auth->stats.refresh_failures++;
+    }
+    s_auth->last_result = ret;
+    s_auth->refreshing = false;
+    s_auth->refresh_seq++;
+    xEventGroupClearBits(s_auth->events, AUTH_EVENT_DONE(s_auth->refresh_seq + 1));
+    xEventGroupSetBits(s_auth->events, AUTH_EVENT_DONE(s_auth->refresh_seq));
+    xSemaphoreGive(s_auth->lock);
+    
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Got access_token, expires in %ld s", (long)lifetime);
+        nvs_store_token(token, expires_at, lifetime);
+    }
+}
+
+/**
+ * 后台刷新任务
+ * 
+ * 睡到 refresh_at_us 或被调用者唤醒，然后执行刷新。
+ */
+static void auth_task(void *arg) {
+    while (!s_auth->should_stop) {
+        xSemaphoreTake(s_auth->lock, portMAX_DELAY);
+        bool requested = s_auth->refresh_requested;
+        int64_t refresh_at_us = s_auth->refresh_at_us;
+        xSemaphoreGive(s_auth->lock);
+        
+        int64_t now_us = esp_timer_get_time();
+        if (requested || now_us >= refresh_at_us) {
+            refresh_token();
+            continue;
+        }
+        
+        int64_t sleep_ms = (refresh_at_us - now_us) / 1000 + 1;
+        if (sleep_ms > AUTH_MAX_SLEEP_MS) {
+            sleep_ms = AUTH_MAX_SLEEP_MS;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleep_ms));
+    }
+    
+    xSemaphoreGive(s_auth->exit_sem);
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// 引用计数
+// ============================================================================
+
+static SemaphoreHandle_t get_ref_lock(void) {
+    static portMUX_TYPE create_lock = portMUX_INITIALIZER_UNLOCKED;
+    
+    portENTER_CRITICAL(&create_lock);
+    bool first = !s_ref_lock_created;
+    s_ref_lock_created = true;
+    portEXIT_CRITICAL(&create_lock);
+    
+    if (first) {
+        s_ref_lock = xSemaphoreCreateMutexStatic(&s_ref_lock_buf);
+    }
+    while (s_ref_lock == NULL) {
+        vTaskDelay(1);
+    }
+    return s_ref_lock;
+}
+
+/**
+ * 释放全部资源 (ref_lock 持有期间调用)
+ */
+static void baidu_auth_teardown(void) {
+    if (s_auth->task != NULL) {
+        s_auth->should_stop = true;
+        xTaskNotifyGive(s_auth->task);
+        // 任务可能正在等待 HTTP 响应 (最长 AUTH_HTTP_TIMEOUT_MS)，必须等它退出后才能释放
+        xSemaphoreTake(s_auth->exit_sem, portMAX_DELAY);
+    }
+    
+    if (s_auth->exit_sem != NULL) {
+        vSemaphoreDelete(s_auth->exit_sem);
+    }
+    if (s_auth->events != NULL) {
+        vEventGroupDelete(s_auth->events);
+    }
+    if (s_auth->lock != NULL) {
+        vSemaphoreDelete(s_auth->lock);
+    }
+    free(s_auth->api_key);
+    free(s_auth->secret_key);
+    free(s_auth);
+    s_auth = NULL;
+}
+
+esp_err_t baidu_auth_acquire(const baidu_auth_config_t *config) {
+    if (config == NULL || config->api_key == NULL || config->secret_key == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    SemaphoreHandle_t ref_lock = get_ref_lock();
+    xSemaphoreTake(ref_lock, portMAX_DELAY);
+    
+    if (s_auth != NULL) {
+        if (strcmp(s_auth->api_key, config->api_key) != 0) {
+            ESP_LOGE(TAG, "Auth provider already initialized with another API key");
+            xSemaphoreGive(ref_lock);
+            return ESP_ERR_INVALID_ARG;
+        }
+        s_auth->ref_count++;
+        xSemaphoreGive(ref_lock);
+        return ESP_OK;
+    }
+    
+    s_auth = calloc(1, sizeof(baidu_auth_t));
+    if (s_auth == NULL) {
+        xSemaphoreGive(ref_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    s_auth->api_key = strdup(config->api_key);
+    s_auth->secret_key = strdup(config->secret_key);
+    s_auth->lock = xSemaphoreCreateMutex();
+    s_auth->events = xEventGroupCreate();
+    s_auth->exit_sem = xSemaphoreCreateBinary();
+    if (s_auth->api_key == NULL || s_auth->secret_key == NULL ||
+        s_auth->lock == NULL || s_auth->events == NULL || s_auth->exit_sem == NULL) {
+        baidu_auth_teardown();
+        xSemaphoreGive(ref_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    s_auth->key_hash = fnv1a_hash(config->api_key);
+    s_auth->ref_count = 1;
+    s_auth->retry_delay_ms = AUTH_RETRY_MIN_MS;
+    s_auth->last_result = ESP_OK;
+    s_auth->hard_expire_us = 0;
+    s_auth->refresh_at_us = INT64_MAX;
+    
+    nvs_load_token();
+    if (!s_auth->has_token) {
+        // 没有缓存：立即在后台获取，通常在第一句话合成前就能完成
+        s_auth->refresh_requested = true;
+    }
+    
+    if (xTaskCreate(auth_task, "baidu_auth", AUTH_TASK_STACK_SIZE, NULL,
+                    AUTH_TASK_PRIORITY, &s_auth->task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create auth task");
+        s_auth->task = NULL;
+        baidu_auth_teardown();
+        xSemaphoreGive(ref_lock);
+        return ESP_FAIL;
+    }
+    
+    ESP_LOGI(TAG, "Baidu auth provider initialized");
+    xSemaphoreGive(ref_lock);
+    return ESP_OK;
+}
+
+void baidu_auth_release(void) {
+    SemaphoreHandle_t ref_lock = get_ref_lock();
+    xSemaphoreTake(ref_lock, portMAX_DELAY);
+    
+    if (s_auth != NULL && --s_auth->ref_count == 0) {
+        baidu_auth_teardown();
+        ESP_LOGI(TAG, "Baidu auth provider destroyed");
+    }
+    
+    xSemaphoreGive(ref_lock);
+}
+
+// ============================================================================
+// 公共 API
+// ============================================================================
+
+esp_err_t baidu_auth_get_token(char *out, size_t out_size, TickType_t timeout) {
+    if (out == NULL || out_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_auth == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    TickType_t start = xTaskGetTickCount();
+    bool waited = false;
+    uint32_t seq = 0;
+    
+    xSemaphoreTake(s_auth->lock, portMAX_DELAY);
+    for (;;) {
+        if (s_auth->has_token && esp_timer_get_time() < s_auth->hard_expire_us) {
+            if (strlen(s_auth->token) >= out_size) {
+                xSemaphoreGive(s_auth->lock);
+                return ESP_ERR_INVALID_SIZE;
+            }
+            strcpy(out, s_auth->token);
+            if (!waited) {
+                s_auth->stats.cache_hits++;
+            }
+            xSemaphoreGive(s_auth->lock);
+            return ESP_OK;
+        }
+        
+        if (waited && s_auth->refresh_seq != seq) {
+            // 等到的刷新失败了
+            esp_err_t ret = s_auth->last_result != ESP_OK ? s_auth->last_result : ESP_FAIL;
+            xSemaphoreGive(s_auth->lock);
+            return ret;
+        }
+        
+        bool notify = false;
+        if (!waited) {
+            // 已有刷新在进行或已被请求时只等待它的结果 (refresh_seq 前进)，不再重复发起
+            if (s_auth->refreshing || s_auth->refresh_requested) {
+                s_auth->stats.coalesced_waits++;
+            } else {
+                s_auth->refresh_requested = true;
+                notify = true;
+            }
+            seq = s_auth->refresh_seq;
+            waited = true;
+        }
+        xSemaphoreGive(s_auth->lock);
+        if (notify) {
+            xTaskNotifyGive(s_auth->task);
+        }
+        
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            return ESP_ERR_TIMEOUT;
+        }
+        xEventGroupWaitBits(s_auth->events, AUTH_EVENT_DONE(seq + 1), pdFALSE, pdTRUE, timeout - elapsed);
+        xSemaphoreTake(s_auth->lock, portMAX_DELAY);
+    }
+}
+
+void baidu_auth_invalidate(const char *token) {
+    if (s_auth == NULL || token == NULL) {
+        return;
+    }
+    
+    xSemaphoreTake(s_auth->lock, portMAX_DELAY);
+    bool current = s_auth->has_token && strcmp(s_auth->token, token) == 0;
+    if (current) {
+        s_auth->has_token = false;
+        s_auth->token[0] = '\0';
+        s_auth->refresh_requested = true;
+    }
+    xSemaphoreGive(s_auth->lock);
+    
+    if (current) {
+        ESP_LOGW(TAG, "Token rejected by server, refreshing");
+        nvs_erase_token();
+        xTaskNotifyGive(s_auth->task);
+    }
+}
+
+bool baidu_auth_is_token_error(const char *body, size_t len) {
+    if (body == NULL || len == 0 || body[0] != '{') {
+        return false;
+    }
+    
+    cJSON *json = cJSON_ParseWithLength(body, len);
+    if (json == NULL) {
+        return false;
+    }
+    cJSON *err_no = cJSON_GetObjectItem(json, "err_no");
+    bool rejected = err_no != NULL && cJSON_IsNumber(err_no) && err_no->valueint == 502;
+    cJSON_Delete(json);
+    return rejected;
+}
+
+esp_err_t baidu_auth_get_stats(baidu_auth_stats_t *stats) {
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_auth == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    xSemaphoreTake(s_auth->lock, portMAX_DELAY);
+    *stats = s_auth->stats;
+    xSemaphoreGive(s_auth->lock);
+    return ESP_OK;
+}
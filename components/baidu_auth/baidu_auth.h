@@ -0,0 +1,110 @@
+/**
+ * 百度开放平台 access_token 提供者
+ * 
+ * 所有使用 API Key / Secret Key 鉴权的百度客户端 (在线 TTS、流式 TTS) 共用同一个 token：
+ * - token 连同服务器给出的 expires_in 换算成的过期时间保存在 NVS，重启后直接复用
+ * - 后台任务在过期前 (剩余寿命的 1/10) 主动刷新，调用者不会在关键路径上等待 HTTPS 往返
+ * - 并发的获取请求只会触发一次网络刷新，其余调用者等待同一次结果
+ * 
+ * 设备没有对时 (未启用 SNTP) 时无法判断缓存 token 是否已过期，此时先按有效使用，
+ * 客户端收到 token 校验失败的响应后调用 baidu_auth_invalidate() 触发刷新。
+ */
+
+#ifndef BAIDU_AUTH_H
+#define BAIDU_AUTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BAIDU_AUTH_TOKEN_MAX_LEN    128     ///< token 缓冲区大小 (含结尾 '\0')
+
+/**
+ * 鉴权配置
+ */
+typedef struct {
+    const char *api_key;        ///< 百度 API Key
+    const char *secret_key;     ///< 百度 Secret Key
+} baidu_auth_config_t;
+
+/**
+ * token 统计
+ */
+typedef struct {
+    uint32_t cache_hits;        ///< 直接返回已有 token 的次数
+    uint32_t refreshes;         ///< 成功的网络刷新次数
+    uint32_t refresh_failures;  ///< 失败的网络刷新次数
+    uint32_t coalesced_waits;   ///< 等待其它调用者发起的刷新的次数
+    int64_t expires_at;         ///< 当前 token 过期的 UNIX 时间 (秒，未知为 0)
+    bool loaded_from_nvs;       ///< 当前 token 来自 NVS 缓存
+} baidu_auth_stats_t;
+
+/**
+ * 获取 token 提供者 (引用计数 +1)
+ * 
+ * 第一次调用时从 NVS 加载缓存的 token 并启动后台刷新任务；之后的调用只增加引用计数，
+ * 且 API Key 必须与第一次相同。NVS 未初始化时 token 只保存在内存中。
+ * 
+ * @param config 鉴权配置
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 配置为空或与已有提供者的 API Key 不同
+ */
+esp_err_t baidu_auth_acquire(const baidu_auth_config_t *config);
+
+/**
+ * 释放 token 提供者 (引用计数 -1)，计数归零时停止后台任务并释放资源
+ */
+void baidu_auth_release(void);
+
+/**
+ * 获取当前有效的 token
+ * 
+ * 有可用 token 时立即返回；否则唤醒后台任务刷新并等待结果，
+ * 多个调用者同时等待时只发起一次网络请求。
+ * 
+ * @param out 输出缓冲区，建议 BAIDU_AUTH_TOKEN_MAX_LEN 字节
+ * @param out_size 缓冲区大小
+ * @param timeout 等待刷新的最长时间
+ * @return ESP_OK 成功，ESP_ERR_TIMEOUT 等待超时，ESP_FAIL 刷新失败
+ */
+esp_err_t baidu_auth_get_token(char *out, size_t out_size, TickType_t timeout);
+
+/**
+ * 标记 token 失效
+ * 
+ * 仅当 token 与当前缓存一致时生效 (避免用旧 token 的失败把刚刷新的 token 作废)，
+ * 同时清除 NVS 缓存并唤醒后台任务刷新。
+ * 
+ * @param token 被服务端拒绝的 token
+ */
+void baidu_auth_invalidate(const char *token);
+
+/**
+ * 判断百度接口的错误响应是否为 token 校验失败
+ * 
+ * 在线 TTS 以 JSON 返回错误，err_no 为 502 表示 token 无效或已过期。
+ * 
+ * @param body 响应内容
+ * @param len 响应长度
+ * @return true token 被拒绝
+ */
+bool baidu_auth_is_token_error(const char *body, size_t len);
+
+/**
+ * 获取统计信息
+ * 
+ * @param stats 输出
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t baidu_auth_get_stats(baidu_auth_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BAIDU_AUTH_H
@@ -0,0 +1,135 @@
+/**
+ * chat_history 主机基准
+ * 
+ * 模拟上百轮对话 (每轮一句用户输入和一段按 SSE 片段流式追加的回复)，按轮次区间统计：
+ * - 每个片段的追加耗时 (平均和最大，最大值包含整轮淘汰的搬移)
+ * - 保存的轮数、行数和文本字节数 (存储大小固定，只看占用是否稳定)
+ * 并在结束时校验最后一轮的文本和每一行的角色。
+ * 
+ * 字形宽度按 14px 字体近似 (汉字 14px，ASCII 7px)，宽度与 main.c 中的历史区域一致。
+ * 
+ * 编译运行：
+ *   gcc -O2 -I.. -I../../stream_text ../chat_history.c ../../stream_text/stream_text.c \
+ *       chat_history_bench.c -o chat_history_bench && ./chat_history_bench
+ */
+
+#include "chat_history.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define VIEW_W          300
+#define LINE_H          16
+#define TEXT_CAP        16384
+#define MAX_LINES       768
+#define MAX_TURNS       64
+#define TURNS           600
+#define BUCKET          100
+
+static int32_t measure(void *ctx, uint32_t letter, uint32_t next) {
+    return letter >= 0x80 ? 14 : 7;
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+ * 生成中英混合的回复，长度在 200 到 3000 字节之间
+ */
+static size_t make_answer(char *out, size_t cap, unsigned *seed) {
+    static const char *const words[] = {"你好世界", "今天天气", "ESP32 ", "很好，", "LVGL ", "流式显示。", "\n"};
+    *seed = *seed * 1103515245 + 12345;
+    size_t len = 200 + (*seed >> 16) % 2800;
+    size_t pos = 0;
+    while (pos < len && pos < cap) {
+        *seed = *seed * 1103515245 + 12345;
+        const char *w = words[(*seed >> 16) % (sizeof(words) / sizeof(words[0]))];
+        size_t wl = strlen(w);
+        if (pos + wl > cap) {
+            break;
+        }
+        memcpy(out + pos, w, wl);
+        pos += wl;
+    }
+    return pos;
+}
+
+int main(void) {
+    static char buf[TEXT_CAP];
+    static stream_text_line_t lines[MAX_LINES];
+    static chat_turn_t turns[MAX_TURNS];
+    static char answer[4096];
+    chat_history_t h;
+    chat_history_init(&h, buf, sizeof(buf), lines, MAX_LINES, turns, MAX_TURNS, VIEW_W, LINE_H, measure, NULL);
+    
+    size_t store = sizeof(buf) + sizeof(lines) + sizeof(turns);
+    printf("store %zu bytes (text %d, lines %d, turns %d)\n\n", store, TEXT_CAP, MAX_LINES, MAX_TURNS);
+    printf("%9s | %8s %8s %8s | %6s %6s %6s %8s\n", "turns", "frags", "avg us", "max us",
+           "kept", "rows", "KB", "evicted");
+    
+    unsigned seed = 1;
+    double sum = 0;
+    double max = 0;
+    size_t frags = 0;
+    size_t answer_len = 0;
+    chat_history_update_t update;
+    for (int t = 0; t < TURNS; t++) {
+        char question[64];
+        int qlen = snprintf(question, sizeof(question), "第 %d 个问题：今天天气怎么样？", t);
+        answer_len = make_answer(answer, sizeof(answer), &seed);
+        
+        double t0 = now_us();
+        chat_history_begin_turn(&h, CHAT_ROLE_USER, &update);
+        chat_history_append(&h, question, (size_t)qlen, &update);
+        chat_history_begin_turn(&h, CHAT_ROLE_AGENT, &update);
+        double dt = now_us() - t0;
+        sum += dt;
+        max = dt > max ? dt : max;
+        frags++;
+        
+        // 按 3 个汉字左右切片，与 SSE 片段粒度相近
+        for (size_t pos = 0; pos < answer_len;) {
+            size_t n = 9;
+            if (pos + n > answer_len) {
+                n = answer_len - pos;
+            }
+            while (pos + n < answer_len && ((uint8_t)answer[pos + n] & 0xC0) == 0x80) {
+                n++;
+            }
+            t0 = now_us();
+            chat_history_append(&h, answer + pos, n, &update);
+            dt = now_us() - t0;
+            sum += dt;
+            max = dt > max ? dt : max;
+            frags++;
+            pos += n;
+        }
+        
+        if ((t + 1) % BUCKET == 0) {
+            printf("%4d-%4d | %8zu %8.2f %8.1f | %6u %6u %6.1f %8u\n", t + 2 - BUCKET, t + 1, frags,
+                   sum / frags, max, h.turn_count, h.text.line_count, h.text.len / 1024.0, h.evicted_turns);
+            sum = 0;
+            max = 0;
+            frags = 0;
+        }
+    }
+    
+    // 最后一轮的回复完整保存在末尾，每一行的角色与所属轮次一致
+    const chat_turn_t *last = &h.turns[h.turn_count - 1];
+    int ok = last->role == CHAT_ROLE_AGENT && h.text.len - last->start == answer_len &&
+             memcmp(h.text.text + last->start, answer, answer_len) == 0;
+    for (uint32_t row = 0, turn = 0; row < h.text.line_count; row++) {
+        while (turn + 1 < h.turn_count && h.turns[turn + 1].start <= h.text.lines[row].start) {
+            turn++;
+        }
+        if (chat_history_row_role(&h, row) != (chat_role_t)h.turns[turn].role) {
+            ok = 0;
+        }
+    }
+    printf("\ncheck %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+/**
+ * 对话历史文本存储实现
+ */
+
+#include "chat_history.h"
+#include <string.h>
+
+/**
+ * 第一个行首不小于 offset 的行
+ */
+static uint32_t line_at_offset(const stream_text_t *st, uint32_t offset) {
+    uint32_t lo = 0;
+    uint32_t hi = st->line_count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (st->lines[mid].start < offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * 淘汰最早的一轮；只剩当前一轮时丢弃它开头的四分之一行，保留最新的内容。
+ * 没有可丢弃的内容时返回 false
+ */
+static bool evict_oldest(chat_history_t *h, chat_history_update_t *update) {
+    uint32_t lines;
+    if (h->turn_count >= 2) {
+        // 每轮从新的一行开始，下一轮的第一行之前都属于最早的一轮
+        lines = line_at_offset(&h->text, h->turns[1].start);
+    } else {
+        lines = h->text.line_count / 4 > 0 ? h->text.line_count / 4 : 1;
+    }
+    if (lines == 0 || lines >= h->text.line_count) {
+        return false;
+    }
+    uint32_t cut = h->text.lines[lines].start;
+    stream_text_discard(&h->text, lines);
+    
+    if (h->turn_count >= 2) {
+        h->turn_count--;
+        memmove(h->turns, h->turns + 1, h->turn_count * sizeof(chat_turn_t));
+        h->evicted_turns++;
+    }
+    for (uint32_t i = 0; i < h->turn_count; i++) {
+        h->turns[i].start = h->turns[i].start > cut ? h->turns[i].start - cut : 0;
+    }
+    
+    update->discarded += lines;
+    update->first_dirty = update->first_dirty > lines ? update->first_dirty - lines : 0;
+    return true;
+}
+
+/**
+ * 确保能追加 bytes 字节；需要淘汰时一次腾出至少四分之一的文本和行缓存
+ */
+static void make_room(chat_history_t *h, size_t bytes, chat_history_update_t *update) {
+    stream_text_t *st = &h->text;
+    // 行缓存按每行至少 8 字节预留，行缓存在追加途中用尽时 stream_text 会截断最后一个单词
+    uint32_t need_lines = (uint32_t)(bytes / 8) + 2;
+    size_t room = st->cap - 1 - st->len;
+    if (room >= bytes && st->max_lines - st->line_count >= need_lines && h->turn_count < h->max_turns) {
+        return;
+    }
+    
+    size_t want_bytes = bytes > st->cap / 4 ? bytes : st->cap / 4;
+    uint32_t want_lines = need_lines > st->max_lines / 4 ? need_lines : st->max_lines / 4;
+    uint32_t want_turns = h->max_turns / 4;
+    while (st->cap - 1 - st->len < want_bytes ||
+           st->max_lines - st->line_count < want_lines ||
+           h->max_turns - h->turn_count < want_turns) {
+        if (!evict_oldest(h, update)) {
+            break;
+        }
+    }
+}
+
+void chat_history_init(chat_history_t *h, char *buf, size_t cap, stream_text_line_t *lines, uint32_t max_lines,
+                       chat_turn_t *turns, uint32_t max_turns, int32_t max_width, int32_t line_height,
+                       stream_text_measure_fn measure, void *ctx) {
+    memset(h, 0, sizeof(*h));
+    stream_text_init(&h->text, buf, cap, lines, max_lines, max_width, line_height, measure, ctx);
+    h->turns = turns;
+    h->max_turns = max_turns;
+    chat_history_clear(h);
+}
+
+void chat_history_clear(chat_history_t *h) {
+    stream_text_clear(&h->text);
+    h->turn_count = 1;
+    h->turns[0].start = 0;
+    h->turns[0].role = CHAT_ROLE_AGENT;
+}
+
+void chat_history_begin_turn(chat_history_t *h, chat_role_t role, chat_history_update_t *update) {
+    update->discarded = 0;
+    update->first_dirty = h->text.line_count - 1;
+    
+    chat_turn_t *cur = &h->turns[h->turn_count - 1];
+    if (cur->start == h->text.len) {
+        cur->role = (uint8_t)role;
+        return;
+    }
+    
+    make_room(h, 1, update);
+    if (h->turn_count >= h->max_turns) {
+        return;
+    }
+    stream_text_area_t dirty[2];
+    size_t before = h->text.len;
+    stream_text_append(&h->text, "\n", 1, dirty);
+    if (h->text.len == before) {
+        return;
+    }
+    cur = &h->turns[h->turn_count++];
+    cur->start = (uint32_t)h->text.len;
+    cur->role = (uint8_t)role;
+}
+
+size_t chat_history_append(chat_history_t *h, const char *text, size_t len, chat_history_update_t *update) {
+    update->discarded = 0;
+    update->first_dirty = h->text.line_count - 1;
+    
+    size_t total = 0;
+    while (len > 0) {
+        make_room(h, len, update);
+        
+        // 行缓存用尽时 stream_text 在行尾截断，淘汰后继续追加剩下的部分
+        stream_text_area_t dirty[2];
+        size_t before = h->text.len;
+        stream_text_append(&h->text, text, len, dirty);
+        size_t accepted = h->text.len > before ? h->text.len - before : 0;
+        total += accepted;
+        text += accepted;
+        len -= accepted;
+        if (len == 0 || !evict_oldest(h, update)) {
+            break;
+        }
+    }
+    return total;
+}
+
+void chat_history_relayout(chat_history_t *h, int32_t max_width, int32_t line_height) {
+    stream_text_relayout(&h->text, max_width, line_height);
+}
+
+chat_role_t chat_history_row_role(const chat_history_t *h, uint32_t row) {
+    if (row >= h->text.line_count) {
+        return (chat_role_t)h->turns[h->turn_count - 1].role;
+    }
+    
+    // 最后一个起始偏移不大于行首的轮次
+    uint32_t start = h->text.lines[row].start;
+    uint32_t lo = 0;
+    uint32_t hi = h->turn_count;
+    while (hi - lo > 1) {
+        uint32_t mid = (lo + hi) / 2;
+        if (h->turns[mid].start <= start) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return (chat_role_t)h->turns[lo].role;
+}
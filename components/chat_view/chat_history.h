@@ -0,0 +1,128 @@
+/**
+ * 对话历史文本存储
+ * 
+ * 多轮对话按轮追加到一块固定大小的文本缓冲区，基于 stream_text 排版：
+ * - 每轮从新的一行开始，记录起始偏移和角色 (用户或智能体)
+ * - 追加只重新折行最后一行，与历史长度无关
+ * - 文本、行缓存或轮次表用尽时整轮淘汰最早的对话，一次至少腾出四分之一的空间，
+ *   内存占用固定，淘汰的搬移代价分摊到很多次追加上；只剩一轮时丢弃它最早的行
+ * 
+ * 本模块不依赖 LVGL，字形宽度通过回调提供。
+ */
+
+#ifndef CHAT_HISTORY_H
+#define CHAT_HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "stream_text.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 发言角色
+ */
+typedef enum {
+    CHAT_ROLE_USER = 0,
+    CHAT_ROLE_AGENT,
+    CHAT_ROLE_COUNT,
+} chat_role_t;
+
+/**
+ * 一轮对话
+ */
+typedef struct {
+    uint32_t start;             ///< 本轮文本在缓冲区中的字节偏移
+    uint8_t role;               ///< chat_role_t
+} chat_turn_t;
+
+/**
+ * 一次更新的结果
+ */
+typedef struct {
+    uint32_t discarded;         ///< 被淘汰的行数，剩余行的行号都前移了这么多
+    uint32_t first_dirty;       ///< 内容变化的第一行 (淘汰后的行号)
+} chat_history_update_t;
+
+/**
+ * 对话历史
+ */
+typedef struct {
+    stream_text_t text;
+    chat_turn_t *turns;
+    uint32_t turn_count;        ///< 轮数 (至少为 1)
+    uint32_t max_turns;
+    uint32_t evicted_turns;     ///< 累计淘汰的轮数
+} chat_history_t;
+
+/**
+ * 初始化
+ * 
+ * @param h 对话历史
+ * @param buf 文本缓冲区
+ * @param cap 缓冲区大小
+ * @param lines 行缓存数组
+ * @param max_lines 行缓存容量
+ * @param turns 轮次数组
+ * @param max_turns 轮次数组容量 (至少为 2)
+ * @param max_width 折行宽度
+ * @param line_height 行高
+ * @param measure 字形宽度回调
+ * @param ctx 回调上下文
+ */
+void chat_history_init(chat_history_t *h, char *buf, size_t cap, stream_text_line_t *lines, uint32_t max_lines,
+                       chat_turn_t *turns, uint32_t max_turns, int32_t max_width, int32_t line_height,
+                       stream_text_measure_fn measure, void *ctx);
+
+/**
+ * 清空全部历史
+ */
+void chat_history_clear(chat_history_t *h);
+
+/**
+ * 开始新的一轮
+ * 
+ * 当前一轮还没有文本时只修改它的角色。
+ * 
+ * @param h 对话历史
+ * @param role 角色
+ * @param update 输出淘汰的行数和变化的第一行
+ */
+void chat_history_begin_turn(chat_history_t *h, chat_role_t role, chat_history_update_t *update);
+
+/**
+ * 向当前一轮追加文本
+ * 
+ * 空间不足时淘汰最早的轮次，只剩当前一轮时丢弃它最早的行；
+ * 一行都丢弃不了 (没有折行宽度) 时截断到完整的 UTF-8 字符。
+ * 
+ * @param h 对话历史
+ * @param text 文本片段
+ * @param len 字节数
+ * @param update 输出淘汰的行数和变化的第一行
+ * @return 实际追加的字节数
+ */
+size_t chat_history_append(chat_history_t *h, const char *text, size_t len, chat_history_update_t *update);
+
+/**
+ * 折行宽度或字体变化后重新排版全部历史
+ */
+void chat_history_relayout(chat_history_t *h, int32_t max_width, int32_t line_height);
+
+/**
+ * 获取某一行所属轮次的角色
+ * 
+ * @param h 对话历史
+ * @param row 行号
+ * @return 角色
+ */
+chat_role_t chat_history_row_role(const chat_history_t *h, uint32_t row);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CHAT_HISTORY_H
@@ -0,0 +1,342 @@
+/**
+ * 虚拟化滚动的对话历史控件实现
+ */
+
+#include "chat_view.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "CHAT_VIEW";
+
+#define POOL_MAX            32      // 行标签上限
+#define LINE_TEXT_MAX       256     // 单行复制到标签的最大字节数
+#define LABEL_SLACK_PX      8       // 标签比折行宽度宽一些，避免 LVGL 测量的细微差异导致二次折行
+#define ROW_NONE            UINT32_MAX
+#define ROLE_NONE           0xFF
+
+typedef struct {
+    lv_obj_t *label;
+    uint32_t row;                   // 显示的行号，ROW_NONE 表示空闲
+    uint8_t role;                   // 当前应用的角色样式
+} row_slot_t;
+
+typedef struct {
+    chat_history_t history;
+    void *store;                    // 文本、行缓存和轮次表 (优先 PSRAM)
+    const lv_font_t *font;
+    int32_t letter_space;
+    lv_obj_t *spacer;               // 撑开滚动范围的空对象
+    row_slot_t pool[POOL_MAX];
+    uint32_t pool_size;
+    uint32_t dirty_from;            // 需要重新设置文本的第一行
+    bool role_styled[CHAT_ROLE_COUNT];
+    lv_color_t role_color[CHAT_ROLE_COUNT];
+    lv_text_align_t role_align[CHAT_ROLE_COUNT];
+    chat_view_stats_t stats;
+} chat_view_t;
+
+static int32_t measure_glyph(void *ctx, uint32_t letter, uint32_t next) {
+    chat_view_t *cv = (chat_view_t *)ctx;
+    return (int32_t)lv_font_get_glyph_width(cv->font, letter, next) + cv->letter_space;
+}
+
+static int32_t line_height(lv_obj_t *obj, const lv_font_t *font) {
+    int32_t h = lv_font_get_line_height(font) + lv_obj_get_style_text_line_space(obj, LV_PART_MAIN);
+    return h > 0 ? h : 1;
+}
+
+static void unbind_all(chat_view_t *cv) {
+    for (uint32_t i = 0; i < cv->pool_size; i++) {
+        cv->pool[i].row = ROW_NONE;
+    }
+}
+
+static void apply_role(chat_view_t *cv, row_slot_t *slot, chat_role_t role) {
+    if (slot->role == role) {
+        return;
+    }
+    slot->role = (uint8_t)role;
+    if (cv->role_styled[role]) {
+        lv_obj_set_style_text_color(slot->label, cv->role_color[role], 0);
+        lv_obj_set_style_text_align(slot->label, cv->role_align[role], 0);
+    } else {
+        // 未设置样式的角色继承控件的文本颜色
+        lv_obj_remove_local_style_prop(slot->label, LV_STYLE_TEXT_COLOR, 0);
+        lv_obj_remove_local_style_prop(slot->label, LV_STYLE_TEXT_ALIGN, 0);
+    }
+}
+
+/**
+ * 把视口内的行绑定到标签；第 row 行固定使用 row % pool_size 号标签，
+ * 滚动时只有移入视口的行需要重新设置文本
+ */
+static void bind_rows(lv_obj_t *obj, chat_view_t *cv) {
+    const stream_text_t *st = &cv->history.text;
+    int32_t scroll_y = lv_obj_get_scroll_y(obj);
+    uint32_t first = scroll_y > 0 ? (uint32_t)(scroll_y / st->line_height) : 0;
+    uint32_t dirty_from = cv->dirty_from;
+    cv->dirty_from = ROW_NONE;
+    
+    char text[LINE_TEXT_MAX];
+    for (uint32_t i = 0; i < cv->pool_size; i++) {
+        uint32_t row = first + i;
+        row_slot_t *slot = &cv->pool[row % cv->pool_size];
+        if (row >= st->line_count) {
+            slot->row = ROW_NONE;
+            if (!lv_obj_has_flag(slot->label, LV_OBJ_FLAG_HIDDEN)) {
+                lv_obj_add_flag(slot->label, LV_OBJ_FLAG_HIDDEN);
+            }
+            continue;
+        }
+        if (slot->row == row && row < dirty_from) {
+            continue;
+        }
+        
+        const stream_text_line_t *line = &st->lines[row];
+        size_t len = line->end - line->start;
+        if (len > sizeof(text) - 1) {
+            len = sizeof(text) - 1;
+        }
+        memcpy(text, st->text + line->start, len);
+        text[len] = '\0';
+        
+        chat_role_t role = chat_history_row_role(&cv->history, row);
+        apply_role(cv, slot, role);
+        int32_t x = 0;
+        if (cv->role_styled[role] && cv->role_align[role] == LV_TEXT_ALIGN_RIGHT) {
+            x = -LABEL_SLACK_PX;
+        } else if (cv->role_styled[role] && cv->role_align[role] == LV_TEXT_ALIGN_CENTER) {
+            x = -LABEL_SLACK_PX / 2;
+        }
+        lv_label_set_text(slot->label, text);
+        lv_obj_set_pos(slot->label, x, (int32_t)row * st->line_height);
+        if (lv_obj_has_flag(slot->label, LV_OBJ_FLAG_HIDDEN)) {
+            lv_obj_remove_flag(slot->label, LV_OBJ_FLAG_HIDDEN);
+        }
+        slot->row = row;
+        cv->stats.rebinds++;
+    }
+}
+
+/**
+ * 行数变化后更新滚动范围，需要时跟随到底部，然后重新绑定可见行
+ * 
+ * @param keep_y 不跟随时保持的滚动位置
+ */
+static void update_scroll(lv_obj_t *obj, chat_view_t *cv, bool follow, int32_t keep_y) {
+    const stream_text_t *st = &cv->history.text;
+    lv_obj_set_height(cv->spacer, (int32_t)st->line_count * st->line_height);
+    lv_obj_update_layout(obj);
+    
+    // 滚动事件会调用 bind_rows，这里再调用一次覆盖滚动位置不变的情况
+    if (follow) {
+        lv_obj_scroll_to_y(obj, LV_COORD_MAX, LV_ANIM_OFF);
+    } else if (keep_y != lv_obj_get_scroll_y(obj)) {
+        lv_obj_scroll_to_y(obj, keep_y > 0 ? keep_y : 0, LV_ANIM_OFF);
+    }
+    bind_rows(obj, cv);
+}
+
+/**
+ * 文本变化后刷新：淘汰使所有行号前移，其余情况只刷新变化的行
+ */
+static void apply_update(lv_obj_t *obj, chat_view_t *cv, const chat_history_update_t *update, bool follow) {
+    int32_t keep_y = lv_obj_get_scroll_y(obj);
+    if (update->discarded > 0) {
+        unbind_all(cv);
+        keep_y -= (int32_t)update->discarded * cv->history.text.line_height;
+    }
+    if (update->first_dirty < cv->dirty_from) {
+        cv->dirty_from = update->first_dirty;
+    }
+    update_scroll(obj, cv, follow, keep_y);
+}
+
+/**
+ * 视口停在底部 (最多差一行) 时追加内容后继续跟随
+ */
+static bool at_bottom(lv_obj_t *obj, const chat_view_t *cv) {
+    return lv_obj_get_scroll_bottom(obj) <= cv->history.text.line_height;
+}
+
+/**
+ * 字体、行距或尺寸变化后重新排版并调整标签池
+ */
+static void refresh_layout(lv_obj_t *obj, chat_view_t *cv) {
+    const lv_font_t *font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+    int32_t letter_space = lv_obj_get_style_text_letter_space(obj, LV_PART_MAIN);
+    int32_t width = lv_obj_get_content_width(obj);
+    int32_t height = line_height(obj, font);
+    stream_text_t *st = &cv->history.text;
+    
+    if (font != cv->font || letter_space != cv->letter_space ||
+        width != st->max_width || height != st->line_height) {
+        cv->font = font;
+        cv->letter_space = letter_space;
+        chat_history_relayout(&cv->history, width, height);
+        cv->stats.relayouts++;
+    }
+    
+    // 视口内最多有行数 + 1 行部分可见
+    uint32_t pool_size = (uint32_t)(lv_obj_get_content_height(obj) / height) + 2;
+    if (pool_size > POOL_MAX) {
+        pool_size = POOL_MAX;
+    }
+    while (cv->pool_size > pool_size) {
+        lv_obj_delete(cv->pool[--cv->pool_size].label);
+    }
+    while (cv->pool_size < pool_size) {
+        lv_obj_t *label = lv_label_create(obj);
+        lv_label_set_long_mode(label, LV_LABEL_LONG_CLIP);
+        lv_obj_remove_flag(label, LV_OBJ_FLAG_CLICKABLE);
+        lv_obj_add_flag(label, LV_OBJ_FLAG_HIDDEN);
+        cv->pool[cv->pool_size].label = label;
+        cv->pool[cv->pool_size].role = ROLE_NONE;
+        cv->pool_size++;
+    }
+    for (uint32_t i = 0; i < cv->pool_size; i++) {
+        lv_obj_set_size(cv->pool[i].label, width + LABEL_SLACK_PX, height);
+        lv_obj_add_flag(cv->pool[i].label, LV_OBJ_FLAG_HIDDEN);
+        cv->pool[i].role = ROLE_NONE;
+    }
+    unbind_all(cv);
+    update_scroll(obj, cv, true, 0);
+}
+
+static void chat_view_event_cb(lv_event_t *e) {
+    lv_event_code_t code = lv_event_get_code(e);
+    lv_obj_t *obj = lv_event_get_current_target_obj(e);
+    chat_view_t *cv = (chat_view_t *)lv_obj_get_user_data(obj);
+    if (cv == NULL || lv_event_get_target_obj(e) != obj) {
+        return;
+    }
+    
+    switch (code) {
+        case LV_EVENT_SCROLL:
+            bind_rows(obj, cv);
+            break;
+        case LV_EVENT_SIZE_CHANGED:
+        case LV_EVENT_STYLE_CHANGED:
+            refresh_layout(obj, cv);
+            break;
+        case LV_EVENT_DELETE:
+            lv_obj_set_user_data(obj, NULL);
+            heap_caps_free(cv->store);
+            free(cv);
+            break;
+        default:
+            break;
+    }
+}
+
+lv_obj_t *chat_view_create(lv_obj_t *parent, size_t text_cap, uint32_t max_lines, uint32_t max_turns) {
+    if (text_cap < 2 || max_lines == 0 || max_turns < 2) {
+        return NULL;
+    }
+    
+    chat_view_t *cv = (chat_view_t *)calloc(1, sizeof(chat_view_t));
+    if (cv == NULL) {
+        return NULL;
+    }
+    // 历史文本占用最大，有 PSRAM 时放到 PSRAM，否则使用内部 RAM
+    size_t lines_size = max_lines * sizeof(stream_text_line_t);
+    size_t turns_size = max_turns * sizeof(chat_turn_t);
+    size_t store_size = lines_size + turns_size + text_cap;
+    cv->store = heap_caps_malloc_prefer(store_size, 2, MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT);
+    if (cv->store == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate chat history (%u bytes)", (unsigned)store_size);
+        free(cv);
+        return NULL;
+    }
+    stream_text_line_t *lines = (stream_text_line_t *)cv->store;
+    chat_turn_t *turns = (chat_turn_t *)((char *)cv->store + lines_size);
+    char *buf = (char *)turns + turns_size;
+    
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_CLICK_FOCUSABLE);
+    lv_obj_set_scroll_dir(obj, LV_DIR_VER);
+    
+    cv->spacer = lv_obj_create(obj);
+    lv_obj_remove_style_all(cv->spacer);
+    lv_obj_remove_flag(cv->spacer, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_size(cv->spacer, 1, 0);
+    
+    cv->font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+    cv->letter_space = lv_obj_get_style_text_letter_space(obj, LV_PART_MAIN);
+    cv->dirty_from = ROW_NONE;
+    chat_history_init(&cv->history, buf, text_cap, lines, max_lines, turns, max_turns,
+                      lv_obj_get_content_width(obj), line_height(obj, cv->font), measure_glyph, cv);
+    
+    lv_obj_set_user_data(obj, cv);
+    lv_obj_add_event_cb(obj, chat_view_event_cb, LV_EVENT_ALL, NULL);
+    refresh_layout(obj, cv);
+    return obj;
+}
+
+void chat_view_set_role_style(lv_obj_t *obj, chat_role_t role, lv_color_t color, lv_text_align_t align) {
+    chat_view_t *cv = (chat_view_t *)lv_obj_get_user_data(obj);
+    if (cv == NULL || role >= CHAT_ROLE_COUNT) {
+        return;
+    }
+    
+    cv->role_styled[role] = true;
+    cv->role_color[role] = color;
+    cv->role_align[role] = align;
+    for (uint32_t i = 0; i < cv->pool_size; i++) {
+        cv->pool[i].role = ROLE_NONE;
+        cv->pool[i].row = ROW_NONE;
+    }
+    bind_rows(obj, cv);
+}
+
+void chat_view_begin_turn(lv_obj_t *obj, chat_role_t role) {
+    chat_view_t *cv = (chat_view_t *)lv_obj_get_user_data(obj);
+    if (cv == NULL || role >= CHAT_ROLE_COUNT) {
+        return;
+    }
+    
+    bool follow = at_bottom(obj, cv);
+    chat_history_update_t update;
+    chat_history_begin_turn(&cv->history, role, &update);
+    apply_update(obj, cv, &update, follow);
+}
+
+void chat_view_append(lv_obj_t *obj, const char *text, size_t len) {
+    chat_view_t *cv = (chat_view_t *)lv_obj_get_user_data(obj);
+    if (cv == NULL || text == NULL || len == 0) {
+        return;
+    }
+    
+    bool follow = at_bottom(obj, cv);
+    chat_history_update_t update;
+    chat_history_append(&cv->history, text, len, &update);
+    apply_update(obj, cv, &update, follow);
+}
+
+void chat_view_clear(lv_obj_t *obj) {
+    chat_view_t *cv = (chat_view_t *)lv_obj_get_user_data(obj);
+    if (cv == NULL) {
+        return;
+    }
+    
+    chat_history_clear(&cv->history);
+    unbind_all(cv);
+    update_scroll(obj, cv, true, 0);
+}
+
+void chat_view_get_stats(lv_obj_t *obj, chat_view_stats_t *stats) {
+    chat_view_t *cv = (chat_view_t *)lv_obj_get_user_data(obj);
+    if (cv == NULL || stats == NULL) {
+        return;
+    }
+    
+    *stats = cv->stats;
+    stats->turns = cv->history.turn_count;
+    stats->evicted_turns = cv->history.evicted_turns;
+    stats->rows = cv->history.text.line_count;
+    stats->pool_size = cv->pool_size;
+    stats->text_len = cv->history.text.len;
+}
@@ -0,0 +1,98 @@
+/**
+ * 虚拟化滚动的对话历史控件
+ * 
+ * 所有轮次的文本保存在 chat_history 中 (有 PSRAM 时分配在 PSRAM)，控件只为视口内
+ * 可见的行创建 lv_label：
+ * - 标签池大小等于视口能容纳的行数加二 (滚动到行中间时上下各有一行部分可见)，与历史长度无关
+ * - 第 row 行固定由 row % 池大小 号标签显示，滚动一行只重新绑定移入视口的那一行
+ * - 追加文本时只刷新变化的行；视口停在底部时自动跟随最新内容，用户向上滚动后保持位置
+ * - 历史超出容量时整轮淘汰最早的对话，内存和每帧开销在上百轮对话后保持不变
+ * 
+ * 字体、行距取自控件的 LV_PART_MAIN 样式，智能体的行使用控件的文本颜色，
+ * 用户的行颜色和对齐方式由 chat_view_set_role_style 设置。
+ * 所有接口须在持有 LVGL 锁时调用。
+ */
+
+#ifndef CHAT_VIEW_H
+#define CHAT_VIEW_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "lvgl.h"
+#include "chat_history.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 控件统计
+ */
+typedef struct {
+    uint32_t turns;             ///< 当前保存的轮数
+    uint32_t evicted_turns;     ///< 累计淘汰的轮数
+    uint32_t rows;              ///< 当前保存的行数
+    uint32_t pool_size;         ///< 行标签个数
+    uint32_t rebinds;           ///< 累计重新设置标签文本的次数
+    uint32_t relayouts;         ///< 整体重新排版次数 (宽度或样式变化)
+    size_t text_len;            ///< 已用的文本字节数
+} chat_view_stats_t;
+
+/**
+ * 创建控件
+ * 
+ * @param parent 父对象
+ * @param text_cap 文本缓冲区大小 (字节，含结尾的 '\0')
+ * @param max_lines 最多缓存的行数
+ * @param max_turns 最多保存的轮数 (至少为 2)
+ * @return 控件对象，内存不足时返回 NULL
+ */
+lv_obj_t *chat_view_create(lv_obj_t *parent, size_t text_cap, uint32_t max_lines, uint32_t max_turns);
+
+/**
+ * 设置某个角色的行颜色和对齐方式
+ * 
+ * @param obj 控件对象
+ * @param role 角色
+ * @param color 文本颜色
+ * @param align 对齐方式 (LV_TEXT_ALIGN_LEFT / RIGHT / CENTER)
+ */
+void chat_view_set_role_style(lv_obj_t *obj, chat_role_t role, lv_color_t color, lv_text_align_t align);
+
+/**
+ * 开始新的一轮
+ * 
+ * @param obj 控件对象
+ * @param role 角色
+ */
+void chat_view_begin_turn(lv_obj_t *obj, chat_role_t role);
+
+/**
+ * 向当前一轮追加文本
+ * 
+ * @param obj 控件对象
+ * @param text 文本片段 (UTF-8，不要求以 '\0' 结尾)
+ * @param len 字节数
+ */
+void chat_view_append(lv_obj_t *obj, const char *text, size_t len);
+
+/**
+ * 清空全部历史
+ * 
+ * @param obj 控件对象
+ */
+void chat_view_clear(lv_obj_t *obj);
+
+/**
+ * 获取统计信息
+ * 
+ * @param obj 控件对象
+ * @param stats 输出统计信息
+ */
+void chat_view_get_stats(lv_obj_t *obj, chat_view_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CHAT_VIEW_H
@@ -0,0 +1,198 @@
+/**
+ * 显示刷新性能统计实现
+ */
+
+#include "disp_perf.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#if CONFIG_DISP_PERF_MONITOR || CONFIG_DISP_PERF_BENCH
+
+static const char *TAG = "DISP_PERF";
+
+static lv_display_t *s_disp = NULL;
+static disp_perf_stats_t s_stats;
+static int64_t s_refr_start = 0;
+static uint32_t s_refr_flushes = 0;     // 本帧开始时的 flush 次数
+static int64_t s_flush_start = 0;
+static int64_t s_wait_start = 0;
+
+static void event_cb(lv_event_t *e) {
+    int64_t now = esp_timer_get_time();
+    const lv_area_t *area = lv_event_get_param(e);
+    
+    switch (lv_event_get_code(e)) {
+        case LV_EVENT_INVALIDATE_AREA:
+            if (area != NULL) {
+                s_stats.inv_px += lv_area_get_size(area);
+            }
+            break;
+        
+        case LV_EVENT_REFR_START:
+            s_refr_start = now;
+            s_refr_flushes = s_stats.flushes;
+            break;
+        
+        case LV_EVENT_REFR_READY:
+            // 没有无效区域的定时器周期也会发送 REFR_START/READY，不算作一帧
+            if (s_stats.flushes != s_refr_flushes) {
+                uint32_t dt = (uint32_t)(now - s_refr_start);
+                s_stats.frames++;
+                s_stats.frame_us += dt;
+                if (dt > s_stats.frame_max_us) {
+                    s_stats.frame_max_us = dt;
+                }
+            }
+            break;
+        
+        case LV_EVENT_FLUSH_START:
+            s_flush_start = now;
+            s_stats.flushes++;
+            if (area != NULL) {
+                s_stats.flush_px += lv_area_get_size(area);
+            }
+            break;
+        
+        case LV_EVENT_FLUSH_FINISH:
+            s_stats.flush_us += (uint64_t)(now - s_flush_start);
+            break;
+        
+        case LV_EVENT_FLUSH_WAIT_START:
+            s_wait_start = now;
+            break;
+        
+        case LV_EVENT_FLUSH_WAIT_FINISH:
+            s_stats.wait_us += (uint64_t)(now - s_wait_start);
+            break;
+        
+        default:
+            break;
+    }
+}
+
+/**
+ * 输出两次快照之间的统计，按帧平均
+ */
+static void log_delta(const char *name, const disp_perf_stats_t *now, const disp_perf_stats_t *before,
+                      int64_t elapsed_us) {
+    uint32_t frames = now->frames - before->frames;
+    if (frames == 0 || elapsed_us <= 0) {
+        return;
+    }
+    ESP_LOGI(TAG, "%s: %.1f fps, 帧 %lu us (最大 %lu), %lu 块/帧 %lu px, flush_cb %lu us/帧, 等待 %lu us/帧, 无效 %lu px/帧",
+             name, frames * 1e6 / elapsed_us,
+             (unsigned long)((now->frame_us - before->frame_us) / frames),
+             (unsigned long)now->frame_max_us,
+             (unsigned long)((now->flushes - before->flushes) / frames),
+             (unsigned long)((now->flush_px - before->flush_px) / frames),
+             (unsigned long)((now->flush_us - before->flush_us) / frames),
+             (unsigned long)((now->wait_us - before->wait_us) / frames),
+             (unsigned long)((now->inv_px - before->inv_px) / frames));
+}
+
+#if CONFIG_DISP_PERF_MONITOR
+static disp_perf_stats_t s_last;
+static int64_t s_last_time = 0;
+
+static void monitor_cb(lv_timer_t *timer) {
+    int64_t now = esp_timer_get_time();
+    log_delta("刷新", &s_stats, &s_last, now - s_last_time);
+    
+    // 最大帧耗时按周期统计
+    s_stats.frame_max_us = 0;
+    s_last = s_stats;
+    s_last_time = now;
+}
+#endif
+
+esp_err_t disp_perf_init(lv_display_t *disp) {
+    if (s_disp != NULL) {
+        return s_disp == disp ? ESP_OK : ESP_ERR_INVALID_STATE;
+    }
+
+#if CONFIG_DISP_PERF_MONITOR
+    if (lv_timer_create(monitor_cb, CONFIG_DISP_PERF_PERIOD_MS, NULL) == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_last_time = esp_timer_get_time();
+#endif
+    
+    lv_display_add_event_cb(disp, event_cb, LV_EVENT_ALL, NULL);
+    s_disp = disp;
+    return ESP_OK;
+}
+
+void disp_perf_get_stats(disp_perf_stats_t *stats) {
+    *stats = s_stats;
+}
+
+#else // 未启用
+
+esp_err_t disp_perf_init(lv_display_t *disp) {
+    return ESP_OK;
+}
+
+void disp_perf_get_stats(disp_perf_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif // CONFIG_DISP_PERF_MONITOR || CONFIG_DISP_PERF_BENCH
+
+#if CONFIG_DISP_PERF_BENCH
+
+/**
+ * 基准场景：每帧使这些区域无效后立即刷新
+ */
+typedef struct {
+    const char *name;
+    lv_area_t areas[2];
+    uint8_t count;
+} bench_case_t;
+
+void disp_perf_run_bench(void) {
+    if (s_disp == NULL) {
+        return;
+    }
+    
+    int32_t w = lv_display_get_horizontal_resolution(s_disp);
+    int32_t h = lv_display_get_vertical_resolution(s_disp);
+    int32_t row = h / 2;
+    // 单行的高度与 14 号字体的对话历史行一致，两行相距的场景模拟标题和状态栏同时更新
+    const bench_case_t cases[] = {
+        {"全屏重绘", {{0, 0, w - 1, h - 1}}, 1},
+        {"单行", {{10, row, w - 11, row + 15}}, 1},
+        {"两行相距", {{10, 5, w - 11, 24}, {10, h - 20, w - 11, h - 6}}, 2},
+        {"两行相交", {{10, row, w - 11, row + 15}, {10, row + 8, w - 11, row + 23}}, 2},
+    };
+    lv_obj_t *scr = lv_display_get_screen_active(s_disp);
+    
+    ESP_LOGI(TAG, "刷新基准: %ldx%ld, 每个场景 %d 帧", (long)w, (long)h, CONFIG_DISP_PERF_BENCH_FRAMES);
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        // 先刷新一次，让上一个场景遗留的传输完成
+        lv_refr_now(s_disp);
+        
+        disp_perf_stats_t before = s_stats;
+        s_stats.frame_max_us = 0;
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < CONFIG_DISP_PERF_BENCH_FRAMES; i++) {
+            for (uint8_t a = 0; a < cases[c].count; a++) {
+                lv_obj_invalidate_area(scr, &cases[c].areas[a]);
+            }
+            lv_refr_now(s_disp);
+        }
+        log_delta(cases[c].name, &s_stats, &before, esp_timer_get_time() - start);
+        
+        // 让空闲任务运行，避免任务看门狗超时
+        vTaskDelay(1);
+    }
+}
+
+#else
+
+void disp_perf_run_bench(void) {
+}
+
+#endif // CONFIG_DISP_PERF_BENCH
@@ -0,0 +1,68 @@
+/**
+ * 显示刷新性能统计
+ * 
+ * 通过 LVGL 显示器事件统计渲染和 SPI 刷新的开销，用于比较不同的渲染缓冲区布局：
+ * - 帧数和帧耗时 (REFR_START 到 REFR_READY，只统计实际刷新了内容的帧)
+ * - flush 次数和像素数：缓冲区越小，同样的无效区域要分越多块发送
+ * - flush_cb 内的耗时：经 DMA 中转缓冲区同步搬移时包含 SPI 传输
+ * - 等待上一块传输完成的时间：双缓冲时渲染与传输重叠，这个值越小越好
+ * - 无效区域像素数 (合并前)，与 flush 像素数对比可看出 LVGL 合并相交区域的效果
+ * 
+ * CONFIG_DISP_PERF_MONITOR 打开时按周期输出统计日志；CONFIG_DISP_PERF_BENCH 打开时
+ * disp_perf_run_bench 运行固定的刷新场景并输出每种场景的帧率。两者都关闭时所有接口为空操作。
+ * 只支持一个显示器，统计在 LVGL 任务中进行，所有接口须在持有 LVGL 锁时调用。
+ */
+
+#ifndef DISP_PERF_H
+#define DISP_PERF_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 累计统计
+ */
+typedef struct {
+    uint32_t frames;            ///< 刷新了内容的帧数
+    uint32_t flushes;           ///< flush_cb 调用次数
+    uint64_t inv_px;            ///< 无效区域像素数 (合并前)
+    uint64_t flush_px;          ///< 渲染并发送的像素数
+    uint64_t frame_us;          ///< 帧耗时累计
+    uint64_t flush_us;          ///< flush_cb 内耗时累计
+    uint64_t wait_us;           ///< 等待传输完成的时间累计
+    uint32_t frame_max_us;      ///< 单帧最大耗时 (每个日志周期和基准场景开始时清零)
+} disp_perf_stats_t;
+
+/**
+ * 开始统计显示器的刷新，按配置创建周期输出日志的定时器
+ * 
+ * @param disp 显示器
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 已经在统计另一个显示器，ESP_ERR_NO_MEM 定时器创建失败
+ */
+esp_err_t disp_perf_init(lv_display_t *disp);
+
+/**
+ * 获取累计统计
+ * 
+ * @param stats 输出统计信息，未启用时全部为 0
+ */
+void disp_perf_get_stats(disp_perf_stats_t *stats);
+
+/**
+ * 运行刷新基准并输出结果
+ * 
+ * 依次测量全屏重绘、单行重绘、相距较远的两行和相交的两行，每种场景连续刷新若干帧
+ * (CONFIG_DISP_PERF_BENCH_FRAMES)。运行期间阻塞 LVGL，只应在启动时调用一次。
+ */
+void disp_perf_run_bench(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISP_PERF_H
@@ -0,0 +1,459 @@
+/*
+ * Font subset host benchmark
+ *
+ * Compares a complete font assets image with a subset one (tools/subset_fonts.py)
+ * on a sample reply text:
+ * - flash: bytes of the font and of the fallback font it chains to
+ * - lookup: code point -> glyph id, walking the fallback chain like
+ *   lv_font_get_glyph_dsc(); get_glyph_id() is a transcription of LVGL's
+ *   lv_font_fmt_txt.c including its lv_utils_bsearch() binary search
+ * - render: lookup plus RLE decompression of every glyph of the text
+ *   (the decoder is the one in glyph_cache_bench.c)
+ *
+ * Build and run:
+ *   gcc -O2 font_subset_bench.c -o font_subset_bench
+ *   ./font_subset_bench full.bin subset.bin font_puhui_16_4 reply.txt
+ * where full.bin comes from tools/pack_font_assets.py and subset.bin from
+ * tools/subset_fonts.py on the same binfonts, and reply.txt is UTF-8 text.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#define MAX_FONTS   8
+#define MAX_TEXT    (256 * 1024)
+#define PASSES      20
+
+// ---- Font assets image (see tools/pack_font_assets.py) ----
+
+typedef struct __attribute__((packed)) {
+    char magic[4];
+    uint16_t version, font_count, glyph_dsc_size, reserved;
+    uint32_t image_size;
+} header_t;
+
+typedef struct __attribute__((packed)) {
+    char name[32];
+    uint32_t offset, size;
+} entry_t;
+
+typedef struct __attribute__((packed)) {
+    int16_t line_height, base_line, underline_position;
+    uint16_t underline_thickness;
+    uint8_t bpp, bitmap_format, subpx, reserved0;
+    uint16_t cmap_num, fallback;
+    uint32_t glyph_count, cmaps_offset, glyph_dsc_offset, bitmap_offset;
+} font_rec_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t range_start;
+    uint16_t range_length, glyph_id_start;
+    uint32_t list_offset;
+    uint16_t list_length;
+    uint8_t type, reserved;
+} cmap_rec_t;
+
+enum { CMAP_FORMAT0_FULL, CMAP_SPARSE_FULL, CMAP_FORMAT0_TINY, CMAP_SPARSE_TINY };
+
+// Same field set as lv_font_fmt_txt_cmap_t
+typedef struct {
+    uint32_t range_start;
+    uint16_t range_length;
+    uint16_t glyph_id_start;
+    const uint16_t *unicode_list;
+    const void *glyph_id_ofs_list;
+    uint16_t list_length;
+    uint8_t type;
+} cmap_t;
+
+typedef struct font {
+    const char *name;
+    uint32_t size;
+    const font_rec_t *rec;
+    const uint8_t *base;
+    cmap_t *cmaps;
+    uint16_t cmap_num;
+    uint8_t bpp;
+    uint8_t format;
+    int large;
+    const struct font *fallback;
+} font_t;
+
+typedef struct {
+    uint8_t *data;
+    uint32_t size;
+    font_t fonts[MAX_FONTS];
+    int count;
+} image_t;
+
+static int load_image(const char *path, image_t *img) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    img->size = (uint32_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    img->data = aligned_alloc(64, (img->size + 63) & ~63u);
+    if (fread(img->data, 1, img->size, f) != img->size) {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    const header_t *h = (const header_t *)img->data;
+    if (memcmp(h->magic, "FPAK", 4) != 0 || h->font_count > MAX_FONTS) {
+        fprintf(stderr, "%s: not a font assets image\n", path);
+        return -1;
+    }
+    const entry_t *entries = (const entry_t *)(img->data + sizeof(header_t));
+    img->count = h->font_count;
+    for (int i = 0; i < img->count; i++) {
+        font_t *font = &img->fonts[i];
+        font->name = entries[i].name;
+        font->size = entries[i].size;
+        font->base = img->data + entries[i].offset;
+        font->rec = (const font_rec_t *)font->base;
+        font->cmap_num = font->rec->cmap_num;
+        font->bpp = font->rec->bpp;
+        font->format = font->rec->bitmap_format;
+        font->large = h->glyph_dsc_size == 16;
+        font->cmaps = calloc(font->cmap_num, sizeof(cmap_t));
+        const cmap_rec_t *src = (const cmap_rec_t *)(font->base + font->rec->cmaps_offset);
+        for (int c = 0; c < font->cmap_num; c++) {
+            const uint8_t *list = font->base + src[c].list_offset;
+            font->cmaps[c] = (cmap_t){
+                .range_start = src[c].range_start,
+                .range_length = src[c].range_length,
+                .glyph_id_start = src[c].glyph_id_start,
+                .list_length = src[c].list_length,
+                .type = src[c].type,
+            };
+            if (src[c].type == CMAP_SPARSE_FULL || src[c].type == CMAP_SPARSE_TINY) {
+                font->cmaps[c].unicode_list = (const uint16_t *)list;
+            }
+            if (src[c].type == CMAP_SPARSE_FULL) {
+                font->cmaps[c].glyph_id_ofs_list = list + src[c].list_length * 2;
+            } else if (src[c].type == CMAP_FORMAT0_FULL) {
+                font->cmaps[c].glyph_id_ofs_list = list;
+            }
+        }
+    }
+    for (int i = 0; i < img->count; i++) {
+        uint16_t fb = img->fonts[i].rec->fallback;
+        img->fonts[i].fallback = fb ? &img->fonts[fb - 1] : NULL;
+    }
+    return 0;
+}
+
+static const font_t *find_font(const image_t *img, const char *name) {
+    for (int i = 0; i < img->count; i++) {
+        if (strcmp(img->fonts[i].name, name) == 0) {
+            return &img->fonts[i];
+        }
+    }
+    return NULL;
+}
+
+// ---- LVGL glyph lookup (lv_font_fmt_txt.c, lv_utils.c) ----
+
+static void *lv_utils_bsearch(const void *key, const void *base, size_t n, size_t size,
+                              int (*cmp)(const void *pRef, const void *pElement)) {
+    const char *middle;
+    int32_t c;
+    for (middle = base; n != 0;) {
+        middle += (n / 2) * size;
+        if ((c = (*cmp)(key, middle)) > 0) {
+            n = (n / 2) - ((n & 1) == 0);
+            base = (middle += size);
+        } else if (c < 0) {
+            n /= 2;
+            middle = base;
+        } else {
+            return (char *)middle;
+        }
+    }
+    return NULL;
+}
+
+static int unicode_list_compare(const void *ref, const void *element) {
+    return (int)*(const uint16_t *)ref - (int)*(const uint16_t *)element;
+}
+
+static uint32_t get_glyph_id(const font_t *font, uint32_t letter) {
+    if (letter == '\0') {
+        return 0;
+    }
+    for (uint16_t i = 0; i < font->cmap_num; i++) {
+        const cmap_t *cmap = &font->cmaps[i];
+        uint32_t rcp = letter - cmap->range_start;
+        if (rcp >= cmap->range_length) {
+            continue;
+        }
+        uint32_t glyph_id = 0;
+        if (cmap->type == CMAP_FORMAT0_TINY) {
+            glyph_id = cmap->glyph_id_start + rcp;
+        } else if (cmap->type == CMAP_FORMAT0_FULL) {
+            const uint8_t *gid_ofs_8 = cmap->glyph_id_ofs_list;
+            glyph_id = cmap->glyph_id_start + gid_ofs_8[rcp];
+        } else if (cmap->type == CMAP_SPARSE_TINY) {
+            uint16_t key = (uint16_t)rcp;
+            uint16_t *p = lv_utils_bsearch(&key, cmap->unicode_list, cmap->list_length,
+                                           sizeof(cmap->unicode_list[0]), unicode_list_compare);
+            if (p) {
+                glyph_id = cmap->glyph_id_start + (uint32_t)(p - cmap->unicode_list);
+            }
+        } else {
+            uint16_t key = (uint16_t)rcp;
+            uint16_t *p = lv_utils_bsearch(&key, cmap->unicode_list, cmap->list_length,
+                                           sizeof(cmap->unicode_list[0]), unicode_list_compare);
+            if (p) {
+                const uint16_t *gid_ofs_16 = cmap->glyph_id_ofs_list;
+                glyph_id = cmap->glyph_id_start + gid_ofs_16[p - cmap->unicode_list];
+            }
+        }
+        return glyph_id;
+    }
+    return 0;
+}
+
+// lv_font_get_glyph_dsc(): try the font, then its fallback chain
+static const font_t *resolve(const font_t *font, uint32_t letter, uint32_t *gid) {
+    for (; font != NULL; font = font->fallback) {
+        *gid = get_glyph_id(font, letter);
+        if (*gid != 0) {
+            return font;
+        }
+    }
+    return NULL;
+}
+
+typedef struct {
+    uint32_t bitmap_index;
+    uint16_t box_w, box_h;
+} glyph_t;
+
+static glyph_t glyph_dsc(const font_t *font, uint32_t gid) {
+    const uint8_t *d = font->base + font->rec->glyph_dsc_offset;
+    if (font->large) {
+        const uint8_t *g = d + gid * 16;
+        glyph_t out = {*(const uint32_t *)g, *(const uint16_t *)(g + 8), *(const uint16_t *)(g + 10)};
+        return out;
+    }
+    const uint8_t *g = d + gid * 8;
+    glyph_t out = {*(const uint32_t *)g & 0xFFFFF, g[4], g[5]};
+    return out;
+}
+
+// ---- LVGL RLE decoder (as in glyph_cache_bench.c) ----
+
+typedef enum { RLE_STATE_SINGLE = 0, RLE_STATE_REPEATED, RLE_STATE_COUNTER } rle_state_t;
+
+typedef struct {
+    uint32_t rdp;
+    const uint8_t *in;
+    uint8_t bpp;
+    uint8_t prev_v;
+    uint8_t count;
+    rle_state_t state;
+} rle_t;
+
+static const uint8_t opa4_table[16] = {0, 17, 34, 51, 68, 85, 102, 119, 136, 153, 170, 187, 204, 221, 238, 255};
+static const uint8_t opa2_table[4] = {0, 85, 170, 255};
+static const uint8_t opa1_table[2] = {0, 255};
+
+static inline uint8_t get_bits(const uint8_t *in, uint32_t bit_pos, uint8_t len) {
+    uint8_t bit_mask = (uint8_t)((1u << len) - 1);
+    uint32_t byte_pos = bit_pos >> 3;
+    bit_pos = bit_pos & 0x7;
+    if (bit_pos + len >= 8) {
+        uint16_t in16 = (uint16_t)((in[byte_pos] << 8) + in[byte_pos + 1]);
+        return (uint8_t)((in16 >> (16 - bit_pos - len)) & bit_mask);
+    }
+    return (uint8_t)((in[byte_pos] >> (8 - bit_pos - len)) & bit_mask);
+}
+
+static inline uint8_t rle_next(rle_t *rle) {
+    uint8_t v;
+    uint8_t ret = 0;
+    if (rle->state == RLE_STATE_SINGLE) {
+        ret = get_bits(rle->in, rle->rdp, rle->bpp);
+        if (rle->rdp != 0 && rle->prev_v == ret) {
+            rle->count = 0;
+            rle->state = RLE_STATE_REPEATED;
+        }
+        rle->prev_v = ret;
+        rle->rdp += rle->bpp;
+    } else if (rle->state == RLE_STATE_REPEATED) {
+        v = get_bits(rle->in, rle->rdp, 1);
+        rle->count++;
+        rle->rdp += 1;
+        if (v == 1) {
+            ret = rle->prev_v;
+            if (rle->count == 11) {
+                rle->count = get_bits(rle->in, rle->rdp, 6);
+                rle->rdp += 6;
+                if (rle->count != 0) {
+                    rle->state = RLE_STATE_COUNTER;
+                } else {
+                    ret = get_bits(rle->in, rle->rdp, rle->bpp);
+                    rle->prev_v = ret;
+                    rle->rdp += rle->bpp;
+                    rle->state = RLE_STATE_SINGLE;
+                }
+            }
+        } else {
+            ret = get_bits(rle->in, rle->rdp, rle->bpp);
+            rle->prev_v = ret;
+            rle->rdp += rle->bpp;
+            rle->state = RLE_STATE_SINGLE;
+        }
+    } else {
+        ret = rle->prev_v;
+        rle->count--;
+        if (rle->count == 0) {
+            ret = get_bits(rle->in, rle->rdp, rle->bpp);
+            rle->prev_v = ret;
+            rle->rdp += rle->bpp;
+            rle->state = RLE_STATE_SINGLE;
+        }
+    }
+    return ret;
+}
+
+static void decompress(const uint8_t *in, uint8_t *out, int32_t w, int32_t h, uint8_t bpp, int prefilter) {
+    const uint8_t *opa_table = bpp == 1 ? opa1_table : (bpp == 2 ? opa2_table : opa4_table);
+    rle_t rle = {.in = in, .bpp = bpp, .state = RLE_STATE_SINGLE};
+    uint8_t line_buf1[256];
+    uint8_t line_buf2[256];
+    for (int32_t x = 0; x < w; x++) {
+        line_buf1[x] = rle_next(&rle);
+        out[x] = opa_table[line_buf1[x]];
+    }
+    for (int32_t y = 1; y < h; y++) {
+        out += w;
+        for (int32_t x = 0; x < w; x++) {
+            line_buf2[x] = rle_next(&rle);
+            line_buf1[x] = prefilter ? line_buf1[x] ^ line_buf2[x] : line_buf2[x];
+            out[x] = opa_table[line_buf1[x]];
+        }
+    }
+}
+
+// ---- Benchmark ----
+
+static uint32_t s_text[MAX_TEXT];
+static size_t s_text_len = 0;
+static uint8_t s_a8[256 * 256];
+
+static void load_text(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        exit(1);
+    }
+    static unsigned char buf[MAX_TEXT * 4];
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    for (size_t i = 0; i < n && s_text_len < MAX_TEXT;) {
+        uint32_t c = buf[i];
+        int len = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : 4;
+        if (len > 1) {
+            c &= 0x3F >> (len - 1);
+            for (int k = 1; k < len; k++) {
+                c = (c << 6) | (buf[i + k] & 0x3F);
+            }
+        }
+        i += len;
+        if (c > ' ') {
+            s_text[s_text_len++] = c;
+        }
+    }
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void run(const char *label, const char *path, const char *name) {
+    static image_t img;
+    memset(&img, 0, sizeof(img));
+    if (load_image(path, &img) != 0) {
+        exit(1);
+    }
+    const font_t *font = find_font(&img, name);
+    if (font == NULL) {
+        fprintf(stderr, "%s: no font %s\n", path, name);
+        exit(1);
+    }
+
+    uint32_t flash = font->size + (font->fallback ? font->fallback->size : 0);
+    size_t fallback_hits = 0;
+    size_t missing = 0;
+    for (size_t i = 0; i < s_text_len; i++) {
+        uint32_t gid;
+        const font_t *f = resolve(font, s_text[i], &gid);
+        if (f == NULL) {
+            missing++;
+        } else if (f != font) {
+            fallback_hits++;
+        }
+    }
+
+    // Lookup only
+    volatile uint32_t sink = 0;
+    double t0 = now_us();
+    for (int p = 0; p < PASSES; p++) {
+        for (size_t i = 0; i < s_text_len; i++) {
+            uint32_t gid;
+            const font_t *f = resolve(font, s_text[i], &gid);
+            sink += gid + (f != NULL);
+        }
+    }
+    double lookup_ns = (now_us() - t0) * 1000.0 / ((double)PASSES * s_text_len);
+
+    // Lookup and decode
+    t0 = now_us();
+    for (int p = 0; p < PASSES; p++) {
+        for (size_t i = 0; i < s_text_len; i++) {
+            uint32_t gid;
+            const font_t *f = resolve(font, s_text[i], &gid);
+            if (f == NULL) {
+                continue;
+            }
+            glyph_t g = glyph_dsc(f, gid);
+            const uint8_t *bitmap = f->base + f->rec->bitmap_offset + g.bitmap_index;
+            if (f->format == 0) {
+                memcpy(s_a8, bitmap, ((uint32_t)g.box_w * g.box_h * f->bpp + 7) / 8);
+            } else {
+                decompress(bitmap, s_a8, g.box_w, g.box_h, f->bpp, f->format == 1);
+            }
+            sink += s_a8[0];
+        }
+    }
+    double render_us = (now_us() - t0) / ((double)PASSES * s_text_len);
+    (void)sink;
+
+    printf("%-7s %7u glyphs %4u cmaps  font %8u B  +fallback %8u B  lookup %6.1f ns/char  "
+           "render %5.3f us/char  fallback %zu  missing %zu\n",
+           label, font->rec->glyph_count - 1, font->cmap_num, font->size, flash, lookup_ns,
+           render_us, fallback_hits, missing);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 5) {
+        fprintf(stderr, "usage: %s full.bin subset.bin font_name text.txt\n", argv[0]);
+        return 1;
+    }
+    load_text(argv[4]);
+    printf("%zu characters of sample text, %d passes\n", s_text_len, PASSES);
+    run("full", argv[1], argv[3]);
+    run("subset", argv[2], argv[3]);
+    return 0;
+}
@@ -0,0 +1,319 @@
+/*
+ * Glyph cache host benchmark
+ * 
+ * Redraws a full response label (9 lines x 21 CJK glyphs) per frame with glyphs
+ * drawn from a Zipf-distributed working set, comparing:
+ * - decode: RLE + prefilter decompression on every draw (LVGL fmt_txt compressed path)
+ * - cache:  glyph_cache_get, decoding and glyph_cache_put only on a miss
+ * 
+ * The RLE decoder is a transcription of LVGL's lv_font_fmt_txt.c decompress();
+ * glyphs are synthetic stroke patterns encoded with a matching encoder. Every
+ * cache hit is checked byte for byte against the decoder output.
+ * 
+ * Build and run:
+ *   gcc -O2 -I.. ../glyph_cache.c glyph_cache_bench.c -o glyph_cache_bench && ./glyph_cache_bench
+ */
+
+#include "glyph_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define GLYPHS          400     // Distinct glyphs in the working set
+#define FRAME_GLYPHS    (9 * 21)
+#define FRAMES          2000
+#define MAX_PACKED      512
+
+// ---- LVGL RLE decoder ----
+
+typedef enum { RLE_STATE_SINGLE = 0, RLE_STATE_REPEATED, RLE_STATE_COUNTER } rle_state_t;
+
+typedef struct {
+    uint32_t rdp;
+    const uint8_t *in;
+    uint8_t bpp;
+    uint8_t prev_v;
+    uint8_t count;
+    rle_state_t state;
+} rle_t;
+
+static const uint8_t opa4_table[16] = {0, 17, 34, 51, 68, 85, 102, 119, 136, 153, 170, 187, 204, 221, 238, 255};
+static const uint8_t opa2_table[4] = {0, 85, 170, 255};
+static const uint8_t opa1_table[2] = {0, 255};
+
+static inline uint8_t get_bits(const uint8_t *in, uint32_t bit_pos, uint8_t len) {
+    uint8_t bit_mask = (uint8_t)((1u << len) - 1);
+    uint32_t byte_pos = bit_pos >> 3;
+    bit_pos = bit_pos & 0x7;
+    if (bit_pos + len >= 8) {
+        uint16_t in16 = (uint16_t)((in[byte_pos] << 8) + in[byte_pos + 1]);
+        return (uint8_t)((in16 >> (16 - bit_pos - len)) & bit_mask);
+    }
+    return (uint8_t)((in[byte_pos] >> (8 - bit_pos - len)) & bit_mask);
+}
+
+static inline uint8_t rle_next(rle_t *rle) {
+    uint8_t v;
+    uint8_t ret = 0;
+    if (rle->state == RLE_STATE_SINGLE) {
+        ret = get_bits(rle->in, rle->rdp, rle->bpp);
+        if (rle->rdp != 0 && rle->prev_v == ret) {
+            rle->count = 0;
+            rle->state = RLE_STATE_REPEATED;
+        }
+        rle->prev_v = ret;
+        rle->rdp += rle->bpp;
+    } else if (rle->state == RLE_STATE_REPEATED) {
+        v = get_bits(rle->in, rle->rdp, 1);
+        rle->count++;
+        rle->rdp += 1;
+        if (v == 1) {
+            ret = rle->prev_v;
+            if (rle->count == 11) {
+                rle->count = get_bits(rle->in, rle->rdp, 6);
+                rle->rdp += 6;
+                if (rle->count != 0) {
+                    rle->state = RLE_STATE_COUNTER;
+                } else {
+                    ret = get_bits(rle->in, rle->rdp, rle->bpp);
+                    rle->prev_v = ret;
+                    rle->rdp += rle->bpp;
+                    rle->state = RLE_STATE_SINGLE;
+                }
+            }
+        } else {
+            ret = get_bits(rle->in, rle->rdp, rle->bpp);
+            rle->prev_v = ret;
+            rle->rdp += rle->bpp;
+            rle->state = RLE_STATE_SINGLE;
+        }
+    } else {
+        ret = rle->prev_v;
+        rle->count--;
+        if (rle->count == 0) {
+            ret = get_bits(rle->in, rle->rdp, rle->bpp);
+            rle->prev_v = ret;
+            rle->rdp += rle->bpp;
+            rle->state = RLE_STATE_SINGLE;
+        }
+    }
+    return ret;
+}
+
+static void decompress(const uint8_t *in, uint8_t *out, int32_t w, int32_t h, uint8_t bpp, uint32_t stride) {
+    const uint8_t *opa_table = bpp == 1 ? opa1_table : (bpp == 2 ? opa2_table : opa4_table);
+    rle_t rle = {.in = in, .bpp = bpp, .state = RLE_STATE_SINGLE};
+    uint8_t *line_buf1 = malloc(w);
+    uint8_t *line_buf2 = malloc(w);
+    for (int32_t x = 0; x < w; x++) {
+        line_buf1[x] = rle_next(&rle);
+        out[x] = opa_table[line_buf1[x]];
+    }
+    for (int32_t y = 1; y < h; y++) {
+        out += stride;
+        for (int32_t x = 0; x < w; x++) {
+            line_buf2[x] = rle_next(&rle);
+            line_buf1[x] ^= line_buf2[x];
+            out[x] = opa_table[line_buf1[x]];
+        }
+    }
+    free(line_buf1);
+    free(line_buf2);
+}
+
+// ---- Matching encoder ----
+
+typedef struct {
+    uint8_t *out;
+    uint32_t bit;
+} bitw_t;
+
+static void put_bits(bitw_t *b, uint32_t v, uint8_t len) {
+    for (int i = len - 1; i >= 0; i--) {
+        if ((v >> i) & 1) {
+            b->out[b->bit >> 3] |= (uint8_t)(0x80 >> (b->bit & 7));
+        }
+        b->bit++;
+    }
+}
+
+static uint32_t compress(const uint8_t *v, uint32_t n, uint8_t bpp, uint8_t *out) {
+    bitw_t b = {out, 0};
+    rle_state_t state = RLE_STATE_SINGLE;
+    uint8_t prev = 0;
+    uint32_t count = 0;
+    uint32_t i = 0;
+    while (i < n) {
+        if (state == RLE_STATE_SINGLE) {
+            put_bits(&b, v[i], bpp);
+            if (i > 0 && v[i] == prev) {
+                count = 0;
+                state = RLE_STATE_REPEATED;
+            }
+            prev = v[i++];
+        } else if (v[i] == prev) {
+            put_bits(&b, 1, 1);
+            count++;
+            i++;
+            if (count == 11) {
+                uint32_t r = 0;
+                while (i + r < n && v[i + r] == prev && r < 62) {
+                    r++;
+                }
+                put_bits(&b, r + 1, 6);
+                i += r;
+                if (i < n) {
+                    put_bits(&b, v[i], bpp);
+                    prev = v[i++];
+                }
+                state = RLE_STATE_SINGLE;
+            }
+        } else {
+            put_bits(&b, 0, 1);
+            put_bits(&b, v[i], bpp);
+            prev = v[i++];
+            state = RLE_STATE_SINGLE;
+        }
+    }
+    return (b.bit + 7) / 8 + 1;     // +1: get_bits may read one byte ahead
+}
+
+// ---- Synthetic glyphs ----
+
+typedef struct {
+    uint8_t w, h, bpp;
+    uint8_t packed[MAX_PACKED];
+} glyph_t;
+
+static glyph_t s_glyphs[GLYPHS];
+
+static void make_glyph(glyph_t *g, int size, uint8_t bpp, unsigned *seed) {
+    uint8_t px[32 * 32] = {0};
+    uint8_t max = (uint8_t)((1 << bpp) - 1);
+    g->w = g->h = (uint8_t)size;
+    g->bpp = bpp;
+    int strokes = 4 + rand_r(seed) % 6;
+    for (int s = 0; s < strokes; s++) {
+        int horiz = rand_r(seed) & 1;
+        int a = 1 + rand_r(seed) % (size - 2);
+        int from = rand_r(seed) % (size / 2);
+        int to = size / 2 + rand_r(seed) % (size / 2);
+        for (int t = from; t < to; t++) {
+            int x = horiz ? t : a;
+            int y = horiz ? a : t;
+            px[y * size + x] = max;
+            // Anti-aliased edge for multi-bit fonts
+            if (bpp > 1) {
+                int ex = horiz ? x : x + 1;
+                int ey = horiz ? y + 1 : y;
+                if (ex < size && ey < size && px[ey * size + ex] == 0) {
+                    px[ey * size + ex] = max / 3;
+                }
+            }
+        }
+    }
+    // Prefilter: each line XOR the previous one
+    uint8_t filtered[32 * 32];
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            filtered[y * size + x] = px[y * size + x] ^ (y > 0 ? px[(y - 1) * size + x] : 0);
+        }
+    }
+    memset(g->packed, 0, sizeof(g->packed));
+    compress(filtered, (uint32_t)(size * size), bpp, g->packed);
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void run(const char *name, int size, uint8_t bpp, size_t budget) {
+    unsigned seed = 7;
+    for (int i = 0; i < GLYPHS; i++) {
+        make_glyph(&s_glyphs[i], size, bpp, &seed);
+    }
+
+    // Zipf(1.0) over the working set: common characters dominate Chinese text
+    static double cdf[GLYPHS];
+    double sum = 0;
+    for (int i = 0; i < GLYPHS; i++) {
+        sum += 1.0 / (i + 1);
+        cdf[i] = sum;
+    }
+    static uint16_t text[FRAMES][FRAME_GLYPHS];
+    for (int f = 0; f < FRAMES; f++) {
+        for (int k = 0; k < FRAME_GLYPHS; k++) {
+            double u = (double)rand_r(&seed) / RAND_MAX * sum;
+            int lo = 0;
+            while (cdf[lo] < u && lo < GLYPHS - 1) {
+                lo++;
+            }
+            text[f][k] = (uint16_t)lo;
+        }
+    }
+
+    uint8_t buf[32 * 32];
+    uint8_t ref[32 * 32];
+    volatile uint32_t sink = 0;
+
+    double t0 = now_us();
+    for (int f = 0; f < FRAMES; f++) {
+        for (int k = 0; k < FRAME_GLYPHS; k++) {
+            const glyph_t *g = &s_glyphs[text[f][k]];
+            decompress(g->packed, buf, g->w, g->h, g->bpp, g->w);
+            sink += buf[g->w + 1];
+        }
+    }
+    double decode_us = (now_us() - t0) / FRAMES;
+
+    glyph_cache_clear();
+    glyph_cache_set_budget(budget);
+    glyph_cache_stats_t before;
+    glyph_cache_get_stats(&before);
+    t0 = now_us();
+    for (int f = 0; f < FRAMES; f++) {
+        for (int k = 0; k < FRAME_GLYPHS; k++) {
+            uint32_t gid = text[f][k];
+            const glyph_t *g = &s_glyphs[gid];
+            if (!glyph_cache_get(g, gid, buf, g->w)) {
+                decompress(g->packed, buf, g->w, g->h, g->bpp, g->w);
+                glyph_cache_put(g, gid, g->w, g->h, g->bpp, buf, g->w);
+            }
+            sink += buf[g->w + 1];
+        }
+    }
+    double cache_us = (now_us() - t0) / FRAMES;
+
+    glyph_cache_stats_t st;
+    glyph_cache_get_stats(&st);
+    uint32_t hits = st.hits - before.hits;
+    uint32_t misses = st.misses - before.misses;
+
+    // Correctness: every cached glyph expands to exactly the decoder output
+    int mismatches = 0;
+    for (int i = 0; i < GLYPHS; i++) {
+        const glyph_t *g = &s_glyphs[i];
+        decompress(g->packed, ref, g->w, g->h, g->bpp, g->w);
+        if (glyph_cache_get(g, (uint32_t)i, buf, g->w) && memcmp(buf, ref, (size_t)g->w * g->h) != 0) {
+            mismatches++;
+        }
+    }
+
+    printf("%-12s %6zu | %9.1f %9.1f %6.2fx | %5.1f%% %6u %7zu %4d\n", name, budget, decode_us, cache_us,
+           decode_us / cache_us, 100.0 * hits / (hits + misses), st.entries, st.bytes, mismatches);
+    (void)sink;
+}
+
+int main(void) {
+    printf("%-12s %6s | %9s %9s %7s | %6s %6s %7s %4s\n", "font", "budget", "decode us", "cache us", "speedup",
+           "hit", "glyphs", "bytes", "bad");
+    run("14px 1bpp", 14, 1, 4 * 1024);
+    run("14px 1bpp", 14, 1, 16 * 1024);
+    run("16px 4bpp", 16, 4, 16 * 1024);
+    run("16px 4bpp", 16, 4, 64 * 1024);
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * Character usage counter implementation
+ */
+
+#include "char_usage.h"
+#include "esp_log.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef CONFIG_FONT_MANAGER_CHAR_USAGE
+
+static const char *TAG = "char_usage";
+
+#define SLOTS           CONFIG_FONT_MANAGER_CHAR_USAGE_SLOTS
+#define FIRST_COUNTED   0x2E80
+#define TOKENS_PER_LINE 10
+
+// Open addressing on the code point; cp 0 marks a free slot
+typedef struct {
+    uint16_t cp;
+    uint16_t count;     // Saturates at UINT16_MAX
+} usage_slot_t;
+
+static usage_slot_t *s_slots = NULL;
+static uint32_t s_distinct = 0;
+static uint32_t s_total = 0;
+static uint32_t s_dropped = 0;  // Characters not counted because the table was full
+static bool s_dirty = false;
+
+static void count(uint16_t cp) {
+    uint32_t i = (cp * 2654435761u) % SLOTS;
+    for (uint32_t probe = 0; probe < SLOTS; probe++) {
+        usage_slot_t *slot = &s_slots[i];
+        if (slot->cp == cp) {
+            if (slot->count < UINT16_MAX) {
+                slot->count++;
+            }
+            return;
+        }
+        if (slot->cp == 0) {
+            // Keep the table at most 3/4 full so probes stay short
+            if (s_distinct >= SLOTS * 3 / 4) {
+                s_dropped++;
+                return;
+            }
+            slot->cp = cp;
+            slot->count = 1;
+            s_distinct++;
+            return;
+        }
+        i = (i + 1) % SLOTS;
+    }
+    s_dropped++;
+}
+
+void char_usage_add(const char *text, size_t len) {
+    if (text == NULL) {
+        return;
+    }
+    if (s_slots == NULL) {
+        s_slots = (usage_slot_t *)calloc(SLOTS, sizeof(usage_slot_t));
+        if (s_slots == NULL) {
+            return;
+        }
+    }
+
+    const unsigned char *p = (const unsigned char *)text;
+    const unsigned char *end = p + len;
+    while (p < end) {
+        // Only 3-byte sequences can encode U+2E80..U+FFFF
+        if ((p[0] & 0xF0) == 0xE0 && end - p >= 3 && (p[1] & 0xC0) == 0x80 && (p[2] & 0xC0) == 0x80) {
+            uint16_t cp = (uint16_t)(((p[0] & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F));
+            if (cp >= FIRST_COUNTED) {
+                count(cp);
+                s_total++;
+                s_dirty = true;
+            }
+            p += 3;
+        } else {
+            p++;
+        }
+    }
+}
+
+void char_usage_dump(void) {
+    if (!s_dirty) {
+        return;
+    }
+    s_dirty = false;
+
+    ESP_LOGI(TAG, "char_usage begin: %u distinct, %u total, %u dropped",
+             (unsigned)s_distinct, (unsigned)s_total, (unsigned)s_dropped);
+    char line[TOKENS_PER_LINE * 16];
+    size_t pos = 0;
+    int tokens = 0;
+    for (uint32_t i = 0; i < SLOTS; i++) {
+        if (s_slots[i].cp == 0) {
+            continue;
+        }
+        pos += (size_t)snprintf(line + pos, sizeof(line) - pos, " U+%04X:%u",
+                                s_slots[i].cp, s_slots[i].count);
+        if (++tokens == TOKENS_PER_LINE) {
+            ESP_LOGI(TAG, "%s", line);
+            pos = 0;
+            tokens = 0;
+        }
+    }
+    if (tokens > 0) {
+        ESP_LOGI(TAG, "%s", line);
+    }
+    ESP_LOGI(TAG, "char_usage end");
+}
+
+#else
+
+void char_usage_add(const char *text, size_t len) {
+    (void)text;
+    (void)len;
+}
+
+void char_usage_dump(void) {
+}
+
+#endif // CONFIG_FONT_MANAGER_CHAR_USAGE
@@ -0,0 +1,39 @@
+/*
+ * Character usage counter
+ * Counts the CJK characters the UI shows, to drive font subsetting
+ *
+ * Enabled with CONFIG_FONT_MANAGER_CHAR_USAGE; otherwise every call is a
+ * no-op and no memory is used. char_usage_dump() logs the cumulative counts
+ * as "U+4F60:37" tokens that tools/subset_fonts.py reads from a captured
+ * serial log (only the last dump in a log is used).
+ *
+ * Only BMP characters from U+2E80 up are counted, since Latin text comes
+ * from Montserrat. Not thread safe: call from one task.
+ */
+
+#ifndef CHAR_USAGE_H
+#define CHAR_USAGE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Count the CJK characters in a UTF-8 string
+ * @param text UTF-8 text (need not be NUL terminated)
+ * @param len Length in bytes
+ */
+void char_usage_add(const char *text, size_t len);
+
+/**
+ * @brief Log all counts if characters were added since the last dump
+ */
+void char_usage_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CHAR_USAGE_H
@@ -0,0 +1,264 @@
+/*
+ * Font assets implementation
+ * The image layout is documented in tools/pack_font_assets.py
+ */
+
+#include "font_assets.h"
+#include "esp_partition.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "font_assets";
+
+#define ASSETS_PARTITION_LABEL  "assets"
+#define ASSETS_MAGIC            "FPAK"
+#define ASSETS_VERSION          1
+#define ASSETS_NAME_LEN         32
+#define ASSETS_MAX_FONTS        8
+
+typedef struct __attribute__((packed)) {
+    char magic[4];
+    uint16_t version;
+    uint16_t font_count;
+    uint16_t glyph_dsc_size;
+    uint16_t reserved;
+    uint32_t image_size;
+} assets_header_t;
+
+typedef struct __attribute__((packed)) {
+    char name[ASSETS_NAME_LEN];
+    uint32_t offset;
+    uint32_t size;
+} assets_font_entry_t;
+
+typedef struct __attribute__((packed)) {
+    int16_t line_height;
+    int16_t base_line;
+    int16_t underline_position;
+    uint16_t underline_thickness;
+    uint8_t bpp;
+    uint8_t bitmap_format;
+    uint8_t subpx;
+    uint8_t reserved0;
+    uint16_t cmap_num;
+    uint16_t fallback;          // 1 + font table index of the fallback font, 0 for none
+    uint32_t glyph_count;
+    uint32_t cmaps_offset;
+    uint32_t glyph_dsc_offset;
+    uint32_t bitmap_offset;
+} assets_font_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t range_start;
+    uint16_t range_length;
+    uint16_t glyph_id_start;
+    uint32_t list_offset;
+    uint16_t list_length;
+    uint8_t type;
+    uint8_t reserved;
+} assets_cmap_t;
+
+// RAM side of a mapped font; everything it points to except cmaps lives in flash
+typedef struct {
+    const char *name;
+    uint16_t index;             // Position in the image's font table
+    uint16_t fallback;
+    lv_font_t font;
+    lv_font_fmt_txt_dsc_t dsc;
+    lv_font_fmt_txt_cmap_t *cmaps;
+} asset_font_t;
+
+static asset_font_t s_fonts[ASSETS_MAX_FONTS];
+static size_t s_font_count = 0;
+static esp_partition_mmap_handle_t s_mmap_handle;
+static bool s_attempted = false;
+static esp_err_t s_init_result = ESP_ERR_INVALID_STATE;
+
+static bool in_range(uint32_t offset, uint32_t len, uint32_t size) {
+    return offset <= size && len <= size - offset;
+}
+
+/**
+ * Set up one font from its record; returns false if any table falls outside the record
+ */
+static bool load_font(asset_font_t *af, const uint8_t *base, uint32_t size) {
+    if (size < sizeof(assets_font_t)) {
+        return false;
+    }
+    const assets_font_t *rec = (const assets_font_t *)base;
+    uint32_t dsc_bytes = rec->glyph_count * sizeof(lv_font_fmt_txt_glyph_dsc_t);
+    if (rec->cmap_num == 0 || rec->glyph_count == 0 ||
+        rec->glyph_count > UINT32_MAX / sizeof(lv_font_fmt_txt_glyph_dsc_t) ||
+        !in_range(rec->cmaps_offset, rec->cmap_num * sizeof(assets_cmap_t), size) ||
+        !in_range(rec->glyph_dsc_offset, dsc_bytes, size) ||
+        rec->bitmap_offset > size) {
+        return false;
+    }
+
+    // Cmap records are repacked for LVGL; the lists they reference stay in flash
+    af->cmaps = (lv_font_fmt_txt_cmap_t *)calloc(rec->cmap_num, sizeof(lv_font_fmt_txt_cmap_t));
+    if (af->cmaps == NULL) {
+        return false;
+    }
+    const assets_cmap_t *src = (const assets_cmap_t *)(base + rec->cmaps_offset);
+    for (uint16_t i = 0; i < rec->cmap_num; i++) {
+        lv_font_fmt_txt_cmap_t *cmap = &af->cmaps[i];
+        cmap->range_start = src[i].range_start;
+        cmap->range_length = src[i].range_length;
+        cmap->glyph_id_start = src[i].glyph_id_start;
+        cmap->list_length = src[i].list_length;
+        cmap->type = (lv_font_fmt_txt_cmap_type_t)src[i].type;
+        const uint8_t *list = base + src[i].list_offset;
+        switch (cmap->type) {
+            case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL:
+                if (!in_range(src[i].list_offset, src[i].list_length, size)) {
+                    goto fail;
+                }
+                cmap->glyph_id_ofs_list = list;
+                break;
+            case LV_FONT_FMT_TXT_CMAP_SPARSE_FULL:
+                if (!in_range(src[i].list_offset, src[i].list_length * 4u, size)) {
+                    goto fail;
+                }
+                cmap->unicode_list = (const uint16_t *)list;
+                cmap->glyph_id_ofs_list = list + src[i].list_length * 2u;
+                break;
+            case LV_FONT_FMT_TXT_CMAP_SPARSE_TINY:
+                if (!in_range(src[i].list_offset, src[i].list_length * 2u, size)) {
+                    goto fail;
+                }
+                cmap->unicode_list = (const uint16_t *)list;
+                break;
+            case LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY:
+                break;
+            default:
+                goto fail;
+        }
+    }
+
+    memset(&af->dsc, 0, sizeof(af->dsc));
+    af->dsc.glyph_bitmap = base + rec->bitmap_offset;
+    af->dsc.glyph_dsc = (const lv_font_fmt_txt_glyph_dsc_t *)(base + rec->glyph_dsc_offset);
+    af->dsc.cmaps = af->cmaps;
+    af->dsc.cmap_num = rec->cmap_num;
+    af->dsc.bpp = rec->bpp;
+    af->dsc.bitmap_format = rec->bitmap_format;
+
+    memset(&af->font, 0, sizeof(af->font));
+    af->font.get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt;
+    af->font.get_glyph_bitmap = lv_font_get_glyph_bitmap_fmt_txt;
+    af->font.line_height = rec->line_height;
+    af->font.base_line = rec->base_line;
+    af->font.subpx = rec->subpx;
+    af->font.underline_position = (int8_t)rec->underline_position;
+    af->font.underline_thickness = (int8_t)rec->underline_thickness;
+    af->font.dsc = &af->dsc;
+    af->fallback = rec->fallback;
+    return true;
+
+fail:
+    free(af->cmaps);
+    af->cmaps = NULL;
+    return false;
+}
+
+/**
+ * Chain subset fonts to their fallback font. Only one level is linked, so a
+ * malformed image cannot make LVGL's fallback walk loop.
+ */
+static void link_fallbacks(void) {
+    for (size_t i = 0; i < s_font_count; i++) {
+        if (s_fonts[i].fallback == 0) {
+            continue;
+        }
+        for (size_t j = 0; j < s_font_count; j++) {
+            if (j != i && s_fonts[j].index + 1 == s_fonts[i].fallback && s_fonts[j].fallback == 0) {
+                s_fonts[i].font.fallback = &s_fonts[j].font;
+                break;
+            }
+        }
+    }
+}
+
+static esp_err_t map_assets(void) {
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           ESP_PARTITION_SUBTYPE_ANY,
+                                                           ASSETS_PARTITION_LABEL);
+    if (part == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Check the header before mapping so an empty partition costs no MMU pages
+    assets_header_t header;
+    esp_err_t ret = esp_partition_read(part, 0, &header, sizeof(header));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (memcmp(header.magic, ASSETS_MAGIC, sizeof(header.magic)) != 0 || header.version != ASSETS_VERSION) {
+        ESP_LOGW(TAG, "No font image in partition '%s'", part->label);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (header.glyph_dsc_size != sizeof(lv_font_fmt_txt_glyph_dsc_t)) {
+        ESP_LOGE(TAG, "Font image glyph descriptors are %u bytes, LVGL expects %u (LV_FONT_FMT_TXT_LARGE mismatch)",
+                 header.glyph_dsc_size, (unsigned)sizeof(lv_font_fmt_txt_glyph_dsc_t));
+        return ESP_ERR_INVALID_VERSION;
+    }
+    uint32_t table_end = sizeof(header) + header.font_count * sizeof(assets_font_entry_t);
+    if (header.image_size > part->size || header.image_size < table_end) {
+        ESP_LOGE(TAG, "Font image size %u does not fit partition (%u bytes)",
+                 (unsigned)header.image_size, (unsigned)part->size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const void *ptr;
+    ret = esp_partition_mmap(part, 0, header.image_size, ESP_PARTITION_MMAP_DATA, &ptr, &s_mmap_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map font image (%u bytes): %s", (unsigned)header.image_size, esp_err_to_name(ret));
+        return ret;
+    }
+
+    const uint8_t *image = (const uint8_t *)ptr;
+    const assets_font_entry_t *entries = (const assets_font_entry_t *)(image + sizeof(header));
+    for (uint16_t i = 0; i < header.font_count && s_font_count < ASSETS_MAX_FONTS; i++) {
+        const assets_font_entry_t *entry = &entries[i];
+        if (entry->name[ASSETS_NAME_LEN - 1] != '\0' || (entry->offset & 3) != 0 ||
+            !in_range(entry->offset, entry->size, header.image_size) ||
+            !load_font(&s_fonts[s_font_count], image + entry->offset, entry->size)) {
+            ESP_LOGW(TAG, "Skipping malformed font entry %u", i);
+            continue;
+        }
+        s_fonts[s_font_count].name = entry->name;
+        s_fonts[s_font_count].index = i;
+        s_font_count++;
+    }
+    if (s_font_count == 0) {
+        esp_partition_munmap(s_mmap_handle);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    link_fallbacks();
+
+    ESP_LOGI(TAG, "Mapped %u fonts from partition '%s' (%u KB)",
+             (unsigned)s_font_count, part->label, (unsigned)(header.image_size / 1024));
+    return ESP_OK;
+}
+
+esp_err_t font_assets_init(void) {
+    if (!s_attempted) {
+        s_attempted = true;
+        s_init_result = map_assets();
+    }
+    return s_init_result;
+}
+
+const lv_font_t* font_assets_get(const char* name) {
+    if (name == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < s_font_count; i++) {
+        if (strcmp(s_fonts[i].name, name) == 0) {
+            return &s_fonts[i].font;
+        }
+    }
+    return NULL;
+}
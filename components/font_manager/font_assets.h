@@ -0,0 +1,47 @@
+/*
+ * Font assets
+ * Loads fonts packed by tools/pack_font_assets.py from the "assets" partition
+ *
+ * The partition is memory-mapped with esp_partition_mmap and the fonts are
+ * set up as LVGL fmt_txt fonts whose glyph descriptors, cmap lists and
+ * bitmaps point into the mapping, so glyph data is read zero-copy from flash
+ * through the MMU cache. Only the font headers and cmap tables (a few hundred
+ * bytes per font) are allocated in RAM. Subset fonts built by
+ * tools/subset_fonts.py are chained to the complete font in the image as
+ * their LVGL fallback.
+ */
+
+#ifndef FONT_ASSETS_H
+#define FONT_ASSETS_H
+
+#include "lvgl.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Map the assets partition and load the fonts in it
+ *
+ * Safe to call more than once; later calls return the first result.
+ *
+ * @return ESP_OK on success
+ *         ESP_ERR_NOT_FOUND if there is no "assets" partition
+ *         ESP_ERR_INVALID_VERSION if the partition holds no valid font image
+ *         or the image was packed for a different LV_FONT_FMT_TXT_LARGE setting
+ */
+esp_err_t font_assets_init(void);
+
+/**
+ * @brief Get a font from the assets partition
+ * @param name Font name, the binfont file name without extension (e.g. "font_puhui_16_4")
+ * @return Pointer to the font, NULL if it is not in the partition or font_assets_init failed
+ */
+const lv_font_t* font_assets_get(const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FONT_ASSETS_H
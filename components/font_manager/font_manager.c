@@ -1,22 +1,213 @@
 /*
  * Font Manager Implementation
- * Dynamically selects appropriate fonts based on text content
+ * Builds Montserrat -> PuHui fallback chains so glyphs are resolved per character
  */
 
 #include "font_manager.h"
+#include "glyph_cache.h"
+#include "font_assets.h"
 #include "esp_log.h"
 #include <string.h>
 
 static const char *TAG = "font_manager";
 
+// With a font assets image the PuHui fonts come from the assets partition and
+// the compiled-in copies are left out of the app unless explicitly kept
+#if !defined(FONT_MANAGER_HAVE_ASSETS) || defined(CONFIG_FONT_MANAGER_BUILTIN_CJK)
+#define FONT_MANAGER_BUILTIN_CJK 1
 // Declare xiaozhi-fonts puhui fonts (阿里巴巴普惠体) - 完整字符集
 LV_FONT_DECLARE(font_puhui_14_1);
 LV_FONT_DECLARE(font_puhui_16_4);
 LV_FONT_DECLARE(font_puhui_20_4);
 LV_FONT_DECLARE(font_puhui_30_4);
+#define BUILTIN_CJK(font) (&(font))
+#else
+#define BUILTIN_CJK(font) NULL
+#endif
+
+// PuHui fonts by name, as packed into the assets image
+typedef struct {
+    const char *name;
+    const lv_font_t *builtin;
+} cjk_font_t;
+
+static const cjk_font_t s_cjk_fonts[] = {
+    {"font_puhui_14_1", BUILTIN_CJK(font_puhui_14_1)},
+    {"font_puhui_16_4", BUILTIN_CJK(font_puhui_16_4)},
+    {"font_puhui_20_4", BUILTIN_CJK(font_puhui_20_4)},
+    {"font_puhui_30_4", BUILTIN_CJK(font_puhui_30_4)},
+};
+
+// UI font sizes; each gets a RAM copy of its Latin font chained to a PuHui font
+typedef struct {
+    int size;
+    lv_font_t font;
+    lv_style_t style;
+} font_chain_t;
+
+static font_chain_t s_chains[] = {
+    {.size = 10}, {.size = 12}, {.size = 14}, {.size = 16}, {.size = 20}, {.size = 24}, {.size = 30},
+};
+static bool s_initialized = false;
+
+// Glyph cache budget: decoded glyphs are small (a 14 px 1 bpp glyph packs to ~25 bytes)
+#ifdef CONFIG_SPIRAM
+#define GLYPH_CACHE_BUDGET (256 * 1024)
+#else
+#define GLYPH_CACHE_BUDGET (16 * 1024)
+#endif
+
+// RAM copies of compressed CJK fonts whose bitmap callback goes through the glyph cache
+typedef struct {
+    lv_font_t font;             // Must be first: resolved_font points here
+    const lv_font_t *src;
+} cached_font_t;
+
+static cached_font_t s_cached_fonts[4];
+static size_t s_cached_font_count = 0;
+
+static uint32_t decode_utf8(const unsigned char **p) {
+    const unsigned char *s = *p;
+    uint32_t c;
+    int n;
+    if (s[0] < 0x80) {
+        *p += 1;
+        return s[0];
+    } else if ((s[0] & 0xE0) == 0xC0) {
+        c = s[0] & 0x1F;
+        n = 1;
+    } else if ((s[0] & 0xF0) == 0xE0) {
+        c = s[0] & 0x0F;
+        n = 2;
+    } else if ((s[0] & 0xF8) == 0xF0) {
+        c = s[0] & 0x07;
+        n = 3;
+    } else {
+        *p += 1;
+        return 0xFFFD;
+    }
+    for (int i = 1; i <= n; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *p += i;
+            return 0xFFFD;
+        }
+        c = (c << 6) | (s[i] & 0x3F);
+    }
+    *p += n + 1;
+    return c;
+}
+
+static bool is_cjk(uint32_t c) {
+    return (c >= 0x1100 && c <= 0x11FF) ||     // Hangul Jamo
+           (c >= 0x2E80 && c <= 0x9FFF) ||     // radicals, CJK punctuation, kana, ideographs
+           (c >= 0xAC00 && c <= 0xD7AF) ||     // Hangul syllables
+           (c >= 0xF900 && c <= 0xFAFF) ||     // compatibility ideographs
+           (c >= 0xFE30 && c <= 0xFE4F) ||     // CJK compatibility forms
+           (c >= 0xFF00 && c <= 0xFFEF) ||     // full-width forms (，！？：；)
+           (c >= 0x20000 && c <= 0x2FA1F);     // extension B and beyond
+}
+
+static const void *cached_glyph_bitmap(lv_font_glyph_dsc_t *g_dsc, lv_draw_buf_t *draw_buf) {
+    const cached_font_t *cf = (const cached_font_t *)g_dsc->resolved_font;
+    if (g_dsc->req_raw_bitmap || draw_buf == NULL || draw_buf->header.cf != LV_COLOR_FORMAT_A8) {
+        return cf->src->get_glyph_bitmap(g_dsc, draw_buf);
+    }
+
+    uint32_t gid = g_dsc->gid.index;
+    if (glyph_cache_get(cf, gid, draw_buf->data, draw_buf->header.stride)) {
+        return draw_buf;
+    }
+    const void *bitmap = cf->src->get_glyph_bitmap(g_dsc, draw_buf);
+    if (bitmap == draw_buf) {
+        const lv_font_fmt_txt_dsc_t *fdsc = (const lv_font_fmt_txt_dsc_t *)cf->src->dsc;
+        glyph_cache_put(cf, gid, g_dsc->box_w, g_dsc->box_h, fdsc->bpp, draw_buf->data, draw_buf->header.stride);
+    }
+    return bitmap;
+}
+
+/**
+ * Put compressed fmt_txt fonts behind the glyph cache; plain fonts are
+ * returned as is since their bitmaps need no decoding
+ */
+static const lv_font_t *with_glyph_cache(const lv_font_t *src) {
+    if (src->get_glyph_dsc != lv_font_get_glyph_dsc_fmt_txt ||
+        ((const lv_font_fmt_txt_dsc_t *)src->dsc)->bitmap_format == LV_FONT_FMT_TXT_PLAIN) {
+        return src;
+    }
+    for (size_t i = 0; i < s_cached_font_count; i++) {
+        if (s_cached_fonts[i].src == src) {
+            return &s_cached_fonts[i].font;
+        }
+    }
+    if (s_cached_font_count == sizeof(s_cached_fonts) / sizeof(s_cached_fonts[0])) {
+        return src;
+    }
+
+    cached_font_t *cf = &s_cached_fonts[s_cached_font_count++];
+    cf->font = *src;
+    cf->src = src;
+    cf->font.get_glyph_bitmap = cached_glyph_bitmap;
+    // Subset asset fonts chain to a complete font for rare characters
+    if (src->fallback != NULL) {
+        cf->font.fallback = with_glyph_cache(src->fallback);
+    }
+    return &cf->font;
+}
+
+/**
+ * Copy the Latin font into RAM, chain the CJK font behind it and size the
+ * line to fit both (LVGL lays out lines with the primary font's metrics)
+ */
+static void build_chain(font_chain_t *chain) {
+    const lv_font_t *latin = font_manager_get_english_font(chain->size);
+    const lv_font_t *cjk = with_glyph_cache(font_manager_get_chinese_font(chain->size));
+
+    chain->font = *latin;
+    chain->font.fallback = cjk;
+    int32_t ascent = LV_MAX(latin->line_height - latin->base_line, cjk->line_height - cjk->base_line);
+    int32_t descent = LV_MAX(latin->base_line, cjk->base_line);
+    chain->font.line_height = ascent + descent;
+    chain->font.base_line = descent;
+
+    lv_style_init(&chain->style);
+    lv_style_set_text_font(&chain->style, &chain->font);
+}
+
+static font_chain_t *find_chain(int size) {
+    if (!s_initialized) {
+        font_manager_init();
+    }
+    // Exact size, otherwise the next larger one, otherwise the largest
+    size_t count = sizeof(s_chains) / sizeof(s_chains[0]);
+    for (size_t i = 0; i < count; i++) {
+        if (s_chains[i].size >= size) {
+            return &s_chains[i];
+        }
+    }
+    return &s_chains[count - 1];
+}
 
 esp_err_t font_manager_init(void) {
-    ESP_LOGI(TAG, "Font manager initialized");
+    if (s_initialized) {
+        return ESP_OK;
+    }
+    glyph_cache_set_budget(GLYPH_CACHE_BUDGET);
+    esp_err_t ret = font_assets_init();
+    if (ret != ESP_OK) {
+#ifdef FONT_MANAGER_BUILTIN_CJK
+        ESP_LOGI(TAG, "Font assets unavailable (%s), using built-in CJK fonts", esp_err_to_name(ret));
+#else
+        ESP_LOGE(TAG, "Font assets unavailable (%s), CJK text will not render; flash the assets partition",
+                 esp_err_to_name(ret));
+#endif
+    }
+    for (size_t i = 0; i < sizeof(s_chains) / sizeof(s_chains[0]); i++) {
+        build_chain(&s_chains[i]);
+    }
+    s_initialized = true;
+    ESP_LOGI(TAG, "Font manager initialized (%u fallback chains, %u cached CJK fonts, %u KB glyph cache)",
+             (unsigned)(sizeof(s_chains) / sizeof(s_chains[0])), (unsigned)s_cached_font_count,
+             (unsigned)(GLYPH_CACHE_BUDGET / 1024));
     return ESP_OK;
 }
 
@@ -27,56 +218,32 @@ bool font_manager_has_chinese(const char* text) {
 
     const unsigned char *p = (const unsigned char *)text;
     while (*p) {
-        // Check for UTF-8 Chinese character range
-        // Chinese characters typically start with 0xE4-0xE9 in UTF-8
-        if (*p >= 0xE4 && *p <= 0xE9) {
-            // Verify it's a valid 3-byte UTF-8 sequence
-            if (p[1] >= 0x80 && p[1] <= 0xBF &&
-                p[2] >= 0x80 && p[2] <= 0xBF) {
-                return true;
-            }
-        }
-        // Skip to next character
-        if (*p < 0x80) {
-            p++; // ASCII
-        } else if ((*p & 0xE0) == 0xC0) {
-            p += 2; // 2-byte UTF-8
-        } else if ((*p & 0xF0) == 0xE0) {
-            p += 3; // 3-byte UTF-8 (Chinese)
-        } else if ((*p & 0xF8) == 0xF0) {
-            p += 4; // 4-byte UTF-8
-        } else {
-            p++; // Invalid, skip
+        if (is_cjk(decode_utf8(&p))) {
+            return true;
         }
     }
     return false;
 }
 
 const lv_font_t* font_manager_get_chinese_font(int size) {
-    // Return appropriate Chinese font based on size
     // Use Alibaba PuHui font (阿里巴巴普惠体) for Chinese text - 完整字符集
+    size_t index;
+    if (size <= 14) {
+        index = 0;
+    } else if (size <= 17) {
+        index = 1;
+    } else if (size <= 20) {
+        index = 2;
+    } else {
+        index = 3;
+    }
 
-    switch (size) {
-        case 14:
-            return &font_puhui_14_1;
-        case 16:
-            return &font_puhui_16_4;
-        case 18:
-        case 20:
-            return &font_puhui_20_4;
-        case 24:
-        case 30:
-            return &font_puhui_30_4;
-        default:
-            // Fall back to appropriate font for other sizes
-            if (size <= 14) {
-                return &font_puhui_14_1;
-            } else if (size <= 20) {
-                return &font_puhui_16_4;
-            } else {
-                return &font_puhui_30_4;
-            }
+    // Prefer the memory-mapped asset font, then the compiled-in one
+    const lv_font_t *font = font_assets_get(s_cjk_fonts[index].name);
+    if (font == NULL) {
+        font = s_cjk_fonts[index].builtin;
     }
+    return font != NULL ? font : LV_FONT_DEFAULT;
 }
 
 const lv_font_t* font_manager_get_english_font(int size) {
@@ -129,15 +296,15 @@ const lv_font_t* font_manager_get_english_font(int size) {
     }
 }
 
-const lv_font_t* font_manager_get_font(const char* text, int size) {
-    if (text == NULL) {
-        return font_manager_get_english_font(size);
-    }
+const lv_font_t* font_manager_get_ui_font(int size) {
+    return &find_chain(size)->font;
+}
 
-    // Check if text contains Chinese characters
-    if (font_manager_has_chinese(text)) {
-        return font_manager_get_chinese_font(size);
-    } else {
-        return font_manager_get_english_font(size);
-    }
+const lv_style_t* font_manager_get_style(int size) {
+    return &find_chain(size)->style;
+}
+
+const lv_font_t* font_manager_get_font(const char* text, int size) {
+    (void)text;
+    return font_manager_get_ui_font(size);
 }
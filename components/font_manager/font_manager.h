@@ -1,6 +1,6 @@
 /*
  * Font Manager for LVGL
- * Provides dynamic font selection for Chinese and English text
+ * Provides Montserrat -> PuHui fallback-chained fonts and shared font styles
  */
 
 #ifndef FONT_MANAGER_H
@@ -21,15 +21,47 @@ extern "C" {
 esp_err_t font_manager_init(void);
 
 /**
- * @brief Get appropriate font for text content
- * @param text Text content to analyze
+ * @brief Get the UI font for a size
+ * 
+ * UI fonts are Montserrat with the PuHui font of the nearest size as LVGL
+ * fallback, so Latin glyphs come from Montserrat and CJK glyphs (including
+ * full-width punctuation) are looked up per character at render time.
+ * The line height covers both fonts.
+ * 
+ * @param size Font size (10, 12, 14, 16, 20, 24, 30)
+ * @return Pointer to the fallback-chained font
+ */
+const lv_font_t* font_manager_get_ui_font(int size);
+
+/**
+ * @brief Get a shared style whose text font is the UI font for a size
+ * 
+ * Add it once when creating a widget with lv_obj_add_style(); text updates
+ * then need no font selection.
+ * 
+ * @param size Font size
+ * @return Pointer to the shared style
+ */
+const lv_style_t* font_manager_get_style(int size);
+
+/**
+ * @brief Get font for text content
+ * 
+ * Kept for compatibility: returns font_manager_get_ui_font(size) without
+ * scanning the text, since the fallback chain covers both scripts.
+ * 
+ * @param text Text content (unused)
  * @param size Font size (14, 16, 20, 24, etc.)
  * @return Pointer to appropriate font
  */
 const lv_font_t* font_manager_get_font(const char* text, int size);
 
 /**
- * @brief Check if text contains Chinese characters
+ * @brief Check if text contains CJK characters
+ * 
+ * Covers CJK ideographs, radicals, CJK and full-width punctuation, kana and
+ * Hangul.
+ * 
  * @param text Text to check
  * @return true if contains Chinese, false otherwise
  */
@@ -37,6 +69,10 @@ bool font_manager_has_chinese(const char* text);
 
 /**
  * @brief Get default Chinese font for given size
+ * 
+ * Comes from the memory-mapped assets partition when it holds the font,
+ * otherwise from the fonts compiled into the app.
+ * 
  * @param size Font size
  * @return Pointer to Chinese font
  */
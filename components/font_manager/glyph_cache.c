@@ -0,0 +1,203 @@
+/*
+ * Glyph bitmap cache implementation
+ */
+
+#include "glyph_cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+// Prefer PSRAM when the board has it, internal RAM otherwise
+#define CACHE_MALLOC(size) heap_caps_malloc_prefer((size), 2, MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT)
+#define CACHE_FREE(ptr) heap_caps_free(ptr)
+#else
+#define CACHE_MALLOC(size) malloc(size)
+#define CACHE_FREE(ptr) free(ptr)
+#endif
+
+#define HASH_BUCKETS 256    // Power of two
+
+typedef struct glyph_entry {
+    struct glyph_entry *prev;   // LRU list, head is most recently used
+    struct glyph_entry *next;
+    struct glyph_entry *hnext;  // Hash chain
+    const void *font;
+    uint32_t gid;
+    uint16_t w;
+    uint16_t h;
+    uint8_t bpp;
+    uint32_t size;              // Allocation size, counted against the budget
+    uint8_t data[];
+} glyph_entry_t;
+
+static glyph_entry_t *s_buckets[HASH_BUCKETS];
+static glyph_entry_t *s_head = NULL;
+static glyph_entry_t *s_tail = NULL;
+static glyph_cache_stats_t s_stats = {0};
+
+// Packed value -> A8 is v * 255 / (2^bpp - 1), identical to LVGL's opa tables for fmt_txt fonts
+static const uint8_t s_opa_scale[5] = {0, 255, 85, 0, 17};
+
+static inline uint32_t row_bytes(uint16_t w, uint8_t bpp) {
+    return ((uint32_t)w * bpp + 7) / 8;
+}
+
+static inline uint32_t hash_key(const void *font, uint32_t gid) {
+    uint32_t h = (uint32_t)(uintptr_t)font ^ (gid * 2654435761u);
+    return (h ^ (h >> 16)) & (HASH_BUCKETS - 1);
+}
+
+static void lru_unlink(glyph_entry_t *e) {
+    if (e->prev) {
+        e->prev->next = e->next;
+    } else {
+        s_head = e->next;
+    }
+    if (e->next) {
+        e->next->prev = e->prev;
+    } else {
+        s_tail = e->prev;
+    }
+}
+
+static void lru_push_front(glyph_entry_t *e) {
+    e->prev = NULL;
+    e->next = s_head;
+    if (s_head) {
+        s_head->prev = e;
+    }
+    s_head = e;
+    if (s_tail == NULL) {
+        s_tail = e;
+    }
+}
+
+static void remove_entry(glyph_entry_t *e) {
+    glyph_entry_t **pp = &s_buckets[hash_key(e->font, e->gid)];
+    while (*pp != e) {
+        pp = &(*pp)->hnext;
+    }
+    *pp = e->hnext;
+    lru_unlink(e);
+    s_stats.bytes -= e->size;
+    s_stats.entries--;
+    CACHE_FREE(e);
+}
+
+static void evict_to(size_t budget) {
+    while (s_tail != NULL && s_stats.bytes > budget) {
+        remove_entry(s_tail);
+        s_stats.evictions++;
+    }
+}
+
+void glyph_cache_set_budget(size_t budget_bytes) {
+    s_stats.budget = budget_bytes;
+    evict_to(budget_bytes);
+}
+
+bool glyph_cache_get(const void *font, uint32_t gid, uint8_t *out, uint32_t stride) {
+    glyph_entry_t *e = s_buckets[hash_key(font, gid)];
+    while (e != NULL && (e->font != font || e->gid != gid)) {
+        e = e->hnext;
+    }
+    if (e == NULL) {
+        s_stats.misses++;
+        return false;
+    }
+
+    if (e != s_head) {
+        lru_unlink(e);
+        lru_push_front(e);
+    }
+    s_stats.hits++;
+
+    uint32_t rb = row_bytes(e->w, e->bpp);
+    if (e->bpp == 8) {
+        for (uint16_t y = 0; y < e->h; y++) {
+            memcpy(out + y * stride, e->data + y * rb, e->w);
+        }
+        return true;
+    }
+
+    // Each row starts on a byte boundary, pixels MSB first; unpack a byte at a time
+    const uint8_t bpp = e->bpp;
+    const uint8_t scale = s_opa_scale[bpp];
+    const uint8_t mask = (uint8_t)((1 << bpp) - 1);
+    const uint8_t per_byte = (uint8_t)(8 / bpp);
+    for (uint16_t y = 0; y < e->h; y++) {
+        const uint8_t *src = e->data + y * rb;
+        uint8_t *row = out + y * stride;
+        uint16_t x = 0;
+        for (uint32_t i = 0; i < rb; i++) {
+            uint8_t byte = src[i];
+            for (uint8_t k = 0; k < per_byte && x < e->w; k++, x++) {
+                row[x] = (uint8_t)(((byte >> (8 - bpp)) & mask) * scale);
+                byte <<= bpp;
+            }
+        }
+    }
+    return true;
+}
+
+void glyph_cache_put(const void *font, uint32_t gid, uint16_t w, uint16_t h, uint8_t bpp,
+                     const uint8_t *a8, uint32_t stride) {
+    if (bpp != 1 && bpp != 2 && bpp != 4) {
+        bpp = 8;
+    }
+    uint32_t data_size = row_bytes(w, bpp) * h;
+    uint32_t size = sizeof(glyph_entry_t) + data_size;
+    if (w == 0 || h == 0 || size > s_stats.budget) {
+        return;
+    }
+
+    evict_to(s_stats.budget - size);
+    glyph_entry_t *e = (glyph_entry_t *)CACHE_MALLOC(size);
+    if (e == NULL) {
+        return;
+    }
+    e->font = font;
+    e->gid = gid;
+    e->w = w;
+    e->h = h;
+    e->bpp = bpp;
+    e->size = size;
+
+    uint32_t rb = row_bytes(w, bpp);
+    if (bpp == 8) {
+        for (uint16_t y = 0; y < h; y++) {
+            memcpy(e->data + y * rb, a8 + y * stride, w);
+        }
+    } else {
+        // A8 -> packed: LVGL's opa tables map back exactly with a right shift
+        memset(e->data, 0, data_size);
+        for (uint16_t y = 0; y < h; y++) {
+            const uint8_t *row = a8 + y * stride;
+            uint8_t *dst = e->data + y * rb;
+            for (uint16_t x = 0; x < w; x++) {
+                uint32_t bit = (uint32_t)x * bpp;
+                dst[bit >> 3] |= (uint8_t)((row[x] >> (8 - bpp)) << (8 - bpp - (bit & 7)));
+            }
+        }
+    }
+
+    uint32_t b = hash_key(font, gid);
+    e->hnext = s_buckets[b];
+    s_buckets[b] = e;
+    lru_push_front(e);
+    s_stats.bytes += size;
+    s_stats.entries++;
+}
+
+void glyph_cache_clear(void) {
+    while (s_tail != NULL) {
+        remove_entry(s_tail);
+    }
+}
+
+void glyph_cache_get_stats(glyph_cache_stats_t *stats) {
+    if (stats != NULL) {
+        *stats = s_stats;
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * Glyph bitmap cache
+ * LRU cache of decompressed glyph bitmaps keyed by (font, glyph id)
+ * 
+ * Compressed LVGL fonts RLE-decode every glyph on every draw. The cache keeps
+ * decoded glyphs packed at the font's bit depth (1/2/4 bpp with byte-aligned
+ * rows, A8 otherwise) and expands them back to A8 on a hit, a shift and a
+ * multiply per pixel instead of a bit-serial RLE decode. Entries are evicted
+ * least-recently-used first when the byte budget is exceeded.
+ * 
+ * Not thread safe: LVGL runs with LV_OS_NONE, so all calls come from the
+ * LVGL task. This module does not depend on LVGL.
+ */
+
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Cache statistics
+ */
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t entries;           ///< Glyphs currently cached
+    size_t bytes;               ///< Bytes currently used (entries and headers)
+    size_t budget;              ///< Byte budget
+} glyph_cache_stats_t;
+
+/**
+ * @brief Set the byte budget, evicting entries if the cache is over it
+ * @param budget_bytes Budget in bytes, 0 disables the cache
+ */
+void glyph_cache_set_budget(size_t budget_bytes);
+
+/**
+ * @brief Look up a glyph and expand it to A8
+ * @param font Font identity (any stable pointer)
+ * @param gid Glyph id within the font
+ * @param out A8 output, box_h rows of stride bytes
+ * @param stride Output row stride in bytes
+ * @return true on a hit (out is filled), false on a miss
+ */
+bool glyph_cache_get(const void *font, uint32_t gid, uint8_t *out, uint32_t stride);
+
+/**
+ * @brief Insert a decoded glyph
+ * @param font Font identity
+ * @param gid Glyph id within the font
+ * @param w Glyph box width
+ * @param h Glyph box height
+ * @param bpp Source bit depth (1, 2 or 4 are stored packed, others as A8)
+ * @param a8 Decoded A8 bitmap
+ * @param stride Row stride of a8 in bytes
+ */
+void glyph_cache_put(const void *font, uint32_t gid, uint16_t w, uint16_t h, uint8_t bpp,
+                     const uint8_t *a8, uint32_t stride);
+
+/**
+ * @brief Drop all entries (statistics are kept)
+ */
+void glyph_cache_clear(void);
+
+/**
+ * @brief Get cache statistics
+ * @param stats Output statistics
+ */
+void glyph_cache_get_stats(glyph_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GLYPH_CACHE_H
@@ -0,0 +1,279 @@
+#!/usr/bin/env python3
+"""
+Pack LVGL binfont files into a font assets image for memory-mapped loading.
+
+lv_font_conv's binary format (--format bin) stores glyph descriptors as
+bit-packed fields in front of each bitmap, so bitmaps are not byte aligned
+and LVGL's binfont loader copies everything into RAM. This tool converts
+each binfont into the layout of a compiled fmt_txt font: a glyph descriptor
+array matching lv_font_fmt_txt_glyph_dsc_t, a contiguous bitmap blob and
+cmap tables. font_assets.c maps the image with esp_partition_mmap and points
+LVGL straight at it, so only a few hundred bytes per font live in RAM.
+
+Image layout (little endian, all offsets relative to the image start):
+
+    header      magic "FPAK", u16 version, u16 font_count,
+                u16 glyph_dsc_size, u16 reserved, u32 image_size
+    font table  font_count x {char name[32], u32 offset, u32 size}
+    font        i16 line_height, i16 base_line, i16 underline_position,
+                u16 underline_thickness, u8 bpp, u8 bitmap_format, u8 subpx,
+                u8 reserved, u16 cmap_num, u16 fallback, u32 glyph_count,
+                u32 cmaps_offset, u32 glyph_dsc_offset, u32 bitmap_offset
+    cmap        cmap_num x {u32 range_start, u16 range_length,
+                u16 glyph_id_start, u32 list_offset, u16 list_length,
+                u8 type, u8 reserved}
+
+fallback is 1 + the font table index of the font LVGL should fall back to
+for missing glyphs, 0 for none (see subset_fonts.py). Kerning tables are
+dropped (CJK fonts do not use them).
+
+Usage:
+    pack_font_assets.py [--large] -o font_assets.bin font_puhui_14_1.bin ...
+
+--large must match CONFIG_LV_FONT_FMT_TXT_LARGE. Fonts are named after
+their file name without extension.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = b'FPAK'
+VERSION = 1
+NAME_LEN = 32
+HEADER = struct.Struct('<4sHHHHI')
+FONT_ENTRY = struct.Struct('<%dsII' % NAME_LEN)
+FONT_RECORD = struct.Struct('<hhhHBBBBHHIIII')
+CMAP_RECORD = struct.Struct('<IHHIHBB')
+
+# lv_font_fmt_txt_cmap_type_t, same numbering as the binfont format_type
+CMAP_FORMAT0_FULL = 0
+CMAP_SPARSE_FULL = 1
+CMAP_FORMAT0_TINY = 2
+CMAP_SPARSE_TINY = 3
+
+
+class BinfontError(Exception):
+    pass
+
+
+class BitReader:
+    """MSB-first bit reader, same order as LVGL's binfont loader"""
+
+    def __init__(self, data, bit_pos):
+        self.data = data
+        self.pos = bit_pos
+
+    def read(self, bits):
+        value = 0
+        for _ in range(bits):
+            byte = self.data[self.pos >> 3]
+            value = (value << 1) | ((byte >> (7 - (self.pos & 7))) & 1)
+            self.pos += 1
+        return value
+
+    def read_signed(self, bits):
+        value = self.read(bits)
+        if bits and value & (1 << (bits - 1)):
+            value -= 1 << bits
+        return value
+
+
+def read_section(data, start, label):
+    if start + 8 > len(data):
+        raise BinfontError('missing %s section' % label)
+    length, name = struct.unpack_from('<I4s', data, start)
+    if name != label.encode() or length < 8 or start + length > len(data):
+        raise BinfontError('bad %s section' % label)
+    return length
+
+
+def parse_binfont(data):
+    head_len = read_section(data, 0, 'head')
+    (version, tables_count, font_size, ascent, descent, typo_ascent, typo_descent,
+     typo_line_gap, min_y, max_y, default_advance_width, kerning_scale,
+     index_to_loc_format, glyph_id_format, advance_width_format, bits_per_pixel,
+     xy_bits, wh_bits, advance_width_bits, compression_id, subpixels_mode, padding,
+     underline_position, underline_thickness) = struct.unpack_from('<IHHHhHhHhhHHBBBBBBBBBBhH', data, 8)
+
+    # cmap section: subtable headers, data offsets relative to the section start
+    cmaps_start = head_len
+    cmaps_len = read_section(data, cmaps_start, 'cmap')
+    (cmap_count,) = struct.unpack_from('<I', data, cmaps_start + 8)
+    cmaps = []
+    for i in range(cmap_count):
+        (data_offset, range_start, range_length, glyph_id_start, entries,
+         format_type, _) = struct.unpack_from('<IIHHHBB', data, cmaps_start + 12 + i * 16)
+        base = cmaps_start + data_offset
+        unicode_list = b''
+        glyph_ids = b''
+        if format_type == CMAP_FORMAT0_FULL:
+            glyph_ids = data[base:base + entries]
+            list_length = range_length
+        elif format_type in (CMAP_SPARSE_FULL, CMAP_SPARSE_TINY):
+            unicode_list = data[base:base + entries * 2]
+            if format_type == CMAP_SPARSE_FULL:
+                glyph_ids = data[base + entries * 2:base + entries * 4]
+            list_length = entries
+        elif format_type == CMAP_FORMAT0_TINY:
+            list_length = 0
+        else:
+            raise BinfontError('unknown cmap format %d' % format_type)
+        cmaps.append((range_start, range_length, glyph_id_start, format_type, list_length,
+                      unicode_list, glyph_ids))
+
+    # loca: glyph offsets relative to the glyf section start
+    loca_start = cmaps_start + cmaps_len
+    loca_len = read_section(data, loca_start, 'loca')
+    (loca_count,) = struct.unpack_from('<I', data, loca_start + 8)
+    fmt = '<%d%s' % (loca_count, 'H' if index_to_loc_format == 0 else 'I')
+    offsets = struct.unpack_from(fmt, data, loca_start + 12)
+
+    glyf_start = loca_start + loca_len
+    glyf_len = read_section(data, glyf_start, 'glyf')
+
+    nbits = advance_width_bits + 2 * xy_bits + 2 * wh_bits
+    glyphs = []
+    bitmaps = bytearray()
+    for i in range(loca_count):
+        start = glyf_start + offsets[i]
+        end = glyf_start + (offsets[i + 1] if i < loca_count - 1 else glyf_len)
+        bits = BitReader(data, start * 8)
+        adv_w = bits.read(advance_width_bits) if advance_width_bits else default_advance_width
+        if advance_width_format == 0:
+            adv_w *= 16
+        ofs_x = bits.read_signed(xy_bits)
+        ofs_y = bits.read_signed(xy_bits)
+        box_w = bits.read(wh_bits)
+        box_h = bits.read(wh_bits)
+        bmp_size = end - start - nbits // 8
+        if i == 0:
+            adv_w = box_w = box_h = ofs_x = ofs_y = 0
+            bmp_size = 0
+        bitmap_index = len(bitmaps)
+        if bmp_size > 0:
+            if nbits % 8 == 0:
+                bitmaps += data[start + nbits // 8:end]
+            else:
+                # Same as the loader: the last byte carries only 8 - nbits % 8 bits, left aligned
+                for _ in range(bmp_size - 1):
+                    bitmaps.append(bits.read(8))
+                bitmaps.append((bits.read(8 - nbits % 8) << (nbits % 8)) & 0xFF)
+        glyphs.append((bitmap_index, adv_w, box_w, box_h, ofs_x, ofs_y))
+
+    return {
+        'line_height': ascent - descent,
+        'base_line': -descent,
+        'underline_position': underline_position,
+        'underline_thickness': underline_thickness,
+        'bpp': bits_per_pixel,
+        'bitmap_format': compression_id,
+        'subpx': subpixels_mode,
+        'cmaps': cmaps,
+        'glyphs': glyphs,
+        'bitmaps': bytes(bitmaps),
+    }
+
+
+def load_binfont(path):
+    """Returns (name, parsed font); exits with a message on errors"""
+    name = os.path.splitext(os.path.basename(path))[0]
+    if len(name.encode()) >= NAME_LEN:
+        sys.exit('%s: font name longer than %d bytes' % (path, NAME_LEN - 1))
+    with open(path, 'rb') as f:
+        data = f.read()
+    try:
+        return name, parse_binfont(data)
+    except (BinfontError, struct.error, IndexError) as e:
+        sys.exit('%s: %s' % (path, e))
+
+
+def pack_glyph(glyph, large):
+    bitmap_index, adv_w, box_w, box_h, ofs_x, ofs_y = glyph
+    if large:
+        return struct.pack('<IIHHhh', bitmap_index, adv_w, box_w, box_h, ofs_x, ofs_y)
+    if bitmap_index >= 1 << 20 or adv_w >= 1 << 12 or box_w > 255 or box_h > 255:
+        raise BinfontError('glyph exceeds the compact descriptor, use --large')
+    # uint32_t bitmap_index : 20; uint32_t adv_w : 12; uint8 box_w, box_h; int8 ofs_x, ofs_y
+    return struct.pack('<IBBbb', bitmap_index | (adv_w << 20), box_w, box_h, ofs_x, ofs_y)
+
+
+def align(buf, n):
+    while len(buf) % n:
+        buf.append(0)
+
+
+def pack_font(font, large):
+    """Serialize one font; offsets are relative to the font record"""
+    body = bytearray(FONT_RECORD.size)
+    align(body, 4)
+    cmaps_offset = len(body)
+    body += bytes(CMAP_RECORD.size * len(font['cmaps']))
+
+    cmap_records = []
+    for (range_start, range_length, glyph_id_start, ctype, list_length,
+         unicode_list, glyph_ids) in font['cmaps']:
+        list_offset = 0
+        if ctype in (CMAP_SPARSE_FULL, CMAP_SPARSE_TINY):
+            align(body, 2)
+            list_offset = len(body)
+            body += unicode_list + glyph_ids
+        elif ctype == CMAP_FORMAT0_FULL:
+            list_offset = len(body)
+            body += glyph_ids
+        cmap_records.append(CMAP_RECORD.pack(range_start, range_length, glyph_id_start,
+                                             list_offset, list_length, ctype, 0))
+    body[cmaps_offset:cmaps_offset + CMAP_RECORD.size * len(cmap_records)] = b''.join(cmap_records)
+
+    align(body, 4)
+    glyph_dsc_offset = len(body)
+    for glyph in font['glyphs']:
+        body += pack_glyph(glyph, large)
+    bitmap_offset = len(body)
+    body += font['bitmaps']
+    align(body, 4)
+
+    body[0:FONT_RECORD.size] = FONT_RECORD.pack(
+        font['line_height'], font['base_line'], font['underline_position'], font['underline_thickness'],
+        font['bpp'], font['bitmap_format'], font['subpx'], 0, len(font['cmaps']), font.get('fallback', 0),
+        len(font['glyphs']), cmaps_offset, glyph_dsc_offset, bitmap_offset)
+    return bytes(body)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('-o', '--output', required=True, help='assets image to write')
+    parser.add_argument('--large', action='store_true', help='CONFIG_LV_FONT_FMT_TXT_LARGE is enabled')
+    parser.add_argument('--max-size', type=lambda s: int(s, 0), default=0, help='fail if the image is larger')
+    parser.add_argument('fonts', nargs='+', help='binfont files')
+    args = parser.parse_args()
+
+    names = []
+    blobs = []
+    for path in args.fonts:
+        name, font = load_binfont(path)
+        names.append(name)
+        blobs.append(pack_font(font, args.large))
+
+    write_image(args.output, names, blobs, args.large, args.max_size)
+
+
+def write_image(path, names, blobs, large, max_size=0):
+    offset = HEADER.size + FONT_ENTRY.size * len(blobs)
+    table = bytearray()
+    for name, blob in zip(names, blobs):
+        table += FONT_ENTRY.pack(name.encode(), offset, len(blob))
+        offset += len(blob)
+
+    glyph_dsc_size = 16 if large else 8
+    image = HEADER.pack(MAGIC, VERSION, len(blobs), glyph_dsc_size, 0, offset) + table + b''.join(blobs)
+    if max_size and len(image) > max_size:
+        sys.exit('font assets image is %d bytes, partition holds %d' % (len(image), max_size))
+    with open(path, 'wb') as f:
+        f.write(image)
+    print('Packed %d fonts into %s (%d bytes)' % (len(blobs), path, len(image)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+"""
+Subset LVGL binfonts to the characters the assistant actually shows.
+
+The PuHui fonts carry a full CJK character set at every size, while replies
+only use a few thousand distinct characters. This tool keeps the observed
+characters in each font and leaves one font complete as the fallback for
+rare characters, then writes a font assets image (see pack_font_assets.py)
+in which every subset font falls back to it.
+
+Character usage comes from --usage files, which are either
+  - serial logs with char_usage dumps (CONFIG_FONT_MANAGER_CHAR_USAGE);
+    "U+4F60:37" tokens are read and only the last dump in each file counts
+  - plain UTF-8 text (a reply corpus), counted character by character
+and from --keep files (e.g. UI sources) whose characters are always kept.
+CJK punctuation, full-width forms and ASCII present in a font are always kept.
+
+Usage:
+    subset_fonts.py [--large] [--coverage 0.999] [--max-glyphs N]
+                    [--fallback font_puhui_14_1] --usage usage.log [--keep main.c]
+                    -o font_assets.bin font_puhui_14_1.bin font_puhui_16_4.bin ...
+
+Without --fallback the smallest input file is the fallback font.
+"""
+
+import argparse
+import collections
+import os
+import re
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import pack_font_assets as pack  # noqa: E402
+
+USAGE_BEGIN = 'char_usage begin'
+USAGE_TOKEN = re.compile(r'U\+([0-9A-Fa-f]{4,6}):(\d+)')
+ALWAYS_KEEP = [(0x20, 0x7E), (0x3000, 0x303F), (0xFF00, 0xFFEF)]
+
+# Runs of at least this many consecutive code points get their own dense
+# (FORMAT0_TINY) cmap; everything else goes into sparse tables. LVGL scans
+# cmaps linearly, so short runs are cheaper inside a binary-searched list.
+DENSE_RUN = 32
+SPARSE_SPAN = 0xFFFE
+
+
+def read_usage(path):
+    with open(path, encoding='utf-8', errors='replace') as f:
+        text = f.read()
+    counts = collections.Counter()
+    if USAGE_TOKEN.search(text):
+        for line in text.splitlines():
+            if USAGE_BEGIN in line:
+                counts.clear()      # Dumps are cumulative, keep the last one
+            for cp, n in USAGE_TOKEN.findall(line):
+                counts[int(cp, 16)] += int(n)
+    else:
+        counts.update(ord(c) for c in text if ord(c) > 0x7F)
+    return counts
+
+
+def read_keep(path):
+    with open(path, encoding='utf-8', errors='replace') as f:
+        return {ord(c) for c in f.read() if ord(c) > 0x7F}
+
+
+def glyph_map(font):
+    """Code point -> glyph id, decoded from the font's cmaps"""
+    cps = {}
+    for (range_start, range_length, glyph_id_start, ctype, list_length,
+         unicode_list, glyph_ids) in font['cmaps']:
+        if ctype == pack.CMAP_FORMAT0_TINY:
+            for i in range(range_length):
+                cps[range_start + i] = glyph_id_start + i
+        elif ctype == pack.CMAP_FORMAT0_FULL:
+            for i, ofs in enumerate(glyph_ids):
+                if i == 0 or ofs != 0:
+                    cps[range_start + i] = glyph_id_start + ofs
+        else:
+            offsets = struct.unpack('<%dH' % list_length, unicode_list)
+            ids = (struct.unpack('<%dH' % list_length, glyph_ids)
+                   if ctype == pack.CMAP_SPARSE_FULL else range(list_length))
+            for ofs, gid in zip(offsets, ids):
+                cps[range_start + ofs] = glyph_id_start + gid
+    return cps
+
+
+def choose(counts, keep, coverage, max_glyphs):
+    """Most used code points covering `coverage` of all uses, plus `keep`"""
+    chosen = set(keep)
+    total = sum(counts.values())
+    covered = 0
+    for cp, n in counts.most_common():
+        if total and covered >= coverage * total:
+            break
+        if max_glyphs and len(chosen) >= max_glyphs:
+            break
+        chosen.add(cp)
+        covered += n
+    return chosen
+
+
+def build_cmaps(cps):
+    """Cmaps for sorted code points mapped to glyph ids 1..len(cps)"""
+    runs = []
+    for cp in cps:
+        if runs and cp == runs[-1][-1] + 1:
+            runs[-1].append(cp)
+        else:
+            runs.append([cp])
+
+    cmaps = []
+    gid = 1
+    sparse = []
+
+    def flush_sparse():
+        nonlocal gid
+        if not sparse:
+            return
+        start = sparse[0]
+        cmaps.append((start, sparse[-1] - start + 1, gid, pack.CMAP_SPARSE_TINY, len(sparse),
+                      struct.pack('<%dH' % len(sparse), *(cp - start for cp in sparse)), b''))
+        gid += len(sparse)
+        sparse.clear()
+
+    for run in runs:
+        if len(run) >= DENSE_RUN:
+            flush_sparse()
+            cmaps.append((run[0], len(run), gid, pack.CMAP_FORMAT0_TINY, 0, b'', b''))
+            gid += len(run)
+            continue
+        for cp in run:
+            if sparse and cp - sparse[0] > SPARSE_SPAN:
+                flush_sparse()
+            sparse.append(cp)
+    flush_sparse()
+    return cmaps
+
+
+def subset_font(font, cps):
+    """Copy of a parsed font holding only the glyphs for `cps`"""
+    mapping = glyph_map(font)
+    cps = sorted(cp for cp in cps if cp in mapping)
+    glyphs = font['glyphs']
+    bitmaps = font['bitmaps']
+
+    new_glyphs = [glyphs[0]]
+    new_bitmaps = bytearray()
+    for cp in cps:
+        gid = mapping[cp]
+        bitmap_index, adv_w, box_w, box_h, ofs_x, ofs_y = glyphs[gid]
+        end = glyphs[gid + 1][0] if gid + 1 < len(glyphs) else len(bitmaps)
+        new_glyphs.append((len(new_bitmaps), adv_w, box_w, box_h, ofs_x, ofs_y))
+        new_bitmaps += bitmaps[bitmap_index:end]
+
+    subset = dict(font)
+    subset['glyphs'] = new_glyphs
+    subset['bitmaps'] = bytes(new_bitmaps)
+    subset['cmaps'] = build_cmaps(cps)
+    return subset
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('-o', '--output', required=True, help='assets image to write')
+    parser.add_argument('--large', action='store_true', help='CONFIG_LV_FONT_FMT_TXT_LARGE is enabled')
+    parser.add_argument('--max-size', type=lambda s: int(s, 0), default=0, help='fail if the image is larger')
+    parser.add_argument('--usage', action='append', default=[], help='usage log or text corpus')
+    parser.add_argument('--keep', action='append', default=[], help='file whose characters are always kept')
+    parser.add_argument('--coverage', type=float, default=1.0,
+                        help='fraction of observed character uses to cover (default: all)')
+    parser.add_argument('--max-glyphs', type=int, default=0, help='cap on kept characters per font')
+    parser.add_argument('--fallback', help='font kept complete for rare characters (default: smallest file)')
+    parser.add_argument('fonts', nargs='+', help='binfont files')
+    args = parser.parse_args()
+
+    counts = collections.Counter()
+    for path in args.usage:
+        counts.update(read_usage(path))
+    keep = set()
+    for path in args.keep:
+        keep |= read_keep(path)
+    for first, last in ALWAYS_KEEP:
+        keep.update(range(first, last + 1))
+    if not counts:
+        sys.exit('no character usage in %s' % ', '.join(args.usage) if args.usage else 'no --usage file given')
+
+    fallback_path = min(args.fonts, key=os.path.getsize)
+    if args.fallback:
+        matches = [p for p in args.fonts if os.path.splitext(os.path.basename(p))[0] == args.fallback]
+        if not matches:
+            sys.exit('fallback font %s is not among the inputs' % args.fallback)
+        fallback_path = matches[0]
+    fallback_index = args.fonts.index(fallback_path)
+    chosen = choose(counts, keep, args.coverage, args.max_glyphs)
+
+    names = []
+    blobs = []
+    full_size = 0
+    for i, path in enumerate(args.fonts):
+        name, font = pack.load_binfont(path)
+        full = pack.pack_font(font, args.large)
+        full_size += len(full)
+        if i == fallback_index:
+            blob = full
+            print('%-20s %6d glyphs %9d bytes  (fallback, complete)' % (name, len(font['glyphs']) - 1, len(blob)))
+        else:
+            subset = subset_font(font, chosen)
+            subset['fallback'] = fallback_index + 1
+            blob = pack.pack_font(subset, args.large)
+            print('%-20s %6d -> %5d glyphs %9d -> %8d bytes' % (
+                name, len(font['glyphs']) - 1, len(subset['glyphs']) - 1, len(full), len(blob)))
+        names.append(name)
+        blobs.append(blob)
+
+    used = sum(counts.values())
+    covered = sum(n for cp, n in counts.items() if cp in chosen)
+    print('Kept %d of %d observed characters, covering %.3f%% of %d uses; fonts %d -> %d bytes' % (
+        len(chosen & set(counts)), len(counts), 100.0 * covered / used, used,
+        full_size, sum(len(b) for b in blobs)))
+    pack.write_image(args.output, names, blobs, args.large, args.max_size)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,185 @@
+/**
+ * IMA-ADPCM 主机测试与基准
+ * 
+ * - 解码与按 IMA 标准 (IMA Recommended Practices, 1992) 的 vpdiff 写法独立实现的参考解码器
+ *   在随机半字节流上逐位一致 (含预测值饱和、步长索引两端夹紧)
+ * - 往返信噪比：440Hz 正弦 (-6dBFS)、近似语音 (140Hz 基频 12 次谐波 + 4Hz 幅度调制)、白噪声 (-12dBFS)
+ * - 分段编码 (每段 1000 个采样) 与分段解码 (每段 256 个采样，与 streaming_tts 播放时相同)
+ *   和一次处理的结果逐位一致；奇数长度只在最后一段出现
+ * - 编码和解码每微秒处理的采样数
+ * 
+ * 编译运行：
+ *   gcc -O2 -I.. ../ima_adpcm.c adpcm_bench.c -lm -o adpcm_bench && ./adpcm_bench
+ */
+
+#include "ima_adpcm.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SAMPLE_RATE     16000
+#define N               (10 * SAMPLE_RATE)
+#define ENCODE_CHUNK    1000
+#define DECODE_CHUNK    256     // 与 streaming_tts 的 PLAY_CHUNK_SIZE (512 字节) 相同
+#define RUNS            20
+
+static int16_t s_pcm[N];
+static int16_t s_out[N];
+static int16_t s_ref[N];
+static uint8_t s_code[IMA_ADPCM_BYTES(N)];
+static uint8_t s_code2[IMA_ADPCM_BYTES(N)];
+static int s_failures = 0;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        s_failures++;
+    }
+}
+
+/**
+ * 参考解码器 (标准文本中的写法，与 ima_adpcm.c 独立)
+ */
+static void ref_decode(const uint8_t *in, size_t samples, int16_t *pcm) {
+    static const int index_table[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+    static const int step_table[89] = {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+        50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+        337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707,
+        1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845,
+        8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+    };
+    int valpred = 0;
+    int index = 0;
+    for (size_t i = 0; i < samples; i++) {
+        int delta = (i & 1) ? in[i / 2] >> 4 : in[i / 2] & 0x0F;
+        int step = step_table[index];
+        int vpdiff = step >> 3;
+        if (delta & 4) {
+            vpdiff += step;
+        }
+        if (delta & 2) {
+            vpdiff += step >> 1;
+        }
+        if (delta & 1) {
+            vpdiff += step >> 2;
+        }
+        valpred += (delta & 8) ? -vpdiff : vpdiff;
+        valpred = valpred > 32767 ? 32767 : valpred < -32768 ? -32768 : valpred;
+        index += index_table[delta];
+        index = index < 0 ? 0 : index > 88 ? 88 : index;
+        pcm[i] = (int16_t)valpred;
+    }
+}
+
+static double snr_db(const int16_t *a, const int16_t *b, size_t n) {
+    double sig = 0;
+    double err = 0;
+    for (size_t i = 0; i < n; i++) {
+        double d = a[i] - b[i];
+        sig += (double)a[i] * a[i];
+        err += d * d;
+    }
+    return err > 0 ? 10 * log10(sig / err) : INFINITY;
+}
+
+static void make_signal(int kind) {
+    for (size_t i = 0; i < N; i++) {
+        double t = (double)i / SAMPLE_RATE;
+        double v = 0;
+        if (kind == 0) {
+            v = 0.5 * sin(2 * M_PI * 440 * t);
+        } else if (kind == 1) {
+            for (int h = 1; h <= 12; h++) {
+                v += sin(2 * M_PI * 140 * h * t + h) / h;
+            }
+            v *= 0.25 * (0.6 + 0.4 * sin(2 * M_PI * 4 * t));
+        } else {
+            v = 0.25 * 1.7 * (rand() / (double)RAND_MAX * 2 - 1);
+        }
+        s_pcm[i] = (int16_t)(v * 32767);
+    }
+}
+
+int main(void) {
+    srand(1);
+    ima_adpcm_state_t enc;
+    ima_adpcm_state_t dec;
+    
+    // 随机半字节流 (大幅度跳变会碰到预测值饱和和索引上限)
+    for (size_t i = 0; i < sizeof(s_code); i++) {
+        s_code[i] = (uint8_t)rand();
+    }
+    ima_adpcm_init(&dec);
+    ima_adpcm_decode(&dec, s_code, N, s_out);
+    ref_decode(s_code, N, s_ref);
+    check(memcmp(s_out, s_ref, sizeof(s_out)) == 0, "decode differs from reference on random nibbles");
+    memset(s_code, 0x77, sizeof(s_code));
+    ima_adpcm_init(&dec);
+    ima_adpcm_decode(&dec, s_code, N, s_out);
+    ref_decode(s_code, N, s_ref);
+    check(memcmp(s_out, s_ref, sizeof(s_out)) == 0 && s_out[N - 1] == INT16_MAX,
+          "decode differs from reference at saturation");
+    printf("decode vs reference: %s\n\n", s_failures == 0 ? "bit-exact" : "DIFFERENT");
+    
+    static const char *const names[] = {"sine 440Hz -6dBFS", "speech-like", "white noise -12dBFS"};
+    printf("%-20s | %-8s | %-10s | chunked == one-shot\n", "signal", "SNR", "bytes");
+    for (int k = 0; k < 3; k++) {
+        make_signal(k);
+        
+        // 分段编码，最后一段为奇数长度
+        size_t n = N - 1;
+        size_t bytes = 0;
+        ima_adpcm_init(&enc);
+        for (size_t off = 0; off < n; off += ENCODE_CHUNK) {
+            bytes += ima_adpcm_encode(&enc, s_pcm + off, n - off < ENCODE_CHUNK ? n - off : ENCODE_CHUNK, s_code + off / 2);
+        }
+        ima_adpcm_init(&enc);
+        ima_adpcm_encode(&enc, s_pcm, n, s_code2);
+        bool same_enc = bytes == IMA_ADPCM_BYTES(n) && memcmp(s_code, s_code2, IMA_ADPCM_BYTES(n)) == 0;
+        
+        // 分段解码
+        ima_adpcm_init(&dec);
+        for (size_t off = 0; off < n; off += DECODE_CHUNK) {
+            ima_adpcm_decode(&dec, s_code + off / 2, n - off < DECODE_CHUNK ? n - off : DECODE_CHUNK, s_out + off);
+        }
+        ima_adpcm_init(&dec);
+        ima_adpcm_decode(&dec, s_code, n, s_ref);
+        bool same_dec = memcmp(s_out, s_ref, n * sizeof(int16_t)) == 0;
+        check(same_enc && same_dec, "chunked coding differs from one-shot");
+        
+        double snr = snr_db(s_pcm, s_out, n);
+        check(k == 2 || snr > 20, "round-trip SNR below 20 dB");
+        printf("%-20s | %5.1f dB | %zu -> %zu | %s\n", names[k], snr, n * sizeof(int16_t), bytes,
+               same_enc && same_dec ? "yes" : "NO");
+    }
+    
+    double best_dec = 1e18;
+    double best_enc = 1e18;
+    for (int r = 0; r < RUNS; r++) {
+        ima_adpcm_init(&enc);
+        double t0 = now_us();
+        ima_adpcm_encode(&enc, s_pcm, N, s_code);
+        double t1 = now_us();
+        ima_adpcm_init(&dec);
+        for (size_t off = 0; off < N; off += DECODE_CHUNK) {
+            ima_adpcm_decode(&dec, s_code + off / 2, DECODE_CHUNK, s_out + off);
+        }
+        double t2 = now_us();
+        best_enc = t1 - t0 < best_enc ? t1 - t0 : best_enc;
+        best_dec = t2 - t1 < best_dec ? t2 - t1 : best_dec;
+    }
+    printf("\nencode %.0f samples/us, decode (%d-sample chunks) %.0f samples/us (best of %d)\n",
+           N / best_enc, DECODE_CHUNK, N / best_dec, RUNS);
+    printf("%d failures\n", s_failures);
+    return s_failures == 0 ? 0 : 1;
+}
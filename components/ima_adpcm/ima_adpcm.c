@@ -0,0 +1,125 @@
+/**
+ * IMA-ADPCM 编解码实现
+ * 
+ * 按 IMA 标准算法实现，解码每个采样只有查表、移位和加法，
+ * 可直接在播放任务写输出流的循环里逐块解码。
+ */
+
+#include "ima_adpcm.h"
+
+static const int16_t s_step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t s_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+/**
+ * 由半字节重建采样并更新状态 (编码端和解码端共用，保证两端重建一致)
+ */
+static inline int32_t step_decode(int32_t *predictor, int32_t *index, uint8_t nibble) {
+    int32_t step = s_step_table[*index];
+    int32_t diff = step >> 3;
+    if (nibble & 4) {
+        diff += step;
+    }
+    if (nibble & 2) {
+        diff += step >> 1;
+    }
+    if (nibble & 1) {
+        diff += step >> 2;
+    }
+    int32_t p = (nibble & 8) ? *predictor - diff : *predictor + diff;
+    if (p > INT16_MAX) {
+        p = INT16_MAX;
+    } else if (p < INT16_MIN) {
+        p = INT16_MIN;
+    }
+    *predictor = p;
+    
+    int32_t i = *index + s_index_table[nibble];
+    if (i < 0) {
+        i = 0;
+    } else if (i > 88) {
+        i = 88;
+    }
+    *index = i;
+    return p;
+}
+
+static inline uint8_t step_encode(int32_t *predictor, int32_t *index, int16_t sample) {
+    int32_t step = s_step_table[*index];
+    int32_t diff = (int32_t)sample - *predictor;
+    uint8_t nibble = 0;
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    if (diff >= step) {
+        nibble |= 4;
+        diff -= step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 2;
+        diff -= step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 1;
+    }
+    step_decode(predictor, index, nibble);
+    return nibble;
+}
+
+void ima_adpcm_init(ima_adpcm_state_t *state) {
+    state->predictor = 0;
+    state->step_index = 0;
+}
+
+size_t ima_adpcm_encode(ima_adpcm_state_t *state, const int16_t *pcm, size_t samples, uint8_t *out) {
+    int32_t predictor = state->predictor;
+    int32_t index = state->step_index;
+    size_t pairs = samples / 2;
+    
+    for (size_t i = 0; i < pairs; i++) {
+        uint8_t lo = step_encode(&predictor, &index, pcm[2 * i]);
+        uint8_t hi = step_encode(&predictor, &index, pcm[2 * i + 1]);
+        out[i] = (uint8_t)(lo | (hi << 4));
+    }
+    if (samples & 1) {
+        out[pairs] = step_encode(&predictor, &index, pcm[samples - 1]);
+    }
+    
+    state->predictor = (int16_t)predictor;
+    state->step_index = (uint8_t)index;
+    return IMA_ADPCM_BYTES(samples);
+}
+
+void ima_adpcm_decode(ima_adpcm_state_t *state, const uint8_t *in, size_t samples, int16_t *pcm) {
+    int32_t predictor = state->predictor;
+    int32_t index = state->step_index;
+    size_t pairs = samples / 2;
+    
+    for (size_t i = 0; i < pairs; i++) {
+        uint8_t byte = in[i];
+        pcm[2 * i] = (int16_t)step_decode(&predictor, &index, byte & 0x0F);
+        pcm[2 * i + 1] = (int16_t)step_decode(&predictor, &index, byte >> 4);
+    }
+    if (samples & 1) {
+        pcm[samples - 1] = (int16_t)step_decode(&predictor, &index, in[pairs] & 0x0F);
+    }
+    
+    state->predictor = (int16_t)predictor;
+    state->step_index = (uint8_t)index;
+}
@@ -0,0 +1,74 @@
+/**
+ * IMA-ADPCM 编解码
+ * 
+ * 16 位 PCM 与 4 位 IMA-ADPCM 互转 (4:1)，用于在内存或 Flash 中缓存合成语音。
+ * 数据为连续的半字节流，不分块、不带块头：低半字节在前 (与 WAV IMA-ADPCM 相同)，
+ * 编解码状态由调用者保存，可分段连续处理。
+ * 不依赖 FreeRTOS，可在主机上编译。
+ */
+
+#ifndef IMA_ADPCM_H
+#define IMA_ADPCM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * samples 个采样编码后的字节数
+ */
+#define IMA_ADPCM_BYTES(samples)    (((samples) + 1) / 2)
+
+/**
+ * 一段字节数可容纳的采样数
+ */
+#define IMA_ADPCM_SAMPLES(bytes)    ((bytes) * 2)
+
+/**
+ * 编解码状态 (编码端和解码端各持有一份，从同一初始状态开始)
+ */
+typedef struct {
+    int16_t predictor;      ///< 上一个重建采样
+    uint8_t step_index;     ///< 量化步长表索引 (0-88)
+} ima_adpcm_state_t;
+
+/**
+ * 初始化编解码状态
+ * 
+ * @param state 状态
+ */
+void ima_adpcm_init(ima_adpcm_state_t *state);
+
+/**
+ * 编码
+ * 
+ * 分段编码时除最后一段外采样数应为偶数，奇数时最后一个字节的高半字节补 0。
+ * 
+ * @param state 编码状态 (输入输出)
+ * @param pcm 16 位 PCM 采样
+ * @param samples 采样数
+ * @param out 输出，至少 IMA_ADPCM_BYTES(samples) 字节
+ * @return 写入的字节数
+ */
+size_t ima_adpcm_encode(ima_adpcm_state_t *state, const int16_t *pcm, size_t samples, uint8_t *out);
+
+/**
+ * 解码
+ * 
+ * 分段解码时除最后一段外采样数应为偶数。
+ * 
+ * @param state 解码状态 (输入输出)
+ * @param in ADPCM 数据，至少 IMA_ADPCM_BYTES(samples) 字节
+ * @param samples 要解码的采样数
+ * @param pcm 输出 16 位 PCM 采样
+ */
+void ima_adpcm_decode(ima_adpcm_state_t *state, const uint8_t *in, size_t samples, int16_t *pcm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMA_ADPCM_H
@@ -0,0 +1,304 @@
+/**
+ * Mario AI 对话界面实现
+ */
+
+#include "mario_ui.h"
+#include "font_manager.h"
+#include "chat_view.h"
+#include "ui_bus.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+static const char *TAG = "MARIO_UI";
+
+// UI 总线目标：其他任务通过 ui_bus 投递更新，不直接持有 LVGL 锁
+enum {
+    UI_TARGET_STATUS = 0,
+};
+
+// 响应文本累积缓冲区（用于屏幕显示和 TTS 播报）
+#define RESPONSE_BUFFER_SIZE 4096
+#define QUESTION_BUFFER_SIZE 512
+#define OVERFLOW_BUFFER_SIZE 2048   // 超出响应缓冲区、只显示不播报的片段 (2 的幂)
+#define FEED_CHUNK_SIZE      1024   // LVGL 任务每次复制到对话历史的最大字节数
+#define FEED_FRAME_BUDGET    4      // 每帧最多追加的次数
+
+// 对话历史容量：超出后整轮淘汰最早的对话；有 PSRAM 时保存更多轮次
+#ifdef CONFIG_SPIRAM
+#define HISTORY_TEXT_SIZE (256 * 1024)
+#define HISTORY_MAX_LINES 8192
+#define HISTORY_MAX_TURNS 512
+#else
+#define HISTORY_TEXT_SIZE (16 * 1024)
+#define HISTORY_MAX_LINES 768
+#define HISTORY_MAX_TURNS 64
+#endif
+
+/**
+ * 一轮问答的文本
+ * 
+ * 相邻两轮交替使用两个缓冲区，LVGL 任务落后一轮时仍能读完上一轮。
+ */
+typedef struct {
+    char question[QUESTION_BUFFER_SIZE];
+    char response[RESPONSE_BUFFER_SIZE];
+    atomic_size_t response_len;     ///< 已发布的回复字节数，一轮之内只增不减
+    size_t overflow_start;          ///< 本轮溢出文本在溢出环中的起始位置
+    size_t overflow_end;            ///< 本轮溢出文本的结束位置 (下一轮开始时写入)
+} turn_text_t;
+
+/*
+ * 对话历史由 LVGL 任务每帧从下面的缓冲区拉取，回复任务只写缓冲区、从不等待渲染，
+ * 消息环满也不会丢失文本或轮次分隔：
+ * - s_seq 为轮次编号的两倍，准备下一轮 (改写两轮前的缓冲区) 期间为奇数
+ * - LVGL 任务先复制再检查 s_seq，所读缓冲区在复制期间被改写时放弃这次复制
+ */
+static turn_text_t s_turns[2];
+static atomic_uint s_seq;
+static uint32_t s_turn = 0;                 // 当前轮次 (回复任务)
+static bool s_overflowed = false;           // 本轮响应缓冲区已满 (回复任务)
+static char s_overflow[OVERFLOW_BUFFER_SIZE];
+static atomic_size_t s_overflow_head;       // 溢出环写入位置 (回复任务)
+static atomic_size_t s_overflow_tail;       // 溢出环读取位置 (LVGL 任务)
+
+// 以下仅 LVGL 任务访问
+static lv_obj_t *s_history_view = NULL;
+static lv_timer_t *s_feed_timer = NULL;
+static uint32_t s_shown_turn = 0;           // 正在显示的轮次
+static size_t s_shown_len = 0;              // 该轮已显示的回复字节数
+static char s_feed[FEED_CHUNK_SIZE + 1];
+
+/**
+ * 截断到不超过 max 字节，不拆开 UTF-8 字符
+ */
+static size_t utf8_cut(const char *text, size_t len, size_t max) {
+    if (len <= max) {
+        return len;
+    }
+    size_t n = max;
+    while (n > 0 && ((uint8_t)text[n] & 0xC0) == 0x80) {
+        n--;
+    }
+    return n;
+}
+
+/**
+ * 复制之后检查第 turn 轮的缓冲区是否仍未被改写
+ */
+static bool turn_intact(uint32_t turn) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&s_seq, memory_order_relaxed) <= 2 * turn + 2;
+}
+
+/**
+ * 从溢出环复制 [pos, pos + len) 到 s_feed
+ */
+static void copy_overflow(size_t pos, size_t len) {
+    size_t at = pos & (OVERFLOW_BUFFER_SIZE - 1);
+    size_t first = OVERFLOW_BUFFER_SIZE - at < len ? OVERFLOW_BUFFER_SIZE - at : len;
+    memcpy(s_feed, s_overflow + at, first);
+    memcpy(s_feed + first, s_overflow, len - first);
+}
+
+/**
+ * 在对话历史中开始第 turn 轮：用户的提问，随后的回复属于智能体的一轮
+ * 
+ * @return false 该轮的缓冲区已被改写 (LVGL 任务落后了两轮以上)
+ */
+static bool show_question(uint32_t turn) {
+    const turn_text_t *t = &s_turns[turn & 1];
+    size_t len = strnlen(t->question, QUESTION_BUFFER_SIZE - 1);
+    memcpy(s_feed, t->question, len);
+    size_t start = t->overflow_start;
+    if (!turn_intact(turn)) {
+        return false;
+    }
+    chat_view_begin_turn(s_history_view, CHAT_ROLE_USER);
+    chat_view_append(s_history_view, s_feed, len);
+    chat_view_begin_turn(s_history_view, CHAT_ROLE_AGENT);
+    s_shown_turn = turn;
+    s_shown_len = 0;
+    atomic_store_explicit(&s_overflow_tail, start, memory_order_release);
+    return true;
+}
+
+/**
+ * 每帧在 LVGL 任务中把尚未显示的提问、轮次分隔和回复追加到对话历史
+ * 
+ * 依次显示：本轮回复缓冲区中的新文本、溢出环中的新文本；本轮已结束且都已显示时开始下一轮。
+ * 所读的轮次在复制期间被改写时，直接跳到最新一轮。
+ */
+static void feed_cb(lv_timer_t *timer) {
+    if (s_history_view == NULL) {
+        return;
+    }
+    for (int budget = FEED_FRAME_BUDGET; budget > 0; budget--) {
+        uint32_t latest = atomic_load_explicit(&s_seq, memory_order_acquire) / 2;
+        const turn_text_t *t = &s_turns[s_shown_turn & 1];
+        bool finished = s_shown_turn < latest;
+        
+        // 先读溢出环位置：看到溢出文本时，本轮回复缓冲区的长度已是最终值
+        size_t tail = atomic_load_explicit(&s_overflow_tail, memory_order_relaxed);
+        size_t end = finished ? t->overflow_end : atomic_load_explicit(&s_overflow_head, memory_order_acquire);
+        size_t len = atomic_load_explicit(&t->response_len, memory_order_acquire);
+        
+        size_t n = 0;
+        if (s_shown_len < len) {
+            n = utf8_cut(t->response + s_shown_len, len - s_shown_len, FEED_CHUNK_SIZE);
+            memcpy(s_feed, t->response + s_shown_len, n);
+        } else if (tail != end) {
+            n = end - tail > FEED_CHUNK_SIZE ? FEED_CHUNK_SIZE + 1 : end - tail;
+            copy_overflow(tail, n);
+            n = utf8_cut(s_feed, n, FEED_CHUNK_SIZE);
+        } else if (!finished) {
+            break;
+        } else {
+            if (!show_question(s_shown_turn + 1) && !show_question(latest)) {
+                break;
+            }
+            continue;
+        }
+        
+        if (!turn_intact(s_shown_turn)) {
+            if (!show_question(latest)) {
+                break;
+            }
+            continue;
+        }
+        chat_view_append(s_history_view, s_feed, n);
+        if (s_shown_len < len) {
+            s_shown_len += n;
+        } else {
+            atomic_store_explicit(&s_overflow_tail, tail + n, memory_order_release);
+        }
+    }
+}
+
+void mario_ui_create(lv_obj_t *scr) {
+    int32_t width = lv_display_get_horizontal_resolution(lv_obj_get_display(scr));
+    int32_t height = lv_display_get_vertical_resolution(lv_obj_get_display(scr));
+    
+    // 设置背景色为纯黑色
+    ESP_LOGI(TAG, "  - 设置背景色");
+    lv_obj_set_style_bg_color(scr, lv_color_hex(0x000000), LV_PART_MAIN);
+    
+    // 顶部标题 "百度智能体"
+    ESP_LOGI(TAG, "  - 创建顶部标题");
+    lv_obj_t *title_label = lv_label_create(scr);
+    lv_label_set_text(title_label, "百度智能体");
+    lv_obj_set_style_text_color(title_label, lv_color_white(), 0);
+    lv_obj_add_style(title_label, font_manager_get_style(16), 0);
+    lv_obj_align(title_label, LV_ALIGN_TOP_MID, 0, 5);
+    
+    // 对话历史（用户输入右对齐绿色，AI 响应左对齐白色，占据大部分空间）
+    ESP_LOGI(TAG, "  - 创建对话历史");
+    lv_obj_t *history_view = chat_view_create(scr, HISTORY_TEXT_SIZE, HISTORY_MAX_LINES, HISTORY_MAX_TURNS);
+    if (history_view != NULL) {
+        lv_obj_set_style_text_color(history_view, lv_color_white(), 0);
+        lv_obj_add_style(history_view, font_manager_get_style(14), 0);
+        lv_obj_set_size(history_view, width - 20, height - 56);  // 留出顶部和底部空间
+        lv_obj_align(history_view, LV_ALIGN_TOP_LEFT, 10, 30);
+        chat_view_set_role_style(history_view, CHAT_ROLE_USER, lv_color_hex(0x4CAF50), LV_TEXT_ALIGN_RIGHT);  // 绿色
+    }
+    
+    // 底部状态标签（右下角）
+    ESP_LOGI(TAG, "  - 创建状态标签");
+    lv_obj_t *status_label = lv_label_create(scr);
+    lv_label_set_text(status_label, "准备就绪");
+    lv_obj_set_style_text_color(status_label, lv_color_hex(0xFFD700), 0);  // 金色
+    lv_obj_add_style(status_label, font_manager_get_style(10), 0);
+    lv_obj_align(status_label, LV_ALIGN_BOTTOM_RIGHT, -5, -5);
+    
+    // 对话历史每帧从回复缓冲区拉取，状态经 UI 总线更新
+    s_history_view = history_view;
+    if (s_feed_timer == NULL) {
+        s_feed_timer = lv_timer_create(feed_cb, LV_DEF_REFR_PERIOD, NULL);
+        if (s_feed_timer == NULL) {
+            ESP_LOGE(TAG, "✗ 对话历史定时器创建失败");
+        }
+    }
+    ui_bus_bind(UI_TARGET_STATUS, status_label);
+    if (ui_bus_init(LV_DEF_REFR_PERIOD) != ESP_OK) {
+        ESP_LOGE(TAG, "✗ UI 总线初始化失败");
+    }
+    
+    // 强制刷新屏幕
+    lv_obj_invalidate(scr);
+    lv_refr_now(NULL);
+}
+
+void mario_ui_set_status(const char *text) {
+    ui_bus_set_text(UI_TARGET_STATUS, text);
+}
+
+void mario_ui_question(const char *question) {
+    size_t head = atomic_load_explicit(&s_overflow_head, memory_order_relaxed);
+    s_turns[s_turn & 1].overflow_end = head;
+    
+    // 改写两轮前的缓冲区作为新的一轮，期间 s_seq 为奇数
+    atomic_store_explicit(&s_seq, 2 * s_turn + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    turn_text_t *t = &s_turns[(s_turn + 1) & 1];
+    size_t len = utf8_cut(question, strlen(question), QUESTION_BUFFER_SIZE - 1);
+    memcpy(t->question, question, len);
+    t->question[len] = '\0';
+    t->response[0] = '\0';
+    atomic_store_explicit(&t->response_len, 0, memory_order_relaxed);
+    t->overflow_start = head;
+    s_turn++;
+    s_overflowed = false;
+    atomic_store_explicit(&s_seq, 2 * s_turn, memory_order_release);
+    
+    ui_bus_set_text(UI_TARGET_STATUS, "发送中...");
+}
+
+void mario_ui_reply_started(void) {
+    ui_bus_set_text(UI_TARGET_STATUS, "回答中...");
+}
+
+void mario_ui_reply_fragment(const char *text, size_t len) {
+    // 追加到响应缓冲区（用于显示和最终 TTS 播报），LVGL 任务在下一帧取走，这里从不等待渲染
+    turn_text_t *t = &s_turns[s_turn & 1];
+    size_t used = atomic_load_explicit(&t->response_len, memory_order_relaxed);
+    if (!s_overflowed && used + len < RESPONSE_BUFFER_SIZE - 1) {
+        memcpy(t->response + used, text, len);
+        t->response[used + len] = '\0';
+        atomic_store_explicit(&t->response_len, used + len, memory_order_release);
+        return;
+    }
+    
+    // 超出响应缓冲区的片段不再参与 TTS 播报，经溢出环只显示在对话历史中；
+    // 之后的片段也都走溢出环，保持显示顺序
+    s_overflowed = true;
+    size_t head = atomic_load_explicit(&s_overflow_head, memory_order_relaxed);
+    size_t space = OVERFLOW_BUFFER_SIZE - (head - atomic_load_explicit(&s_overflow_tail, memory_order_acquire));
+    size_t n = utf8_cut(text, len, space);
+    if (n < len) {
+        ESP_LOGW(TAG, "对话历史落后超过 %d 字节，丢弃 %d 字节", OVERFLOW_BUFFER_SIZE, (int)(len - n));
+    }
+    size_t at = head & (OVERFLOW_BUFFER_SIZE - 1);
+    size_t first = OVERFLOW_BUFFER_SIZE - at < n ? OVERFLOW_BUFFER_SIZE - at : n;
+    memcpy(s_overflow + at, text, first);
+    memcpy(s_overflow, text + first, n - first);
+    atomic_store_explicit(&s_overflow_head, head + n, memory_order_release);
+}
+
+const char *mario_ui_reply_finished(size_t *len) {
+    ui_bus_set_text(UI_TARGET_STATUS, "回答结束");
+    ui_bus_set_color(UI_TARGET_STATUS, 0xFFD700);
+    
+    const turn_text_t *t = &s_turns[s_turn & 1];
+    if (len != NULL) {
+        *len = atomic_load_explicit(&t->response_len, memory_order_relaxed);
+    }
+    return t->response;
+}
+
+void mario_ui_error(const char *message) {
+    char error_text[64];
+    snprintf(error_text, sizeof(error_text), "错误: %s", message);
+    ui_bus_set_text(UI_TARGET_STATUS, error_text);
+    ui_bus_set_color(UI_TARGET_STATUS, 0xFF0000);
+}
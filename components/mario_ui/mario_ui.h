@@ -0,0 +1,81 @@
+/**
+ * Mario AI 对话界面
+ * 
+ * 屏幕布局 (顶部标题、对话历史、右下角状态) 和一轮问答的显示逻辑：
+ * - 提问作为用户的一轮加入对话历史，回复片段流式追加到智能体的一轮
+ * - 回复累积在固定大小的缓冲区中，回答结束后整段交给 TTS 播报；超出缓冲区的片段只显示不播报
+ * - 对话历史由 LVGL 任务每帧从缓冲区拉取尚未显示的提问、轮次分隔和回复，不经过消息环，
+ *   回复任务从不等待渲染，也不会因消息环满而丢失文本
+ * 
+ * 除 mario_ui_create 外，所有接口都不需要持有 LVGL 锁 (状态栏经 ui_bus 投递)；
+ * 回复相关的接口须在同一个任务中调用 (智能体客户端的事件回调)。
+ * 界面只依赖 LVGL、font_manager、chat_view 和 ui_bus，主机基准 (host/) 在内存帧缓冲区上运行同一份代码。
+ */
+
+#ifndef MARIO_UI_H
+#define MARIO_UI_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 在屏幕上创建界面，绑定 UI 总线目标并开始每帧更新对话历史
+ * 
+ * 须在 font_manager_init 之后、持有 LVGL 锁时调用。
+ * 
+ * @param scr 屏幕对象，界面按它所在显示器的分辨率布局
+ */
+void mario_ui_create(lv_obj_t *scr);
+
+/**
+ * 设置状态文本 (保持当前颜色)
+ * 
+ * @param text 状态文本
+ */
+void mario_ui_set_status(const char *text);
+
+/**
+ * 开始一轮问答：清空回复缓冲区，把提问加入对话历史
+ * 
+ * @param question 用户输入
+ */
+void mario_ui_question(const char *question);
+
+/**
+ * 智能体开始回复
+ */
+void mario_ui_reply_started(void);
+
+/**
+ * 追加一个回复片段
+ * 
+ * @param text 片段 (UTF-8，不要求以 '\0' 结尾)
+ * @param len 字节数
+ */
+void mario_ui_reply_fragment(const char *text, size_t len);
+
+/**
+ * 回复结束：状态显示 "回答结束"
+ * 
+ * @param len 输出回复缓冲区中的字节数，可为 NULL
+ * @return 累积的回复 (以 '\0' 结尾)，用于 TTS 播报，下一次 mario_ui_question 前有效
+ */
+const char *mario_ui_reply_finished(size_t *len);
+
+/**
+ * 以红色在状态栏显示错误
+ * 
+ * @param message 错误信息
+ */
+void mario_ui_error(const char *message);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MARIO_UI_H
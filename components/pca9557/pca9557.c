@@ -0,0 +1,89 @@
+/**
+ * PCA9557 IO 扩展芯片驱动实现
+ */
+
+#include "pca9557.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "PCA9557";
+
+static i2c_master_dev_handle_t s_dev = NULL;
+static SemaphoreHandle_t s_lock = NULL;
+static uint8_t s_output;                // 输出寄存器的缓存
+
+static esp_err_t pca9557_write_reg(uint8_t reg, uint8_t data) {
+    uint8_t write_buf[2] = {reg, data};
+    return i2c_master_transmit(s_dev, write_buf, 2, -1);
+}
+
+esp_err_t pca9557_init(i2c_master_bus_handle_t bus, uint8_t output, uint8_t config) {
+    if (s_dev != NULL) {
+        return ESP_OK;
+    }
+    if (bus == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    i2c_device_config_t dev_cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = PCA9557_ADDR,
+        .scl_speed_hz = 100000,
+    };
+    esp_err_t ret = i2c_master_bus_add_device(bus, &dev_cfg, &s_dev);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add device: %s", esp_err_to_name(ret));
+        goto fail;
+    }
+    
+    ret = pca9557_write_reg(PCA9557_REG_OUTPUT, output);
+    s_output = output;
+    if (ret == ESP_OK) {
+        ret = pca9557_write_reg(PCA9557_REG_CONFIG, config);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure: %s", esp_err_to_name(ret));
+        i2c_master_bus_rm_device(s_dev);
+        goto fail;
+    }
+    
+    ESP_LOGI(TAG, "PCA9557 initialized (output=0x%02x, config=0x%02x)", output, config);
+    return ESP_OK;
+
+fail:
+    s_dev = NULL;
+    vSemaphoreDelete(s_lock);
+    s_lock = NULL;
+    return ret;
+}
+
+bool pca9557_is_ready(void) {
+    return s_dev != NULL;
+}
+
+esp_err_t pca9557_set_output(uint8_t pin, uint8_t level) {
+    if (s_dev == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (pin > 7) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    esp_err_t ret = ESP_OK;
+    uint8_t data = (s_output & ~(1 << pin)) | ((level ? 1 : 0) << pin);
+    if (data != s_output) {
+        ret = pca9557_write_reg(PCA9557_REG_OUTPUT, data);
+        if (ret == ESP_OK) {
+            s_output = data;
+        }
+    }
+    xSemaphoreGive(s_lock);
+    return ret;
+}
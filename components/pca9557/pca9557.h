@@ -0,0 +1,69 @@
+/**
+ * PCA9557 IO 扩展芯片驱动
+ * 
+ * 立创实战派 ESP32-S3 上 PCA9557 挂在 I2C_NUM_1，控制 LCD 片选和音频功放使能。
+ * 显示和音频两个子系统共用同一个芯片，由内部互斥锁串行化。
+ * 输出寄存器只由本驱动写入，因此在内存中缓存一份，改单个引脚只需一次 I2C 写。
+ */
+
+#ifndef PCA9557_H
+#define PCA9557_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/i2c_master.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PCA9557_ADDR            0x19
+
+// 寄存器地址
+#define PCA9557_REG_INPUT       0x00
+#define PCA9557_REG_OUTPUT      0x01
+#define PCA9557_REG_POLARITY    0x02
+#define PCA9557_REG_CONFIG      0x03
+
+// 立创实战派 ESP32-S3 引脚分配
+#define PCA9557_PIN_LCD_CS      0       ///< LCD 片选 (低有效)
+#define PCA9557_PIN_PA_EN       1       ///< 音频功放使能 (高有效)
+
+// 上电默认值：LCD 片选和功放使能为高，低 3 位为输出
+#define PCA9557_DEFAULT_OUTPUT  0x03
+#define PCA9557_DEFAULT_CONFIG  0xf8
+
+/**
+ * 初始化 PCA9557
+ * 
+ * 在总线上添加设备并写入初始输出电平和方向配置。重复调用直接返回 ESP_OK。
+ * 
+ * @param bus I2C 总线句柄
+ * @param output 初始输出寄存器值
+ * @param config 方向寄存器值 (1 为输入)
+ * @return ESP_OK 成功
+ */
+esp_err_t pca9557_init(i2c_master_bus_handle_t bus, uint8_t output, uint8_t config);
+
+/**
+ * 是否已初始化
+ */
+bool pca9557_is_ready(void);
+
+/**
+ * 设置单个输出引脚电平
+ * 
+ * 基于缓存的输出寄存器修改后整体写入，不读芯片；电平未变化时不访问总线。
+ * 
+ * @param pin 引脚编号 (0-7)
+ * @param level 电平 (0/1)
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t pca9557_set_output(uint8_t pin, uint8_t level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PCA9557_H
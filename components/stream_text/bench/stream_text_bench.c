@@ -0,0 +1,122 @@
+/**
+ * stream_text 主机基准
+ * 
+ * 按回复长度比较两种刷新方式每个片段的排版耗时和失效面积：
+ * - 整段：每个片段复制整个缓冲区、从头折行、失效整个控件 (lv_label_set_text 的行为)
+ * - 追加：stream_text_append，只折行最后一行、只失效脏区域
+ * 
+ * 字形宽度按 14px 字体近似 (汉字 14px，ASCII 7px)，控件尺寸与 main.c 中的回复区域一致。
+ * 帧时间 = 排版耗时 + 失效像素经 80MHz SPI 以 RGB565 发送的时间，不含光栅化。
+ * 
+ * 编译运行：
+ *   gcc -O2 -I.. ../stream_text.c stream_text_bench.c -o stream_text_bench && ./stream_text_bench
+ */
+
+#include "stream_text.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LABEL_W         300
+#define LABEL_H         160
+#define LINE_H          16
+#define TEXT_CAP        4096
+#define MAX_LINES       512
+#define SPI_BYTES_PER_US 10.0   // 80MHz SPI
+
+static int32_t measure(void *ctx, uint32_t letter, uint32_t next) {
+    return letter >= 0x80 ? 14 : 7;
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+ * 生成中英混合的回复，按 3 个汉字或一个英文单词切成片段 (与 SSE 片段粒度相近)
+ */
+static size_t make_answer(char *out, size_t len, size_t *frag_end, size_t *frag_count) {
+    static const char *const words[] = {"你好世界", "今天天气", "ESP32 ", "很好，", "LVGL ", "流式显示。", "\n"};
+    size_t pos = 0;
+    size_t n = 0;
+    unsigned seed = 1;
+    while (pos < len) {
+        seed = seed * 1103515245 + 12345;
+        const char *w = words[(seed >> 16) % (sizeof(words) / sizeof(words[0]) - (n % 20 ? 1 : 0))];
+        size_t wl = strlen(w);
+        if (pos + wl > len) {
+            break;
+        }
+        memcpy(out + pos, w, wl);
+        pos += wl;
+        frag_end[n++] = pos;
+    }
+    *frag_count = n;
+    return pos;
+}
+
+int main(void) {
+    static char answer[TEXT_CAP];
+    static size_t frag_end[TEXT_CAP];
+    static char buf[TEXT_CAP];
+    static char copy[TEXT_CAP];
+    static stream_text_line_t lines[MAX_LINES];
+    static const size_t sizes[] = {256, 512, 1024, 2048, 4000};
+    const int reps = 50;
+    
+    printf("%6s %6s | %10s %10s %10s | %10s %10s %10s\n", "bytes", "frags",
+           "full us", "full px", "full ms", "append us", "append px", "append ms");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t frags;
+        size_t len = make_answer(answer, sizes[s], frag_end, &frags);
+        stream_text_t st;
+        stream_text_area_t dirty[2];
+        
+        // 整段刷新
+        double t0 = now_us();
+        for (int r = 0; r < reps; r++) {
+            stream_text_init(&st, buf, sizeof(buf), lines, MAX_LINES, LABEL_W, LINE_H, measure, NULL);
+            for (size_t i = 0; i < frags; i++) {
+                memcpy(copy, answer, frag_end[i]);
+                st.len = frag_end[i];
+                memcpy(st.text, copy, st.len);
+                stream_text_relayout(&st, LABEL_W, LINE_H);
+            }
+        }
+        double full_us = (now_us() - t0) / reps / frags;
+        double full_px = (double)LABEL_W * LABEL_H;
+        
+        // 追加刷新：超过一屏后每新增一行整体重绘一次 (滚动)
+        uint64_t px = 0;
+        t0 = now_us();
+        for (int r = 0; r < reps; r++) {
+            stream_text_init(&st, buf, sizeof(buf), lines, MAX_LINES, LABEL_W, LINE_H, measure, NULL);
+            size_t prev = 0;
+            for (size_t i = 0; i < frags; i++) {
+                uint32_t before = st.line_count;
+                uint32_t count = stream_text_append(&st, answer + prev, frag_end[i] - prev, dirty);
+                prev = frag_end[i];
+                if (r != 0) {
+                    continue;
+                }
+                if (st.line_count != before && st.line_count > LABEL_H / LINE_H) {
+                    px += LABEL_W * LABEL_H;
+                    continue;
+                }
+                for (uint32_t k = 0; k < count; k++) {
+                    px += (uint64_t)(dirty[k].x2 - dirty[k].x1 + 1) * (dirty[k].y2 - dirty[k].y1 + 1);
+                }
+            }
+        }
+        double append_us = (now_us() - t0) / reps / frags;
+        double append_px = (double)px / frags;
+        
+        printf("%6zu %6zu | %10.2f %10.0f %10.2f | %10.2f %10.0f %10.2f\n", len, frags,
+               full_us, full_px, full_us / 1000 + full_px * 2 / SPI_BYTES_PER_US / 1000,
+               append_us, append_px, append_us / 1000 + append_px * 2 / SPI_BYTES_PER_US / 1000);
+    }
+    return 0;
+}
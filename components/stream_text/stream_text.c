@@ -0,0 +1,254 @@
+/**
+ * 流式文本排版实现
+ */
+
+#include "stream_text.h"
+#include <string.h>
+
+// 西文在这些字符之后可以换行 (与 LVGL 默认的 LV_TXT_BREAK_CHARS 一致)
+#define BREAK_CHARS " ,.;:-_)]}"
+
+/**
+ * 中日韩字符 (部首、标点、假名、汉字、全角符号)，前后均可换行
+ */
+static inline bool is_wide_char(uint32_t c) {
+    return c >= 0x2E80;
+}
+
+size_t stream_text_utf8_next(const char *text, size_t len, uint32_t *out) {
+    if (len == 0) {
+        *out = 0;
+        return 0;
+    }
+    
+    const uint8_t *s = (const uint8_t *)text;
+    size_t n;
+    uint32_t c;
+    if (s[0] < 0x80) {
+        *out = s[0];
+        return 1;
+    } else if ((s[0] & 0xE0) == 0xC0) {
+        n = 2;
+        c = s[0] & 0x1F;
+    } else if ((s[0] & 0xF0) == 0xE0) {
+        n = 3;
+        c = s[0] & 0x0F;
+    } else if ((s[0] & 0xF8) == 0xF0) {
+        n = 4;
+        c = s[0] & 0x07;
+    } else {
+        *out = s[0];
+        return 1;
+    }
+    if (n > len) {
+        *out = s[0];
+        return 1;
+    }
+    for (size_t i = 1; i < n; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *out = s[0];
+            return 1;
+        }
+        c = (c << 6) | (s[i] & 0x3F);
+    }
+    *out = c;
+    return n;
+}
+
+/**
+ * 开始新的一行，行缓存已满时返回 false
+ */
+static bool new_line(stream_text_t *st, uint32_t start) {
+    if (st->line_count >= st->max_lines) {
+        return false;
+    }
+    stream_text_line_t *line = &st->lines[st->line_count++];
+    line->start = start;
+    line->end = start;
+    line->width = 0;
+    return true;
+}
+
+/**
+ * 从第 index 行行首开始重新折行到文本末尾
+ * 
+ * 行缓存用尽时把文本截断到最后一行的末尾。
+ */
+static void wrap_from(stream_text_t *st, uint32_t index) {
+    st->line_count = index + 1;
+    stream_text_line_t *line = &st->lines[index];
+    uint32_t pos = line->start;
+    int32_t width = 0;
+    
+    // 最近的换行点：下一行从 brk 开始，本行到 brk_end 结束，宽度为 brk_width
+    uint32_t brk = 0;
+    uint32_t brk_end = 0;
+    int32_t brk_width = 0;
+    
+    while (pos < st->len) {
+        uint32_t c;
+        uint32_t next = 0;
+        size_t n = stream_text_utf8_next(st->text + pos, st->len - pos, &c);
+        stream_text_utf8_next(st->text + pos + n, st->len - pos - n, &next);
+        
+        if (c == '\n') {
+            line->end = pos;
+            line->width = width;
+            if (!new_line(st, pos + n)) {
+                st->len = pos;
+                break;
+            }
+            line = &st->lines[st->line_count - 1];
+            pos += n;
+            width = 0;
+            brk = 0;
+            continue;
+        }
+        if (c == '\r') {
+            pos += n;
+            continue;
+        }
+        
+        int32_t w = st->measure(st->ctx, c, next);
+        if (st->max_width > 0 && width + w > st->max_width && pos > line->start) {
+            uint32_t start;
+            if (c == ' ') {
+                // 行尾空格不占宽度，直接换到下一行
+                line->end = pos;
+                line->width = width;
+                start = pos + n;
+            } else if (brk > line->start) {
+                line->end = brk_end;
+                line->width = brk_width;
+                start = brk;
+            } else {
+                // 单词比一行长或刚好在汉字处溢出，从当前字符断开
+                line->end = pos;
+                line->width = width;
+                start = pos;
+            }
+            if (!new_line(st, start)) {
+                st->len = line->end;
+                width = line->width;
+                break;
+            }
+            line = &st->lines[st->line_count - 1];
+            pos = start;
+            width = 0;
+            brk = 0;
+            continue;
+        }
+        
+        if (is_wide_char(c) && pos > line->start) {
+            brk = pos;
+            brk_end = pos;
+            brk_width = width;
+        }
+        width += w;
+        pos += n;
+        if (c == ' ') {
+            brk = pos;
+            brk_end = pos - n;
+            brk_width = width - w;
+        } else if (is_wide_char(c) || (c < 0x80 && strchr(BREAK_CHARS, (int)c) != NULL)) {
+            brk = pos;
+            brk_end = pos;
+            brk_width = width;
+        }
+    }
+    
+    line->end = st->len > line->start ? st->len : line->start;
+    line->width = width;
+    st->text[st->len] = '\0';
+}
+
+void stream_text_init(stream_text_t *st, char *buf, size_t cap, stream_text_line_t *lines, uint32_t max_lines,
+                      int32_t max_width, int32_t line_height, stream_text_measure_fn measure, void *ctx) {
+    memset(st, 0, sizeof(*st));
+    st->text = buf;
+    st->cap = cap;
+    st->lines = lines;
+    st->max_lines = max_lines;
+    st->max_width = max_width;
+    st->line_height = line_height;
+    st->measure = measure;
+    st->ctx = ctx;
+    stream_text_clear(st);
+}
+
+void stream_text_clear(stream_text_t *st) {
+    st->len = 0;
+    st->text[0] = '\0';
+    st->line_count = 1;
+    st->lines[0].start = 0;
+    st->lines[0].end = 0;
+    st->lines[0].width = 0;
+}
+
+uint32_t stream_text_append(stream_text_t *st, const char *text, size_t len, stream_text_area_t dirty[2]) {
+    size_t room = st->cap - 1 - st->len;
+    if (len > room) {
+        // 截断到完整的 UTF-8 字符
+        len = room;
+        while (len > 0 && ((uint8_t)text[len] & 0xC0) == 0x80) {
+            len--;
+        }
+    }
+    if (len == 0) {
+        return 0;
+    }
+    
+    uint32_t last = st->line_count - 1;
+    int32_t old_width = st->lines[last].width;
+    memcpy(st->text + st->len, text, len);
+    st->len += len;
+    wrap_from(st, last);
+    
+    uint32_t count = 0;
+    int32_t new_width = st->lines[last].width;
+    if (new_width != old_width) {
+        // 最后一行只重绘变化的部分 (追加的字符，或被挤到下一行的单词)
+        int32_t x1 = old_width < new_width ? old_width : new_width;
+        int32_t x2 = old_width < new_width ? new_width : old_width;
+        dirty[count].x1 = x1;
+        dirty[count].y1 = (int32_t)last * st->line_height;
+        dirty[count].x2 = x2 - 1;
+        dirty[count].y2 = (int32_t)(last + 1) * st->line_height - 1;
+        count++;
+    }
+    if (st->line_count > last + 1) {
+        dirty[count].x1 = 0;
+        dirty[count].y1 = (int32_t)(last + 1) * st->line_height;
+        dirty[count].x2 = st->max_width - 1;
+        dirty[count].y2 = (int32_t)st->line_count * st->line_height - 1;
+        count++;
+    }
+    return count;
+}
+
+void stream_text_relayout(stream_text_t *st, int32_t max_width, int32_t line_height) {
+    st->max_width = max_width;
+    st->line_height = line_height;
+    st->lines[0].start = 0;
+    wrap_from(st, 0);
+}
+
+void stream_text_discard(stream_text_t *st, uint32_t lines) {
+    if (lines == 0 || lines >= st->line_count) {
+        return;
+    }
+    
+    uint32_t cut = st->lines[lines].start;
+    memmove(st->text, st->text + cut, st->len - cut + 1);
+    st->len -= cut;
+    st->line_count -= lines;
+    memmove(st->lines, st->lines + lines, st->line_count * sizeof(stream_text_line_t));
+    for (uint32_t i = 0; i < st->line_count; i++) {
+        st->lines[i].start -= cut;
+        st->lines[i].end -= cut;
+    }
+}
+
+int32_t stream_text_height(const stream_text_t *st) {
+    return (int32_t)st->line_count * st->line_height;
+}
@@ -0,0 +1,144 @@
+/**
+ * 流式文本排版
+ * 
+ * 智能体的回复逐片段到达，整段重新排版 (每个片段都从头测量、折行) 使每个片段的
+ * 代价与已有文本长度成正比，整段回复为 O(n²)。本模块只追加：
+ * - 文本追加到缓冲区末尾，已完成的行 (行首偏移和行宽) 保持缓存不变
+ * - 每次追加只从最后一行行首重新折行，代价与最后一行和新片段的长度成正比
+ * - 返回需要重绘的区域：最后一行的变化部分加上新产生的整行
+ * 
+ * 折行规则与 LVGL 相近：'\n' 强制换行，中日韩字符之间可随处换行，
+ * 西文单词在空格和标点处换行，单词长于一行时按字符断开。
+ * 
+ * 本模块不依赖 LVGL，字形宽度通过回调提供。
+ */
+
+#ifndef STREAM_TEXT_H
+#define STREAM_TEXT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 字形宽度回调
+ * 
+ * @param ctx 调用者上下文
+ * @param letter 当前字符 (Unicode)
+ * @param next 下一个字符 (用于字距调整，未知时为 0)
+ * @return 字形宽度 (像素，含字间距)
+ */
+typedef int32_t (*stream_text_measure_fn)(void *ctx, uint32_t letter, uint32_t next);
+
+/**
+ * 行缓存
+ */
+typedef struct {
+    uint32_t start;             ///< 行首在文本中的字节偏移
+    uint32_t end;               ///< 行尾字节偏移 (不含换行符和行尾空格)
+    int32_t width;              ///< 行宽 (像素)
+} stream_text_line_t;
+
+/**
+ * 重绘区域 (相对文本左上角，含边界)
+ */
+typedef struct {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+} stream_text_area_t;
+
+/**
+ * 排版状态
+ */
+typedef struct {
+    char *text;                 ///< 文本缓冲区 (以 '\0' 结尾)
+    size_t len;
+    size_t cap;                 ///< 缓冲区大小 (含结尾的 '\0')
+    stream_text_line_t *lines;  ///< 行缓存
+    uint32_t line_count;        ///< 行数 (至少为 1)
+    uint32_t max_lines;
+    int32_t max_width;          ///< 折行宽度
+    int32_t line_height;        ///< 行高 (含行距)
+    stream_text_measure_fn measure;
+    void *ctx;
+} stream_text_t;
+
+/**
+ * 初始化
+ * 
+ * @param st 排版状态
+ * @param buf 文本缓冲区
+ * @param cap 缓冲区大小
+ * @param lines 行缓存数组
+ * @param max_lines 行缓存容量，行数达到上限后不再追加
+ * @param max_width 折行宽度
+ * @param line_height 行高
+ * @param measure 字形宽度回调
+ * @param ctx 回调上下文
+ */
+void stream_text_init(stream_text_t *st, char *buf, size_t cap, stream_text_line_t *lines, uint32_t max_lines,
+                      int32_t max_width, int32_t line_height, stream_text_measure_fn measure, void *ctx);
+
+/**
+ * 清空文本
+ */
+void stream_text_clear(stream_text_t *st);
+
+/**
+ * 追加一段文本
+ * 
+ * 缓冲区或行缓存不足时截断到完整的 UTF-8 字符。
+ * 
+ * @param st 排版状态
+ * @param text 文本片段
+ * @param len 字节数
+ * @param dirty 输出需要重绘的区域，最多 2 个 (最后一行的变化部分、新增的整行)
+ * @return 重绘区域个数
+ */
+uint32_t stream_text_append(stream_text_t *st, const char *text, size_t len, stream_text_area_t dirty[2]);
+
+/**
+ * 折行宽度或字体变化后重新排版全部文本
+ * 
+ * @param st 排版状态
+ * @param max_width 新的折行宽度
+ * @param line_height 新的行高
+ */
+void stream_text_relayout(stream_text_t *st, int32_t max_width, int32_t line_height);
+
+/**
+ * 丢弃开头的若干行
+ * 
+ * 剩余文本移到缓冲区开头，行缓存的偏移随之前移，不重新折行。
+ * 
+ * @param st 排版状态
+ * @param lines 丢弃的行数，必须小于行数 (至少保留最后一行)
+ */
+void stream_text_discard(stream_text_t *st, uint32_t lines);
+
+/**
+ * 文本总高度
+ */
+int32_t stream_text_height(const stream_text_t *st);
+
+/**
+ * 从 UTF-8 文本中解码一个字符
+ * 
+ * @param text 文本
+ * @param len 剩余字节数
+ * @param out 输出字符
+ * @return 字符占用的字节数，len 为 0 时返回 0；非法字节按单字节处理
+ */
+size_t stream_text_utf8_next(const char *text, size_t len, uint32_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STREAM_TEXT_H
@@ -0,0 +1,275 @@
+/**
+ * 表单编码器主机基准
+ * 
+ * 把 form_encoder 的输出与改动前的做法 (url_encode 逐字节 sprintf 到堆缓冲区，再 snprintf
+ * 拼出整个请求体，原样取自 tts_service.c) 逐字节比较，并测量两者构建请求体的耗时：
+ * - 字段与 tts_service 的请求相同，tok 为 71 字节的 access_token
+ * - 文本：空串、ASCII、中文、全部 1-255 字节值、1 到 3000 字节的随机 UTF-8 串，
+ *   以及从长文本中间按 value_len 引用的分段 (即 tts_service 分段时的用法)
+ * - form_body_len 是否等于实际写出的字节数 (Content-Length)
+ * - 回调短写时 form_body_write 是否返回失败
+ * 旧的 streaming_tts 把请求体拼在 1024 字节的栈缓冲区里，超长时截断，一并统计。
+ * 
+ * 编译运行：
+ *   gcc -O2 -I.. ../form_encoder.c form_encoder_bench.c -o form_encoder_bench && ./form_encoder_bench
+ */
+
+#include "form_encoder.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_BODY        16384
+#define RANDOM_TEXTS    2000
+#define RUNS            20000
+
+#define TOKEN           "24.6f1d2c3b4a5e6d7c8b9a0f1e2d3c4b5a.2592000.1760000000.282335-12345678"
+
+static char s_out[MAX_BODY];
+static size_t s_out_len;
+static volatile size_t s_keep;          // 防止计时循环被优化掉
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+ * 改动前的 URL 编码 (tts_service.c / streaming_tts.c)
+ */
+static char *url_encode(const char *str) {
+    if (str == NULL) return NULL;
+    
+    size_t len = strlen(str);
+    // 最坏情况：每个字符都需要编码为 %XX (3倍)
+    char *encoded = malloc(len * 3 + 1);
+    if (encoded == NULL) return NULL;
+    
+    char *p = encoded;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)str[i];
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+            (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.' || c == '~') {
+            *p++ = c;
+        } else {
+            sprintf(p, "%%%02X", c);
+            p += 3;
+        }
+    }
+    *p = '\0';
+    return encoded;
+}
+
+/**
+ * 改动前 tts_service 构建请求体的步骤 (分段先 strndup)
+ * 
+ * @return 调用者释放的请求体，post_len 为 snprintf 的返回值
+ */
+static char *old_body(const char *text, size_t text_len, int *post_len) {
+    char *chunk = strndup(text, text_len);
+    char *encoded_text = url_encode(chunk);
+    free(chunk);
+    size_t post_data_size = strlen(encoded_text) + 512;
+    char *post_data = malloc(post_data_size);
+    *post_len = snprintf(post_data, post_data_size,
+             "tex=%s&tok=%s&cuid=esp32_tts&ctp=1&lan=zh&spd=5&pit=5&vol=10&per=0&aue=4",
+             encoded_text, TOKEN);
+    free(encoded_text);
+    return post_data;
+}
+
+static int sink_write(void *ctx, const char *data, int len) {
+    if (s_out_len + (size_t)len > sizeof(s_out)) {
+        return -1;
+    }
+    memcpy(s_out + s_out_len, data, (size_t)len);
+    s_out_len += (size_t)len;
+    return len;
+}
+
+/**
+ * 累计只接受 *ctx 字节的回调，之后短写
+ */
+static int short_write(void *ctx, const char *data, int len) {
+    size_t *left = (size_t *)ctx;
+    int n = (size_t)len > *left ? (int)*left : len;
+    *left -= (size_t)n;
+    return n;
+}
+
+static int null_write(void *ctx, const char *data, int len) {
+    *(size_t *)ctx += (size_t)len;
+    return len;
+}
+
+/**
+ * 与 tts_service 相同的字段
+ */
+static size_t make_fields(form_field_t *fields, const char *text, size_t text_len) {
+    const form_field_t f[] = {
+        {"tex", text, text_len},
+        {"tok", TOKEN, 0},
+        {"cuid", "esp32_tts", 0},
+        {"ctp", "1", 0},
+        {"lan", "zh", 0},
+        {"spd", "5", 0},
+        {"pit", "5", 0},
+        {"vol", "10", 0},
+        {"per", "0", 0},
+        {"aue", "4", 0},
+    };
+    memcpy(fields, f, sizeof(f));
+    return sizeof(f) / sizeof(f[0]);
+}
+
+/**
+ * 比较一段文本两种做法的请求体
+ * 
+ * value_len 为 0 时 form_encoder 按 strlen 计算，因此空串两种情况相同。
+ */
+static bool compare(const char *text, size_t text_len) {
+    form_field_t fields[10];
+    size_t count = make_fields(fields, text, text_len);
+    size_t body_len = form_body_len(fields, count);
+    s_out_len = 0;
+    bool written = form_body_write(fields, count, sink_write, NULL);
+    
+    int old_len = 0;
+    char *old = old_body(text, text_len, &old_len);
+    bool same = written && body_len == s_out_len && (size_t)old_len == s_out_len &&
+                memcmp(old, s_out, s_out_len) == 0;
+    free(old);
+    return same;
+}
+
+/**
+ * 随机 UTF-8 文本：ASCII 字母数字、标点、空格、换行、2/3/4 字节字符混合
+ */
+static size_t random_text(char *buf, size_t max) {
+    static const char *const pieces[] = {
+        "a", "Z", "7", " ", "\n", ",", ".", "-", "_", "~", "%", "&", "=", "+", "?", "/", "#",
+        "é", "ü", "，", "。", "！", "？", "、", "“", "”", "今", "天", "气", "很", "好", "😀",
+    };
+    size_t target = (size_t)(rand() % (int)max);
+    size_t n = 0;
+    for (;;) {
+        const char *p = pieces[rand() % (int)(sizeof(pieces) / sizeof(pieces[0]))];
+        size_t len = strlen(p);
+        if (n + len > target) {
+            break;
+        }
+        memcpy(buf + n, p, len);
+        n += len;
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+static size_t repeat_text(char *buf, size_t max, const char *unit) {
+    size_t unit_len = strlen(unit);
+    size_t n = 0;
+    while (n + unit_len <= max) {
+        memcpy(buf + n, unit, unit_len);
+        n += unit_len;
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+int main(void) {
+    static char text[4096];
+    size_t failures = 0;
+    size_t cases = 0;
+    
+    // 固定文本
+    const char *fixed[] = {
+        "",
+        "Hello, world! 1+1=2 & 50% off? a/b#c",
+        "今天天气很好，我们去公园散步吧。温度 25.5°C，湿度 60%。",
+    };
+    for (size_t i = 0; i < sizeof(fixed) / sizeof(fixed[0]); i++) {
+        cases++;
+        failures += !compare(fixed[i], strlen(fixed[i]));
+    }
+    for (int c = 1; c < 256; c++) {
+        text[c - 1] = (char)c;
+    }
+    text[255] = '\0';
+    cases++;
+    failures += !compare(text, 255);
+    
+    // 随机 UTF-8 文本
+    srand(32);
+    for (int i = 0; i < RANDOM_TEXTS; i++) {
+        size_t n = random_text(text, 3000);
+        cases++;
+        failures += !compare(text, n);
+    }
+    
+    // 分段：从长文本中间按长度引用，不以 '\0' 结尾
+    size_t long_len = repeat_text(text, 3000, "今天天气很好，我们去公园散步吧。Hello 2024! ");
+    size_t chunks = 0;
+    for (size_t off = 0; off + 1 < long_len; off += 97) {
+        size_t len = 1 + (off * 7) % 511;
+        if (off + len > long_len) {
+            len = long_len - off;
+        }
+        chunks++;
+        failures += !compare(text + off, len);
+    }
+    cases += chunks;
+    printf("byte-for-byte vs url_encode + snprintf: %zu / %zu bodies identical (incl. %zu length-bounded chunks)\n",
+           cases - failures, cases, chunks);
+    
+    // 短写
+    form_field_t fields[10];
+    size_t count = make_fields(fields, "今天天气很好", 0);
+    size_t left = form_body_len(fields, count) - 1;
+    bool short_ok = !form_body_write(fields, count, short_write, &left);
+    printf("short write reported as failure: %s\n", short_ok ? "yes" : "NO");
+    
+    // 旧的 streaming_tts 在 1023 字节处截断请求体
+    size_t truncated = 0;
+    srand(33);
+    for (int i = 0; i < RANDOM_TEXTS; i++) {
+        size_t n = random_text(text, 1000);
+        count = make_fields(fields, text, n);
+        size_t streaming_len = form_body_len(fields, count) + strlen("esp32_streaming_tts") - strlen("esp32_tts");
+        truncated += streaming_len > 1023;
+    }
+    printf("old streaming_tts 1024-byte body buffer would have cut %zu / %d random texts of < 1000 bytes\n",
+           truncated, RANDOM_TEXTS);
+    
+    // 耗时
+    printf("\ntext bytes | old url_encode + snprintf | form_encoder len + write (best of %d)\n", RUNS);
+    const size_t sizes[] = {48, 300, 1008};
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+        size_t n = repeat_text(text, sizes[k], "今天天气很好，我们去公园散步吧。");
+        count = make_fields(fields, text, n);
+        double best_old = 1e18;
+        double best_new = 1e18;
+        for (int r = 0; r < RUNS; r++) {
+            int post_len = 0;
+            double t0 = now_us();
+            char *old = old_body(text, n, &post_len);
+            double t1 = now_us();
+            size_t written = 0;
+            size_t body_len = form_body_len(fields, count);
+            form_body_write(fields, count, null_write, &written);
+            double t2 = now_us();
+            s_keep += (size_t)post_len + body_len + written + (uint8_t)old[0];
+            free(old);
+            if (t1 - t0 < best_old) {
+                best_old = t1 - t0;
+            }
+            if (t2 - t1 < best_new) {
+                best_new = t2 - t1;
+            }
+        }
+        printf("%10zu | %8.2f us               | %6.2f us (%.0fx faster)\n", n, best_old, best_new, best_old / best_new);
+    }
+    return failures == 0 && short_ok ? 0 : 1;
+}
@@ -0,0 +1,337 @@
+/**
+ * 对冲 TTS 请求主机基准
+ * 
+ * 在本机启动一个代替 tsn.baidu.com 的 HTTP 服务 (每个请求延迟 150-350ms，6% 的请求
+ * 额外延迟 1.5-4s)，按 streaming_tts 的对冲策略顺序发出请求，比较不对冲和对冲时
+ * 收到响应头的耗时分布：
+ * - 阈值：最近 32 次首包耗时的 P90，限制在 300-5000ms，样本不足 8 个时为 1500ms
+ * - 额度：每个请求积累 10，上限 200，一次对冲消耗 100
+ * - 先收到响应头的请求胜出，另一个请求在自己的线程中读完后关闭
+ * 策略常量与 streaming_tts.c 中的 HEDGE_* 保持一致。
+ * 
+ * 服务端延迟按 TIME_SCALE 缩短以加快运行，报告的耗时已换算回原始时间。
+ * 
+ * 编译运行：
+ *   gcc -O2 -pthread hedge_bench.c -o hedge_bench && ./hedge_bench
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define REQUESTS                300
+#define TIME_SCALE              0.25    // 服务端延迟和策略阈值的时间缩放
+
+#define HEDGE_WINDOW            32
+#define HEDGE_MIN_SAMPLES       8
+#define HEDGE_PERCENTILE        90
+#define HEDGE_DEFAULT_MS        1500
+#define HEDGE_MIN_MS            300
+#define HEDGE_MAX_MS            5000
+#define HEDGE_POLL_MS           20
+#define HEDGE_BUDGET_PER_REQUEST 10
+#define HEDGE_COST              100
+#define HEDGE_BUDGET_MAX        200
+
+#define RESPONSE_BYTES          2000
+
+static uint16_t s_port;
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;     // 保护所有槽
+static pthread_cond_t s_cond = PTHREAD_COND_INITIALIZER;       // 任一请求收到响应头或失败
+static pthread_mutex_t s_rand_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned s_seed;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static double rand_unit(void) {
+    pthread_mutex_lock(&s_rand_lock);
+    s_seed = s_seed * 1103515245 + 12345;
+    double r = ((s_seed >> 8) & 0xFFFFFF) / (double)0x1000000;
+    pthread_mutex_unlock(&s_rand_lock);
+    return r;
+}
+
+static void sleep_ms(double ms) {
+    struct timespec ts = {(time_t)(ms / 1000), (long)(((long long)(ms * 1e6)) % 1000000000LL)};
+    nanosleep(&ts, NULL);
+}
+
+// ---- 代替百度 TTS 的本地服务 ----
+
+static void *serve_conn(void *arg) {
+    int fd = (int)(intptr_t)arg;
+    char buf[2048];
+    size_t len = 0;
+    
+    // 读取请求头和请求体
+    char *body = NULL;
+    long content_len = 0;
+    while (len < sizeof(buf) - 1) {
+        ssize_t n = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (n <= 0) {
+            close(fd);
+            return NULL;
+        }
+        len += (size_t)n;
+        buf[len] = '\0';
+        if (body == NULL && (body = strstr(buf, "\r\n\r\n")) != NULL) {
+            body += 4;
+            const char *cl = strstr(buf, "Content-Length:");
+            content_len = cl != NULL ? strtol(cl + 15, NULL, 10) : 0;
+        }
+        if (body != NULL && (long)(buf + len - body) >= content_len) {
+            break;
+        }
+    }
+    
+    double delay = 150 + rand_unit() * 200;
+    if (rand_unit() < 0.06) {
+        delay += 1500 + rand_unit() * 2500;  // 延迟尖峰
+    }
+    sleep_ms(delay * TIME_SCALE);
+    
+    char head[128];
+    int n = snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nContent-Type: audio/basic\r\nContent-Length: %d\r\n\r\n",
+                     RESPONSE_BYTES);
+    static const char audio[RESPONSE_BYTES];
+    send(fd, head, (size_t)n, MSG_NOSIGNAL);
+    send(fd, audio, sizeof(audio), MSG_NOSIGNAL);
+    close(fd);
+    return NULL;
+}
+
+static void *server_thread(void *arg) {
+    int lfd = (int)(intptr_t)arg;
+    while (true) {
+        int fd = accept(lfd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+        pthread_t t;
+        pthread_create(&t, NULL, serve_conn, (void *)(intptr_t)fd);
+        pthread_detach(t);
+    }
+    return NULL;
+}
+
+static void start_server(void) {
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t alen = sizeof(addr);
+    if (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(lfd, 64) != 0) {
+        perror("listen");
+        exit(1);
+    }
+    getsockname(lfd, (struct sockaddr *)&addr, &alen);
+    s_port = ntohs(addr.sin_port);
+    pthread_t t;
+    pthread_create(&t, NULL, server_thread, (void *)(intptr_t)lfd);
+    pthread_detach(t);
+}
+
+// ---- 请求工作线程 (对应 tts_request_worker) ----
+
+typedef struct {
+    double start_ms;
+    double ttfb_ms;         // 收到响应头的耗时，< 0 表示尚未收到
+    bool failed;
+    int refs;               // 工作线程和发起者各持有一个引用
+} slot_t;
+
+static void slot_release(slot_t *slot) {
+    pthread_mutex_lock(&s_lock);
+    bool last = --slot->refs == 0;
+    pthread_mutex_unlock(&s_lock);
+    if (last) {
+        free(slot);
+    }
+}
+
+static void *request_worker(void *arg) {
+    slot_t *slot = (slot_t *)arg;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(s_port),
+                               .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    bool ok = connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+    
+    static const char body[] = "tex=%E4%BD%A0%E5%A5%BD&tok=x&cuid=esp32_streaming_tts&ctp=1&lan=zh&aue=4";
+    char req[256];
+    int n = snprintf(req, sizeof(req),
+                     "POST /text2audio HTTP/1.1\r\nHost: localhost\r\n"
+                     "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: %d\r\n\r\n%s",
+                     (int)strlen(body), body);
+    ok = ok && send(fd, req, (size_t)n, MSG_NOSIGNAL) == n;
+    
+    // 等待响应头
+    char buf[4096];
+    size_t len = 0;
+    bool headers = false;
+    while (ok && !headers && len < sizeof(buf) - 1) {
+        ssize_t r = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (r <= 0) {
+            ok = false;
+            break;
+        }
+        len += (size_t)r;
+        buf[len] = '\0';
+        headers = strstr(buf, "\r\n\r\n") != NULL;
+    }
+    
+    pthread_mutex_lock(&s_lock);
+    if (headers) {
+        slot->ttfb_ms = now_ms() - slot->start_ms;
+    } else {
+        slot->failed = true;
+    }
+    pthread_cond_broadcast(&s_cond);
+    pthread_mutex_unlock(&s_lock);
+    
+    // 读完响应体后关闭 (胜出的请求由播放任务读取，落败的请求自行关闭，这里不区分)
+    while (ok && recv(fd, buf, sizeof(buf), 0) > 0) {
+    }
+    close(fd);
+    slot_release(slot);
+    return NULL;
+}
+
+static slot_t *start_request(void) {
+    slot_t *slot = calloc(1, sizeof(slot_t));
+    slot->start_ms = now_ms();
+    slot->ttfb_ms = -1;
+    slot->refs = 2;
+    pthread_t t;
+    pthread_create(&t, NULL, request_worker, slot);
+    pthread_detach(t);
+    return slot;
+}
+
+// ---- 对冲策略 (对应 hedge_threshold_ms 和 tts_request_open_hedged) ----
+
+typedef struct {
+    uint16_t ttfb[HEDGE_WINDOW];
+    uint32_t head;
+    uint32_t count;
+    uint32_t budget;
+    uint32_t fired;
+    uint32_t won;
+} policy_t;
+
+static int cmp_u16(const void *a, const void *b) {
+    return (int)*(const uint16_t *)a - (int)*(const uint16_t *)b;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double d = *(const double *)a - *(const double *)b;
+    return (d > 0) - (d < 0);
+}
+
+static uint32_t threshold_ms(const policy_t *p) {
+    if (p->count < HEDGE_MIN_SAMPLES) {
+        return HEDGE_DEFAULT_MS;
+    }
+    uint16_t sorted[HEDGE_WINDOW];
+    memcpy(sorted, p->ttfb, p->count * sizeof(uint16_t));
+    qsort(sorted, p->count, sizeof(uint16_t), cmp_u16);
+    uint32_t t = sorted[(p->count * HEDGE_PERCENTILE) / 100];
+    return t < HEDGE_MIN_MS ? HEDGE_MIN_MS : t > HEDGE_MAX_MS ? HEDGE_MAX_MS : t;
+}
+
+static void record_ttfb(policy_t *p, double ms) {
+    p->ttfb[p->head] = ms > UINT16_MAX ? UINT16_MAX : (uint16_t)ms;
+    p->head = (p->head + 1) % HEDGE_WINDOW;
+    if (p->count < HEDGE_WINDOW) {
+        p->count++;
+    }
+}
+
+/**
+ * 发出一个请求，返回收到响应头的耗时 (原始时间，毫秒)
+ */
+static double hedged_request(policy_t *p, bool hedge) {
+    uint32_t threshold = threshold_ms(p);
+    p->budget += HEDGE_BUDGET_PER_REQUEST;
+    if (p->budget > HEDGE_BUDGET_MAX) {
+        p->budget = HEDGE_BUDGET_MAX;
+    }
+    
+    double start = now_ms();
+    slot_t *slots[2] = {start_request(), NULL};
+    slot_t *winner = NULL;
+    
+    pthread_mutex_lock(&s_lock);
+    while (winner == NULL) {
+        for (int i = 0; i < 2 && winner == NULL; i++) {
+            if (slots[i] != NULL && slots[i]->ttfb_ms >= 0) {
+                winner = slots[i];
+            }
+        }
+        if (winner != NULL) {
+            break;
+        }
+        if (slots[0]->failed && (slots[1] == NULL || slots[1]->failed)) {
+            break;
+        }
+        if (hedge && slots[1] == NULL && p->budget >= HEDGE_COST &&
+            (now_ms() - start) / TIME_SCALE >= threshold) {
+            slots[1] = start_request();
+            p->budget -= HEDGE_COST;
+            p->fired++;
+            continue;
+        }
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        long ns = ts.tv_nsec + (long)(HEDGE_POLL_MS * TIME_SCALE * 1e6);
+        ts.tv_sec += ns / 1000000000L;
+        ts.tv_nsec = ns % 1000000000L;
+        pthread_cond_timedwait(&s_cond, &s_lock, &ts);
+    }
+    double total = (now_ms() - start) / TIME_SCALE;
+    double ttfb = winner != NULL ? winner->ttfb_ms / TIME_SCALE : total;
+    if (winner != NULL && winner == slots[1]) {
+        p->won++;
+    }
+    pthread_mutex_unlock(&s_lock);
+    
+    record_ttfb(p, ttfb);
+    for (int i = 0; i < 2; i++) {
+        if (slots[i] != NULL) {
+            slot_release(slots[i]);
+        }
+    }
+    return total;
+}
+
+static void run(bool hedge) {
+    s_seed = 11;
+    policy_t policy = {0};
+    static double lat[REQUESTS];
+    for (int i = 0; i < REQUESTS; i++) {
+        lat[i] = hedged_request(&policy, hedge);
+    }
+    qsort(lat, REQUESTS, sizeof(double), cmp_double);
+    printf("%-8s | %5.0f %5.0f %5.0f %5.0f %5.0f | %5u %5u\n", hedge ? "hedged" : "baseline",
+           lat[REQUESTS / 2], lat[REQUESTS * 90 / 100], lat[REQUESTS * 95 / 100], lat[REQUESTS * 99 / 100],
+           lat[REQUESTS - 1], policy.fired, policy.won);
+}
+
+int main(void) {
+    start_server();
+    printf("%d sequential requests, server 150-350 ms + 6%% spikes of 1.5-4 s\n", REQUESTS);
+    printf("mode     |   p50   p90   p95   p99   max (ms) | fired   won\n");
+    run(false);
+    run(true);
+    return 0;
+}
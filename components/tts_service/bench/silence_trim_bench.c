@@ -0,0 +1,196 @@
+/**
+ * 句首尾静音裁剪主机基准
+ * 
+ * 按 streaming_tts 的参数 (门限 200，保留 40ms) 裁剪一句 TTS 输出并检查：
+ * - 裁掉的句首、句尾静音时长，保留部分起止处的电平 (句间直接拼接是否会有咔哒声)
+ * - 输入按 1/7/160/333/512 个采样分块时输出是否逐位一致 (512 即每次读取 HTTP 的 1024 字节)
+ * - 缓冲区只能容纳一半音频时，静音裁剪统计是否把截断的部分排除在外
+ * - 每秒音频的 CPU 耗时
+ * 
+ * 参数为录下的 TTS 输出 (16kHz 单声道 16 位小端 PCM，即百度 TTS aue=4 的响应体)；
+ * 不带参数时使用合成的句子：200ms 底噪 + 1.2s 谐波语音 (中间 80ms 停顿) + 250ms 底噪。
+ * 
+ * 编译运行：
+ *   gcc -O2 -I.. -I../../audio_dsp ../silence_trim.c ../../audio_dsp/audio_dsp.c silence_trim_bench.c -lm \
+ *       -o silence_trim_bench && ./silence_trim_bench [sentence.pcm]
+ */
+
+#include "silence_trim.h"
+#include "audio_dsp.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SAMPLE_RATE     16000
+#define THRESHOLD       200     // 与 SILENCE_THRESHOLD_DEFAULT 相同
+#define PAD_SAMPLES     640     // 与 SILENCE_PAD_MS_DEFAULT (40ms) 相同
+#define EDGE_SAMPLES    80      // 统计起止电平的长度 (5ms)
+#define RUNS            50
+
+/**
+ * 模拟 streaming_tts 的 ADPCM 缓冲区：写满后丢弃其余采样
+ */
+typedef struct {
+    int16_t *buf;
+    size_t samples;
+    size_t max_samples;
+} sink_t;
+
+static silence_trim_t s_trim;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void sink_write(void *ctx, const int16_t *pcm, size_t samples) {
+    sink_t *sink = (sink_t *)ctx;
+    if (samples > sink->max_samples - sink->samples) {
+        samples = sink->max_samples - sink->samples;
+    }
+    memcpy(sink->buf + sink->samples, pcm, samples * sizeof(int16_t));
+    sink->samples += samples;
+}
+
+/**
+ * 与 baidu_tts_synthesize 相同的读取循环和统计
+ * 
+ * @param trimmed 输出参数，计入 silence_trimmed_ms 的采样数
+ * @return 保留的采样数
+ */
+static size_t run(const int16_t *in, size_t n, size_t chunk, sink_t *sink, size_t *trimmed) {
+    sink->samples = 0;
+    silence_trim_init(&s_trim, THRESHOLD, PAD_SAMPLES, sink_write, sink);
+    for (size_t i = 0; i < n && sink->samples < sink->max_samples; i += chunk) {
+        silence_trim_push(&s_trim, in + i, n - i < chunk ? n - i : chunk);
+    }
+    size_t samples = silence_trim_finish(&s_trim);
+    size_t stored = s_trim.out_samples < sink->samples ? s_trim.out_samples : sink->samples;
+    if (samples > stored) {
+        samples = stored;
+    }
+    *trimmed = s_trim.in_samples - s_trim.out_samples + stored - samples;
+    return samples;
+}
+
+static int peak(const int16_t *x, size_t n) {
+    int p = 0;
+    for (size_t i = 0; i < n; i++) {
+        int v = abs(x[i]);
+        if (v > p) {
+            p = v;
+        }
+    }
+    return p;
+}
+
+static double ms(size_t samples) {
+    return samples * 1000.0 / SAMPLE_RATE;
+}
+
+static int16_t *synth_sentence(size_t *n) {
+    const size_t lead = SAMPLE_RATE / 5;
+    const size_t voice = SAMPLE_RATE * 6 / 5;
+    const size_t trail = SAMPLE_RATE / 4;
+    *n = lead + voice + trail;
+    int16_t *x = malloc(*n * sizeof(int16_t));
+    srand(3);
+    for (size_t i = 0; i < *n; i++) {
+        double v = rand() % 41 - 20;
+        size_t k = i - lead;
+        if (i >= lead && i < lead + voice && (k < voice / 2 || k >= voice / 2 + SAMPLE_RATE * 2 / 25)) {
+            double t = (double)k / SAMPLE_RATE;
+            double s = 0;
+            for (int h = 1; h <= 10; h++) {
+                s += sin(2 * M_PI * 130 * h * t) / h;
+            }
+            // 起止各 30ms 的包络，近似 TTS 的音节起落
+            double env = fmin(1.0, fmin(t, (double)voice / SAMPLE_RATE - t) / 0.03);
+            v += 8000 * s * env * (0.6 + 0.4 * sin(2 * M_PI * 3 * t));
+        }
+        x[i] = (int16_t)v;
+    }
+    return x;
+}
+
+static int16_t *load_pcm(const char *path, size_t *n) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    int16_t *x = malloc(size > 0 ? (size_t)size : 1);
+    *n = fread(x, sizeof(int16_t), (size_t)size / sizeof(int16_t), f);
+    fclose(f);
+    return x;
+}
+
+int main(int argc, char **argv) {
+    size_t n = 0;
+    int16_t *in = argc > 1 ? load_pcm(argv[1], &n) : synth_sentence(&n);
+    if (in == NULL || n < SAMPLE_RATE / 10) {
+        fprintf(stderr, "need at least 100ms of 16kHz s16le PCM\n");
+        return 1;
+    }
+    int16_t *out = malloc(n * sizeof(int16_t));
+    int16_t *ref = malloc(n * sizeof(int16_t));
+    sink_t sink = {.buf = ref, .max_samples = n};
+    size_t trimmed = 0;
+    
+    // 整句裁剪结果
+    size_t keep = run(in, n, 512, &sink, &trimmed);
+    size_t lead = s_trim.in_samples - s_trim.out_samples;
+    int full_peak = peak(in, n);
+    printf("%s: %.0f ms in, %.0f ms kept, %.0f ms trimmed (lead %.0f, trail %.0f)\n",
+           argc > 1 ? argv[1] : "synthetic", ms(n), ms(keep), ms(trimmed), ms(lead), ms(trimmed - lead));
+    if (keep >= 2 * EDGE_SAMPLES) {
+        printf("edge peak in first/last %d ms: %d / %d (sentence peak %d, %.1f / %.1f dB below)\n",
+               EDGE_SAMPLES * 1000 / SAMPLE_RATE, peak(ref, EDGE_SAMPLES), peak(ref + keep - EDGE_SAMPLES, EDGE_SAMPLES),
+               full_peak, 20 * log10((double)full_peak / (peak(ref, EDGE_SAMPLES) + 1)),
+               20 * log10((double)full_peak / (peak(ref + keep - EDGE_SAMPLES, EDGE_SAMPLES) + 1)));
+    }
+    
+    // 分块大小不影响输出
+    static const size_t chunks[] = {1, 7, 160, 333, 512};
+    bool ok = true;
+    for (size_t k = 0; k < sizeof(chunks) / sizeof(chunks[0]); k++) {
+        sink_t s = {.buf = out, .max_samples = n};
+        size_t t = 0;
+        size_t kk = run(in, n, chunks[k], &s, &t);
+        bool same = kk == keep && t == trimmed && memcmp(out, ref, keep * sizeof(int16_t)) == 0;
+        ok = ok && same;
+        printf("chunk %3zu: %s\n", chunks[k], same ? "identical" : "DIFFERENT");
+    }
+    
+    // 缓冲区只能存下一半：截断的部分不计入静音裁剪
+    sink_t half = {.buf = out, .max_samples = n / 2};
+    size_t t = 0;
+    size_t kh = run(in, n, 512, &half, &t);
+    size_t half_lead = s_trim.in_samples - s_trim.out_samples;
+    bool half_ok = kh == half.samples && t == half_lead;
+    ok = ok && half_ok;
+    printf("buffer %.0f ms: %.0f ms kept, %.0f ms counted as trimmed (lead %.0f) -> %s\n",
+           ms(half.max_samples), ms(kh), ms(t), ms(half_lead), half_ok ? "ok" : "WRONG");
+    
+    double best = 1e18;
+    for (int r = 0; r < RUNS; r++) {
+        sink_t s = {.buf = out, .max_samples = n};
+        double t0 = now_us();
+        run(in, n, 512, &s, &t);
+        double dt = now_us() - t0;
+        if (dt < best) {
+            best = dt;
+        }
+    }
+    printf("CPU per second of audio: %.1f us (best of %d)\n", best / ((double)n / SAMPLE_RATE), RUNS);
+    
+    free(in);
+    free(out);
+    free(ref);
+    return ok ? 0 : 1;
+}
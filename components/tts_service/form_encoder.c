@@ -0,0 +1,122 @@
+/**
+ * application/x-www-form-urlencoded 请求体编码器实现
+ */
+
+#include "form_encoder.h"
+#include <stdint.h>
+#include <string.h>
+
+// 每次回调写出的字节数：栈上缓冲区大小，需至少容纳一个 %XX
+#define FORM_WRITE_CHUNK 128
+
+// RFC 3986 非保留字符：A-Z a-z 0-9 - _ . ~ 原样输出，其余编码为 %XX
+// 表项为编码后的长度 (1 或 3)，长度计算和编码共用
+static const uint8_t s_encoded_len[256] = {
+#define X3 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3
+    X3, X3,                                             // 0x00-0x1f
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 1, 1, 3,     // 0x20-0x2f: '-' '.'
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 3, 3,     // 0x30-0x3f: 0-9
+    3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,     // 0x40-0x4f: A-O
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 1,     // 0x50-0x5f: P-Z '_'
+    3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,     // 0x60-0x6f: a-o
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 1, 3,     // 0x70-0x7f: p-z '~'
+    X3, X3, X3, X3, X3, X3, X3, X3,                     // 0x80-0xff: UTF-8 多字节
+#undef X3
+};
+
+static const char s_hex[16] = "0123456789ABCDEF";
+
+size_t form_encoded_len(const char *str, size_t len) {
+    const uint8_t *p = (const uint8_t *)str;
+    size_t total = 0;
+    for (size_t i = 0; i < len; i++) {
+        total += s_encoded_len[p[i]];
+    }
+    return total;
+}
+
+static size_t field_value_len(const form_field_t *field) {
+    return field->value_len > 0 ? field->value_len : strlen(field->value);
+}
+
+size_t form_body_len(const form_field_t *fields, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += (i > 0 ? 1 : 0) + strlen(fields[i].key) + 1;
+        total += form_encoded_len(fields[i].value, field_value_len(&fields[i]));
+    }
+    return total;
+}
+
+/**
+ * 带缓冲的写出器：攒满 FORM_WRITE_CHUNK 字节后调用一次回调
+ */
+typedef struct {
+    char buf[FORM_WRITE_CHUNK];
+    size_t used;
+    form_write_fn write;
+    void *ctx;
+    bool failed;
+} form_writer_t;
+
+static void writer_flush(form_writer_t *w) {
+    if (w->used > 0 && !w->failed) {
+        if (w->write(w->ctx, w->buf, (int)w->used) != (int)w->used) {
+            w->failed = true;
+        }
+    }
+    w->used = 0;
+}
+
+static void writer_raw(form_writer_t *w, const char *data, size_t len) {
+    while (len > 0 && !w->failed) {
+        size_t n = sizeof(w->buf) - w->used;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(w->buf + w->used, data, n);
+        w->used += n;
+        data += n;
+        len -= n;
+        if (w->used == sizeof(w->buf)) {
+            writer_flush(w);
+        }
+    }
+}
+
+static void writer_encoded(form_writer_t *w, const char *str, size_t len) {
+    const uint8_t *p = (const uint8_t *)str;
+    for (size_t i = 0; i < len && !w->failed; i++) {
+        if (w->used + 3 > sizeof(w->buf)) {
+            writer_flush(w);
+        }
+        uint8_t c = p[i];
+        if (s_encoded_len[c] == 1) {
+            w->buf[w->used++] = (char)c;
+        } else {
+            w->buf[w->used++] = '%';
+            w->buf[w->used++] = s_hex[c >> 4];
+            w->buf[w->used++] = s_hex[c & 0x0f];
+        }
+    }
+}
+
+bool form_body_write(const form_field_t *fields, size_t count, form_write_fn write, void *ctx) {
+    form_writer_t w = {
+        .used = 0,
+        .write = write,
+        .ctx = ctx,
+        .failed = false,
+    };
+    
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            writer_raw(&w, "&", 1);
+        }
+        writer_raw(&w, fields[i].key, strlen(fields[i].key));
+        writer_raw(&w, "=", 1);
+        writer_encoded(&w, fields[i].value, field_value_len(&fields[i]));
+    }
+    writer_flush(&w);
+    return !w.failed;
+}
@@ -0,0 +1,67 @@
+/**
+ * application/x-www-form-urlencoded 请求体编码器
+ * 
+ * 百度 TTS 的请求体由若干 key=value 字段组成，文本字段需要百分号编码。
+ * 编码器先单遍计算编码后的精确长度 (用作 Content-Length)，再查表逐字节编码，
+ * 经栈上小缓冲区直接写入 HTTP 请求流，不分配堆内存，也不限制文本长度。
+ * 
+ * 本模块不依赖 ESP-IDF，写入目标通过回调提供。
+ */
+
+#ifndef FORM_ENCODER_H
+#define FORM_ENCODER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 请求体字段
+ * 
+ * key 原样输出 (调用者保证只含非保留字符)，value 按 RFC 3986 非保留字符集编码。
+ */
+typedef struct {
+    const char *key;
+    const char *value;
+    size_t value_len;           ///< value 的字节数，0 表示按 strlen 计算
+} form_field_t;
+
+/**
+ * 写入回调
+ * 
+ * @param ctx 调用者上下文 (如 esp_http_client_handle_t)
+ * @param data 数据
+ * @param len 数据长度
+ * @return 实际写入的字节数，失败返回负数
+ */
+typedef int (*form_write_fn)(void *ctx, const char *data, int len);
+
+/**
+ * 计算一段字符串百分号编码后的长度
+ */
+size_t form_encoded_len(const char *str, size_t len);
+
+/**
+ * 计算整个请求体编码后的长度 ("k1=v1&k2=v2...")
+ */
+size_t form_body_len(const form_field_t *fields, size_t count);
+
+/**
+ * 编码请求体并通过回调写出
+ * 
+ * @param fields 字段数组
+ * @param count 字段数
+ * @param write 写入回调
+ * @param ctx 回调上下文
+ * @return 写入成功返回 true，回调失败或短写返回 false
+ */
+bool form_body_write(const form_field_t *fields, size_t count, form_write_fn write, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORM_ENCODER_H
@@ -0,0 +1,113 @@
+/**
+ * 句首尾静音裁剪实现
+ */
+
+#include "silence_trim.h"
+#include "audio_dsp.h"
+#include <string.h>
+
+void silence_trim_init(silence_trim_t *trim, uint16_t threshold, size_t pad_samples,
+                       silence_trim_emit_fn emit, void *ctx) {
+    if (pad_samples > SILENCE_TRIM_MAX_PAD_BLOCKS * SILENCE_TRIM_BLOCK_SAMPLES) {
+        pad_samples = SILENCE_TRIM_MAX_PAD_BLOCKS * SILENCE_TRIM_BLOCK_SAMPLES;
+    }
+    trim->threshold = threshold;
+    trim->pad = pad_samples & ~(size_t)1;
+    trim->emit = emit;
+    trim->ctx = ctx;
+    
+    trim->voiced = false;
+    trim->in_samples = 0;
+    trim->out_samples = 0;
+    trim->voiced_end = 0;
+    trim->block_len = 0;
+    trim->preroll_head = 0;
+    trim->preroll_count = 0;
+}
+
+static void emit(silence_trim_t *trim, const int16_t *pcm, size_t samples) {
+    trim->emit(trim->ctx, pcm, samples);
+    trim->out_samples += samples;
+}
+
+/**
+ * 输出句首暂存的静音，只保留最后 pad 个采样
+ */
+static void flush_preroll(silence_trim_t *trim) {
+    size_t stored = trim->preroll_count * SILENCE_TRIM_BLOCK_SAMPLES;
+    size_t skip = stored > trim->pad ? stored - trim->pad : 0;
+    size_t first = (trim->preroll_head + SILENCE_TRIM_MAX_PAD_BLOCKS - trim->preroll_count) % SILENCE_TRIM_MAX_PAD_BLOCKS;
+    
+    for (size_t i = 0; i < trim->preroll_count; i++) {
+        const int16_t *b = trim->preroll[(first + i) % SILENCE_TRIM_MAX_PAD_BLOCKS];
+        if (skip >= SILENCE_TRIM_BLOCK_SAMPLES) {
+            skip -= SILENCE_TRIM_BLOCK_SAMPLES;
+            continue;
+        }
+        emit(trim, b + skip, SILENCE_TRIM_BLOCK_SAMPLES - skip);
+        skip = 0;
+    }
+    trim->preroll_count = 0;
+}
+
+static void process_block(silence_trim_t *trim, const int16_t *pcm, size_t samples) {
+    bool loud = audio_dsp_abs_sum_s16(pcm, samples) > trim->threshold * (uint32_t)samples;
+    trim->in_samples += samples;
+    
+    if (!trim->voiced) {
+        if (!loud) {
+            // 句首静音：只暂存最近的若干块
+            if (trim->pad > 0 && samples == SILENCE_TRIM_BLOCK_SAMPLES) {
+                memcpy(trim->preroll[trim->preroll_head], pcm, samples * sizeof(int16_t));
+                trim->preroll_head = (trim->preroll_head + 1) % SILENCE_TRIM_MAX_PAD_BLOCKS;
+                if (trim->preroll_count < SILENCE_TRIM_MAX_PAD_BLOCKS) {
+                    trim->preroll_count++;
+                }
+            }
+            return;
+        }
+        trim->voiced = true;
+        flush_preroll(trim);
+    }
+    
+    emit(trim, pcm, samples);
+    if (loud) {
+        trim->voiced_end = trim->out_samples;
+    }
+}
+
+void silence_trim_push(silence_trim_t *trim, const int16_t *pcm, size_t samples) {
+    while (samples > 0) {
+        // 整块直接从输入处理，零碎部分先拼成一块
+        if (trim->block_len == 0 && samples >= SILENCE_TRIM_BLOCK_SAMPLES) {
+            process_block(trim, pcm, SILENCE_TRIM_BLOCK_SAMPLES);
+            pcm += SILENCE_TRIM_BLOCK_SAMPLES;
+            samples -= SILENCE_TRIM_BLOCK_SAMPLES;
+            continue;
+        }
+        size_t n = SILENCE_TRIM_BLOCK_SAMPLES - trim->block_len;
+        if (n > samples) {
+            n = samples;
+        }
+        memcpy(trim->block + trim->block_len, pcm, n * sizeof(int16_t));
+        trim->block_len += n;
+        pcm += n;
+        samples -= n;
+        if (trim->block_len == SILENCE_TRIM_BLOCK_SAMPLES) {
+            process_block(trim, trim->block, SILENCE_TRIM_BLOCK_SAMPLES);
+            trim->block_len = 0;
+        }
+    }
+}
+
+size_t silence_trim_finish(silence_trim_t *trim) {
+    if (trim->block_len > 0) {
+        process_block(trim, trim->block, trim->block_len);
+        trim->block_len = 0;
+    }
+    if (!trim->voiced) {
+        return 0;
+    }
+    size_t keep = trim->voiced_end + trim->pad;
+    return keep < trim->out_samples ? keep : trim->out_samples;
+}
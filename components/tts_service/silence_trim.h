@@ -0,0 +1,89 @@
+/**
+ * 句首尾静音裁剪
+ * 
+ * 百度 TTS 每段音频前后各有一两百毫秒静音，逐句合成时会在句间叠加成明显的空白。
+ * 裁剪器按 10ms 块计算平均幅度作为能量门限：第一个有声块之前的静音只保留
+ * 最后 pad 个采样，最后一个有声块之后的部分由调用者按返回的长度截断。
+ * 
+ * 以流的方式逐段输入，有声部分直接从输入转发给输出回调，只有句首静音需要暂存。
+ * 本模块不依赖 ESP-IDF。
+ */
+
+#ifndef SILENCE_TRIM_H
+#define SILENCE_TRIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SILENCE_TRIM_BLOCK_SAMPLES  160     ///< 门限判断的块长 (16kHz 下 10ms)
+#define SILENCE_TRIM_MAX_PAD_BLOCKS 8       ///< 句首最多保留的静音块数
+
+/**
+ * 输出回调
+ * 
+ * @param ctx 调用者上下文
+ * @param pcm 保留下来的采样
+ * @param samples 采样数 (除最后一次外均为偶数)
+ */
+typedef void (*silence_trim_emit_fn)(void *ctx, const int16_t *pcm, size_t samples);
+
+/**
+ * 裁剪器状态 (内含句首静音暂存区，约 3KB，不宜放在任务栈上)
+ */
+typedef struct {
+    uint32_t threshold;             ///< 块平均幅度门限
+    size_t pad;                     ///< 有声部分前后保留的采样数
+    silence_trim_emit_fn emit;
+    void *ctx;
+    
+    bool voiced;                    ///< 是否已遇到有声块
+    size_t in_samples;              ///< 已输入的采样数
+    size_t out_samples;             ///< 已输出的采样数
+    size_t voiced_end;              ///< 最后一个有声块在输出中的结束位置
+    
+    int16_t block[SILENCE_TRIM_BLOCK_SAMPLES];  ///< 不足一块的输入
+    size_t block_len;
+    int16_t preroll[SILENCE_TRIM_MAX_PAD_BLOCKS][SILENCE_TRIM_BLOCK_SAMPLES];  ///< 句首静音环形缓冲
+    size_t preroll_head;
+    size_t preroll_count;
+} silence_trim_t;
+
+/**
+ * 初始化裁剪器 (每句调用一次)
+ * 
+ * @param trim 裁剪器
+ * @param threshold 块平均幅度门限，低于此值视为静音
+ * @param pad_samples 有声部分前后保留的采样数 (向下取偶，上限 SILENCE_TRIM_MAX_PAD_BLOCKS 块)
+ * @param emit 输出回调
+ * @param ctx 回调上下文
+ */
+void silence_trim_init(silence_trim_t *trim, uint16_t threshold, size_t pad_samples,
+                       silence_trim_emit_fn emit, void *ctx);
+
+/**
+ * 输入一段采样
+ * 
+ * @param trim 裁剪器
+ * @param pcm 采样
+ * @param samples 采样数
+ */
+void silence_trim_push(silence_trim_t *trim, const int16_t *pcm, size_t samples);
+
+/**
+ * 结束输入
+ * 
+ * @param trim 裁剪器
+ * @return 应保留的输出采样数 (其后为句尾静音)，整句都是静音时返回 0
+ */
+size_t silence_trim_finish(silence_trim_t *trim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SILENCE_TRIM_H
@@ -6,19 +6,24 @@
  */
 
 #include "streaming_tts.h"
+#include "audio_output.h"
+#include "baidu_auth.h"
+#include "form_encoder.h"
+#include "ima_adpcm.h"
+#include "silence_trim.h"
+#include "tts_scheduler.h"
+#include "audio_dsp.h"
 #include "esp_log.h"
 #include "esp_http_client.h"
 #include "esp_crt_bundle.h"
-#include "esp_codec_dev.h"
-#include "esp_codec_dev_defaults.h"
 #include "esp_timer.h"
 #include "esp_heap_caps.h"
-#include "driver/i2s_std.h"
-#include "driver/i2c_master.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -31,25 +36,123 @@ static const char *TAG = "STREAMING_TTS";
 #define SENTENCE_MAX_LEN        512     // 单个句子最大长度
 #define SENTENCE_BUFFER_SIZE    512     // 分句缓冲区大小
 
+_Static_assert(SENTENCE_BUFFER_SIZE <= SENTENCE_MAX_LEN, "a full sentence buffer must fit in one sentence");
+
+// 推测性切分：缓冲文本迟迟等不到句末标点时按软断点提前切出
+#define SPECULATIVE_MIN_CHARS       6       // 推测性切出的句子最少字符数
+#define SPECULATIVE_TIMEOUT_MIN_MS  300     // 自适应超时下限
+#define SPECULATIVE_TIMEOUT_MAX_MS  1500    // 自适应超时上限
+#define SPECULATIVE_GAP_INIT_MS     600     // 切句间隔初始估计
+#define SPECULATIVE_GAP_MAX_MS      10000   // 超过此间隔视为新一轮对话，不计入平均
+
 // 音频配置
-#define SAMPLE_RATE             16000
-#define AUDIO_BUFFER_SIZE       (32 * 1024)  // 32KB 音频缓冲区
+#define SAMPLE_RATE             AUDIO_OUTPUT_SAMPLE_RATE
+#define AUDIO_BUFFER_SIZE       (32 * 1024)  // 32KB IMA-ADPCM 音频缓冲区 (约 4 秒)
+#define TTS_STREAM_BUFFER_SIZE  (8 * 1024)   // 语音流缓冲区 256ms
+#define EARCON_STREAM_BUFFER_SIZE (8 * 1024) // 提示音流缓冲区
+#define EARCON_FADE_IN_FRAMES   32      // 提示音起始淡入 2ms，避免咔哒声
+
+// 打断 (barge-in) 配置
+#define PLAY_CHUNK_SIZE         512     // 单次写入输出流的字节数 (16ms)，决定打断检测粒度
+#define HTTP_READ_CHUNK_SIZE    1024    // 单次读取 HTTP 响应的字节数
+#define STOP_ACK_TIMEOUT_MS     100     // 等待播放任务确认静音的最长时间
+
+// 句间静音裁剪 (保留的静音也让句子在低电平处起止，拼接处没有咔哒声)
+#define SILENCE_PAD_MS_DEFAULT      40      // 句首尾保留的静音
+#define SILENCE_THRESHOLD_DEFAULT   200     // 10ms 块平均幅度门限 (约 -44dBFS)
+
+// 积压时加速播放 (WSOLA，音调不变)，按句调整，每句最多变化约 0.05 倍
+#define RATE_BACKLOG_LOW        2       // 分句队列积压不超过此值时原速
+#define RATE_BACKLOG_HIGH       8       // 积压达到此值时最快
+#define RATE_MAX_Q8             333     // 最快 1.3 倍
+#define RATE_STEP_Q8            13
 
 // 百度 TTS API
-#define BAIDU_TOKEN_URL         "https://aip.baidubce.com/oauth/2.0/token"
 #define BAIDU_TTS_URL           "https://tsn.baidu.com/text2audio"
+#define TOKEN_WAIT_TIMEOUT_MS   15000   // 没有可用 token 时等待后台刷新的最长时间
 
-// ES8311 音频编解码器地址
-#define ES8311_ADDR             0x30
+// 对冲请求：首包超过近期 P90 仍未到达时在第二个连接上重发
+#define HEDGE_SLOTS             2       // 请求工作任务数 (主请求 + 对冲请求)
+#define HEDGE_WORKER_STACK      8192    // 工作任务在自己的栈上完成 TLS 握手
+#define HEDGE_WINDOW            32      // 首包耗时统计窗口
+#define HEDGE_MIN_SAMPLES       8       // 样本不足时使用默认阈值
+#define HEDGE_PERCENTILE        90
+#define HEDGE_DEFAULT_MS        1500
+#define HEDGE_MIN_MS            300
+#define HEDGE_MAX_MS            5000
+#define HEDGE_POLL_MS           20      // 等待首包期间检查打断的间隔
+#define HEDGE_BUDGET_PER_REQUEST 10     // 每个请求积累的对冲额度
+#define HEDGE_COST              100     // 一次对冲消耗的额度，即对冲率不超过 10%
+#define HEDGE_BUDGET_MAX        200     // 额度上限，允许短时间连续对冲两次
 
-// PCA9557 IO 扩展芯片
-#define PCA9557_ADDR            0x19
-#define PCA9557_REG_OUTPUT      0x01
+// 任务退出事件位：销毁时等待所有任务退出后才释放状态
+#define TASK_EXIT_SPLITTER      BIT0
+#define TASK_EXIT_PLAYER        BIT1
+#define TASK_EXIT_WORKER(i)     (BIT2 << (i))
 
 // 队列超时
-#define QUEUE_SEND_TIMEOUT_MS   5000
 #define QUEUE_RECV_TIMEOUT_MS   100
 
+/**
+ * 句子时钟：当前句子在语音输出流中的起点
+ * 
+ * 实际输出进度来自 audio_output 的流位置，这里只记录句子边界。
+ * 所有字段由 s_clock_lock 保护。
+ */
+typedef struct {
+    bool active;
+    uint32_t turn;
+    uint32_t sentence;
+    uint64_t sentence_start_frame;      // 句子开始时语音流的 frames_queued
+    size_t sentence_bytes;
+    uint16_t rate_q8;                   // 句子播放速率，输出帧换算回原始音频位置
+} audio_clock_t;
+
+/**
+ * 请求工作槽状态
+ */
+typedef enum {
+    TTS_REQ_IDLE = 0,           // 空闲，可分配
+    TTS_REQ_RUNNING,            // 工作任务正在建立连接、等待首包
+    TTS_REQ_READY,              // 已收到响应头，连接等待播放任务接管
+    TTS_REQ_FAILED,             // 请求失败，等待播放任务读取结果
+} tts_req_state_t;
+
+/**
+ * 请求工作槽
+ * 
+ * state、cancelled、client、result 由 s_hedge_lock 保护。被取消的请求由工作任务
+ * 在阻塞调用返回后自行关闭连接并把槽位置回空闲。
+ */
+typedef struct {
+    TaskHandle_t task;
+    uint8_t index;
+    tts_req_state_t state;
+    volatile bool cancelled;
+    esp_http_client_handle_t client;
+    esp_err_t result;
+    int64_t start_us;
+    uint32_t ttfb_ms;
+    char text[SENTENCE_MAX_LEN];
+    char token[BAIDU_AUTH_TOKEN_MAX_LEN];
+} tts_req_slot_t;
+
+/**
+ * 原始文本队列项：文本片段及其所属代次
+ */
+typedef struct {
+    uint32_t generation;
+    char text[RAW_TEXT_MAX_LEN];
+} raw_text_item_t;
+
+/**
+ * 分句队列项：句子及其所属代次
+ */
+typedef struct {
+    uint32_t generation;
+    char text[SENTENCE_MAX_LEN];
+} sentence_item_t;
+
 /**
  * 流式 TTS 内部状态结构体
  */
@@ -64,134 +167,111 @@ typedef struct {
     // 任务
     TaskHandle_t splitter_task;         // 分句任务
     TaskHandle_t player_task;           // TTS 播放任务
+    EventGroupHandle_t task_exit;       // 任务退出前置位 TASK_EXIT_*
     
     // 状态
     volatile bool stream_ended;         // 流是否结束
     volatile bool is_playing;           // 是否正在播放
     volatile bool should_stop;          // 停止标志
     volatile bool initialized;          // 是否已初始化
-
+    
     // 分句缓冲区
     char sentence_buffer[SENTENCE_BUFFER_SIZE];
     size_t buffer_pos;
     
-    // I2S 和音频编解码器
-    i2s_chan_handle_t i2s_tx_handle;
-    i2c_master_bus_handle_t i2c_bus;
-    i2c_master_dev_handle_t pca9557_dev;
+    // 推测性切分 (仅分句任务和 stop 访问)
+    int64_t pending_since_us;           // 缓冲区中最早未输出文本的到达时间，0 表示缓冲区为空
+    int64_t last_split_us;              // 上一次按标点切出句子的时间
+    uint32_t split_gap_ewma_ms;         // 按标点切句间隔的滑动平均
+    int64_t speculative_at_us;          // 尚未等到后续标点的推测性切分时间
     
-    // ESP Codec Dev
-    const audio_codec_data_if_t *data_if;
-    const audio_codec_ctrl_if_t *ctrl_if;
-    const audio_codec_gpio_if_t *gpio_if;
-    const audio_codec_if_t *codec_if;
-    esp_codec_dev_handle_t codec_dev;
+    // 音频输出
+    bool output_acquired;
+    audio_output_stream_t tts_stream;   // 语音
+    audio_output_stream_t earcon_stream; // 提示音
+    SemaphoreHandle_t earcon_lock;      // 提示音流只允许一个写入者
     
     // 百度 TTS
-    char *access_token;
-    int64_t token_expire_time;
+    bool auth_acquired;
     
-    // 音频缓冲区
+    // 对冲请求 (仅 config.hedge_requests 时创建)
+    tts_req_slot_t req_slots[HEDGE_SLOTS];
+    EventGroupHandle_t req_events;      // 每个槽一位，请求完成时置位
+    uint16_t ttfb_ms[HEDGE_WINDOW];     // 近期首包耗时
+    uint32_t ttfb_head;
+    uint32_t ttfb_count;
+    uint32_t hedge_budget;
+    
+    // 音频缓冲区 (IMA-ADPCM，合成结果边下载边裁剪静音、边压缩)
     uint8_t *audio_buffer;
     size_t audio_buffer_size;
-    
-    // PA 状态
-    bool pa_enabled;
-    
-    // 播放完成信号量
-    SemaphoreHandle_t play_done_sem;
-    volatile size_t pending_bytes;      // 待播放的字节数
+    silence_trim_t trim;
+    
+    // 积压时变速播放 (仅播放任务访问)
+    uint16_t rate_q8;
+    audio_dsp_wsola_t wsola;
+    int16_t stretch_buf[AUDIO_DSP_WSOLA_IN_CAP + AUDIO_DSP_WSOLA_FRAME];
+    
+    // 打断控制
+    volatile uint32_t generation;       // 每次 stop 递增，旧代次的结果一律丢弃
+    uint32_t split_generation;          // 分句缓冲区中文本所属的代次 (仅分句任务访问)
+    SemaphoreHandle_t stop_ack_sem;     // 播放任务完成淡出和 DMA 清空后释放
+    streaming_tts_stats_t stats;        // 运行统计
+    
+    // 音频时钟
+    audio_clock_t clock;
+    uint32_t clock_turn;                // 播放任务最近处理的代次
+    uint32_t clock_sentence;            // 该代次内已开始播放的句子数
 } streaming_tts_t;
 
 // 全局实例
 static streaming_tts_t *s_tts = NULL;
+static portMUX_TYPE s_clock_lock = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE s_hedge_lock = portMUX_INITIALIZER_UNLOCKED;
 
 // ============================================================================
 // 内部辅助函数声明
 // ============================================================================
 
-static esp_err_t init_i2c_devices(i2c_master_bus_handle_t external_i2c_bus);
-static esp_err_t init_es8311_codec(void);
-static esp_err_t enable_audio_pa(bool enable);
 static void splitter_task(void *arg);
 static void player_task(void *arg);
 static bool is_chinese_punctuation(const char *str, size_t *char_len);
-static size_t split_by_punctuation(const char *input, char *sentence_out, size_t sentence_max_len);
+static size_t append_sentence_buffer(const char *input, size_t input_len);
+static size_t split_by_punctuation(char *sentence_out, size_t sentence_max_len);
 static size_t flush_remaining_text(char *sentence_out, size_t sentence_max_len);
+static size_t speculative_split(char *sentence_out, size_t sentence_max_len);
 static size_t utf8_char_count(const char *str);
+static size_t utf8_floor(const char *str, size_t len);
 
 // ============================================================================
-// I2S 事件回调
+// 音频时钟
 // ============================================================================
 
 /**
- * I2S TX 发送完成回调
- * 
- * 当 DMA 缓冲区中的数据发送完成时触发。
- * 用于精确检测音频播放完成。
+ * 标记一个句子开始播放
  */
-static IRAM_ATTR bool i2s_tx_sent_callback(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx) {
-    BaseType_t high_task_wakeup = pdFALSE;
-    
-    if (s_tts != NULL && s_tts->play_done_sem != NULL) {
-        // 减少待播放字节数
-        if (s_tts->pending_bytes >= event->size) {
-            s_tts->pending_bytes -= event->size;
-        } else {
-            s_tts->pending_bytes = 0;
-        }
-        
-        // 当所有数据播放完成时，发送信号量
-        if (s_tts->pending_bytes == 0) {
-            xSemaphoreGiveFromISR(s_tts->play_done_sem, &high_task_wakeup);
-        }
-    }
-    
-    return high_task_wakeup == pdTRUE;
+static void audio_clock_begin_sentence(uint32_t turn, uint32_t sentence, size_t sentence_bytes, uint16_t rate_q8) {
+    audio_output_position_t pos;
+    audio_output_stream_get_position(s_tts->tts_stream, &pos);
+    
+    audio_clock_t *clock = &s_tts->clock;
+    portENTER_CRITICAL(&s_clock_lock);
+    clock->active = true;
+    clock->turn = turn;
+    clock->sentence = sentence;
+    clock->sentence_start_frame = pos.frames_queued;
+    clock->sentence_bytes = sentence_bytes;
+    clock->rate_q8 = rate_q8;
+    portEXIT_CRITICAL(&s_clock_lock);
 }
 
-// ============================================================================
-// PCA9557 IO 扩展芯片操作
-// ============================================================================
-
-static esp_err_t pca9557_write_reg(uint8_t reg, uint8_t data) {
-    if (s_tts == NULL || s_tts->pca9557_dev == NULL) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    uint8_t write_buf[2] = {reg, data};
-    return i2c_master_transmit(s_tts->pca9557_dev, write_buf, 2, -1);
-}
-
-static esp_err_t pca9557_read_reg(uint8_t reg, uint8_t *data) {
-    if (s_tts == NULL || s_tts->pca9557_dev == NULL) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    return i2c_master_transmit_receive(s_tts->pca9557_dev, &reg, 1, data, 1, -1);
-}
-
-static esp_err_t enable_audio_pa(bool enable) {
-    if (s_tts == NULL || s_tts->pca9557_dev == NULL) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    uint8_t data;
-    esp_err_t ret = pca9557_read_reg(PCA9557_REG_OUTPUT, &data);
-    if (ret != ESP_OK) {
-        return ret;
-    }
-    
-    if (enable) {
-        data |= (1 << 1);
-    } else {
-        data &= ~(1 << 1);
-    }
-    
-    ret = pca9557_write_reg(PCA9557_REG_OUTPUT, data);
-    if (ret == ESP_OK) {
-        s_tts->pa_enabled = enable;
-        ESP_LOGI(TAG, "Audio PA %s", enable ? "enabled" : "disabled");
-    }
-    return ret;
+/**
+ * 句子结束或被打断
+ */
+static void audio_clock_end_sentence(void) {
+    portENTER_CRITICAL(&s_clock_lock);
+    s_tts->clock.active = false;
+    portEXIT_CRITICAL(&s_clock_lock);
 }
 
 // ============================================================================
@@ -275,41 +355,59 @@ static size_t utf8_char_count(const char *str) {
     return count;
 }
 
+/**
+ * 把截断长度回退到 UTF-8 字符边界，不拆开多字节字符
+ * 
+ * @param str 字符串 (str[len] 可读)
+ * @param len 截断长度
+ * @return 不超过 len 的字符边界
+ */
+static size_t utf8_floor(const char *str, size_t len) {
+    while (len > 0 && ((unsigned char)str[len] & 0xC0) == 0x80) {
+        len--;
+    }
+    return len;
+}
+
+/**
+ * 把输入文本追加到分句缓冲区
+ * 
+ * 放不下时只追加能放下的部分，并退回到 UTF-8 字符边界，剩余部分由调用者腾出空间后再追加。
+ * 
+ * @param input 输入文本
+ * @param input_len 输入字节数
+ * @return 已追加的字节数
+ */
+static size_t append_sentence_buffer(const char *input, size_t input_len) {
+    size_t space = SENTENCE_BUFFER_SIZE - s_tts->buffer_pos - 1;
+    if (input_len > space) {
+        input_len = utf8_floor(input, space);
+    }
+    if (input_len > 0) {
+        memcpy(s_tts->sentence_buffer + s_tts->buffer_pos, input, input_len);
+        s_tts->buffer_pos += input_len;
+        s_tts->sentence_buffer[s_tts->buffer_pos] = '\0';
+    }
+    return input_len;
+}
+
 /**
  * 按中文标点符号分句
  * 
  * 从内部缓冲区中查找第一个中文标点符号，将标点前的内容（包含标点）作为一个句子输出。
  * 如果找到句子，会从内部缓冲区中移除该句子。
  * 
- * @param input 输入文本（追加到内部缓冲区）
  * @param sentence_out 输出句子缓冲区
  * @param sentence_max_len 输出缓冲区最大长度
  * @return 输出句子的字节长度，0 表示没有完整句子
  * 
  * Requirements: 2.2, 2.3, 2.4
  */
-static size_t split_by_punctuation(const char *input, char *sentence_out, size_t sentence_max_len) {
+static size_t split_by_punctuation(char *sentence_out, size_t sentence_max_len) {
     if (s_tts == NULL || sentence_out == NULL || sentence_max_len == 0) {
         return 0;
     }
     
-    // 追加输入文本到内部缓冲区
-    if (input != NULL && *input != '\0') {
-        size_t input_len = strlen(input);
-        size_t remaining = SENTENCE_BUFFER_SIZE - s_tts->buffer_pos - 1;
-        
-        if (input_len > remaining) {
-            input_len = remaining;
-            ESP_LOGW(TAG, "Sentence buffer overflow, truncating input");
-        }
-        
-        if (input_len > 0) {
-            memcpy(s_tts->sentence_buffer + s_tts->buffer_pos, input, input_len);
-            s_tts->buffer_pos += input_len;
-            s_tts->sentence_buffer[s_tts->buffer_pos] = '\0';
-        }
-    }
-    
     // 在缓冲区中查找中文标点
     const char *p = s_tts->sentence_buffer;
     size_t pos = 0;
@@ -339,7 +437,7 @@ static size_t split_by_punctuation(const char *input, char *sentence_out, size_t
             
             // 复制句子到输出缓冲区
             if (sentence_len >= sentence_max_len) {
-                sentence_len = sentence_max_len - 1;
+                sentence_len = utf8_floor(s_tts->sentence_buffer, sentence_max_len - 1);
             }
             memcpy(sentence_out, s_tts->sentence_buffer, sentence_len);
             sentence_out[sentence_len] = '\0';
@@ -406,7 +504,7 @@ static size_t flush_remaining_text(char *sentence_out, size_t sentence_max_len)
     // 复制剩余文本到输出缓冲区
     size_t len = s_tts->buffer_pos;
     if (len >= sentence_max_len) {
-        len = sentence_max_len - 1;
+        len = utf8_floor(s_tts->sentence_buffer, sentence_max_len - 1);
     }
     
     memcpy(sentence_out, s_tts->sentence_buffer, len);
@@ -420,236 +518,345 @@ static size_t flush_remaining_text(char *sentence_out, size_t sentence_max_len)
     return len;
 }
 
-// ============================================================================
-// I2C 设备初始化
-// ============================================================================
-
-static esp_err_t init_i2c_devices(i2c_master_bus_handle_t external_i2c_bus) {
-    if (external_i2c_bus != NULL) {
-        s_tts->i2c_bus = external_i2c_bus;
-    } else {
-        return ESP_OK;
-    }
-    
-    // 添加 PCA9557 设备
-    i2c_device_config_t pca9557_cfg = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address = PCA9557_ADDR,
-        .scl_speed_hz = 100000,
+/**
+ * 判断 str 处是否为软断点 (推测性切分时可接受的切点)
+ * 
+ * 空白、顿号、英文标点和右括号之后可以切，左括号之前可以切。
+ * 英文句点和逗号只在后面是空白 (或文本流已结束) 时才算，"3.14"、"v5.1"、"1,000"
+ * 在片段边界处 ("3." + "14") 也不会被切开。
+ * 
+ * @param str 当前字符
+ * @param char_len 输出字符字节数
+ * @param cut_before 输出 true 表示切点在该字符之前
+ * @return true 是软断点
+ */
+static bool is_soft_boundary(const char *str, size_t *char_len, bool *cut_before) {
+    if (*str == '.' || *str == ',') {
+        char next = str[1];
+        *char_len = 1;
+        *cut_before = false;
+        return next == ' ' || next == '\t' || next == '\n' || next == '\r' ||
+               (next == '\0' && s_tts->stream_ended);
+    }
+    
+    static const char *after[] = {
+        " ", "\t", "\n", ";", ":", "!", "?", ")", "]",
+        "\xE3\x80\x81",  // 、
+        "\xEF\xBC\x89",  // ）
+        "\xE3\x80\x91",  // 】
+        "\xE3\x80\x8D",  // 」
+        "\xE3\x80\x8B",  // 》
+    };
+    static const char *before[] = {
+        "(", "[",
+        "\xEF\xBC\x88",  // （
+        "\xE3\x80\x90",  // 【
+        "\xE3\x80\x8C",  // 「
+        "\xE3\x80\x8A",  // 《
     };
-    esp_err_t ret = i2c_master_bus_add_device(s_tts->i2c_bus, &pca9557_cfg, &s_tts->pca9557_dev);
-    if (ret != ESP_OK) {
-        s_tts->pca9557_dev = NULL;
-        ESP_LOGW(TAG, "PCA9557 not found, PA control disabled");
-    }
     
-    return ESP_OK;
+    for (size_t i = 0; i < sizeof(after) / sizeof(after[0]); i++) {
+        size_t len = strlen(after[i]);
+        if (strncmp(str, after[i], len) == 0) {
+            *char_len = len;
+            *cut_before = false;
+            return true;
+        }
+    }
+    for (size_t i = 0; i < sizeof(before) / sizeof(before[0]); i++) {
+        size_t len = strlen(before[i]);
+        if (strncmp(str, before[i], len) == 0) {
+            *char_len = len;
+            *cut_before = true;
+            return true;
+        }
+    }
+    return false;
 }
 
-// ============================================================================
-// ES8311 编解码器初始化
-// ============================================================================
-
-static esp_err_t init_es8311_codec(void) {
-    ESP_LOGI(TAG, "Initializing ES8311 codec...");
-    
-    // 创建 I2S 通道
-    i2s_chan_config_t chan_cfg = {
-        .id = I2S_NUM_0,
-        .role = I2S_ROLE_MASTER,
-        .dma_desc_num = 6,
-        .dma_frame_num = 240,
-        .auto_clear_after_cb = true,
-        .auto_clear_before_cb = false,
-        .intr_priority = 0,
-    };
-    
-    esp_err_t ret = i2s_new_channel(&chan_cfg, &s_tts->i2s_tx_handle, NULL);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create I2S channel");
-        return ret;
+/**
+ * 推测性切分 (超时仍未等到句末标点时调用)
+ * 
+ * 在缓冲区中找最靠后的软断点切出一句，保证句子不少于 SPECULATIVE_MIN_CHARS 个字符；
+ * 没有合适的软断点时输出整个缓冲区。
+ * 
+ * @param sentence_out 输出句子缓冲区
+ * @param sentence_max_len 输出缓冲区最大长度
+ * @return 输出句子的字节长度，0 表示缓冲区文本不足最小长度
+ */
+static size_t speculative_split(char *sentence_out, size_t sentence_max_len) {
+    if (s_tts == NULL || sentence_out == NULL || sentence_max_len == 0) {
+        return 0;
     }
-    
-    // 配置 I2S 标准模式
-    i2s_std_config_t std_cfg = {
-        .clk_cfg = {
-            .sample_rate_hz = SAMPLE_RATE,
-            .clk_src = I2S_CLK_SRC_DEFAULT,
-            .mclk_multiple = I2S_MCLK_MULTIPLE_256,
-        },
-        .slot_cfg = {
-            .data_bit_width = I2S_DATA_BIT_WIDTH_16BIT,
-            .slot_bit_width = I2S_SLOT_BIT_WIDTH_AUTO,
-            .slot_mode = I2S_SLOT_MODE_MONO,
-            .slot_mask = I2S_STD_SLOT_LEFT,
-            .ws_width = I2S_DATA_BIT_WIDTH_16BIT,
-            .ws_pol = false,
-            .bit_shift = true,
-        },
-        .gpio_cfg = {
-            .mclk = s_tts->config.i2s_mclk_pin,
-            .bclk = s_tts->config.i2s_bclk_pin,
-            .ws = s_tts->config.i2s_ws_pin,
-            .dout = s_tts->config.i2s_dout_pin,
-            .din = I2S_GPIO_UNUSED,
-            .invert_flags = {
-                .mclk_inv = false,
-                .bclk_inv = false,
-                .ws_inv = false,
-            },
-        },
-    };
-    
-    ret = i2s_channel_init_std_mode(s_tts->i2s_tx_handle, &std_cfg);
-    if (ret != ESP_OK) {
-        i2s_del_channel(s_tts->i2s_tx_handle);
-        return ret;
+    if (utf8_char_count(s_tts->sentence_buffer) < SPECULATIVE_MIN_CHARS) {
+        return 0;
     }
     
-    // 注册 I2S TX 发送完成回调
-    i2s_event_callbacks_t cbs = {
-        .on_recv = NULL,
-        .on_recv_q_ovf = NULL,
-        .on_sent = i2s_tx_sent_callback,
-        .on_send_q_ovf = NULL,
-    };
-    ret = i2s_channel_register_event_callback(s_tts->i2s_tx_handle, &cbs, NULL);
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to register I2S callback: %s", esp_err_to_name(ret));
-        // 继续执行，回调失败不影响基本功能
+    size_t cut = 0;
+    size_t chars = 0;
+    size_t pos = 0;
+    while (pos < s_tts->buffer_pos) {
+        const char *p = s_tts->sentence_buffer + pos;
+        size_t char_len = 0;
+        bool cut_before = false;
+        if (is_soft_boundary(p, &char_len, &cut_before)) {
+            size_t at = cut_before ? pos : pos + char_len;
+            size_t at_chars = cut_before ? chars : chars + 1;
+            if (at_chars >= SPECULATIVE_MIN_CHARS) {
+                cut = at;
+            }
+        } else {
+            unsigned char c = (unsigned char)*p;
+            char_len = 1;
+            if ((c & 0xE0) == 0xC0) {
+                char_len = 2;
+            } else if ((c & 0xF0) == 0xE0) {
+                char_len = 3;
+            } else if ((c & 0xF8) == 0xF0) {
+                char_len = 4;
+            }
+        }
+        pos += char_len;
+        chars++;
     }
-    
-    // 创建 I2S 数据接口
-    audio_codec_i2s_cfg_t i2s_cfg = {
-        .port = I2S_NUM_0,
-        .rx_handle = NULL,
-        .tx_handle = s_tts->i2s_tx_handle,
-    };
-    s_tts->data_if = audio_codec_new_i2s_data(&i2s_cfg);
-    if (s_tts->data_if == NULL) {
-        i2s_del_channel(s_tts->i2s_tx_handle);
-        return ESP_FAIL;
+    if (cut == 0) {
+        cut = s_tts->buffer_pos;
     }
     
-    // 创建 I2C 控制接口
-    audio_codec_i2c_cfg_t i2c_cfg = {
-        .port = I2C_NUM_1,
-        .addr = ES8311_ADDR,
-        .bus_handle = s_tts->i2c_bus,
-    };
-    s_tts->ctrl_if = audio_codec_new_i2c_ctrl(&i2c_cfg);
-    if (s_tts->ctrl_if == NULL) {
-        return ESP_FAIL;
+    size_t len = cut;
+    if (len >= sentence_max_len) {
+        len = utf8_floor(s_tts->sentence_buffer, sentence_max_len - 1);
     }
+    memcpy(sentence_out, s_tts->sentence_buffer, len);
+    sentence_out[len] = '\0';
     
-    // 创建 GPIO 接口
-    s_tts->gpio_if = audio_codec_new_gpio();
-    if (s_tts->gpio_if == NULL) {
-        return ESP_FAIL;
+    size_t remaining = s_tts->buffer_pos - len;
+    if (remaining > 0) {
+        memmove(s_tts->sentence_buffer, s_tts->sentence_buffer + len, remaining);
     }
+    s_tts->buffer_pos = remaining;
+    s_tts->sentence_buffer[s_tts->buffer_pos] = '\0';
     
-    // 创建 ES8311 编解码器
-    es8311_codec_cfg_t es8311_cfg = {
-        .ctrl_if = s_tts->ctrl_if,
-        .gpio_if = s_tts->gpio_if,
-        .codec_mode = ESP_CODEC_DEV_WORK_MODE_DAC,
-        .pa_pin = -1,
-        .use_mclk = true,
-        .hw_gain = {
-            .pa_voltage = 5.0,
-            .codec_dac_voltage = 3.3,
-        },
-    };
-    s_tts->codec_if = es8311_codec_new(&es8311_cfg);
-    if (s_tts->codec_if == NULL) {
-        return ESP_FAIL;
+    ESP_LOGD(TAG, "Speculative split (%zu bytes): %s", len, sentence_out);
+    return len;
+}
+
+/**
+ * 当前推测性切分超时
+ * 
+ * 以按标点切句的平均间隔为基准 (1.5 倍)；播放器仍有音频可播时
+ * 停顿不会被听到，超时加倍，尽量等到真正的句末。
+ */
+static uint32_t speculative_timeout_ms(void) {
+    uint32_t timeout = s_tts->split_gap_ewma_ms * 3 / 2;
+    if (s_tts->is_playing || uxQueueMessagesWaiting(s_tts->sentence_queue) > 0) {
+        timeout *= 2;
     }
-    
-    // 创建编解码器设备
-    esp_codec_dev_cfg_t dev_cfg = {
-        .dev_type = ESP_CODEC_DEV_TYPE_OUT,
-        .codec_if = s_tts->codec_if,
-        .data_if = s_tts->data_if,
-    };
-    s_tts->codec_dev = esp_codec_dev_new(&dev_cfg);
-    if (s_tts->codec_dev == NULL) {
-        return ESP_FAIL;
+    if (timeout < SPECULATIVE_TIMEOUT_MIN_MS) {
+        timeout = SPECULATIVE_TIMEOUT_MIN_MS;
+    } else if (timeout > SPECULATIVE_TIMEOUT_MAX_MS) {
+        timeout = SPECULATIVE_TIMEOUT_MAX_MS;
     }
-    
-    // 打开编解码器
-    esp_codec_dev_sample_info_t fs = {
-        .bits_per_sample = 16,
-        .channel = 1,
-        .channel_mask = 0,
-        .sample_rate = SAMPLE_RATE,
-        .mclk_multiple = 0,
-    };
-    ret = esp_codec_dev_open(s_tts->codec_dev, &fs);
-    if (ret != ESP_OK) {
-        return ret;
+    return timeout;
+}
+
+/**
+ * 记录一次按标点切出的句子，更新切句间隔和推测性切分节省的时间
+ * 
+ * 推测性切分之后的第一个句末标点 (或流结束) 就是不做推测时最早能合成的时刻，
+ * 两者之差即为这次推测性切分提前的首音时间。
+ */
+static void note_terminator_split(int64_t now_us) {
+    if (s_tts->last_split_us != 0) {
+        int64_t gap_ms = (now_us - s_tts->last_split_us) / 1000;
+        if (gap_ms > 0 && gap_ms < SPECULATIVE_GAP_MAX_MS) {
+            s_tts->split_gap_ewma_ms = (s_tts->split_gap_ewma_ms * 7 + (uint32_t)gap_ms) / 8;
+        }
     }
+    s_tts->last_split_us = now_us;
     
-    // 设置音量
-    esp_codec_dev_set_out_vol(s_tts->codec_dev, 80);
-    
-    ESP_LOGI(TAG, "ES8311 codec initialized");
-    return ESP_OK;
+    if (s_tts->speculative_at_us != 0) {
+        uint32_t saved_ms = (uint32_t)((now_us - s_tts->speculative_at_us) / 1000);
+        s_tts->stats.ttfa_saved_ms_total += saved_ms;
+        if (saved_ms > s_tts->stats.ttfa_saved_ms_max) {
+            s_tts->stats.ttfa_saved_ms_max = saved_ms;
+        }
+        s_tts->speculative_at_us = 0;
+    }
 }
 
-
 // ============================================================================
 // 分句任务
 // ============================================================================
 
+/**
+ * 将句子连同所属代次推入分句队列
+ * 
+ * 队列满时一直等待，不丢弃本轮的句子：积压本身会让播放任务加速 (最快 1.3 倍)，
+ * 分句任务阻塞后原始文本队列随之积压，推送文本的一方也随之等待。
+ * 切句期间或等待期间发生了 stop 的句子直接丢弃，不再占用合成请求。
+ */
+static void queue_sentence(const sentence_item_t *item) {
+    while (item->generation == s_tts->generation && !s_tts->should_stop) {
+        if (xQueueSend(s_tts->sentence_queue, item, pdMS_TO_TICKS(QUEUE_RECV_TIMEOUT_MS)) == pdTRUE) {
+            ESP_LOGD(TAG, "Sentence queued: %s", item->text);
+            // 合成期间打开功放，播放时无需等待其稳定
+            audio_output_pa_prewarm();
+            return;
+        }
+    }
+    s_tts->stats.stale_sentences_dropped++;
+    ESP_LOGD(TAG, "Dropping stale sentence: %s", item->text);
+}
+
+/**
+ * 分句缓冲区切换到新的代次
+ * 
+ * streaming_tts_stop 在其他任务中清空缓冲区，可能与正在进行的切句交错；
+ * 分句任务收到新代次的第一个片段时自行再清空一次，确保旧文本不会拼进新句子。
+ */
+static void splitter_begin_generation(uint32_t generation) {
+    s_tts->split_generation = generation;
+    s_tts->buffer_pos = 0;
+    s_tts->sentence_buffer[0] = '\0';
+    s_tts->pending_since_us = 0;
+    s_tts->last_split_us = 0;
+    s_tts->speculative_at_us = 0;
+}
+
 /**
  * 分句任务
  * 
  * 从原始文本队列读取文本，调用分句逻辑，将完整句子推入分句队列。
+ * 缓冲文本超过自适应超时仍没有句末标点时 (长列表、代码或智能体中途停顿)，
+ * 按软断点推测性切分，避免有文本却长时间无声。
  * 
  * Requirements: 2.1, 2.2, 2.3
  */
 static void splitter_task(void *arg) {
     ESP_LOGI(TAG, "Splitter task started");
     
-    char raw_text[RAW_TEXT_MAX_LEN];
-    char sentence[SENTENCE_MAX_LEN];
+    raw_text_item_t raw;
+    sentence_item_t item;
+    char *sentence = item.text;
     bool stream_end_processed = false;
     
     while (!s_tts->should_stop) {
+        // 缓冲区有文本时，等待时间不超过推测性切分的截止时间
+        TickType_t wait = pdMS_TO_TICKS(QUEUE_RECV_TIMEOUT_MS);
+        if (s_tts->pending_since_us != 0 && !s_tts->stream_ended) {
+            int64_t deadline_us = s_tts->pending_since_us + (int64_t)speculative_timeout_ms() * 1000;
+            int64_t left_ms = (deadline_us - esp_timer_get_time()) / 1000;
+            if (left_ms < QUEUE_RECV_TIMEOUT_MS) {
+                wait = left_ms > 0 ? pdMS_TO_TICKS(left_ms) : 0;
+            }
+        }
+        
         // 从原始文本队列读取 (Requirements 2.1)
-        if (xQueueReceive(s_tts->raw_text_queue, raw_text, pdMS_TO_TICKS(QUEUE_RECV_TIMEOUT_MS)) == pdTRUE) {
-            ESP_LOGD(TAG, "Received raw text: %s", raw_text);
+        if (xQueueReceive(s_tts->raw_text_queue, &raw, wait) == pdTRUE) {
+            ESP_LOGD(TAG, "Received raw text: %s", raw.text);
+            
+            // 旧代次的片段 (stop 之前已出队或迟到的推送) 直接丢弃
+            if (raw.generation != s_tts->generation) {
+                s_tts->stats.stale_fragments_dropped++;
+                continue;
+            }
+            if (raw.generation != s_tts->split_generation) {
+                splitter_begin_generation(raw.generation);
+            }
+            item.generation = raw.generation;
             
             // 调用分句逻辑，提取所有完整句子 (Requirements 2.2)
-            size_t len = split_by_punctuation(raw_text, sentence, SENTENCE_MAX_LEN);
-            while (len > 0) {
-                // 将句子推入分句队列
-                if (xQueueSend(s_tts->sentence_queue, sentence, pdMS_TO_TICKS(QUEUE_SEND_TIMEOUT_MS)) != pdTRUE) {
-                    ESP_LOGW(TAG, "Sentence queue full, timeout");
-                } else {
-                    ESP_LOGD(TAG, "Sentence queued: %s", sentence);
+            // 缓冲区放不下整个片段时先切出一句腾出空间，再追加剩余部分，不丢弃文本
+            bool split = false;
+            const char *input = raw.text;
+            size_t input_len = strlen(raw.text);
+            for (;;) {
+                size_t appended = append_sentence_buffer(input, input_len);
+                input += appended;
+                input_len -= appended;
+                
+                size_t len = split_by_punctuation(sentence, SENTENCE_MAX_LEN);
+                while (len > 0) {
+                    note_terminator_split(esp_timer_get_time());
+                    s_tts->stats.punctuation_splits++;
+                    queue_sentence(&item);
+                    split = true;
+                    
+                    // 继续提取下一个句子
+                    len = split_by_punctuation(sentence, SENTENCE_MAX_LEN);
+                }
+                if (input_len == 0) {
+                    break;
+                }
+                if (appended > 0) {
+                    continue;  // 切句可能已腾出空间
                 }
                 
-                // 继续提取下一个句子
-                len = split_by_punctuation(NULL, sentence, SENTENCE_MAX_LEN);
+                // 缓冲区已满且没有句末标点：按软断点切出一句，没有软断点时整体切出
+                len = speculative_split(sentence, SENTENCE_MAX_LEN);
+                if (len == 0) {
+                    len = s_tts->buffer_pos;
+                    memcpy(sentence, s_tts->sentence_buffer, len);
+                    sentence[len] = '\0';
+                    s_tts->buffer_pos = 0;
+                    s_tts->sentence_buffer[0] = '\0';
+                }
+                ESP_LOGD(TAG, "Sentence buffer full, split early: %s", sentence);
+                s_tts->stats.overflow_splits++;
+                queue_sentence(&item);
+                split = true;
+            }
+            
+            // 剩余文本从现在起重新计时
+            if (s_tts->buffer_pos == 0) {
+                s_tts->pending_since_us = 0;
+            } else if (split || s_tts->pending_since_us == 0) {
+                s_tts->pending_since_us = esp_timer_get_time();
             }
             
             // 重置流结束处理标志（有新数据进来）
             stream_end_processed = false;
         }
         
+        // 超时仍没有句末标点：推测性切分
+        if (s_tts->pending_since_us != 0 && !s_tts->stream_ended) {
+            uint32_t timeout_ms = speculative_timeout_ms();
+            int64_t now_us = esp_timer_get_time();
+            s_tts->stats.speculative_timeout_ms = timeout_ms;
+            
+            if (now_us - s_tts->pending_since_us >= (int64_t)timeout_ms * 1000) {
+                item.generation = s_tts->split_generation;
+                size_t len = speculative_split(sentence, SENTENCE_MAX_LEN);
+                if (len > 0) {
+                    ESP_LOGI(TAG, "Speculative flush after %lu ms: %s",
+                             (unsigned long)((now_us - s_tts->pending_since_us) / 1000), sentence);
+                    s_tts->stats.speculative_flushes++;
+                    if (s_tts->speculative_at_us == 0) {
+                        s_tts->speculative_at_us = now_us;
+                    }
+                    queue_sentence(&item);
+                }
+                // 文本不足最小长度时同样重新计时，避免每轮都尝试
+                s_tts->pending_since_us = s_tts->buffer_pos > 0 ? now_us : 0;
+            }
+        }
+        
         // 检查流是否结束 (Requirements 2.3)
         if (s_tts->stream_ended && !stream_end_processed) {
             ESP_LOGI(TAG, "Stream ended, flushing remaining text");
             
+            // 流结束等同于句末：结算推测性切分节省的时间
+            note_terminator_split(esp_timer_get_time());
+            s_tts->last_split_us = 0;
+            s_tts->pending_since_us = 0;
+            
             // 处理剩余文本
+            item.generation = s_tts->split_generation;
             size_t len = flush_remaining_text(sentence, SENTENCE_MAX_LEN);
             if (len > 0) {
-                if (xQueueSend(s_tts->sentence_queue, sentence, pdMS_TO_TICKS(QUEUE_SEND_TIMEOUT_MS)) != pdTRUE) {
-                    ESP_LOGW(TAG, "Sentence queue full, timeout");
-                } else {
-                    ESP_LOGI(TAG, "Final sentence queued: %s", sentence);
-                }
+                queue_sentence(&item);
+                ESP_LOGI(TAG, "Final sentence queued: %s", sentence);
             }
             
             stream_end_processed = true;
@@ -657,6 +864,7 @@ static void splitter_task(void *arg) {
     }
     
     ESP_LOGI(TAG, "Splitter task stopped");
+    xEventGroupSetBits(s_tts->task_exit, TASK_EXIT_SPLITTER);
     vTaskDelete(NULL);
 }
 
@@ -665,304 +873,553 @@ static void splitter_task(void *arg) {
 // ============================================================================
 
 /**
- * Token HTTP 响应上下文
+ * form_encoder 写入回调：直接写入 HTTP 请求流
  */
-typedef struct {
-    char *buffer;
-    size_t buffer_size;
-    size_t data_len;
-} token_response_t;
+static int http_form_write(void *ctx, const char *data, int len) {
+    return esp_http_client_write((esp_http_client_handle_t)ctx, data, len);
+}
 
 /**
- * Token HTTP 事件处理器
+ * 裁剪器输出：压缩写入音频缓冲区，缓冲区满后丢弃
  */
-static esp_err_t token_http_event_handler(esp_http_client_event_t *evt) {
-    token_response_t *ctx = (token_response_t *)evt->user_data;
-    
-    switch (evt->event_id) {
-        case HTTP_EVENT_ON_DATA:
-            if (ctx != NULL && ctx->buffer != NULL) {
-                if (ctx->data_len + evt->data_len < ctx->buffer_size) {
-                    memcpy(ctx->buffer + ctx->data_len, evt->data, evt->data_len);
-                    ctx->data_len += evt->data_len;
-                    ctx->buffer[ctx->data_len] = '\0';
-                }
-            }
-            break;
-        default:
-            break;
+typedef struct {
+    ima_adpcm_state_t enc;
+    uint8_t *buffer;
+    size_t samples;
+    size_t max_samples;
+} adpcm_sink_t;
+
+static void adpcm_sink_write(void *ctx, const int16_t *pcm, size_t samples) {
+    adpcm_sink_t *sink = (adpcm_sink_t *)ctx;
+    if (samples > sink->max_samples - sink->samples) {
+        samples = sink->max_samples - sink->samples;
     }
-    return ESP_OK;
+    ima_adpcm_encode(&sink->enc, pcm, samples, sink->buffer + sink->samples / 2);
+    sink->samples += samples;
 }
 
 /**
- * 获取百度 access_token
+ * 发起 TTS 请求：建立连接、写入请求体并等待响应头
+ * 
+ * esp_http_client 不支持从其他任务中止阻塞中的连接 (关闭传输层会释放正在使用的 TLS 上下文)，
+ * 因此取消标志只在连接建立、请求体写完这两个阶段之间检查，被取消时不再等待响应头。
  * 
- * Requirements: 3.1
+ * @param text 要合成的文本
+ * @param token access_token
+ * @param cancel 取消标志，可为 NULL
+ * @param out_client 成功时返回已收到响应头的连接，由调用者关闭
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 被取消
  */
-static esp_err_t get_baidu_access_token(void) {
-    if (s_tts == NULL) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    // 检查 token 是否有效
-    if (s_tts->access_token != NULL && s_tts->token_expire_time > esp_timer_get_time() / 1000000) {
-        return ESP_OK;
-    }
-    
-    ESP_LOGI(TAG, "Getting Baidu access_token...");
-    
-    // 准备响应缓冲区
-    token_response_t response_ctx = {
-        .buffer = malloc(2048),
-        .buffer_size = 2048,
-        .data_len = 0,
+static esp_err_t tts_request_open(const char *text, const char *token, const volatile bool *cancel,
+                                  esp_http_client_handle_t *out_client) {
+    // POST 字段，文本在写入请求流时才编码，Content-Length 预先精确计算
+    const form_field_t fields[] = {
+        {"tex", text, 0},
+        {"tok", token, 0},
+        {"cuid", "esp32_streaming_tts", 0},
+        {"ctp", "1", 0},
+        {"lan", "zh", 0},
+        {"spd", "5", 0},
+        {"pit", "5", 0},
+        {"vol", "10", 0},
+        {"per", "0", 0},
+        {"aue", "4", 0},
     };
-    if (response_ctx.buffer == NULL) {
-        return ESP_ERR_NO_MEM;
-    }
-    response_ctx.buffer[0] = '\0';
-    
-    // 构建 URL
-    char url[512];
-    snprintf(url, sizeof(url),
-             "%s?grant_type=client_credentials&client_id=%s&client_secret=%s",
-             BAIDU_TOKEN_URL,
-             s_tts->config.api_key,
-             s_tts->config.secret_key);
+    const size_t field_count = sizeof(fields) / sizeof(fields[0]);
+    int post_len = (int)form_body_len(fields, field_count);
     
     esp_http_client_config_t config = {
-        .url = url,
+        .url = BAIDU_TTS_URL,
         .method = HTTP_METHOD_POST,
-        .timeout_ms = 10000,
-        .event_handler = token_http_event_handler,
-        .user_data = &response_ctx,
+        .timeout_ms = 30000,
         .crt_bundle_attach = esp_crt_bundle_attach,
     };
     
     esp_http_client_handle_t client = esp_http_client_init(&config);
     if (client == NULL) {
-        free(response_ctx.buffer);
         return ESP_FAIL;
     }
     
-    esp_err_t err = esp_http_client_perform(client);
-    esp_http_client_cleanup(client);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to get token: %s", esp_err_to_name(err));
-        free(response_ctx.buffer);
-        return err;
+    esp_http_client_set_header(client, "Content-Type", "application/x-www-form-urlencoded");
+    
+    esp_err_t ret = esp_http_client_open(client, post_len);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "TTS request failed: %s", esp_err_to_name(ret));
+        esp_http_client_cleanup(client);
+        return ret;
+    }
+    
+    int status_code = 0;
+    if (cancel != NULL && *cancel) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else if (!form_body_write(fields, field_count, http_form_write, client)) {
+        ESP_LOGE(TAG, "TTS request write failed");
+        ret = ESP_FAIL;
+    } else if (cancel != NULL && *cancel) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else if (esp_http_client_fetch_headers(client) < 0) {
+        ESP_LOGE(TAG, "TTS response headers failed");
+        ret = ESP_FAIL;
+    } else if ((status_code = esp_http_client_get_status_code(client)) != 200) {
+        ESP_LOGE(TAG, "TTS request failed, status: %d", status_code);
+        if (tts_sched_is_throttle_error(status_code, NULL, 0)) {
+            tts_sched_feedback(true);
+        }
+        ret = ESP_FAIL;
+    }
+    
+    if (ret != ESP_OK) {
+        esp_http_client_close(client);
+        esp_http_client_cleanup(client);
+        return ret;
+    }
+    *out_client = client;
+    return ESP_OK;
+}
+
+static void tts_request_close(esp_http_client_handle_t client) {
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+}
+
+// ============================================================================
+// 对冲请求
+// ============================================================================
+
+/**
+ * 记录一次首包耗时
+ */
+static void hedge_record_ttfb(uint32_t ttfb_ms) {
+    s_tts->ttfb_ms[s_tts->ttfb_head] = ttfb_ms > UINT16_MAX ? UINT16_MAX : (uint16_t)ttfb_ms;
+    s_tts->ttfb_head = (s_tts->ttfb_head + 1) % HEDGE_WINDOW;
+    if (s_tts->ttfb_count < HEDGE_WINDOW) {
+        s_tts->ttfb_count++;
+    }
+}
+
+/**
+ * 对冲阈值：近期首包耗时的 P90
+ */
+static uint32_t hedge_threshold_ms(void) {
+    uint32_t n = s_tts->ttfb_count;
+    if (n < HEDGE_MIN_SAMPLES) {
+        return HEDGE_DEFAULT_MS;
+    }
+    
+    // 窗口很小，插入排序即可
+    uint16_t sorted[HEDGE_WINDOW];
+    for (uint32_t i = 0; i < n; i++) {
+        uint16_t v = s_tts->ttfb_ms[i];
+        uint32_t j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+    uint32_t threshold = sorted[(n * HEDGE_PERCENTILE) / 100];
+    if (threshold < HEDGE_MIN_MS) {
+        threshold = HEDGE_MIN_MS;
+    } else if (threshold > HEDGE_MAX_MS) {
+        threshold = HEDGE_MAX_MS;
+    }
+    return threshold;
+}
+
+/**
+ * 请求工作任务：收到通知后发起槽内的请求，直到收到响应头
+ */
+static void tts_request_worker(void *arg) {
+    tts_req_slot_t *slot = (tts_req_slot_t *)arg;
+    
+    while (!s_tts->should_stop) {
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(QUEUE_RECV_TIMEOUT_MS)) == 0) {
+            continue;
+        }
+        
+        esp_http_client_handle_t client = NULL;
+        esp_err_t ret = tts_request_open(slot->text, slot->token, &slot->cancelled, &client);
+        uint32_t ttfb_ms = (uint32_t)((esp_timer_get_time() - slot->start_us) / 1000);
+        
+        portENTER_CRITICAL(&s_hedge_lock);
+        bool cancelled = slot->cancelled;
+        if (cancelled) {
+            slot->state = TTS_REQ_IDLE;
+        } else {
+            slot->client = client;
+            slot->result = ret;
+            slot->ttfb_ms = ttfb_ms;
+            slot->state = ret == ESP_OK ? TTS_REQ_READY : TTS_REQ_FAILED;
+        }
+        portEXIT_CRITICAL(&s_hedge_lock);
+        
+        if (cancelled) {
+            // 输给了另一个请求或被打断，自行关闭连接
+            if (client != NULL) {
+                tts_request_close(client);
+            }
+            ESP_LOGD(TAG, "Cancelled TTS request %d finished after %lu ms", slot->index, (unsigned long)ttfb_ms);
+        } else {
+            xEventGroupSetBits(s_tts->req_events, BIT0 << slot->index);
+        }
+    }
+    
+    xEventGroupSetBits(s_tts->task_exit, TASK_EXIT_WORKER(slot->index));
+    vTaskDelete(NULL);
+}
+
+/**
+ * 分配空闲槽并发起请求
+ * 
+ * @return 槽，没有空闲槽时返回 NULL (被取消的请求仍在等待超时)
+ */
+static tts_req_slot_t *hedge_start(const char *text, const char *token) {
+    tts_req_slot_t *slot = NULL;
+    portENTER_CRITICAL(&s_hedge_lock);
+    for (int i = 0; i < HEDGE_SLOTS; i++) {
+        if (s_tts->req_slots[i].state == TTS_REQ_IDLE) {
+            slot = &s_tts->req_slots[i];
+            slot->state = TTS_REQ_RUNNING;
+            slot->cancelled = false;
+            slot->client = NULL;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_hedge_lock);
+    if (slot == NULL) {
+        return NULL;
+    }
+    
+    snprintf(slot->text, sizeof(slot->text), "%s", text);
+    snprintf(slot->token, sizeof(slot->token), "%s", token);
+    slot->start_us = esp_timer_get_time();
+    xTaskNotifyGive(slot->task);
+    return slot;
+}
+
+/**
+ * 放弃一个槽：仍在进行的请求标记为取消，已就绪的连接直接关闭
+ */
+static void hedge_cancel(tts_req_slot_t *slot) {
+    esp_http_client_handle_t client = NULL;
+    portENTER_CRITICAL(&s_hedge_lock);
+    if (slot->state == TTS_REQ_RUNNING) {
+        slot->cancelled = true;
+    } else {
+        client = slot->client;
+        slot->client = NULL;
+        slot->state = TTS_REQ_IDLE;
+    }
+    portEXIT_CRITICAL(&s_hedge_lock);
+    if (client != NULL) {
+        tts_request_close(client);
+    }
+}
+
+/**
+ * 以对冲方式发起 TTS 请求
+ * 
+ * 主请求在工作任务中进行，播放任务等待首包；超过阈值仍未收到时，若额度允许，
+ * 在第二个连接上发出相同的请求 (TTS 请求是幂等的)，先收到响应头的一方胜出，另一方被取消。
+ * 
+ * @param text 要合成的文本
+ * @param token access_token
+ * @param generation 发起请求时的代次
+ * @param out_client 成功时返回胜出的连接
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 被打断
+ */
+static esp_err_t tts_request_open_hedged(const char *text, const char *token, uint32_t generation,
+                                         esp_http_client_handle_t *out_client) {
+    tts_req_slot_t *primary = hedge_start(text, token);
+    if (primary == NULL) {
+        // 两个槽都被尚未结束的已取消请求占用，退回直接请求
+        return tts_request_open(text, token, NULL, out_client);
+    }
+    
+    uint32_t threshold_ms = hedge_threshold_ms();
+    s_tts->stats.hedge_threshold_ms = threshold_ms;
+    s_tts->hedge_budget += HEDGE_BUDGET_PER_REQUEST;
+    if (s_tts->hedge_budget > HEDGE_BUDGET_MAX) {
+        s_tts->hedge_budget = HEDGE_BUDGET_MAX;
     }
     
-    ESP_LOGD(TAG, "Token response: %s", response_ctx.buffer);
-    
-    // 解析 JSON 获取 access_token
-    char *token_start = strstr(response_ctx.buffer, "\"access_token\":\"");
-    if (token_start == NULL) {
-        ESP_LOGE(TAG, "access_token not found in response");
-        free(response_ctx.buffer);
-        return ESP_FAIL;
-    }
+    tts_req_slot_t *slots[HEDGE_SLOTS] = {primary, NULL};
+    tts_req_slot_t *winner = NULL;
+    esp_err_t ret = ESP_FAIL;
+    int running = 1;
     
-    token_start += strlen("\"access_token\":\"");
-    char *token_end = strchr(token_start, '"');
-    if (token_end == NULL) {
-        free(response_ctx.buffer);
-        return ESP_FAIL;
+    while (winner == NULL && running > 0) {
+        if (generation != s_tts->generation || s_tts->should_stop) {
+            ret = ESP_ERR_INVALID_STATE;
+            break;
+        }
+        xEventGroupWaitBits(s_tts->req_events, (BIT0 << HEDGE_SLOTS) - 1, pdTRUE, pdFALSE,
+                            pdMS_TO_TICKS(HEDGE_POLL_MS));
+        
+        for (int i = 0; i < HEDGE_SLOTS && winner == NULL; i++) {
+            tts_req_slot_t *slot = slots[i];
+            if (slot == NULL) {
+                continue;
+            }
+            portENTER_CRITICAL(&s_hedge_lock);
+            tts_req_state_t state = slot->state;
+            portEXIT_CRITICAL(&s_hedge_lock);
+            if (state == TTS_REQ_READY) {
+                winner = slot;
+            } else if (state == TTS_REQ_FAILED) {
+                ret = slot->result;
+                hedge_cancel(slot);
+                slots[i] = NULL;
+                running--;
+            }
+        }
+        
+        // 首包超时：额度允许且调度器立即有令牌时发出对冲请求 (对冲不排队，不挤占正常请求)
+        if (winner == NULL && running > 0 && slots[1] == NULL && s_tts->hedge_budget >= HEDGE_COST &&
+            esp_timer_get_time() - primary->start_us >= (int64_t)threshold_ms * 1000 &&
+            tts_sched_acquire(TTS_SCHED_PREFETCH, 0, NULL, NULL) == ESP_OK) {
+            slots[1] = hedge_start(text, token);
+            if (slots[1] != NULL) {
+                s_tts->hedge_budget -= HEDGE_COST;
+                s_tts->stats.hedges_fired++;
+                running++;
+                ESP_LOGI(TAG, "No TTS response after %lu ms, hedging", (unsigned long)threshold_ms);
+            }
+        }
     }
     
-    // 保存 token
-    size_t token_len = token_end - token_start;
-    if (s_tts->access_token != NULL) {
-        free(s_tts->access_token);
+    // 取消其余请求
+    for (int i = 0; i < HEDGE_SLOTS; i++) {
+        if (slots[i] != NULL && slots[i] != winner) {
+            hedge_cancel(slots[i]);
+        }
     }
-    s_tts->access_token = malloc(token_len + 1);
-    if (s_tts->access_token == NULL) {
-        free(response_ctx.buffer);
-        return ESP_ERR_NO_MEM;
+    if (winner == NULL) {
+        return ret;
     }
-    memcpy(s_tts->access_token, token_start, token_len);
-    s_tts->access_token[token_len] = '\0';
     
-    // 设置过期时间 (默认30天，这里设置为29天)
-    s_tts->token_expire_time = esp_timer_get_time() / 1000000 + 29 * 24 * 3600;
+    portENTER_CRITICAL(&s_hedge_lock);
+    *out_client = winner->client;
+    uint32_t ttfb_ms = winner->ttfb_ms;
+    winner->client = NULL;
+    winner->state = TTS_REQ_IDLE;
+    portEXIT_CRITICAL(&s_hedge_lock);
     
-    ESP_LOGI(TAG, "Got access_token successfully");
-    free(response_ctx.buffer);
-    return ESP_OK;
-}
-
-/**
- * 音频 HTTP 响应上下文
- */
-typedef struct {
-    uint8_t *buffer;
-    size_t buffer_size;
-    size_t data_len;
-} http_audio_context_t;
-
-/**
- * 音频 HTTP 事件处理器
- */
-static esp_err_t http_audio_event_handler(esp_http_client_event_t *evt) {
-    http_audio_context_t *ctx = (http_audio_context_t *)evt->user_data;
-    
-    switch (evt->event_id) {
-        case HTTP_EVENT_ON_DATA:
-            if (ctx != NULL && ctx->buffer != NULL) {
-                if (ctx->data_len + evt->data_len <= ctx->buffer_size) {
-                    memcpy(ctx->buffer + ctx->data_len, evt->data, evt->data_len);
-                    ctx->data_len += evt->data_len;
-                }
-            }
-            break;
-        default:
-            break;
+    hedge_record_ttfb(ttfb_ms);
+    if (winner != primary) {
+        s_tts->stats.hedges_won++;
+        ESP_LOGI(TAG, "Hedged TTS request won (%lu ms)", (unsigned long)ttfb_ms);
     }
     return ESP_OK;
 }
 
+// ============================================================================
+// 百度 TTS 合成
+// ============================================================================
+
 /**
- * URL 编码
+ * 调度器排队期间的中止检查：发生 stop 后放弃排队
  */
-static char *url_encode(const char *str) {
-    if (str == NULL) return NULL;
-    
-    size_t len = strlen(str);
-    char *encoded = malloc(len * 3 + 1);
-    if (encoded == NULL) return NULL;
-    
-    char *p = encoded;
-    for (size_t i = 0; i < len; i++) {
-        unsigned char c = (unsigned char)str[i];
-        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || 
-            (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.' || c == '~') {
-            *p++ = c;
-        } else {
-            sprintf(p, "%%%02X", c);
-            p += 3;
-        }
-    }
-    *p = '\0';
-    return encoded;
+static bool synth_aborted(void *ctx) {
+    return *(const uint32_t *)ctx != s_tts->generation || s_tts->should_stop;
 }
 
 /**
  * 调用百度 TTS API 获取音频
  * 
+ * 使用 open/read 分段读取响应，每读一段检查一次代次；
+ * 代次变化 (streaming_tts_stop 被调用) 时立即关闭连接并放弃本次结果。
+ * 返回的 PCM 边读边裁剪句首尾静音并压缩为 IMA-ADPCM，同样的缓冲区可容纳 4 倍时长。
+ * 
  * @param text 要合成的文本
- * @param audio_buffer 音频数据输出缓冲区
+ * @param generation 发起请求时的代次
+ * @param audio_buffer IMA-ADPCM 输出缓冲区
  * @param buffer_size 缓冲区大小
- * @param audio_len 输出参数，返回音频数据长度
- * @return ESP_OK 成功
+ * @param sample_count 输出参数，返回采样数
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 被打断
  * 
  * Requirements: 3.1, 3.2
  */
-static esp_err_t baidu_tts_synthesize(const char *text, uint8_t *audio_buffer, size_t buffer_size, size_t *audio_len) {
+static esp_err_t baidu_tts_synthesize(const char *text, uint32_t generation,
+                                      uint8_t *audio_buffer, size_t buffer_size, size_t *sample_count) {
     if (s_tts == NULL || text == NULL || audio_buffer == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    // 获取 access_token
-    esp_err_t ret = get_baidu_access_token();
+    // 获取 access_token (通常直接命中缓存，过期前由后台任务刷新)
+    char token[BAIDU_AUTH_TOKEN_MAX_LEN];
+    esp_err_t ret = baidu_auth_get_token(token, sizeof(token), pdMS_TO_TICKS(TOKEN_WAIT_TIMEOUT_MS));
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to get access_token");
+        ESP_LOGE(TAG, "Failed to get access_token: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    ESP_LOGI(TAG, "Calling Baidu TTS API: %s", text);
-    
-    // URL 编码文本
-    char *encoded_text = url_encode(text);
-    if (encoded_text == NULL) {
-        return ESP_ERR_NO_MEM;
+    // 排队取得请求令牌：本代次的第一句用户正在等待，优先于后续句子
+    bool first = s_tts->clock_turn != generation || s_tts->clock_sentence == 0;
+    ret = tts_sched_acquire(first ? TTS_SCHED_INTERACTIVE : TTS_SCHED_NORMAL, portMAX_DELAY,
+                            synth_aborted, &generation);
+    if (ret != ESP_OK) {
+        ESP_LOGI(TAG, "TTS request abandoned while queued");
+        return ESP_ERR_INVALID_STATE;
     }
     
-    // 构建 POST 数据
-    char post_data[1024];
-    snprintf(post_data, sizeof(post_data),
-             "tex=%s&tok=%s&cuid=esp32_streaming_tts&ctp=1&lan=zh&spd=5&pit=5&vol=10&per=0&aue=4",
-             encoded_text, s_tts->access_token);
-    free(encoded_text);
-    
-    // 准备接收缓冲区
-    http_audio_context_t ctx = {
-        .buffer = audio_buffer,
-        .buffer_size = buffer_size,
-        .data_len = 0,
-    };
-    
-    esp_http_client_config_t config = {
-        .url = BAIDU_TTS_URL,
-        .method = HTTP_METHOD_POST,
-        .timeout_ms = 30000,
-        .event_handler = http_audio_event_handler,
-        .user_data = &ctx,
-        .crt_bundle_attach = esp_crt_bundle_attach,
-    };
+    ESP_LOGI(TAG, "Calling Baidu TTS API: %s", text);
     
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (client == NULL) {
-        return ESP_FAIL;
+    esp_http_client_handle_t client = NULL;
+    if (s_tts->req_events != NULL) {
+        ret = tts_request_open_hedged(text, token, generation, &client);
+    } else {
+        ret = tts_request_open(text, token, NULL, &client);
     }
-    
-    esp_http_client_set_header(client, "Content-Type", "application/x-www-form-urlencoded");
-    esp_http_client_set_post_field(client, post_data, strlen(post_data));
-    
-    ret = esp_http_client_perform(client);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "TTS request failed: %s", esp_err_to_name(ret));
-        esp_http_client_cleanup(client);
         return ret;
     }
     
-    int status_code = esp_http_client_get_status_code(client);
-    esp_http_client_cleanup(client);
-    
-    if (status_code != 200) {
-        ESP_LOGE(TAG, "TTS request failed, status: %d", status_code);
-        return ESP_FAIL;
+    // 分段读取音频，每段之间检查是否已被打断；奇数字节的尾部留到下一段
+    int16_t pcm[HTTP_READ_CHUNK_SIZE / sizeof(int16_t)];
+    size_t pending = 0;
+    size_t total_read = 0;
+    adpcm_sink_t sink = {
+        .buffer = audio_buffer,
+        .max_samples = IMA_ADPCM_SAMPLES(buffer_size),
+    };
+    ima_adpcm_init(&sink.enc);
+    silence_trim_init(&s_tts->trim, s_tts->config.silence_threshold,
+                      (size_t)s_tts->config.silence_pad_ms * SAMPLE_RATE / 1000, adpcm_sink_write, &sink);
+    
+    while (sink.samples < sink.max_samples) {
+        if (generation != s_tts->generation) {
+            ESP_LOGI(TAG, "TTS request aborted by stop");
+            ret = ESP_ERR_INVALID_STATE;
+            goto done;
+        }
+        int read_len = esp_http_client_read(client, (char *)pcm + pending, sizeof(pcm) - pending);
+        if (read_len < 0) {
+            ESP_LOGE(TAG, "TTS response read failed: %d", read_len);
+            ret = ESP_FAIL;
+            goto done;
+        }
+        if (read_len == 0) {
+            break;
+        }
+        
+        // 检查是否返回了错误 JSON
+        if (total_read == 0 && ((const char *)pcm)[0] == '{') {
+            ESP_LOGE(TAG, "TTS returned error: %.*s", read_len > 200 ? 200 : read_len, (const char *)pcm);
+            if (baidu_auth_is_token_error((const char *)pcm, read_len)) {
+                baidu_auth_invalidate(token);
+            } else if (tts_sched_is_throttle_error(200, (const char *)pcm, read_len)) {
+                tts_sched_feedback(true);
+            }
+            ret = ESP_FAIL;
+            goto done;
+        }
+        
+        total_read += read_len;
+        pending += read_len;
+        size_t count = pending / sizeof(int16_t);
+        silence_trim_push(&s_tts->trim, pcm, count);
+        pending -= count * sizeof(int16_t);
+        memmove(pcm, pcm + count, pending);
+    }
+    if (sink.samples == sink.max_samples && !esp_http_client_is_complete_data_received(client)) {
+        ESP_LOGW(TAG, "Audio buffer full, sentence audio truncated");
     }
     
-    // 检查是否返回了错误 JSON
-    if (ctx.data_len > 0 && ctx.buffer[0] == '{') {
-        ESP_LOGE(TAG, "TTS returned error: %.*s", (int)(ctx.data_len > 200 ? 200 : ctx.data_len), ctx.buffer);
-        return ESP_FAIL;
+    // 截掉句尾静音；缓冲区满时超出部分 (已输出但未写入) 是截断，不计入静音裁剪
+    size_t samples = silence_trim_finish(&s_tts->trim);
+    size_t stored = s_tts->trim.out_samples < sink.samples ? s_tts->trim.out_samples : sink.samples;
+    if (samples > stored) {
+        samples = stored;
     }
+    s_tts->stats.silence_trimmed_ms += (uint32_t)((s_tts->trim.in_samples - s_tts->trim.out_samples + stored - samples) *
+                                                  1000 / SAMPLE_RATE);
     
     // 检查音频数据有效性
-    if (ctx.data_len < 100) {
-        ESP_LOGE(TAG, "TTS returned data too small: %d bytes", (int)ctx.data_len);
-        return ESP_FAIL;
+    if (samples < 50) {
+        ESP_LOGE(TAG, "TTS returned data too small: %d samples", (int)samples);
+        ret = ESP_FAIL;
+        goto done;
     }
     
-    *audio_len = ctx.data_len;
-    ESP_LOGI(TAG, "TTS synthesis success, audio size: %d bytes", (int)ctx.data_len);
-    return ESP_OK;
+    *sample_count = samples;
+    tts_sched_feedback(false);
+    ESP_LOGI(TAG, "TTS synthesis success, %d samples (%d bytes ADPCM)",
+             (int)samples, (int)IMA_ADPCM_BYTES(samples));
+    ret = ESP_OK;
+
+done:
+    // 关闭连接 (打断时也在这里关闭 socket，停止继续下载)
+    tts_request_close(client);
+    return ret;
+}
+
+/**
+ * 把一段 PCM 完整写入语音流，缓冲区满时以 10ms 为单位等待，期间检查代次
+ * 
+ * @return false 代次已变化
+ */
+static bool write_speech(const int16_t *pcm, size_t count, uint32_t generation) {
+    size_t offset = 0;
+    while (offset < count && !s_tts->should_stop) {
+        if (generation != s_tts->generation) {
+            return false;
+        }
+        offset += audio_output_stream_write(s_tts->tts_stream, pcm + offset, count - offset, pdMS_TO_TICKS(10));
+    }
+    return generation == s_tts->generation;
+}
+
+/**
+ * 按分句队列积压选择本句播放速率
+ * 
+ * 积压在 RATE_BACKLOG_LOW 到 RATE_BACKLOG_HIGH 之间时线性提速到 RATE_MAX_Q8；
+ * 每句最多变化 RATE_STEP_Q8，积压消化后逐句回到原速。
+ */
+static uint16_t playback_rate_q8(void) {
+    int backlog = (int)uxQueueMessagesWaiting(s_tts->sentence_queue);
+    int target = AUDIO_DSP_RATE_UNITY;
+    if (backlog >= RATE_BACKLOG_HIGH) {
+        target = RATE_MAX_Q8;
+    } else if (backlog > RATE_BACKLOG_LOW) {
+        target = AUDIO_DSP_RATE_UNITY + (RATE_MAX_Q8 - AUDIO_DSP_RATE_UNITY) * (backlog - RATE_BACKLOG_LOW) /
+                 (RATE_BACKLOG_HIGH - RATE_BACKLOG_LOW);
+    }
+    
+    int rate = s_tts->rate_q8;
+    if (target > rate) {
+        rate = target - rate > RATE_STEP_Q8 ? rate + RATE_STEP_Q8 : target;
+    } else if (target < rate) {
+        rate = rate - target > RATE_STEP_Q8 ? rate - RATE_STEP_Q8 : target;
+    }
+    s_tts->rate_q8 = (uint16_t)rate;
+    s_tts->stats.playback_rate_q8 = (uint16_t)rate;
+    return (uint16_t)rate;
 }
 
 /**
- * 播放 PCM 音频
+ * 播放 IMA-ADPCM 音频
  * 
- * @param audio_data PCM 音频数据
- * @param audio_len 音频数据长度
- * @return ESP_OK 成功
+ * 以 PLAY_CHUNK_SIZE 为单位解码并写入语音输出流，分句队列积压时经 WSOLA 加速；
+ * 每块之间以及等待输出完成期间检查代次；
+ * 代次变化时清空输出流 (淡出并丢弃 DMA)，然后通知 streaming_tts_stop 已静音。
+ * 
+ * @param adpcm IMA-ADPCM 音频数据
+ * @param total 采样数
+ * @param generation 句子所属的代次
+ * @return ESP_OK 播放完成，ESP_ERR_INVALID_STATE 被打断
  * 
  * Requirements: 3.2
  */
-static esp_err_t play_pcm_audio(const uint8_t *audio_data, size_t audio_len) {
-    if (s_tts == NULL || s_tts->codec_dev == NULL || audio_data == NULL) {
+static esp_err_t play_adpcm_audio(const uint8_t *adpcm, size_t total, uint32_t generation) {
+    if (s_tts == NULL || s_tts->tts_stream == NULL || adpcm == NULL) {
         return ESP_ERR_INVALID_STATE;
     }
     
-    ESP_LOGI(TAG, "Playing PCM audio, size: %d bytes", (int)audio_len);
+    ESP_LOGI(TAG, "Playing audio, %d samples", (int)total);
     
     // 使能音频放大器
-    if (!s_tts->pa_enabled && s_tts->pca9557_dev != NULL) {
-        enable_audio_pa(true);
-        vTaskDelay(pdMS_TO_TICKS(50));
-    }
+    audio_output_set_pa(true);
     
     // 通知播放开始
     if (s_tts->config.on_start) {
@@ -970,48 +1427,92 @@ static esp_err_t play_pcm_audio(const uint8_t *audio_data, size_t audio_len) {
     }
     s_tts->is_playing = true;
     
-    // 清空信号量（防止之前的残留信号）
-    if (s_tts->play_done_sem != NULL) {
-        xSemaphoreTake(s_tts->play_done_sem, 0);
+    // 音频时钟：同一代次内的句子依次编号
+    if (s_tts->clock_turn != generation) {
+        s_tts->clock_turn = generation;
+        s_tts->clock_sentence = 0;
+    }
+    uint16_t rate = playback_rate_q8();
+    audio_clock_begin_sentence(generation, s_tts->clock_sentence++, total * sizeof(int16_t), rate);
+    if (rate != AUDIO_DSP_RATE_UNITY) {
+        audio_dsp_wsola_init(&s_tts->wsola, rate);
+        s_tts->stats.stretched_sentences++;
+        ESP_LOGI(TAG, "Backlog %d sentences, playing at %d.%02dx",
+                 (int)uxQueueMessagesWaiting(s_tts->sentence_queue), rate / 256, (rate % 256) * 100 / 256);
     }
     
-    // 设置待播放字节数
-    s_tts->pending_bytes = audio_len;
-    
-    // 分块播放
-    const size_t chunk_size = 1024;
+    // 逐块解码 (必要时变速) 并写入输出流
+    int16_t pcm[PLAY_CHUNK_SIZE / sizeof(int16_t)];
     size_t offset = 0;
-    
-    while (offset < audio_len && !s_tts->should_stop) {
-        size_t write_len = (audio_len - offset) > chunk_size ? chunk_size : (audio_len - offset);
-        esp_err_t ret = esp_codec_dev_write(s_tts->codec_dev, (void *)(audio_data + offset), write_len);
-        if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "Failed to write audio data");
-            break;
+    size_t queued = 0;
+    bool aborted = false;
+    ima_adpcm_state_t dec;
+    ima_adpcm_init(&dec);
+    
+    while (offset < total && !aborted && !s_tts->should_stop) {
+        size_t count = total - offset;
+        if (count > sizeof(pcm) / sizeof(pcm[0])) {
+            count = sizeof(pcm) / sizeof(pcm[0]);
         }
-        offset += write_len;
+        ima_adpcm_decode(&dec, adpcm + offset / 2, count, pcm);
+        
+        if (rate == AUDIO_DSP_RATE_UNITY) {
+            aborted = !write_speech(pcm, count, generation);
+            queued += count;
+        } else {
+            size_t n = audio_dsp_wsola_process(&s_tts->wsola, pcm, count, s_tts->stretch_buf);
+            aborted = !write_speech(s_tts->stretch_buf, n, generation);
+            queued += n;
+        }
+        offset += count;
+    }
+    if (!aborted && rate != AUDIO_DSP_RATE_UNITY) {
+        size_t n = audio_dsp_wsola_flush(&s_tts->wsola, s_tts->stretch_buf);
+        aborted = !write_speech(s_tts->stretch_buf, n, generation);
+        queued += n;
     }
+    uint64_t end_frame = s_tts->clock.sentence_start_frame + queued;
     
-    // 等待播放完成（通过 I2S 回调信号量）
-    if (!s_tts->should_stop && offset > 0 && s_tts->play_done_sem != NULL) {
+    // 等待播放完成（I2S 回调确认输出到句尾），分段等待以便及时响应打断
+    if (!aborted && !s_tts->should_stop && queued > 0) {
         // 计算最大等待时间：音频时长 + 500ms 余量
-        uint32_t max_wait_ms = (audio_len * 1000) / (SAMPLE_RATE * 2) + 500;
+        uint32_t max_wait_ms = (uint32_t)((uint64_t)queued * 1000 / SAMPLE_RATE) + 500;
+        int64_t deadline = esp_timer_get_time() + (int64_t)max_wait_ms * 1000;
         ESP_LOGD(TAG, "Waiting for playback completion (max %lu ms)", (unsigned long)max_wait_ms);
         
-        if (xSemaphoreTake(s_tts->play_done_sem, pdMS_TO_TICKS(max_wait_ms)) != pdTRUE) {
-            ESP_LOGW(TAG, "Playback wait timeout, pending_bytes=%d", (int)s_tts->pending_bytes);
+        while (!audio_output_stream_wait(s_tts->tts_stream, end_frame, pdMS_TO_TICKS(10))) {
+            if (generation != s_tts->generation) {
+                aborted = true;
+                break;
+            }
+            if (esp_timer_get_time() > deadline) {
+                audio_output_position_t pos;
+                audio_output_stream_get_position(s_tts->tts_stream, &pos);
+                ESP_LOGW(TAG, "Playback wait timeout, %d frames not played",
+                         (int)(pos.frames_queued - pos.frames_played));
+                // 丢弃残留语音，避免与下一句重叠
+                audio_output_stream_flush(s_tts->tts_stream);
+                break;
+            }
         }
     }
     
+    if (aborted) {
+        s_tts->stats.stale_audio_skipped_ms += (uint32_t)((uint64_t)(total - offset) * 1000 / SAMPLE_RATE);
+        audio_output_stream_flush(s_tts->tts_stream);
+        xSemaphoreGive(s_tts->stop_ack_sem);
+        ESP_LOGI(TAG, "Playback aborted at %d/%d samples", (int)offset, (int)total);
+    }
+    
     s_tts->is_playing = false;
-    s_tts->pending_bytes = 0;
+    audio_clock_end_sentence();
     
     // 通知播放结束
     if (s_tts->config.on_stop) {
         s_tts->config.on_stop();
     }
     
-    return ESP_OK;
+    return aborted ? ESP_ERR_INVALID_STATE : ESP_OK;
 }
 
 // ============================================================================
@@ -1028,7 +1529,8 @@ static esp_err_t play_pcm_audio(const uint8_t *audio_data, size_t audio_len) {
 static void player_task(void *arg) {
     ESP_LOGI(TAG, "Player task started");
     
-    char sentence[SENTENCE_MAX_LEN];
+    sentence_item_t item;
+    const char *sentence = item.text;
     
     // 分配音频缓冲区
     s_tts->audio_buffer = heap_caps_malloc(AUDIO_BUFFER_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
@@ -1037,6 +1539,7 @@ static void player_task(void *arg) {
     }
     if (s_tts->audio_buffer == NULL) {
         ESP_LOGE(TAG, "Failed to allocate audio buffer");
+        xEventGroupSetBits(s_tts->task_exit, TASK_EXIT_PLAYER);
         vTaskDelete(NULL);
         return;
     }
@@ -1044,7 +1547,7 @@ static void player_task(void *arg) {
     
     while (!s_tts->should_stop) {
         // 从分句队列读取 (Requirements 3.1)
-        if (xQueueReceive(s_tts->sentence_queue, sentence, pdMS_TO_TICKS(QUEUE_RECV_TIMEOUT_MS)) == pdTRUE) {
+        if (xQueueReceive(s_tts->sentence_queue, &item, pdMS_TO_TICKS(QUEUE_RECV_TIMEOUT_MS)) == pdTRUE) {
             ESP_LOGI(TAG, "Processing sentence: %s", sentence);
             
             // 检查是否应该停止
@@ -1052,19 +1555,43 @@ static void player_task(void *arg) {
                 break;
             }
             
+            // 句子所属代次已过期 (入队与 stop 交错)，不再发起合成请求
+            uint32_t generation = item.generation;
+            if (generation != s_tts->generation) {
+                s_tts->stats.stale_sentences_dropped++;
+                ESP_LOGD(TAG, "Dropping stale sentence");
+                continue;
+            }
+            
             // 调用百度 TTS API 获取音频 (Requirements 3.1)
-            size_t audio_len = 0;
-            esp_err_t ret = baidu_tts_synthesize(sentence, s_tts->audio_buffer, s_tts->audio_buffer_size, &audio_len);
+            size_t sample_count = 0;
+            esp_err_t ret = baidu_tts_synthesize(sentence, generation,
+                                                 s_tts->audio_buffer, s_tts->audio_buffer_size, &sample_count);
             
+            if (ret == ESP_ERR_INVALID_STATE) {
+                // 排队或下载中被 stop 打断，连接已关闭
+                s_tts->stats.synth_aborted++;
+                continue;
+            }
             if (ret != ESP_OK) {
                 // 记录日志，跳过当前句子，继续下一句 (Error Handling)
                 ESP_LOGW(TAG, "TTS synthesis failed for: %s, skipping", sentence);
                 continue;
             }
             
+            // 合成期间发生了 stop，丢弃迟到的结果
+            if (generation != s_tts->generation) {
+                s_tts->stats.late_results_dropped++;
+                ESP_LOGD(TAG, "Dropping stale synthesis result");
+                continue;
+            }
+            
             // 播放音频 (Requirements 3.2)
-            ret = play_pcm_audio(s_tts->audio_buffer, audio_len);
-            if (ret != ESP_OK) {
+            ret = play_adpcm_audio(s_tts->audio_buffer, sample_count, generation);
+            if (ret == ESP_ERR_INVALID_STATE) {
+                ESP_LOGD(TAG, "Sentence playback interrupted");
+                continue;
+            } else if (ret != ESP_OK) {
                 ESP_LOGW(TAG, "Audio playback failed, continuing");
             }
             
@@ -1075,9 +1602,54 @@ static void player_task(void *arg) {
     }
     
     ESP_LOGI(TAG, "Player task stopped");
+    xEventGroupSetBits(s_tts->task_exit, TASK_EXIT_PLAYER);
     vTaskDelete(NULL);
 }
 
+/**
+ * 通知所有已创建的任务退出并等待它们结束
+ * 
+ * 递增代次让播放任务放弃正在进行的合成，取消工作任务中的请求。
+ * 阻塞在网络调用中的任务要等调用返回 (最长为 HTTP 超时)，此前不能释放 s_tts。
+ */
+static void stop_tasks(void) {
+    s_tts->should_stop = true;
+    s_tts->generation++;
+    
+    EventBits_t wait_bits = 0;
+    if (s_tts->splitter_task != NULL) {
+        wait_bits |= TASK_EXIT_SPLITTER;
+    }
+    if (s_tts->player_task != NULL) {
+        wait_bits |= TASK_EXIT_PLAYER;
+    }
+    for (int i = 0; i < HEDGE_SLOTS; i++) {
+        tts_req_slot_t *slot = &s_tts->req_slots[i];
+        if (slot->task == NULL) {
+            continue;
+        }
+        portENTER_CRITICAL(&s_hedge_lock);
+        if (slot->state == TTS_REQ_RUNNING) {
+            slot->cancelled = true;
+        }
+        portEXIT_CRITICAL(&s_hedge_lock);
+        xTaskNotifyGive(slot->task);
+        wait_bits |= TASK_EXIT_WORKER(i);
+    }
+    if (wait_bits != 0) {
+        xEventGroupWaitBits(s_tts->task_exit, wait_bits, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    
+    // 被取消的工作任务已自行关闭连接，这里只剩已就绪而未被接管的连接
+    for (int i = 0; i < HEDGE_SLOTS; i++) {
+        tts_req_slot_t *slot = &s_tts->req_slots[i];
+        if (slot->client != NULL) {
+            tts_request_close(slot->client);
+            slot->client = NULL;
+        }
+    }
+}
+
 // ============================================================================
 // 公共 API 实现
 // ============================================================================
@@ -1104,6 +1676,12 @@ esp_err_t streaming_tts_init(const streaming_tts_config_t *config) {
     
     // 复制配置
     s_tts->config = *config;
+    if (s_tts->config.silence_pad_ms == 0) {
+        s_tts->config.silence_pad_ms = SILENCE_PAD_MS_DEFAULT;
+    }
+    if (s_tts->config.silence_threshold == 0) {
+        s_tts->config.silence_threshold = SILENCE_THRESHOLD_DEFAULT;
+    }
     
     // 复制 API 密钥 (深拷贝)
     if (config->api_key != NULL) {
@@ -1124,61 +1702,86 @@ esp_err_t streaming_tts_init(const streaming_tts_config_t *config) {
         }
     }
     
-    // 设置默认 I2S 引脚 (立创实战派 ESP32-S3 默认值)
-    if (s_tts->config.i2s_mclk_pin == 0) s_tts->config.i2s_mclk_pin = 38;
-    if (s_tts->config.i2s_bclk_pin == 0) s_tts->config.i2s_bclk_pin = 14;
-    if (s_tts->config.i2s_ws_pin == 0) s_tts->config.i2s_ws_pin = 13;
-    if (s_tts->config.i2s_dout_pin == 0) s_tts->config.i2s_dout_pin = 45;
-    
     // 初始化状态
     s_tts->stream_ended = false;
     s_tts->is_playing = false;
     s_tts->should_stop = false;
     s_tts->buffer_pos = 0;
     memset(s_tts->sentence_buffer, 0, SENTENCE_BUFFER_SIZE);
+    s_tts->split_gap_ewma_ms = SPECULATIVE_GAP_INIT_MS;
+    s_tts->rate_q8 = AUDIO_DSP_RATE_UNITY;
+    
+    // 任务退出事件组 (销毁时用来等待任务退出)
+    s_tts->task_exit = xEventGroupCreate();
+    if (s_tts->task_exit == NULL) {
+        ESP_LOGE(TAG, "Failed to create task exit event group");
+        goto cleanup;
+    }
     
     // 创建原始文本队列
-    s_tts->raw_text_queue = xQueueCreate(RAW_TEXT_QUEUE_SIZE, RAW_TEXT_MAX_LEN);
+    s_tts->raw_text_queue = xQueueCreate(RAW_TEXT_QUEUE_SIZE, sizeof(raw_text_item_t));
     if (s_tts->raw_text_queue == NULL) {
         ESP_LOGE(TAG, "Failed to create raw text queue");
         goto cleanup;
     }
     ESP_LOGI(TAG, "Raw text queue created (size: %d, item: %d bytes)", 
-             RAW_TEXT_QUEUE_SIZE, RAW_TEXT_MAX_LEN);
+             RAW_TEXT_QUEUE_SIZE, (int)sizeof(raw_text_item_t));
     
     // 创建分句队列
-    s_tts->sentence_queue = xQueueCreate(SENTENCE_QUEUE_SIZE, SENTENCE_MAX_LEN);
+    s_tts->sentence_queue = xQueueCreate(SENTENCE_QUEUE_SIZE, sizeof(sentence_item_t));
     if (s_tts->sentence_queue == NULL) {
         ESP_LOGE(TAG, "Failed to create sentence queue");
         goto cleanup;
     }
     ESP_LOGI(TAG, "Sentence queue created (size: %d, item: %d bytes)", 
-             SENTENCE_QUEUE_SIZE, SENTENCE_MAX_LEN);
+             SENTENCE_QUEUE_SIZE, (int)sizeof(sentence_item_t));
     
-    // 创建播放完成信号量
-    s_tts->play_done_sem = xSemaphoreCreateBinary();
-    if (s_tts->play_done_sem == NULL) {
-        ESP_LOGE(TAG, "Failed to create play done semaphore");
+    // 创建打断确认信号量和提示音锁
+    s_tts->stop_ack_sem = xSemaphoreCreateBinary();
+    s_tts->earcon_lock = xSemaphoreCreateMutex();
+    if (s_tts->stop_ack_sem == NULL || s_tts->earcon_lock == NULL) {
+        ESP_LOGE(TAG, "Failed to create semaphores");
         goto cleanup;
     }
-    ESP_LOGI(TAG, "Play done semaphore created");
     
-    // 初始化 I2C 设备
-    esp_err_t ret = init_i2c_devices((i2c_master_bus_handle_t)s_tts->config.i2c_bus_handle);
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "I2C devices init failed, continuing without PA control");
+    // 获取共享的百度 token 提供者 (从 NVS 加载缓存的 token，没有缓存时立即在后台获取)
+    baidu_auth_config_t auth_cfg = {
+        .api_key = s_tts->config.api_key,
+        .secret_key = s_tts->config.secret_key,
+    };
+    if (baidu_auth_acquire(&auth_cfg) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to acquire Baidu auth provider");
+        goto cleanup;
     }
+    s_tts->auth_acquired = true;
     
-    // 初始化 ES8311 编解码器
-    ret = init_es8311_codec();
+    // 获取共享音频输出并打开语音流和提示音流
+    audio_output_config_t output_cfg = {
+        .i2s_mclk_pin = s_tts->config.i2s_mclk_pin,
+        .i2s_bclk_pin = s_tts->config.i2s_bclk_pin,
+        .i2s_ws_pin = s_tts->config.i2s_ws_pin,
+        .i2s_dout_pin = s_tts->config.i2s_dout_pin,
+        .i2c_bus_handle = s_tts->config.i2c_bus_handle,
+    };
+    esp_err_t ret = audio_output_acquire(&output_cfg);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to init ES8311 codec");
+        ESP_LOGE(TAG, "Failed to acquire audio output");
         goto cleanup;
     }
+    s_tts->output_acquired = true;
     
-    // 使能音频放大器
-    if (s_tts->pca9557_dev != NULL) {
-        enable_audio_pa(true);
+    audio_output_stream_config_t tts_stream_cfg = {
+        .buffer_size = TTS_STREAM_BUFFER_SIZE,
+    };
+    audio_output_stream_config_t earcon_stream_cfg = {
+        .buffer_size = EARCON_STREAM_BUFFER_SIZE,
+        .fade_in_frames = EARCON_FADE_IN_FRAMES,
+        .duck_others = true,
+    };
+    if (audio_output_stream_open(&tts_stream_cfg, &s_tts->tts_stream) != ESP_OK ||
+        audio_output_stream_open(&earcon_stream_cfg, &s_tts->earcon_stream) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open audio streams");
+        goto cleanup;
     }
     
     // 创建分句任务
@@ -1195,6 +1798,25 @@ esp_err_t streaming_tts_init(const streaming_tts_config_t *config) {
         goto cleanup;
     }
     
+    // 对冲请求工作任务
+    if (s_tts->config.hedge_requests) {
+        s_tts->req_events = xEventGroupCreate();
+        if (s_tts->req_events == NULL) {
+            ESP_LOGE(TAG, "Failed to create request event group");
+            goto cleanup;
+        }
+        for (int i = 0; i < HEDGE_SLOTS; i++) {
+            tts_req_slot_t *slot = &s_tts->req_slots[i];
+            slot->index = (uint8_t)i;
+            char name[16];
+            snprintf(name, sizeof(name), "tts_req%d", i);
+            if (xTaskCreate(tts_request_worker, name, HEDGE_WORKER_STACK, slot, 5, &slot->task) != pdPASS) {
+                ESP_LOGE(TAG, "Failed to create request worker %d", i);
+                goto cleanup;
+            }
+        }
+    }
+    
     // 创建 TTS 播放任务
     task_ret = xTaskCreate(
         player_task,
@@ -1214,10 +1836,10 @@ esp_err_t streaming_tts_init(const streaming_tts_config_t *config) {
     return ESP_OK;
 
 cleanup:
-    // 清理已分配的资源
-    if (s_tts->splitter_task != NULL) {
-        s_tts->should_stop = true;
-        vTaskDelay(pdMS_TO_TICKS(200));
+    // 清理已分配的资源 (先等已创建的任务退出)
+    stop_tasks();
+    if (s_tts->task_exit != NULL) {
+        vEventGroupDelete(s_tts->task_exit);
     }
     if (s_tts->raw_text_queue != NULL) {
         vQueueDelete(s_tts->raw_text_queue);
@@ -1225,12 +1847,22 @@ cleanup:
     if (s_tts->sentence_queue != NULL) {
         vQueueDelete(s_tts->sentence_queue);
     }
-    if (s_tts->codec_dev != NULL) {
-        esp_codec_dev_close(s_tts->codec_dev);
-        esp_codec_dev_delete(s_tts->codec_dev);
+    if (s_tts->stop_ack_sem != NULL) {
+        vSemaphoreDelete(s_tts->stop_ack_sem);
+    }
+    if (s_tts->earcon_lock != NULL) {
+        vSemaphoreDelete(s_tts->earcon_lock);
+    }
+    if (s_tts->req_events != NULL) {
+        vEventGroupDelete(s_tts->req_events);
     }
-    if (s_tts->i2s_tx_handle != NULL) {
-        i2s_del_channel(s_tts->i2s_tx_handle);
+    audio_output_stream_close(s_tts->tts_stream);
+    audio_output_stream_close(s_tts->earcon_stream);
+    if (s_tts->output_acquired) {
+        audio_output_release();
+    }
+    if (s_tts->auth_acquired) {
+        baidu_auth_release();
     }
     if (s_tts->config.api_key != NULL) {
         free((void *)s_tts->config.api_key);
@@ -1248,11 +1880,24 @@ cleanup:
  * 推送文本到流式 TTS 处理流程
  * 
  * 将 SSE 接收到的文本追加到原始文本队列，由分句器异步处理。
- * 如果队列已满，会阻塞等待直到队列有空间（最多 5 秒超时）。
+ * 如果队列已满，会阻塞等待直到队列有空间 (本轮被 stop 时放弃)。
  * 
  * Requirements: 1.1, 1.2, 5.2
  */
 esp_err_t streaming_tts_push_text(const char *text) {
+    if (s_tts == NULL || !s_tts->initialized) {
+        ESP_LOGW(TAG, "Streaming TTS not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    return streaming_tts_push_text_turn(text, s_tts->generation);
+}
+
+/**
+ * 推送属于指定轮次的文本
+ * 
+ * 每个片段带着轮次进入原始文本队列，分句、合成和播放各阶段据此丢弃旧轮次的工作。
+ */
+esp_err_t streaming_tts_push_text_turn(const char *text, uint32_t turn) {
     // 检查服务是否已初始化
     if (s_tts == NULL || !s_tts->initialized) {
         ESP_LOGW(TAG, "Streaming TTS not initialized");
@@ -1264,11 +1909,22 @@ esp_err_t streaming_tts_push_text(const char *text) {
         return ESP_OK;
     }
     
+    // 上一轮迟到的 SSE 片段
+    if (turn != s_tts->generation) {
+        s_tts->stats.stale_fragments_dropped++;
+        ESP_LOGD(TAG, "Dropping text from stale turn %lu", (unsigned long)turn);
+        return ESP_OK;
+    }
+    
     // 重置流结束标志（有新数据进来表示流还在继续）
     s_tts->stream_ended = false;
     
+    // 文本已经开始到达，提前打开功放
+    audio_output_pa_prewarm();
+    
     // 准备文本缓冲区
-    char text_buf[RAW_TEXT_MAX_LEN];
+    raw_text_item_t item = {.generation = turn};
+    char *text_buf = item.text;
     size_t text_len = strlen(text);
     
     // 如果文本超过最大长度，需要分段发送
@@ -1283,10 +1939,12 @@ esp_err_t streaming_tts_push_text(const char *text) {
         text_buf[chunk_len] = '\0';
         
         // 发送到原始文本队列 (Requirements 1.1)
-        // 如果队列已满，阻塞等待直到队列有空间 (Requirements 1.2)
-        if (xQueueSend(s_tts->raw_text_queue, text_buf, pdMS_TO_TICKS(QUEUE_SEND_TIMEOUT_MS)) != pdTRUE) {
-            ESP_LOGW(TAG, "Raw text queue full, timeout after %d ms", QUEUE_SEND_TIMEOUT_MS);
-            return ESP_ERR_TIMEOUT;
+        // 如果队列已满，阻塞等待直到队列有空间 (Requirements 1.2)；等待期间轮次过期则丢弃
+        while (xQueueSend(s_tts->raw_text_queue, &item, pdMS_TO_TICKS(QUEUE_RECV_TIMEOUT_MS)) != pdTRUE) {
+            if (turn != s_tts->generation || s_tts->should_stop) {
+                s_tts->stats.stale_fragments_dropped++;
+                return ESP_OK;
+            }
         }
         
         ESP_LOGD(TAG, "Text pushed to queue (%zu bytes): %s", chunk_len, text_buf);
@@ -1305,11 +1963,26 @@ esp_err_t streaming_tts_push_text(const char *text) {
  * Requirements: 1.3, 2.3
  */
 esp_err_t streaming_tts_end_stream(void) {
+    if (s_tts == NULL || !s_tts->initialized) {
+        ESP_LOGW(TAG, "Streaming TTS not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    return streaming_tts_end_stream_turn(s_tts->generation);
+}
+
+/**
+ * 标记指定轮次的文本流结束，上一轮迟到的断开事件被忽略
+ */
+esp_err_t streaming_tts_end_stream_turn(uint32_t turn) {
     // 检查服务是否已初始化
     if (s_tts == NULL || !s_tts->initialized) {
         ESP_LOGW(TAG, "Streaming TTS not initialized");
         return ESP_ERR_INVALID_STATE;
     }
+    if (turn != s_tts->generation) {
+        ESP_LOGD(TAG, "Ignoring end of stale turn %lu", (unsigned long)turn);
+        return ESP_OK;
+    }
     
     // 标记流结束 (Requirements 1.3)
     // 分句任务会检测此标志并处理剩余文本 (Requirements 2.3)
@@ -1322,8 +1995,9 @@ esp_err_t streaming_tts_end_stream(void) {
 /**
  * 停止播放并清空所有队列
  * 
- * 立即停止当前播放，清空原始文本队列和分句队列，
- * 重置内部状态以便接收新的文本流。
+ * 递增代次使所有在途的合成请求和播放失效，清空原始文本队列和分句队列，
+ * 重置内部状态以便接收新的文本流。如果正在播放，等待播放任务完成淡出
+ * 和 DMA 清空后返回，并记录 stop 到静音的耗时。
  * 
  * Requirements: 4.1
  */
@@ -1335,11 +2009,16 @@ esp_err_t streaming_tts_stop(void) {
     }
     
     ESP_LOGI(TAG, "Stopping streaming TTS...");
+    int64_t start_us = esp_timer_get_time();
     
-    // 设置停止标志，通知播放任务停止当前播放
     // 注意：这里不设置 should_stop，因为那会导致任务退出
     // 我们只是想停止当前播放，而不是销毁服务
     
+    // 丢弃之前残留的确认信号，再递增代次通知播放任务
+    xSemaphoreTake(s_tts->stop_ack_sem, 0);
+    s_tts->generation++;
+    bool was_playing = s_tts->is_playing;
+    
     // 清空原始文本队列 (Requirements 4.1)
     if (s_tts->raw_text_queue != NULL) {
         xQueueReset(s_tts->raw_text_queue);
@@ -1358,17 +2037,136 @@ esp_err_t streaming_tts_stop(void) {
     // 清空分句缓冲区
     s_tts->buffer_pos = 0;
     memset(s_tts->sentence_buffer, 0, SENTENCE_BUFFER_SIZE);
-    
-    // 通知播放停止回调
-    if (s_tts->is_playing && s_tts->config.on_stop) {
-        s_tts->config.on_stop();
+    s_tts->pending_since_us = 0;
+    s_tts->last_split_us = 0;
+    s_tts->speculative_at_us = 0;
+    
+    // 等待播放任务淡出并清空 DMA
+    s_tts->stats.stops++;
+    if (was_playing) {
+        if (xSemaphoreTake(s_tts->stop_ack_sem, pdMS_TO_TICKS(STOP_ACK_TIMEOUT_MS)) != pdTRUE) {
+            ESP_LOGW(TAG, "Player did not acknowledge stop within %d ms", STOP_ACK_TIMEOUT_MS);
+        }
+        
+        uint32_t latency_us = (uint32_t)(esp_timer_get_time() - start_us);
+        s_tts->stats.last_stop_latency_us = latency_us;
+        if (latency_us > s_tts->stats.max_stop_latency_us) {
+            s_tts->stats.max_stop_latency_us = latency_us;
+        }
+        ESP_LOGI(TAG, "Stop-to-silence latency: %lu us", (unsigned long)latency_us);
     }
-    s_tts->is_playing = false;
     
     ESP_LOGI(TAG, "Streaming TTS stopped, ready for new stream");
     return ESP_OK;
 }
 
+/**
+ * 开始新的一轮
+ */
+uint32_t streaming_tts_begin_turn(void) {
+    if (s_tts == NULL || !s_tts->initialized) {
+        return 0;
+    }
+    streaming_tts_stop();
+    return s_tts->generation;
+}
+
+/**
+ * 获取当前轮次
+ */
+uint32_t streaming_tts_get_turn(void) {
+    return s_tts != NULL ? s_tts->generation : 0;
+}
+
+/**
+ * 获取音频时钟
+ * 
+ * 当前句子的播放位置由语音输出流经 on_sent 确认的帧数推算，精度为一个 DMA 缓冲区
+ * (240 帧，15ms)。
+ */
+esp_err_t streaming_tts_get_clock(streaming_tts_clock_t *clock) {
+    if (clock == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_tts == NULL || !s_tts->initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    audio_output_position_t pos;
+    audio_output_stats_t output_stats;
+    audio_output_stream_get_position(s_tts->tts_stream, &pos);
+    if (audio_output_get_stats(&output_stats) != ESP_OK) {
+        memset(&output_stats, 0, sizeof(output_stats));
+    }
+    
+    const audio_clock_t *src = &s_tts->clock;
+    portENTER_CRITICAL(&s_clock_lock);
+    clock->active = src->active;
+    clock->turn = src->turn;
+    clock->sentence = src->sentence;
+    clock->sentence_bytes = src->sentence_bytes;
+    clock->byte_offset = 0;
+    if (src->active && pos.frames_played > src->sentence_start_frame) {
+        uint64_t frames = (pos.frames_played - src->sentence_start_frame) * src->rate_q8 / AUDIO_DSP_RATE_UNITY;
+        clock->byte_offset = (size_t)frames * sizeof(int16_t);
+        if (clock->byte_offset > src->sentence_bytes) {
+            clock->byte_offset = src->sentence_bytes;
+        }
+    }
+    portEXIT_CRITICAL(&s_clock_lock);
+    
+    clock->frames_played = output_stats.frames_played;
+    clock->output_latency_us = output_stats.last_latency_us;
+    clock->avg_output_latency_us = output_stats.avg_latency_us;
+    clock->sample_rate = SAMPLE_RATE;
+    return ESP_OK;
+}
+
+/**
+ * 播放提示音
+ * 
+ * 提示音写入独立的输出流，与语音叠加输出；播放期间语音自动压低。
+ * 提示音流缓冲区满时阻塞到剩余数据能够放入为止。
+ */
+esp_err_t streaming_tts_play_earcon(const int16_t *pcm, size_t samples, uint16_t gain_q15) {
+    if (pcm == NULL || samples == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_tts == NULL || !s_tts->initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    xSemaphoreTake(s_tts->earcon_lock, portMAX_DELAY);
+    
+    // 提示音流从空闲恢复时由混音器自动淡入，避免起始处的咔哒声
+    audio_output_stream_set_gain(s_tts->earcon_stream, gain_q15, EARCON_FADE_IN_FRAMES);
+    audio_output_set_pa(true);
+    
+    size_t offset = 0;
+    while (offset < samples) {
+        offset += audio_output_stream_write(s_tts->earcon_stream, pcm + offset, samples - offset,
+                                            pdMS_TO_TICKS(10));
+    }
+    
+    xSemaphoreGive(s_tts->earcon_lock);
+    return ESP_OK;
+}
+
+/**
+ * 获取运行统计
+ */
+esp_err_t streaming_tts_get_stats(streaming_tts_stats_t *stats) {
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_tts == NULL || !s_tts->initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    *stats = s_tts->stats;
+    return ESP_OK;
+}
+
 /**
  * 查询是否正在播放
  * 
@@ -1406,17 +2204,10 @@ void streaming_tts_destroy(void) {
     // 标记服务为未初始化，防止其他函数继续使用
     s_tts->initialized = false;
     
-    // 设置停止标志，通知所有任务退出 (Requirements 5.4)
-    s_tts->should_stop = true;
-    
-    // 等待任务退出
-    // 给任务足够的时间来检测停止标志并清理
-    vTaskDelay(pdMS_TO_TICKS(300));
-    
-    // 禁用音频放大器
-    if (s_tts->pa_enabled && s_tts->pca9557_dev != NULL) {
-        enable_audio_pa(false);
-    }
+    // 通知所有任务退出并等待它们结束，之后不再有任务访问 s_tts (Requirements 5.4)
+    stop_tasks();
+    vEventGroupDelete(s_tts->task_exit);
+    s_tts->task_exit = NULL;
     
     // 删除队列 (Requirements 5.4 - 释放所有资源)
     if (s_tts->raw_text_queue != NULL) {
@@ -1430,26 +2221,28 @@ void streaming_tts_destroy(void) {
         ESP_LOGD(TAG, "Sentence queue deleted");
     }
     
-    // 删除播放完成信号量
-    if (s_tts->play_done_sem != NULL) {
-        vSemaphoreDelete(s_tts->play_done_sem);
-        s_tts->play_done_sem = NULL;
-        ESP_LOGD(TAG, "Play done semaphore deleted");
+    // 删除信号量
+    if (s_tts->stop_ack_sem != NULL) {
+        vSemaphoreDelete(s_tts->stop_ack_sem);
+        s_tts->stop_ack_sem = NULL;
     }
-    
-    // 关闭并删除编解码器设备
-    if (s_tts->codec_dev != NULL) {
-        esp_codec_dev_close(s_tts->codec_dev);
-        esp_codec_dev_delete(s_tts->codec_dev);
-        s_tts->codec_dev = NULL;
-        ESP_LOGD(TAG, "Codec device closed and deleted");
+    if (s_tts->earcon_lock != NULL) {
+        vSemaphoreDelete(s_tts->earcon_lock);
+        s_tts->earcon_lock = NULL;
+    }
+    if (s_tts->req_events != NULL) {
+        vEventGroupDelete(s_tts->req_events);
+        s_tts->req_events = NULL;
     }
     
-    // 删除 I2S 通道
-    if (s_tts->i2s_tx_handle != NULL) {
-        i2s_del_channel(s_tts->i2s_tx_handle);
-        s_tts->i2s_tx_handle = NULL;
-        ESP_LOGD(TAG, "I2S channel deleted");
+    // 关闭输出流并释放共享音频输出 (最后一个使用者释放时关闭功放和 I2S)
+    audio_output_stream_close(s_tts->tts_stream);
+    audio_output_stream_close(s_tts->earcon_stream);
+    s_tts->tts_stream = NULL;
+    s_tts->earcon_stream = NULL;
+    if (s_tts->output_acquired) {
+        audio_output_release();
+        s_tts->output_acquired = false;
     }
     
     // 释放音频缓冲区
@@ -1459,10 +2252,10 @@ void streaming_tts_destroy(void) {
         ESP_LOGD(TAG, "Audio buffer freed");
     }
     
-    // 释放 access_token
-    if (s_tts->access_token != NULL) {
-        free(s_tts->access_token);
-        s_tts->access_token = NULL;
+    // 释放 token 提供者引用
+    if (s_tts->auth_acquired) {
+        baidu_auth_release();
+        s_tts->auth_acquired = false;
     }
     
     // 释放配置中的字符串（深拷贝的副本）
@@ -12,6 +12,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 
 #ifdef __cplusplus
@@ -45,8 +46,60 @@ typedef struct {
     // 事件回调 (可选)
     streaming_tts_callback_t on_start;  ///< 开始播放回调
     streaming_tts_callback_t on_stop;   ///< 停止播放回调
+    
+    // 句首尾静音裁剪 (可选，0 使用默认值)
+    uint16_t silence_pad_ms;    ///< 句首尾保留的静音时长，默认 40ms，上限 80ms
+    uint16_t silence_threshold; ///< 静音门限 (10ms 块的平均幅度)，默认 200
+    
+    // 对冲请求 (可选)：首包超过近期 P90 仍未到达时在第二个连接上重发，
+    // 先响应的一方胜出；对冲率不超过 10%，额外占用两个 8KB 栈的工作任务
+    bool hedge_requests;
 } streaming_tts_config_t;
 
+/**
+ * 流式 TTS 运行统计
+ */
+typedef struct {
+    uint32_t stops;                     ///< streaming_tts_stop 调用次数
+    uint32_t last_stop_latency_us;      ///< 最近一次 stop 到静音的耗时 (仅统计播放中的 stop)
+    uint32_t max_stop_latency_us;       ///< stop 到静音的最大耗时
+    uint32_t late_results_dropped;      ///< stop 之后才返回而被丢弃的合成结果数
+    uint32_t punctuation_splits;        ///< 按句末标点切出的句子数
+    uint32_t speculative_flushes;       ///< 超时无标点而推测性切出的片段数
+    uint32_t overflow_splits;           ///< 分句缓冲区放不下新片段而提前切出的片段数
+    uint32_t speculative_timeout_ms;    ///< 当前自适应推测超时
+    uint32_t ttfa_saved_ms_total;       ///< 推测性切分相对等待句末标点累计提前的时间
+    uint32_t ttfa_saved_ms_max;         ///< 单次推测性切分提前的最大时间
+    uint32_t silence_trimmed_ms;        ///< 裁剪掉的句首尾静音累计时长
+    uint32_t hedges_fired;              ///< 发出的对冲请求数
+    uint32_t hedges_won;                ///< 对冲请求先于主请求响应的次数
+    uint32_t hedge_threshold_ms;        ///< 当前对冲阈值 (近期首包耗时 P90)
+    uint32_t stretched_sentences;       ///< 因积压加速播放的句子数
+    uint16_t playback_rate_q8;          ///< 当前播放速率 (Q8，256 为原速)
+    uint32_t stale_fragments_dropped;   ///< 属于旧轮次而被丢弃的文本片段数
+    uint32_t stale_sentences_dropped;   ///< 属于旧轮次而未发起合成的句子数
+    uint32_t synth_aborted;             ///< 排队或下载中被 stop 中止的合成请求数
+    uint32_t stale_audio_skipped_ms;    ///< 被 stop 打断而未播放的语音时长
+} streaming_tts_stats_t;
+
+/**
+ * 音频时钟
+ * 
+ * 以 I2S on_sent 回调确认输出的帧数为准，把播放进度映射回 (轮次, 句子, 字节偏移)。
+ * 轮次即 streaming_tts_stop 递增的代次，句子序号在每个轮次内从 0 开始。
+ */
+typedef struct {
+    bool active;                        ///< 是否有句子正在播放
+    uint32_t turn;                      ///< 当前句子所属轮次
+    uint32_t sentence;                  ///< 当前句子在轮次内的序号
+    size_t byte_offset;                 ///< 当前句子已实际输出的字节数
+    size_t sentence_bytes;              ///< 当前句子的 PCM 总字节数
+    uint64_t frames_played;             ///< 音频输出初始化以来实际输出的帧数 (混音后，含所有流)
+    uint32_t sample_rate;               ///< 采样率 (帧/秒)
+    uint32_t output_latency_us;         ///< 最近一次测得的 esp_codec_dev_write 到 DMA 发送完成的延迟
+    uint32_t avg_output_latency_us;     ///< 输出延迟的滑动平均
+} streaming_tts_clock_t;
+
 /**
  * 初始化流式 TTS 服务
  * 
@@ -66,12 +119,24 @@ esp_err_t streaming_tts_init(const streaming_tts_config_t *config);
  * 如果队列已满，会阻塞等待直到队列有空间。
  * 
  * @param text 要推送的文本
- * @return ESP_OK 成功，ESP_ERR_TIMEOUT 队列满超时
+ * @return ESP_OK 成功
  * 
  * Requirements: 1.1, 1.2, 5.2
  */
 esp_err_t streaming_tts_push_text(const char *text);
 
+/**
+ * 推送属于指定轮次的文本
+ * 
+ * 调用者在开始一轮对话时用 streaming_tts_begin_turn 记下轮次，
+ * 此后该轮的文本都带上这个轮次推送；上一轮迟到的片段在入队前即被丢弃。
+ * 
+ * @param text 要推送的文本
+ * @param turn 文本所属轮次
+ * @return ESP_OK 成功 (含被丢弃的旧轮次文本)
+ */
+esp_err_t streaming_tts_push_text_turn(const char *text, uint32_t turn);
+
 /**
  * 标记文本流结束
  * 
@@ -83,10 +148,20 @@ esp_err_t streaming_tts_push_text(const char *text);
  */
 esp_err_t streaming_tts_end_stream(void);
 
+/**
+ * 标记指定轮次的文本流结束，轮次已过期时忽略
+ * 
+ * @param turn 文本流所属轮次
+ * @return ESP_OK 成功
+ */
+esp_err_t streaming_tts_end_stream_turn(uint32_t turn);
+
 /**
  * 停止播放并清空所有队列
  * 
  * 立即停止当前播放，清空原始文本队列和分句队列。
+ * 正在进行的合成请求会被关闭，正在播放的句子淡出后清空 DMA，
+ * 函数在输出静音后返回 (最多等待 100ms)。
  * 
  * @return ESP_OK 成功
  * 
@@ -94,6 +169,27 @@ esp_err_t streaming_tts_end_stream(void);
  */
 esp_err_t streaming_tts_stop(void);
 
+/**
+ * 开始新的一轮
+ * 
+ * 服务已初始化时等同于 streaming_tts_stop (上一轮的文本、句子、合成和播放全部丢弃)，
+ * 返回新的轮次；未初始化时什么也不做，返回 0。在发出新一轮请求时调用，
+ * 随后用返回的轮次推送本轮文本，上一轮迟到的片段因轮次过期而被丢弃。
+ * 
+ * @return 新的轮次
+ */
+uint32_t streaming_tts_begin_turn(void);
+
+/**
+ * 获取当前轮次
+ * 
+ * 轮次即代次，每次 streaming_tts_stop 递增；文本片段、句子、合成请求和播放都带着轮次，
+ * 各阶段丢弃旧轮次的工作。
+ * 
+ * @return 当前轮次
+ */
+uint32_t streaming_tts_get_turn(void);
+
 /**
  * 查询是否正在播放
  * 
@@ -103,6 +199,37 @@ esp_err_t streaming_tts_stop(void);
  */
 bool streaming_tts_is_playing(void);
 
+/**
+ * 获取音频时钟
+ * 
+ * 可在任意任务中调用，例如 UI 据此高亮正在播报的句子。
+ * 
+ * @param clock 输出时钟数据
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 服务未初始化
+ */
+esp_err_t streaming_tts_get_clock(streaming_tts_clock_t *clock);
+
+/**
+ * 播放提示音
+ * 
+ * 提示音与语音在软件混音器中叠加输出，无需停止 TTS；提示音播放期间语音压低 6dB。
+ * 数据被复制进混音器后即返回，调用者可立即释放 pcm。
+ * 
+ * @param pcm 16kHz 单声道 16 位 PCM
+ * @param samples 采样数
+ * @param gain_q15 增益 (Q15，32767 为原始音量)
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 服务未初始化
+ */
+esp_err_t streaming_tts_play_earcon(const int16_t *pcm, size_t samples, uint16_t gain_q15);
+
+/**
+ * 获取运行统计
+ * 
+ * @param stats 输出统计数据
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 服务未初始化
+ */
+esp_err_t streaming_tts_get_stats(streaming_tts_stats_t *stats);
+
 /**
  * 销毁流式 TTS 服务
  * 
@@ -0,0 +1,209 @@
+/**
+ * TTS 请求调度器实现
+ */
+
+#include "tts_scheduler.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "cJSON.h"
+#include <string.h>
+
+static const char *TAG = "TTS_SCHED";
+
+#define TOKEN_UNIT          1000000LL   // 一个令牌 (以百万分之一令牌计)
+#define SCHED_POLL_MS       20          // 等待期间检查中止和优先级的间隔
+#define RATE_RECOVER_DIV    20          // 每次成功请求恢复上限的 1/20
+
+// 直方图各桶上界 (ms)，最后一桶不设上界
+static const uint16_t s_hist_bounds_ms[TTS_SCHED_HIST_BUCKETS - 1] = {10, 50, 100, 250, 500, 1000, 2000};
+
+static portMUX_TYPE s_sched_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static struct {
+    uint32_t max_qps_milli;
+    uint32_t burst;
+    int64_t tokens;                     // 百万分之一令牌
+    int64_t last_refill_us;
+    uint8_t waiting[TTS_SCHED_PRIORITY_COUNT];
+    tts_sched_stats_t stats;
+} s_sched = {
+    .max_qps_milli = TTS_SCHED_DEFAULT_QPS_MILLI,
+    .burst = TTS_SCHED_DEFAULT_BURST,
+    .tokens = TTS_SCHED_DEFAULT_BURST * TOKEN_UNIT,
+    .stats.rate_qps_milli = TTS_SCHED_DEFAULT_QPS_MILLI,
+};
+
+/**
+ * 按经过的时间补充令牌 (调用者持有锁)
+ */
+static void refill(int64_t now_us) {
+    if (s_sched.last_refill_us != 0) {
+        s_sched.tokens += (now_us - s_sched.last_refill_us) * s_sched.stats.rate_qps_milli / 1000;
+        if (s_sched.tokens > (int64_t)s_sched.burst * TOKEN_UNIT) {
+            s_sched.tokens = (int64_t)s_sched.burst * TOKEN_UNIT;
+        }
+    }
+    s_sched.last_refill_us = now_us;
+}
+
+/**
+ * 记录一次排队耗时 (调用者持有锁)
+ */
+static void record_wait(tts_sched_priority_t priority, uint32_t wait_ms) {
+    int bucket = 0;
+    while (bucket < TTS_SCHED_HIST_BUCKETS - 1 && wait_ms >= s_hist_bounds_ms[bucket]) {
+        bucket++;
+    }
+    s_sched.stats.wait_hist[priority][bucket]++;
+    if (wait_ms > s_sched.stats.wait_max_ms[priority]) {
+        s_sched.stats.wait_max_ms[priority] = wait_ms;
+    }
+}
+
+void tts_sched_set_limit(uint32_t qps_milli, uint32_t burst) {
+    if (qps_milli < TTS_SCHED_MIN_QPS_MILLI) {
+        qps_milli = TTS_SCHED_MIN_QPS_MILLI;
+    }
+    if (burst == 0) {
+        burst = 1;
+    }
+    
+    portENTER_CRITICAL(&s_sched_lock);
+    s_sched.max_qps_milli = qps_milli;
+    s_sched.burst = burst;
+    if (s_sched.stats.rate_qps_milli > qps_milli) {
+        s_sched.stats.rate_qps_milli = qps_milli;
+    }
+    if (s_sched.tokens > (int64_t)burst * TOKEN_UNIT) {
+        s_sched.tokens = (int64_t)burst * TOKEN_UNIT;
+    }
+    portEXIT_CRITICAL(&s_sched_lock);
+}
+
+esp_err_t tts_sched_acquire(tts_sched_priority_t priority, TickType_t timeout,
+                            tts_sched_abort_fn abort, void *ctx) {
+    if (priority >= TTS_SCHED_PRIORITY_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    int64_t start_us = esp_timer_get_time();
+    TickType_t start_tick = xTaskGetTickCount();
+    esp_err_t ret = ESP_ERR_TIMEOUT;
+    
+    portENTER_CRITICAL(&s_sched_lock);
+    s_sched.waiting[priority]++;
+    portEXIT_CRITICAL(&s_sched_lock);
+    
+    while (true) {
+        int64_t now_us = esp_timer_get_time();
+        uint32_t delay_ms = SCHED_POLL_MS;
+        bool granted = false;
+        
+        portENTER_CRITICAL(&s_sched_lock);
+        refill(now_us);
+        bool ahead = false;
+        for (int p = 0; p < (int)priority; p++) {
+            ahead |= s_sched.waiting[p] > 0;
+        }
+        if (!ahead && s_sched.tokens >= TOKEN_UNIT) {
+            s_sched.tokens -= TOKEN_UNIT;
+            s_sched.stats.granted[priority]++;
+            record_wait(priority, (uint32_t)((now_us - start_us) / 1000));
+            granted = true;
+        } else if (!ahead) {
+            // 睡到下一个令牌补满
+            uint32_t need_ms = (uint32_t)((TOKEN_UNIT - s_sched.tokens) / s_sched.stats.rate_qps_milli) + 1;
+            if (need_ms < delay_ms) {
+                delay_ms = need_ms;
+            }
+        }
+        portEXIT_CRITICAL(&s_sched_lock);
+        
+        if (granted) {
+            ret = ESP_OK;
+            break;
+        }
+        if (abort != NULL && abort(ctx)) {
+            ret = ESP_ERR_INVALID_STATE;
+            break;
+        }
+        TickType_t elapsed = xTaskGetTickCount() - start_tick;
+        if (elapsed >= timeout) {
+            break;
+        }
+        TickType_t ticks = pdMS_TO_TICKS(delay_ms);
+        if (ticks == 0) {
+            ticks = 1;
+        }
+        vTaskDelay(ticks < timeout - elapsed ? ticks : timeout - elapsed);
+    }
+    
+    portENTER_CRITICAL(&s_sched_lock);
+    s_sched.waiting[priority]--;
+    if (ret != ESP_OK && timeout > 0) {
+        s_sched.stats.timeouts[priority]++;
+    }
+    portEXIT_CRITICAL(&s_sched_lock);
+    return ret;
+}
+
+void tts_sched_feedback(bool throttled) {
+    uint32_t rate;
+    portENTER_CRITICAL(&s_sched_lock);
+    if (throttled) {
+        // 乘性减速，桶内剩余令牌作废，避免紧接着的突发再次触发限流
+        rate = s_sched.stats.rate_qps_milli / 2;
+        if (rate < TTS_SCHED_MIN_QPS_MILLI) {
+            rate = TTS_SCHED_MIN_QPS_MILLI;
+        }
+        s_sched.tokens = 0;
+        s_sched.stats.throttled++;
+    } else {
+        // 加性恢复
+        rate = s_sched.stats.rate_qps_milli + s_sched.max_qps_milli / RATE_RECOVER_DIV;
+        if (rate > s_sched.max_qps_milli) {
+            rate = s_sched.max_qps_milli;
+        }
+    }
+    s_sched.stats.rate_qps_milli = rate;
+    portEXIT_CRITICAL(&s_sched_lock);
+    
+    if (throttled) {
+        ESP_LOGW(TAG, "TTS throttled by server, rate lowered to %lu.%03lu QPS",
+                 (unsigned long)(rate / 1000), (unsigned long)(rate % 1000));
+    }
+}
+
+bool tts_sched_is_throttle_error(int status_code, const char *body, size_t len) {
+    if (status_code == 429) {
+        return true;
+    }
+    if (body == NULL || len == 0 || body[0] != '{') {
+        return false;
+    }
+    
+    // 百度开放平台通用错误码：4 集群请求超限，18 QPS 超限 (TTS 接口用 err_no，其余接口用 error_code)
+    cJSON *json = cJSON_ParseWithLength(body, len);
+    if (json == NULL) {
+        return false;
+    }
+    cJSON *code = cJSON_GetObjectItem(json, "err_no");
+    if (code == NULL) {
+        code = cJSON_GetObjectItem(json, "error_code");
+    }
+    bool limited = code != NULL && cJSON_IsNumber(code) && (code->valueint == 4 || code->valueint == 18);
+    cJSON_Delete(json);
+    return limited;
+}
+
+esp_err_t tts_sched_get_stats(tts_sched_stats_t *stats) {
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    portENTER_CRITICAL(&s_sched_lock);
+    *stats = s_sched.stats;
+    portEXIT_CRITICAL(&s_sched_lock);
+    return ESP_OK;
+}
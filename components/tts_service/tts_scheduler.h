@@ -0,0 +1,115 @@
+/**
+ * TTS 请求调度器
+ * 
+ * 百度 TTS 接口按 QPS 限流，流式合成、对冲请求和整段播放共用同一个配额。
+ * 所有 TTS 请求在建立连接前先从令牌桶取得令牌：
+ * - 令牌按当前速率补充，桶容量决定允许的突发请求数
+ * - 等待者按优先级排队，高优先级 (用户正在等待的首句) 先于预取请求取得令牌
+ * - 收到 HTTP 429 或百度 QPS 超限错误时速率减半，之后每次成功请求线性恢复 (AIMD)
+ * 
+ * 调度器是进程内单例，无需初始化；排队耗时按优先级记录为直方图。
+ */
+
+#ifndef TTS_SCHEDULER_H
+#define TTS_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TTS_SCHED_DEFAULT_QPS_MILLI 5000    ///< 默认速率上限 (千分之一请求/秒)
+#define TTS_SCHED_DEFAULT_BURST     2       ///< 默认桶容量 (请求数)
+#define TTS_SCHED_MIN_QPS_MILLI     500     ///< 限流反馈后速率的下限
+#define TTS_SCHED_HIST_BUCKETS      8       ///< 排队耗时直方图的桶数
+
+/**
+ * 请求优先级 (数值越小越优先)
+ */
+typedef enum {
+    TTS_SCHED_INTERACTIVE = 0,  ///< 用户正在等待的首句
+    TTS_SCHED_NORMAL,           ///< 播放中的后续句子
+    TTS_SCHED_PREFETCH,         ///< 预取、缓存预热和对冲请求
+    TTS_SCHED_PRIORITY_COUNT,
+} tts_sched_priority_t;
+
+/**
+ * 等待期间的中止检查
+ * 
+ * @param ctx 调用者上下文
+ * @return true 放弃等待
+ */
+typedef bool (*tts_sched_abort_fn)(void *ctx);
+
+/**
+ * 调度器统计
+ * 
+ * 直方图各桶的上界依次为 10、50、100、250、500、1000、2000ms，最后一桶为 2000ms 以上。
+ */
+typedef struct {
+    uint32_t rate_qps_milli;                                        ///< 当前速率
+    uint32_t throttled;                                             ///< 收到的限流响应数
+    uint32_t granted[TTS_SCHED_PRIORITY_COUNT];                     ///< 取得令牌的请求数
+    uint32_t timeouts[TTS_SCHED_PRIORITY_COUNT];                    ///< 等待超时或被中止的请求数
+    uint32_t wait_max_ms[TTS_SCHED_PRIORITY_COUNT];                 ///< 最长排队耗时
+    uint32_t wait_hist[TTS_SCHED_PRIORITY_COUNT][TTS_SCHED_HIST_BUCKETS];  ///< 排队耗时直方图
+} tts_sched_stats_t;
+
+/**
+ * 设置速率上限和桶容量
+ * 
+ * @param qps_milli 速率上限 (千分之一请求/秒)，不低于 TTS_SCHED_MIN_QPS_MILLI
+ * @param burst 桶容量 (请求数)，至少为 1
+ */
+void tts_sched_set_limit(uint32_t qps_milli, uint32_t burst);
+
+/**
+ * 取得一个请求令牌
+ * 
+ * 桶中没有令牌或有更高优先级的等待者时阻塞。timeout 为 0 时只尝试一次，
+ * 适合可以放弃的请求 (如对冲)。
+ * 
+ * @param priority 优先级
+ * @param timeout 最长等待时间
+ * @param abort 中止检查，可为 NULL，等待期间约每 20ms 调用一次
+ * @param ctx 中止检查的上下文
+ * @return ESP_OK 取得令牌，ESP_ERR_TIMEOUT 超时，ESP_ERR_INVALID_STATE 被中止
+ */
+esp_err_t tts_sched_acquire(tts_sched_priority_t priority, TickType_t timeout,
+                            tts_sched_abort_fn abort, void *ctx);
+
+/**
+ * 反馈一次请求的结果
+ * 
+ * @param throttled true 表示被服务端限流 (速率减半并清空令牌)，false 表示请求成功
+ */
+void tts_sched_feedback(bool throttled);
+
+/**
+ * 判断 HTTP 状态码或错误响应是否表示限流
+ * 
+ * @param status_code HTTP 状态码 (429 视为限流)
+ * @param body 响应体 (JSON)，可为 NULL
+ * @param len 响应体长度
+ * @return true 服务端限流
+ */
+bool tts_sched_is_throttle_error(int status_code, const char *body, size_t len);
+
+/**
+ * 获取统计信息
+ * 
+ * @param stats 输出统计信息
+ * @return ESP_OK 成功
+ */
+esp_err_t tts_sched_get_stats(tts_sched_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TTS_SCHEDULER_H
@@ -7,15 +7,17 @@
 #include "esp_log.h"
 #include "esp_http_client.h"
 #include "esp_crt_bundle.h"
-#include "esp_codec_dev.h"
-#include "esp_codec_dev_defaults.h"
 #include "esp_timer.h"
 #include "esp_heap_caps.h"
-#include "driver/i2s_std.h"
-#include "driver/i2c_master.h"
+#include "audio_output.h"
+#include "baidu_auth.h"
+#include "form_encoder.h"
+#include "tts_scheduler.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
@@ -25,495 +27,241 @@ static const char *TAG = "BAIDU_TTS";
 // 百度 TTS API 配置
 #define BAIDU_TTS_API_KEY    "your_api_key"      // 需要替换为你的 API Key
 #define BAIDU_TTS_SECRET_KEY "your_secret_key"   // 需要替换为你的 Secret Key
-#define BAIDU_TOKEN_URL      "https://aip.baidubce.com/oauth/2.0/token"
 #define BAIDU_TTS_URL        "https://tsn.baidu.com/text2audio"
+#define TOKEN_WAIT_TIMEOUT_MS 15000  // 没有可用 token 时等待后台刷新的最长时间
 
-// ES8311 音频编解码器地址
-#define ES8311_ADDR 0x30
-
-// PCA9557 IO 扩展芯片
-#define PCA9557_ADDR 0x19
-#define PCA9557_REG_OUTPUT 0x01
-
-#define TTS_TEXT_QUEUE_SIZE 20  // 增加队列大小以容纳更多文本片段
-#define TTS_MAX_TEXT_LEN 512
-#define SAMPLE_RATE 16000
+#define TTS_TEXT_QUEUE_SIZE 20  // 增加队列大小以容纳更多文本片段 (队列中只存文本指针)
+#define TTS_REQUEST_QUEUE_SIZE 1  // 预取深度：当前段播放时最多提前发出一段请求
+#define SAMPLE_RATE AUDIO_OUTPUT_SAMPLE_RATE
 #define AUDIO_BUFFER_SIZE (50 * 1024)  // 50KB 音频缓冲区，约 1.5 秒音频
+#define TTS_STREAM_BUFFER_SIZE (8 * 1024)  // 输出流缓冲区，约 250ms 音频
+
+// 任务退出事件位：销毁时等待所有任务退出后才释放状态
+#define TASK_EXIT_PLAYER BIT0
+#define TASK_EXIT_FETCH  BIT1
 
 typedef struct {
     tts_config_t config;
-    i2s_chan_handle_t i2s_tx_handle;
-    i2c_master_bus_handle_t i2c_bus;
-    i2c_master_dev_handle_t pca9557_dev;
     
-    // ESP Codec Dev
-    const audio_codec_data_if_t *data_if;
-    const audio_codec_ctrl_if_t *ctrl_if;
-    const audio_codec_gpio_if_t *gpio_if;
-    const audio_codec_if_t *codec_if;
-    esp_codec_dev_handle_t codec_dev;
+    // 共享音频输出
+    bool output_acquired;
+    audio_output_stream_t stream;
     
     // 百度 TTS
-    char *access_token;
-    int64_t token_expire_time;
+    bool auth_acquired;
     
     // 音频缓冲区
     uint8_t *audio_buffer;
     size_t audio_buffer_size;
     
-    QueueHandle_t text_queue;
+    QueueHandle_t text_queue;       // tts_job_t，待分段的文本
+    QueueHandle_t request_queue;    // tts_request_t，已发出待播放的分段请求
     TaskHandle_t task_handle;
+    TaskHandle_t fetch_task_handle;
+    EventGroupHandle_t task_exit;   // 任务退出前置位 TASK_EXIT_*
+    volatile uint32_t generation;   // tts_stop 时递增，用于丢弃旧文本的剩余分段
+    tts_stats_t stats;
     bool is_playing;
     bool should_stop;
     bool initialized;
-    bool pa_enabled;
 } tts_service_t;
 
 static tts_service_t *s_tts = NULL;
 
 
-// PCA9557 写寄存器
-static esp_err_t pca9557_write_reg(uint8_t reg, uint8_t data) {
-    if (s_tts == NULL || s_tts->pca9557_dev == NULL) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    uint8_t write_buf[2] = {reg, data};
-    return i2c_master_transmit(s_tts->pca9557_dev, write_buf, 2, -1);
-}
+// 音频流写入上下文
+typedef struct {
+    audio_output_stream_t stream;
+    uint32_t generation;        // 所属请求的代次，变化后停止写入
+    size_t total_len;
+    uint8_t pending_byte;       // 上一块末尾不足一个采样的字节
+    bool has_pending_byte;
+} http_streaming_audio_context_t;
 
-// PCA9557 读寄存器
-static esp_err_t pca9557_read_reg(uint8_t reg, uint8_t *data) {
-    if (s_tts == NULL || s_tts->pca9557_dev == NULL) {
-        return ESP_ERR_INVALID_STATE;
+// 分批写入采样，输出流满时每 10ms 检查一次代次，服务销毁或 tts_stop 后放弃剩余部分
+// 返回 false 表示被打断
+static bool write_stream_samples(http_streaming_audio_context_t *ctx, const int16_t *pcm, size_t count) {
+    size_t offset = 0;
+    while (offset < count) {
+        if (s_tts->should_stop || ctx->generation != s_tts->generation) {
+            return false;
+        }
+        offset += audio_output_stream_write(ctx->stream, pcm + offset, count - offset, pdMS_TO_TICKS(10));
     }
-    return i2c_master_transmit_receive(s_tts->pca9557_dev, &reg, 1, data, 1, -1);
+    return true;
 }
 
-// 使能/禁用音频放大器
-static esp_err_t enable_audio_pa(bool enable) {
-    if (s_tts == NULL || s_tts->pca9557_dev == NULL) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    uint8_t data;
-    esp_err_t ret = pca9557_read_reg(PCA9557_REG_OUTPUT, &data);
-    if (ret != ESP_OK) {
-        return ret;
+// 将字节流按 16bit 采样写入输出流，跨块的奇数字节留到下一块拼接
+// 返回 false 表示被打断，剩余字节已丢弃
+static bool write_stream_bytes(http_streaming_audio_context_t *ctx, const uint8_t *data, size_t len) {
+    if (ctx->has_pending_byte && len > 0) {
+        uint8_t pair[2] = {ctx->pending_byte, data[0]};
+        int16_t sample;
+        memcpy(&sample, pair, sizeof(sample));
+        ctx->has_pending_byte = false;
+        if (!write_stream_samples(ctx, &sample, 1)) {
+            return false;
+        }
+        data++;
+        len--;
     }
     
-    if (enable) {
-        data |= (1 << 1);
-    } else {
-        data &= ~(1 << 1);
+    size_t count = len / 2;
+    if (count > 0) {
+        if (((uintptr_t)data & 1) == 0) {
+            if (!write_stream_samples(ctx, (const int16_t *)data, count)) {
+                return false;
+            }
+        } else {
+            // HTTP 缓冲区未按采样对齐，经栈上小缓冲区中转
+            int16_t tmp[128];
+            size_t done = 0;
+            while (done < count) {
+                size_t n = count - done;
+                if (n > sizeof(tmp) / sizeof(tmp[0])) {
+                    n = sizeof(tmp) / sizeof(tmp[0]);
+                }
+                memcpy(tmp, data + done * 2, n * 2);
+                if (!write_stream_samples(ctx, tmp, n)) {
+                    return false;
+                }
+                done += n;
+            }
+        }
     }
     
-    ret = pca9557_write_reg(PCA9557_REG_OUTPUT, data);
-    if (ret == ESP_OK) {
-        s_tts->pa_enabled = enable;
-        ESP_LOGI(TAG, "Audio PA %s", enable ? "enabled" : "disabled");
+    if (len & 1) {
+        ctx->pending_byte = data[len - 1];
+        ctx->has_pending_byte = true;
     }
-    return ret;
+    return true;
 }
 
-// 初始化 I2C 设备
-static esp_err_t init_i2c_devices(i2c_master_bus_handle_t external_i2c_bus) {
-    if (external_i2c_bus != NULL) {
-        s_tts->i2c_bus = external_i2c_bus;
-    } else {
-        return ESP_OK;
-    }
-    
-    // 添加 PCA9557 设备
-    i2c_device_config_t pca9557_cfg = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address = PCA9557_ADDR,
-        .scl_speed_hz = 100000,
-    };
-    esp_err_t ret = i2c_master_bus_add_device(s_tts->i2c_bus, &pca9557_cfg, &s_tts->pca9557_dev);
-    if (ret != ESP_OK) {
-        s_tts->pca9557_dev = NULL;
-    }
-    
-    return ESP_OK;
+// form_encoder 写入回调：直接写入 HTTP 请求流
+static int http_form_write(void *ctx, const char *data, int len) {
+    return esp_http_client_write((esp_http_client_handle_t)ctx, data, len);
 }
 
-// 初始化 ES8311 编解码器
-static esp_err_t init_es8311_codec(void) {
-    ESP_LOGI(TAG, "Initializing ES8311 codec...");
-    
-    // 创建 I2S 通道
-    i2s_chan_config_t chan_cfg = {
-        .id = I2S_NUM_0,
-        .role = I2S_ROLE_MASTER,
-        .dma_desc_num = 6,
-        .dma_frame_num = 240,
-        .auto_clear_after_cb = true,
-        .auto_clear_before_cb = false,
-        .intr_priority = 0,
-    };
-    
-    esp_err_t ret = i2s_new_channel(&chan_cfg, &s_tts->i2s_tx_handle, NULL);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create I2S channel");
-        return ret;
-    }
-    
-    // 配置 I2S 标准模式
-    i2s_std_config_t std_cfg = {
-        .clk_cfg = {
-            .sample_rate_hz = SAMPLE_RATE,
-            .clk_src = I2S_CLK_SRC_DEFAULT,
-            .mclk_multiple = I2S_MCLK_MULTIPLE_256,
-        },
-        .slot_cfg = {
-            .data_bit_width = I2S_DATA_BIT_WIDTH_16BIT,
-            .slot_bit_width = I2S_SLOT_BIT_WIDTH_AUTO,
-            .slot_mode = I2S_SLOT_MODE_MONO,
-            .slot_mask = I2S_STD_SLOT_LEFT,
-            .ws_width = I2S_DATA_BIT_WIDTH_16BIT,
-            .ws_pol = false,
-            .bit_shift = true,
-        },
-        .gpio_cfg = {
-            .mclk = s_tts->config.i2s_mclk_pin,
-            .bclk = s_tts->config.i2s_bclk_pin,
-            .ws = s_tts->config.i2s_ws_pin,
-            .dout = s_tts->config.i2s_dout_pin,
-            .din = I2S_GPIO_UNUSED,
-            .invert_flags = {
-                .mclk_inv = false,
-                .bclk_inv = false,
-                .ws_inv = false,
-            },
-        },
-    };
-    
-    ret = i2s_channel_init_std_mode(s_tts->i2s_tx_handle, &std_cfg);
-    if (ret != ESP_OK) {
-        i2s_del_channel(s_tts->i2s_tx_handle);
-        return ret;
-    }
-    
-    // 创建 I2S 数据接口
-    audio_codec_i2s_cfg_t i2s_cfg = {
-        .port = I2S_NUM_0,
-        .rx_handle = NULL,
-        .tx_handle = s_tts->i2s_tx_handle,
-    };
-    s_tts->data_if = audio_codec_new_i2s_data(&i2s_cfg);
-    if (s_tts->data_if == NULL) {
-        i2s_del_channel(s_tts->i2s_tx_handle);
-        return ESP_FAIL;
-    }
-    
-    // 创建 I2C 控制接口
-    audio_codec_i2c_cfg_t i2c_cfg = {
-        .port = I2C_NUM_1,
-        .addr = ES8311_ADDR,
-        .bus_handle = s_tts->i2c_bus,
-    };
-    s_tts->ctrl_if = audio_codec_new_i2c_ctrl(&i2c_cfg);
-    if (s_tts->ctrl_if == NULL) {
-        return ESP_FAIL;
-    }
-    
-    // 创建 GPIO 接口
-    s_tts->gpio_if = audio_codec_new_gpio();
-    if (s_tts->gpio_if == NULL) {
-        return ESP_FAIL;
-    }
-    
-    // 创建 ES8311 编解码器
-    es8311_codec_cfg_t es8311_cfg = {
-        .ctrl_if = s_tts->ctrl_if,
-        .gpio_if = s_tts->gpio_if,
-        .codec_mode = ESP_CODEC_DEV_WORK_MODE_DAC,
-        .pa_pin = -1,
-        .use_mclk = true,
-        .hw_gain = {
-            .pa_voltage = 5.0,
-            .codec_dac_voltage = 3.3,
-        },
-    };
-    s_tts->codec_if = es8311_codec_new(&es8311_cfg);
-    if (s_tts->codec_if == NULL) {
-        return ESP_FAIL;
-    }
-    
-    // 创建编解码器设备
-    esp_codec_dev_cfg_t dev_cfg = {
-        .dev_type = ESP_CODEC_DEV_TYPE_OUT,
-        .codec_if = s_tts->codec_if,
-        .data_if = s_tts->data_if,
-    };
-    s_tts->codec_dev = esp_codec_dev_new(&dev_cfg);
-    if (s_tts->codec_dev == NULL) {
-        return ESP_FAIL;
-    }
-    
-    // 打开编解码器
-    esp_codec_dev_sample_info_t fs = {
-        .bits_per_sample = 16,
-        .channel = 1,
-        .channel_mask = 0,
-        .sample_rate = SAMPLE_RATE,
-        .mclk_multiple = 0,
-    };
-    ret = esp_codec_dev_open(s_tts->codec_dev, &fs);
-    if (ret != ESP_OK) {
-        return ret;
-    }
-    
-    // 设置音量
-    esp_codec_dev_set_out_vol(s_tts->codec_dev, 80);
-    
-    ESP_LOGI(TAG, "ES8311 codec initialized");
-    return ESP_OK;
-}
 
+// 百度 TTS API 单次请求最大文本长度（UTF-8 字节数）
+// 百度官方限制是 2048 字节
+#define BAIDU_TTS_MAX_TEXT_LEN 2048
+
+// 长文本分段：每段不超过 TTS_CHUNK_MAX_BYTES，优先在句末标点处断开，
+// 其次在逗号处，最后退回到 UTF-8 字符边界。
+// 预取的下一段请求在服务端等待当前段播放完，段越长等待越久，
+// 384 字节约 128 个汉字、30 秒语音，远低于服务端的发送超时。
+#define TTS_CHUNK_MAX_BYTES 384
+#define TTS_CHUNK_MIN_BYTES 64     // 断句点不能早于此处，避免切出过短的片段
+#define HTTP_READ_CHUNK_SIZE 1024
+
+_Static_assert(TTS_CHUNK_MAX_BYTES <= BAIDU_TTS_MAX_TEXT_LEN, "chunk exceeds Baidu TTS text limit");
 
-// Token 响应缓冲区
+// 合成任务：文本队列中的一项
 typedef struct {
-    char *buffer;
-    size_t buffer_size;
-    size_t data_len;
-} token_response_t;
-
-static esp_err_t token_http_event_handler(esp_http_client_event_t *evt) {
-    token_response_t *ctx = (token_response_t *)evt->user_data;
-    
-    switch (evt->event_id) {
-        case HTTP_EVENT_ON_DATA:
-            // 接收所有数据，包括 chunked 响应
-            if (ctx != NULL && ctx->buffer != NULL) {
-                if (ctx->data_len + evt->data_len < ctx->buffer_size) {
-                    memcpy(ctx->buffer + ctx->data_len, evt->data, evt->data_len);
-                    ctx->data_len += evt->data_len;
-                    ctx->buffer[ctx->data_len] = '\0';
-                }
-            }
-            break;
-        default:
-            break;
-    }
-    return ESP_OK;
+    char *text;                 // 堆上的文本副本，由取走它的任务释放
+    SemaphoreHandle_t done_sem; // tts_speak 同步等待时非 NULL
+    esp_err_t *result;          // 同步调用的结果输出
+    uint32_t generation;        // 入队时的代次
+} tts_job_t;
+
+// 已发出的分段请求：请求头已收到，响应体等待播放任务读取
+typedef struct {
+    esp_http_client_handle_t client;  // 请求失败时为 NULL
+    char token[BAIDU_AUTH_TOKEN_MAX_LEN];
+    esp_err_t err;
+    uint32_t generation;
+    bool first;                 // 所属文本的第一段
+    bool last;                  // 所属文本的最后一段
+    tts_job_t job;              // 仅最后一段携带，用于通知完成
+} tts_request_t;
+
+// 是否以 prefix 开头
+static bool starts_with(const char *s, size_t len, const char *prefix) {
+    size_t n = strlen(prefix);
+    return len >= n && memcmp(s, prefix, n) == 0;
 }
 
-// 获取百度 access_token
-static esp_err_t get_baidu_access_token(void) {
-    if (s_tts == NULL) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    // 检查 token 是否有效
-    if (s_tts->access_token != NULL && s_tts->token_expire_time > esp_timer_get_time() / 1000000) {
-        return ESP_OK;
-    }
-    
-    ESP_LOGI(TAG, "获取百度 access_token...");
-    
-    // 准备响应缓冲区
-    token_response_t response_ctx = {
-        .buffer = malloc(2048),
-        .buffer_size = 2048,
-        .data_len = 0,
-    };
-    if (response_ctx.buffer == NULL) {
-        return ESP_ERR_NO_MEM;
-    }
-    response_ctx.buffer[0] = '\0';
-    
-    // 构建 URL
-    char url[512];
-    snprintf(url, sizeof(url),
-             "%s?grant_type=client_credentials&client_id=%s&client_secret=%s",
-             BAIDU_TOKEN_URL,
-             s_tts->config.api_key ? s_tts->config.api_key : BAIDU_TTS_API_KEY,
-             s_tts->config.secret_key ? s_tts->config.secret_key : BAIDU_TTS_SECRET_KEY);
-    
-    esp_http_client_config_t config = {
-        .url = url,
-        .method = HTTP_METHOD_POST,
-        .timeout_ms = 10000,
-        .event_handler = token_http_event_handler,
-        .user_data = &response_ctx,
-        .crt_bundle_attach = esp_crt_bundle_attach,
-    };
-    
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (client == NULL) {
-        free(response_ctx.buffer);
-        return ESP_FAIL;
+// 若 text[0..] 是句末标点 (中英文)，返回其字节数，否则返回 0
+static size_t sentence_end_len(const char *s, size_t len) {
+    static const char *const marks[] = {"。", "！", "？", "；", "…", "\n", ".", "!", "?", ";"};
+    for (size_t i = 0; i < sizeof(marks) / sizeof(marks[0]); i++) {
+        if (starts_with(s, len, marks[i])) {
+            return strlen(marks[i]);
+        }
     }
-    
-    esp_err_t err = esp_http_client_perform(client);
-    esp_http_client_cleanup(client);
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "获取 token 失败: %s", esp_err_to_name(err));
-        free(response_ctx.buffer);
-        return err;
+    return 0;
+}
+
+// 若 text[0..] 是句中停顿标点，返回其字节数，否则返回 0
+static size_t clause_end_len(const char *s, size_t len) {
+    static const char *const marks[] = {"，", "、", "：", ",", ":", " "};
+    for (size_t i = 0; i < sizeof(marks) / sizeof(marks[0]); i++) {
+        if (starts_with(s, len, marks[i])) {
+            return strlen(marks[i]);
+        }
     }
-    
-    ESP_LOGI(TAG, "Token 响应: %s", response_ctx.buffer);
-    
-    // 解析 JSON 获取 access_token
-    char *token_start = strstr(response_ctx.buffer, "\"access_token\":\"");
-    if (token_start == NULL) {
-        ESP_LOGE(TAG, "响应中未找到 access_token");
-        free(response_ctx.buffer);
-        return ESP_FAIL;
+    return 0;
+}
+
+// 计算从 text 开始的下一段长度 (字节)，保证不切断 UTF-8 字符
+static size_t next_chunk_len(const char *text, size_t len) {
+    if (len <= TTS_CHUNK_MAX_BYTES) {
+        return len;
     }
     
-    token_start += strlen("\"access_token\":\"");
-    char *token_end = strchr(token_start, '"');
-    if (token_end == NULL) {
-        free(response_ctx.buffer);
-        return ESP_FAIL;
+    size_t sentence_cut = 0;
+    size_t clause_cut = 0;
+    for (size_t i = TTS_CHUNK_MIN_BYTES; i < TTS_CHUNK_MAX_BYTES; i++) {
+        if (((unsigned char)text[i] & 0xC0) == 0x80) {
+            continue;  // UTF-8 后续字节
+        }
+        size_t n = sentence_end_len(text + i, len - i);
+        if (n > 0 && i + n <= TTS_CHUNK_MAX_BYTES) {
+            sentence_cut = i + n;
+            continue;
+        }
+        n = clause_end_len(text + i, len - i);
+        if (n > 0 && i + n <= TTS_CHUNK_MAX_BYTES) {
+            clause_cut = i + n;
+        }
     }
-    
-    // 保存 token
-    size_t token_len = token_end - token_start;
-    if (s_tts->access_token != NULL) {
-        free(s_tts->access_token);
+    if (sentence_cut > 0) {
+        return sentence_cut;
     }
-    s_tts->access_token = malloc(token_len + 1);
-    if (s_tts->access_token == NULL) {
-        free(response_ctx.buffer);
-        return ESP_ERR_NO_MEM;
+    if (clause_cut > 0) {
+        return clause_cut;
     }
-    memcpy(s_tts->access_token, token_start, token_len);
-    s_tts->access_token[token_len] = '\0';
     
-    // 设置过期时间 (默认30天，这里设置为29天)
-    s_tts->token_expire_time = esp_timer_get_time() / 1000000 + 29 * 24 * 3600;
-    
-    ESP_LOGI(TAG, "获取 access_token 成功");
-    free(response_ctx.buffer);
-    return ESP_OK;
-}
-
-// HTTP 事件处理器 - 边接收边播放音频数据
-typedef struct {
-    esp_codec_dev_handle_t codec_dev;
-    size_t total_len;
-    bool first_chunk;
-    bool is_error;
-} http_streaming_audio_context_t;
-
-static esp_err_t http_streaming_audio_event_handler(esp_http_client_event_t *evt) {
-    http_streaming_audio_context_t *ctx = (http_streaming_audio_context_t *)evt->user_data;
-    
-    switch (evt->event_id) {
-        case HTTP_EVENT_ON_DATA:
-            if (ctx != NULL && ctx->codec_dev != NULL && !ctx->is_error) {
-                // 检查是否是错误响应（JSON 格式）
-                if (ctx->first_chunk && evt->data_len > 0) {
-                    ctx->first_chunk = false;
-                    if (((char *)evt->data)[0] == '{') {
-                        ESP_LOGE(TAG, "TTS 返回错误: %.*s", (int)evt->data_len, (char *)evt->data);
-                        ctx->is_error = true;
-                        return ESP_OK;
-                    }
-                }
-                
-                // 直接播放收到的音频数据
-                esp_err_t ret = esp_codec_dev_write(ctx->codec_dev, evt->data, evt->data_len);
-                if (ret != ESP_OK) {
-                    ESP_LOGW(TAG, "写入音频数据失败");
-                }
-                ctx->total_len += evt->data_len;
-            }
-            break;
-        default:
-            break;
+    // 没有标点，退回到最近的 UTF-8 字符边界
+    size_t cut = TTS_CHUNK_MAX_BYTES;
+    while (cut > 0 && ((unsigned char)text[cut] & 0xC0) == 0x80) {
+        cut--;
     }
-    return ESP_OK;
+    return cut;
 }
 
-// URL 编码
-static char *url_encode(const char *str) {
-    if (str == NULL) return NULL;
-    
-    size_t len = strlen(str);
-    // 最坏情况：每个字符都需要编码为 %XX (3倍)
-    char *encoded = malloc(len * 3 + 1);
-    if (encoded == NULL) return NULL;
-    
-    char *p = encoded;
-    for (size_t i = 0; i < len; i++) {
-        unsigned char c = (unsigned char)str[i];
-        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || 
-            (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.' || c == '~') {
-            *p++ = c;
-        } else {
-            sprintf(p, "%%%02X", c);
-            p += 3;
-        }
-    }
-    *p = '\0';
-    return encoded;
+// 调度器排队和发出请求期间的中止检查：tts_stop 或服务销毁之后放弃
+static bool fetch_aborted(void *ctx) {
+    return *(const uint32_t *)ctx != s_tts->generation || s_tts->should_stop;
 }
 
-
-// 百度 TTS API 单次请求最大文本长度（UTF-8 字节数）
-// 百度官方限制是 2048 字节
-#define BAIDU_TTS_MAX_TEXT_LEN 2048
-
-// 调用百度 TTS API 并流式播放音频
-static esp_err_t baidu_tts_synthesize(const char *text, uint8_t *audio_buffer, size_t buffer_size, size_t *audio_len) {
-    (void)audio_buffer;  // 不再使用，保留参数兼容性
-    (void)buffer_size;
+// 发出一段合成请求：发送 POST 并等待响应头，响应体留给播放任务读取
+// esp_http_client 无法从其他任务中止，因此只在连接建立、请求体写完之后检查是否被打断，
+// 被打断时返回 ESP_ERR_INVALID_STATE，不再等待响应头
+static esp_err_t tts_request_open(const char *text, size_t text_len, tts_request_t *req) {
+    req->client = NULL;
     
-    if (s_tts == NULL || text == NULL) {
-        return ESP_ERR_INVALID_ARG;
-    }
-    
-    // 获取 access_token
-    esp_err_t ret = get_baidu_access_token();
+    // 获取 access_token (共享缓存，过期前由后台任务刷新)
+    esp_err_t ret = baidu_auth_get_token(req->token, sizeof(req->token), pdMS_TO_TICKS(TOKEN_WAIT_TIMEOUT_MS));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "获取 access_token 失败");
         return ret;
     }
     
-    // 限制文本长度，避免超出百度 API 限制
-    size_t text_len = strlen(text);
-    char *truncated_text = NULL;
-    const char *tts_text = text;
-    
-    if (text_len > BAIDU_TTS_MAX_TEXT_LEN) {
-        ESP_LOGW(TAG, "文本过长 (%d 字节)，截断到 %d 字节", (int)text_len, BAIDU_TTS_MAX_TEXT_LEN);
-        truncated_text = malloc(BAIDU_TTS_MAX_TEXT_LEN + 1);
-        if (truncated_text == NULL) {
-            return ESP_ERR_NO_MEM;
-        }
-        memcpy(truncated_text, text, BAIDU_TTS_MAX_TEXT_LEN);
-        truncated_text[BAIDU_TTS_MAX_TEXT_LEN] = '\0';
-        tts_text = truncated_text;
-    }
-    
-    ESP_LOGI(TAG, "调用百度 TTS API: %s", tts_text);
-    
-    // URL 编码文本
-    char *encoded_text = url_encode(tts_text);
-    if (truncated_text != NULL) {
-        free(truncated_text);
-    }
-    if (encoded_text == NULL) {
-        return ESP_ERR_NO_MEM;
-    }
+    ESP_LOGI(TAG, "调用百度 TTS API (%d 字节): %.*s", (int)text_len, (int)text_len, text);
     
-    // 动态分配 POST 数据缓冲区
-    // URL 编码后最大长度 = 原文本长度 * 3 + token(~200) + 其他参数(~100)
-    size_t encoded_len = strlen(encoded_text);
-    size_t post_data_size = encoded_len + 512;
-    char *post_data = malloc(post_data_size);
-    if (post_data == NULL) {
-        free(encoded_text);
-        return ESP_ERR_NO_MEM;
-    }
-    
-    // 构建 POST 数据
+    // 构建 POST 字段 (分段直接引用原文本，写入请求流时才编码)
     // 参数说明:
     // tex: 文本
     // tok: access_token
@@ -525,164 +273,347 @@ static esp_err_t baidu_tts_synthesize(const char *text, uint8_t *audio_buffer, s
     // vol: 音量 0-15, 默认5
     // per: 发音人 0=女声, 1=男声, 3=情感男声, 4=情感女声
     // aue: 音频格式 3=mp3, 4=pcm-16k, 5=pcm-8k, 6=wav
-    snprintf(post_data, post_data_size,
-             "tex=%s&tok=%s&cuid=esp32_tts&ctp=1&lan=zh&spd=5&pit=5&vol=10&per=0&aue=4",
-             encoded_text, s_tts->access_token);
-    free(encoded_text);
-    
-    // 使用流式播放上下文，边下载边播放
-    http_streaming_audio_context_t ctx = {
-        .codec_dev = s_tts->codec_dev,
-        .total_len = 0,
-        .first_chunk = true,
-        .is_error = false,
+    const form_field_t fields[] = {
+        {"tex", text, text_len},
+        {"tok", req->token, 0},
+        {"cuid", "esp32_tts", 0},
+        {"ctp", "1", 0},
+        {"lan", "zh", 0},
+        {"spd", "5", 0},
+        {"pit", "5", 0},
+        {"vol", "10", 0},
+        {"per", "0", 0},
+        {"aue", "4", 0},
     };
+    const size_t field_count = sizeof(fields) / sizeof(fields[0]);
+    int post_len = (int)form_body_len(fields, field_count);
     
     esp_http_client_config_t config = {
         .url = BAIDU_TTS_URL,
         .method = HTTP_METHOD_POST,
         .timeout_ms = 30000,
-        .event_handler = http_streaming_audio_event_handler,
-        .user_data = &ctx,
         .crt_bundle_attach = esp_crt_bundle_attach,
     };
     
     esp_http_client_handle_t client = esp_http_client_init(&config);
     if (client == NULL) {
-        free(post_data);
         return ESP_FAIL;
     }
     
     esp_http_client_set_header(client, "Content-Type", "application/x-www-form-urlencoded");
-    esp_http_client_set_post_field(client, post_data, strlen(post_data));
-    
-    ret = esp_http_client_perform(client);
-    free(post_data);
-    post_data = NULL;
     
+    ret = esp_http_client_open(client, post_len);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "TTS 请求失败: %s", esp_err_to_name(ret));
         esp_http_client_cleanup(client);
         return ret;
     }
     
-    int status_code = esp_http_client_get_status_code(client);
-    esp_http_client_cleanup(client);
-    
-    if (status_code != 200) {
+    int status_code = 0;
+    if (fetch_aborted(&req->generation)) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else if (!form_body_write(fields, field_count, http_form_write, client)) {
+        ESP_LOGE(TAG, "TTS 请求体发送失败");
+        ret = ESP_FAIL;
+    } else if (fetch_aborted(&req->generation)) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else if (esp_http_client_fetch_headers(client) < 0) {
+        ESP_LOGE(TAG, "TTS 响应头接收失败");
+        ret = ESP_FAIL;
+    } else if ((status_code = esp_http_client_get_status_code(client)) != 200) {
         ESP_LOGE(TAG, "TTS 请求失败，状态码: %d", status_code);
-        return ESP_FAIL;
-    }
-    
-    if (ctx.is_error) {
-        return ESP_FAIL;
+        if (tts_sched_is_throttle_error(status_code, NULL, 0)) {
+            tts_sched_feedback(true);
+        }
+        ret = ESP_FAIL;
     }
-    
-    if (ctx.total_len < 100) {
-        ESP_LOGE(TAG, "TTS 返回数据太小: %d bytes", (int)ctx.total_len);
-        return ESP_FAIL;
+    if (ret != ESP_OK) {
+        esp_http_client_close(client);
+        esp_http_client_cleanup(client);
+        return ret;
     }
     
-    *audio_len = ctx.total_len;
-    ESP_LOGI(TAG, "TTS 流式播放完成，总音频大小: %d bytes", (int)ctx.total_len);
+    req->client = client;
     return ESP_OK;
 }
 
-// 播放 PCM 音频
-static esp_err_t play_pcm_audio(const uint8_t *audio_data, size_t audio_len) {
-    if (s_tts == NULL || s_tts->codec_dev == NULL || audio_data == NULL) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    ESP_LOGI(TAG, "播放 PCM 音频，大小: %d bytes", (int)audio_len);
-    
-    // 使能音频放大器
-    if (!s_tts->pa_enabled && s_tts->pca9557_dev != NULL) {
-        enable_audio_pa(true);
-        vTaskDelay(pdMS_TO_TICKS(50));
-    }
+// 读取一段请求的响应体并写入输出流 (边下载边播放)，结束后关闭连接
+static esp_err_t tts_request_play(tts_request_t *req) {
+    http_streaming_audio_context_t ctx = {
+        .stream = s_tts->stream,
+        .generation = req->generation,
+        .total_len = 0,
+    };
+    uint8_t buf[HTTP_READ_CHUNK_SIZE];
+    esp_err_t ret = ESP_OK;
+    bool first = true;
     
-    // 通知播放开始
-    if (s_tts->config.callback) {
-        s_tts->config.callback(TTS_EVENT_START, s_tts->config.user_data);
+    while (!s_tts->should_stop) {
+        // tts_stop 之后不再读取旧文本的音频 (每次读取约 32ms 语音)
+        if (req->generation != s_tts->generation) {
+            ret = ESP_ERR_INVALID_STATE;
+            break;
+        }
+        
+        int read_len = esp_http_client_read(req->client, (char *)buf, sizeof(buf));
+        if (read_len < 0) {
+            ESP_LOGE(TAG, "TTS 响应读取失败: %d", read_len);
+            ret = ESP_FAIL;
+            break;
+        }
+        if (read_len == 0) {
+            break;
+        }
+        
+        // 检查是否是错误响应（JSON 格式）
+        if (first) {
+            first = false;
+            if (buf[0] == '{') {
+                ESP_LOGE(TAG, "TTS 返回错误: %.*s", read_len, (char *)buf);
+                if (baidu_auth_is_token_error((const char *)buf, read_len)) {
+                    baidu_auth_invalidate(req->token);
+                } else if (tts_sched_is_throttle_error(200, (const char *)buf, read_len)) {
+                    tts_sched_feedback(true);
+                }
+                ret = ESP_FAIL;
+                break;
+            }
+        }
+        
+        // 收到的音频数据直接写入输出流，由混音任务送入 I2S
+        // 输出流满时分批等待，tts_stop 或服务销毁后不再阻塞在写入上
+        if (!write_stream_bytes(&ctx, buf, read_len)) {
+            ret = ESP_ERR_INVALID_STATE;
+            break;
+        }
+        ctx.total_len += read_len;
     }
-    s_tts->is_playing = true;
     
-    // 写入音频数据到 DMA 缓冲区
-    esp_err_t ret = esp_codec_dev_write(s_tts->codec_dev, (void *)audio_data, audio_len);
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "写入音频数据失败: %s", esp_err_to_name(ret));
+    if (ret == ESP_ERR_INVALID_STATE) {
+        // 丢弃输出流中尚未播放的部分，连同服务端还没发完的音频计入跳过时长
+        audio_output_position_t pos;
+        audio_output_stream_get_position(s_tts->stream, &pos);
+        uint64_t skipped = pos.frames_queued - pos.frames_played;
+        int64_t content_len = esp_http_client_get_content_length(req->client);
+        if (content_len > (int64_t)ctx.total_len) {
+            skipped += (uint64_t)(content_len - (int64_t)ctx.total_len) / 2;
+        }
+        audio_output_stream_flush(s_tts->stream);
+        s_tts->stats.chunks_aborted++;
+        s_tts->stats.stale_audio_skipped_ms += (uint32_t)(skipped * 1000 / SAMPLE_RATE);
+        ESP_LOGI(TAG, "TTS 分段播放被打断，已播放 %d bytes", (int)ctx.total_len);
     }
     
-    // 注意：esp_codec_dev_write 返回后，DMA 仍在后台播放音频
-    // 这里不做任何等待，让音频自然播放完成
+    esp_http_client_close(req->client);
+    esp_http_client_cleanup(req->client);
+    req->client = NULL;
     
-    s_tts->is_playing = false;
-    
-    // 通知播放结束（实际上音频可能还在播放）
-    if (s_tts->config.callback) {
-        s_tts->config.callback(TTS_EVENT_STOP, s_tts->config.user_data);
+    if (ret == ESP_OK && ctx.total_len < 100) {
+        ESP_LOGE(TAG, "TTS 返回数据太小: %d bytes", (int)ctx.total_len);
+        ret = ESP_FAIL;
+    }
+    if (ret == ESP_OK) {
+        tts_sched_feedback(false);
+        ESP_LOGI(TAG, "TTS 分段播放完成，音频大小: %d bytes", (int)ctx.total_len);
     }
-    
     return ret;
 }
 
-// 播放文本（合成并播放）
-static esp_err_t tts_play_text(const char *text) {
-    if (s_tts == NULL || text == NULL || strlen(text) == 0) {
-        return ESP_ERR_INVALID_ARG;
-    }
-    
-    // 过滤太短的文本（少于2个字符可能导致 TTS 问题）
-    size_t text_len = strlen(text);
-    if (text_len < 2) {
-        ESP_LOGW(TAG, "文本太短，跳过 TTS: %s", text);
-        return ESP_OK;
-    }
-    
-    // 使能音频放大器
-    if (!s_tts->pa_enabled && s_tts->pca9557_dev != NULL) {
-        enable_audio_pa(true);
-        vTaskDelay(pdMS_TO_TICKS(50));
-    }
-    
-    // 通知播放开始
-    if (s_tts->config.callback) {
-        s_tts->config.callback(TTS_EVENT_START, s_tts->config.user_data);
-    }
-    s_tts->is_playing = true;
-    
-    // 调用百度 TTS（边下载边播放）
-    size_t audio_len = 0;
-    esp_err_t ret = baidu_tts_synthesize(text, NULL, 0, &audio_len);
-    
-    s_tts->is_playing = false;
-    
-    // 通知播放结束
-    if (s_tts->config.callback) {
-        s_tts->config.callback(TTS_EVENT_STOP, s_tts->config.user_data);
+// 丢弃一项尚未处理的合成任务
+static void tts_job_discard(tts_job_t *job, esp_err_t result) {
+    free(job->text);
+    job->text = NULL;
+    if (job->done_sem != NULL) {
+        *job->result = result;
+        xSemaphoreGive(job->done_sem);
     }
+}
+
+// 合成任务：把文本分段并依次发出请求
+// 请求队列深度为 1，因此第 N 段在播放时第 N+1 段的请求已经发出并收到响应头，
+// 第 N 段结束后立即可以读取第 N+1 段的音频，段与段之间没有往返延迟造成的停顿。
+static void tts_fetch_task(void *arg) {
+    tts_job_t job;
     
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "TTS 合成/播放失败");
+    while (!s_tts->should_stop) {
+        if (xQueueReceive(s_tts->text_queue, &job, pdMS_TO_TICKS(100)) != pdTRUE) {
+            continue;
+        }
+        
+        // 入队后才被 tts_stop 清除的文本 (出队与清空交错)
+        uint32_t generation = job.generation;
+        if (generation != s_tts->generation) {
+            ESP_LOGD(TAG, "丢弃旧代次的文本");
+            s_tts->stats.stale_jobs_dropped++;
+            tts_job_discard(&job, ESP_ERR_INVALID_STATE);
+            continue;
+        }
+        const char *text = job.text;
+        size_t remaining = strlen(text);
+        bool first = true;
+        
+        while (true) {
+            size_t len = next_chunk_len(text, remaining);
+            bool last = len >= remaining;
+            
+            tts_request_t req = {
+                .generation = generation,
+                .first = first,
+                .last = last,
+            };
+            // 第一段用户正在等待；之后的分段在上一段播放时预取，排在其他请求之后
+            if (!fetch_aborted(&generation) &&
+                tts_sched_acquire(first ? TTS_SCHED_INTERACTIVE : TTS_SCHED_PREFETCH, portMAX_DELAY,
+                                  fetch_aborted, &generation) != ESP_OK) {
+                ESP_LOGI(TAG, "TTS 请求排队时被打断");
+            }
+            if (fetch_aborted(&generation)) {
+                // 被 tts_stop 打断：剩余分段不再请求，发一个空的结束段收尾
+                req.err = ESP_ERR_INVALID_STATE;
+                req.last = true;
+                last = true;
+            } else {
+                req.err = tts_request_open(text, len, &req);
+            }
+            if (last) {
+                req.job = job;
+                req.job.text = NULL;
+            }
+            
+            bool sent = false;
+            while (!sent && !s_tts->should_stop) {
+                sent = xQueueSend(s_tts->request_queue, &req, pdMS_TO_TICKS(100)) == pdTRUE;
+            }
+            if (!sent) {
+                if (req.client != NULL) {
+                    esp_http_client_close(req.client);
+                    esp_http_client_cleanup(req.client);
+                }
+                if (last && req.job.done_sem != NULL) {
+                    *req.job.result = ESP_ERR_INVALID_STATE;
+                    xSemaphoreGive(req.job.done_sem);
+                }
+                break;
+            }
+            
+            if (last) {
+                break;
+            }
+            first = false;
+            text += len;
+            remaining -= len;
+        }
+        
+        free(job.text);
     }
     
-    return ret;
+    xEventGroupSetBits(s_tts->task_exit, TASK_EXIT_FETCH);
+    vTaskDelete(NULL);
 }
 
-// TTS 任务
+// 播放任务：按顺序读取已发出请求的音频并写入输出流
 static void tts_task(void *arg) {
-    char text[TTS_MAX_TEXT_LEN];
+    tts_request_t req;
+    esp_err_t job_result = ESP_OK;
     
     while (!s_tts->should_stop) {
-        if (xQueueReceive(s_tts->text_queue, text, pdMS_TO_TICKS(100)) == pdTRUE) {
-            tts_play_text(text);
+        if (xQueueReceive(s_tts->request_queue, &req, pdMS_TO_TICKS(100)) != pdTRUE) {
+            continue;
+        }
+        
+        if (req.first) {
+            job_result = ESP_OK;
+            
+            // 使能音频放大器
+            audio_output_set_pa(true);
+            
+            // 通知播放开始
+            if (s_tts->config.callback) {
+                s_tts->config.callback(TTS_EVENT_START, s_tts->config.user_data);
+            }
+            s_tts->is_playing = true;
+        }
+        
+        esp_err_t ret = req.err;
+        if (req.client != NULL && req.generation != s_tts->generation) {
+            // 预取的请求属于已被 tts_stop 清除的文本
+            esp_http_client_close(req.client);
+            esp_http_client_cleanup(req.client);
+            req.client = NULL;
+            s_tts->stats.stale_chunks_dropped++;
+            ret = ESP_ERR_INVALID_STATE;
+        }
+        if (req.client != NULL) {
+            ret = tts_request_play(&req);
+        }
+        if (ret == ESP_OK) {
+            s_tts->stats.chunks_played++;
+        } else if (ret != ESP_ERR_INVALID_STATE) {
+            ESP_LOGE(TAG, "TTS 合成/播放失败");
+        }
+        if (ret != ESP_OK && job_result == ESP_OK) {
+            job_result = ret;
+        }
+        
+        if (req.last) {
+            s_tts->is_playing = false;
+            
+            // 通知播放结束（输出流中的音频可能还在播放）
+            if (s_tts->config.callback) {
+                s_tts->config.callback(TTS_EVENT_STOP, s_tts->config.user_data);
+            }
+            if (req.job.done_sem != NULL) {
+                *req.job.result = job_result;
+                xSemaphoreGive(req.job.done_sem);
+            }
         }
     }
     
+    xEventGroupSetBits(s_tts->task_exit, TASK_EXIT_PLAYER);
     vTaskDelete(NULL);
 }
 
+// 复制文本并加入合成队列
+static esp_err_t tts_enqueue(const char *text, SemaphoreHandle_t done_sem, esp_err_t *result,
+                             TickType_t timeout) {
+    tts_job_t job = {
+        .text = strdup(text),
+        .done_sem = done_sem,
+        .result = result,
+        .generation = s_tts->generation,
+    };
+    if (job.text == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xQueueSend(s_tts->text_queue, &job, timeout) != pdTRUE) {
+        free(job.text);
+        return ESP_ERR_TIMEOUT;
+    }
+    // 请求合成期间打开功放，播放时无需等待其稳定
+    audio_output_pa_prewarm();
+    return ESP_OK;
+}
+
+/**
+ * 通知所有已创建的任务退出并等待它们结束
+ * 
+ * 递增代次让正在进行的播放和排队中的请求放弃。阻塞在网络调用中的合成任务
+ * 要等调用返回 (最长为 HTTP 超时)，此前不能释放 s_tts。
+ */
+static void stop_tasks(void) {
+    s_tts->should_stop = true;
+    s_tts->generation++;
+    EventBits_t wait_bits = 0;
+    if (s_tts->task_handle != NULL) {
+        wait_bits |= TASK_EXIT_PLAYER;
+    }
+    if (s_tts->fetch_task_handle != NULL) {
+        wait_bits |= TASK_EXIT_FETCH;
+    }
+    if (wait_bits != 0) {
+        xEventGroupWaitBits(s_tts->task_exit, wait_bits, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+}
 
 // 初始化 TTS 服务
 esp_err_t tts_service_init(const tts_config_t *config) {
@@ -715,69 +646,140 @@ esp_err_t tts_service_init(const tts_config_t *config) {
     if (s_tts->config.sample_rate == 0) s_tts->config.sample_rate = SAMPLE_RATE;
     if (s_tts->config.speed == 0) s_tts->config.speed = 5;
     
-    // 默认 I2S 引脚
-    if (s_tts->config.i2s_mclk_pin == 0) s_tts->config.i2s_mclk_pin = 38;
-    if (s_tts->config.i2s_bclk_pin == 0) s_tts->config.i2s_bclk_pin = 14;
-    if (s_tts->config.i2s_ws_pin == 0) s_tts->config.i2s_ws_pin = 13;
-    if (s_tts->config.i2s_dout_pin == 0) s_tts->config.i2s_dout_pin = 45;
-    
     ESP_LOGI(TAG, "Initializing Baidu TTS service...");
     
-    // 初始化 I2C 设备
-    esp_err_t ret = init_i2c_devices((i2c_master_bus_handle_t)s_tts->config.i2c_bus_handle);
+    // 获取共享的百度 token 提供者 (从 NVS 加载缓存的 token，没有缓存时立即在后台获取)
+    baidu_auth_config_t auth_cfg = {
+        .api_key = s_tts->config.api_key ? s_tts->config.api_key : BAIDU_TTS_API_KEY,
+        .secret_key = s_tts->config.secret_key ? s_tts->config.secret_key : BAIDU_TTS_SECRET_KEY,
+    };
+    esp_err_t ret = baidu_auth_acquire(&auth_cfg);
     if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "I2C devices init failed");
+        ESP_LOGE(TAG, "Failed to acquire Baidu auth provider");
+        free(s_tts);
+        s_tts = NULL;
+        return ret;
     }
+    s_tts->auth_acquired = true;
     
-    // 初始化 ES8311 编解码器
-    ret = init_es8311_codec();
+    // 获取共享音频输出 (引脚为 0 时使用开发板默认值)
+    audio_output_config_t output_cfg = {
+        .i2s_mclk_pin = s_tts->config.i2s_mclk_pin,
+        .i2s_bclk_pin = s_tts->config.i2s_bclk_pin,
+        .i2s_ws_pin = s_tts->config.i2s_ws_pin,
+        .i2s_dout_pin = s_tts->config.i2s_dout_pin,
+        .i2c_bus_handle = s_tts->config.i2c_bus_handle,
+    };
+    ret = audio_output_acquire(&output_cfg);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to init ES8311 codec");
+        ESP_LOGE(TAG, "Failed to acquire audio output");
+        baidu_auth_release();
         free(s_tts);
         s_tts = NULL;
         return ret;
     }
+    s_tts->output_acquired = true;
     
-    // 使能音频放大器
-    if (s_tts->pca9557_dev != NULL) {
-        enable_audio_pa(true);
+    audio_output_stream_config_t stream_cfg = {
+        .buffer_size = TTS_STREAM_BUFFER_SIZE,
+    };
+    ret = audio_output_stream_open(&stream_cfg, &s_tts->stream);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open audio stream");
+        audio_output_release();
+        baidu_auth_release();
+        free(s_tts);
+        s_tts = NULL;
+        return ret;
     }
     
     // 注意：不再需要预分配音频缓冲区，因为现在是边下载边播放
     
-    // 创建文本队列
-    s_tts->text_queue = xQueueCreate(TTS_TEXT_QUEUE_SIZE, TTS_MAX_TEXT_LEN);
-    if (s_tts->text_queue == NULL) {
-        ESP_LOGE(TAG, "Failed to create text queue");
-        free(s_tts);
-        s_tts = NULL;
-        return ESP_ERR_NO_MEM;
+    // 创建文本队列和分段请求队列
+    s_tts->text_queue = xQueueCreate(TTS_TEXT_QUEUE_SIZE, sizeof(tts_job_t));
+    s_tts->request_queue = xQueueCreate(TTS_REQUEST_QUEUE_SIZE, sizeof(tts_request_t));
+    if (s_tts->text_queue == NULL || s_tts->request_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create queues");
+        ret = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+    
+    // 任务退出事件组 (销毁时用来等待任务退出)
+    s_tts->task_exit = xEventGroupCreate();
+    if (s_tts->task_exit == NULL) {
+        ESP_LOGE(TAG, "Failed to create task exit event group");
+        ret = ESP_ERR_NO_MEM;
+        goto cleanup;
     }
     
-    // 创建 TTS 任务
+    // 创建播放任务和分段请求任务
     BaseType_t task_ret = xTaskCreate(tts_task, "baidu_tts", 8192, NULL, 5, &s_tts->task_handle);
     if (task_ret != pdPASS) {
         ESP_LOGE(TAG, "Failed to create TTS task");
-        vQueueDelete(s_tts->text_queue);
-        free(s_tts);
-        s_tts = NULL;
-        return ESP_FAIL;
+        ret = ESP_FAIL;
+        goto cleanup;
+    }
+    task_ret = xTaskCreate(tts_fetch_task, "baidu_tts_fetch", 8192, NULL, 5, &s_tts->fetch_task_handle);
+    if (task_ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create TTS fetch task");
+        ret = ESP_FAIL;
+        goto cleanup;
     }
     
     s_tts->initialized = true;
     ESP_LOGI(TAG, "Baidu TTS service initialized");
     return ESP_OK;
+
+cleanup:
+    // 清理已分配的资源 (先等已创建的任务退出)
+    if (s_tts->task_exit != NULL) {
+        stop_tasks();
+        vEventGroupDelete(s_tts->task_exit);
+    }
+    if (s_tts->text_queue != NULL) {
+        vQueueDelete(s_tts->text_queue);
+    }
+    if (s_tts->request_queue != NULL) {
+        vQueueDelete(s_tts->request_queue);
+    }
+    audio_output_stream_close(s_tts->stream);
+    audio_output_release();
+    baidu_auth_release();
+    free(s_tts);
+    s_tts = NULL;
+    return ret;
 }
 
 // 文本转语音并播放 (同步)
+// 与异步调用共用分段流水线，按入队顺序播放，返回时全部分段已写入输出流
 esp_err_t tts_speak(const char *text) {
     if (s_tts == NULL || text == NULL || !s_tts->initialized) {
         return ESP_ERR_INVALID_STATE;
     }
-    return tts_play_text(text);
+    
+    // 过滤太短的文本（少于2个字符可能导致 TTS 问题）
+    if (strlen(text) < 2) {
+        ESP_LOGW(TAG, "文本太短，跳过 TTS: %s", text);
+        return ESP_OK;
+    }
+    
+    SemaphoreHandle_t done_sem = xSemaphoreCreateBinary();
+    if (done_sem == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    esp_err_t result = ESP_FAIL;
+    esp_err_t ret = tts_enqueue(text, done_sem, &result, portMAX_DELAY);
+    if (ret == ESP_OK) {
+        xSemaphoreTake(done_sem, portMAX_DELAY);
+        ret = result;
+    }
+    vSemaphoreDelete(done_sem);
+    return ret;
 }
 
 // 将文本添加到播放队列 (异步)
+// 文本长度不限，由分段任务切成多次请求
 esp_err_t tts_speak_async(const char *text) {
     if (s_tts == NULL || text == NULL || !s_tts->initialized) {
         return ESP_ERR_INVALID_STATE;
@@ -790,27 +792,26 @@ esp_err_t tts_speak_async(const char *text) {
         return ESP_OK;
     }
     
-    char text_buf[TTS_MAX_TEXT_LEN];
-    strncpy(text_buf, text, TTS_MAX_TEXT_LEN - 1);
-    text_buf[TTS_MAX_TEXT_LEN - 1] = '\0';
-    
     // 检查队列剩余空间
     UBaseType_t spaces = uxQueueSpacesAvailable(s_tts->text_queue);
+    esp_err_t ret;
     if (spaces == 0) {
         ESP_LOGW(TAG, "TTS 队列已满，等待空间...");
         // 等待更长时间让队列有空间
-        if (xQueueSend(s_tts->text_queue, text_buf, pdMS_TO_TICKS(5000)) != pdTRUE) {
-            ESP_LOGE(TAG, "TTS 队列超时，丢弃文本: %s", text_buf);
-            return ESP_ERR_TIMEOUT;
+        ret = tts_enqueue(text, NULL, NULL, pdMS_TO_TICKS(5000));
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "TTS 队列超时，丢弃文本: %s", text);
+            return ret;
         }
     } else {
-        if (xQueueSend(s_tts->text_queue, text_buf, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ret = tts_enqueue(text, NULL, NULL, pdMS_TO_TICKS(100));
+        if (ret != ESP_OK) {
             ESP_LOGW(TAG, "TTS 队列发送失败");
             return ESP_ERR_NO_MEM;
         }
     }
     
-    ESP_LOGI(TAG, "TTS 文本已加入队列 (剩余空间: %d): %s", (int)spaces, text_buf);
+    ESP_LOGI(TAG, "TTS 文本已加入队列 (%d 字节，剩余空间: %d)", (int)text_len, (int)spaces);
     return ESP_OK;
 }
 
@@ -821,7 +822,14 @@ esp_err_t tts_stop(void) {
     }
     // 只清空队列，不设置 should_stop 标志
     // should_stop 标志仅用于销毁服务时停止任务
-    xQueueReset(s_tts->text_queue);
+    // 代次递增后，正在播放的分段在下一次读取前停止并清空输出流，
+    // 当前文本的剩余分段和预取的请求也由代次丢弃
+    s_tts->generation++;
+    tts_job_t job;
+    while (xQueueReceive(s_tts->text_queue, &job, 0) == pdTRUE) {
+        s_tts->stats.stale_jobs_dropped++;
+        tts_job_discard(&job, ESP_ERR_INVALID_STATE);
+    }
     ESP_LOGI(TAG, "TTS 队列已清空");
     return ESP_OK;
 }
@@ -831,37 +839,63 @@ bool tts_is_playing(void) {
     return s_tts != NULL && s_tts->is_playing;
 }
 
+// 获取统计信息
+esp_err_t tts_get_stats(tts_stats_t *stats) {
+    if (s_tts == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *stats = s_tts->stats;
+    return ESP_OK;
+}
+
 // 销毁 TTS 服务
 void tts_service_destroy(void) {
     if (s_tts == NULL) {
         return;
     }
     
-    s_tts->should_stop = true;
-    
-    if (s_tts->task_handle != NULL) {
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
+    // 通知所有任务退出并等待它们结束，之后不再有任务访问 s_tts
+    stop_tasks();
+    vEventGroupDelete(s_tts->task_exit);
+    s_tts->task_exit = NULL;
     
     if (s_tts->text_queue != NULL) {
+        tts_job_t job;
+        while (xQueueReceive(s_tts->text_queue, &job, 0) == pdTRUE) {
+            tts_job_discard(&job, ESP_ERR_INVALID_STATE);
+        }
         vQueueDelete(s_tts->text_queue);
     }
     
-    if (s_tts->codec_dev != NULL) {
-        esp_codec_dev_close(s_tts->codec_dev);
-        esp_codec_dev_delete(s_tts->codec_dev);
+    if (s_tts->request_queue != NULL) {
+        tts_request_t req;
+        while (xQueueReceive(s_tts->request_queue, &req, 0) == pdTRUE) {
+            if (req.client != NULL) {
+                esp_http_client_close(req.client);
+                esp_http_client_cleanup(req.client);
+            }
+            if (req.last && req.job.done_sem != NULL) {
+                *req.job.result = ESP_ERR_INVALID_STATE;
+                xSemaphoreGive(req.job.done_sem);
+            }
+        }
+        vQueueDelete(s_tts->request_queue);
+    }
+    
+    if (s_tts->stream != NULL) {
+        audio_output_stream_close(s_tts->stream);
     }
     
-    if (s_tts->i2s_tx_handle != NULL) {
-        i2s_del_channel(s_tts->i2s_tx_handle);
+    if (s_tts->output_acquired) {
+        audio_output_release();
     }
     
     if (s_tts->audio_buffer != NULL) {
         free(s_tts->audio_buffer);
     }
     
-    if (s_tts->access_token != NULL) {
-        free(s_tts->access_token);
+    if (s_tts->auth_acquired) {
+        baidu_auth_release();
     }
     
     if (s_tts->config.api_key != NULL) {
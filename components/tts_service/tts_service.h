@@ -52,6 +52,17 @@ typedef struct {
     void *i2c_bus_handle;       // i2c_master_bus_handle_t
 } tts_config_t;
 
+/**
+ * TTS 统计信息
+ */
+typedef struct {
+    uint32_t chunks_played;             // 完整播放的分段数
+    uint32_t stale_jobs_dropped;        // 被 tts_stop 清除而未开始合成的文本数
+    uint32_t stale_chunks_dropped;      // 已预取但属于旧代次而未播放的分段数
+    uint32_t chunks_aborted;            // 播放中被 tts_stop 打断的分段数
+    uint32_t stale_audio_skipped_ms;    // 被 tts_stop 打断而未播放的语音时长
+} tts_stats_t;
+
 /**
  * 初始化本地 TTS 服务
  * @param config TTS 配置
@@ -61,6 +72,8 @@ esp_err_t tts_service_init(const tts_config_t *config);
 
 /**
  * 文本转语音并播放 (同步)
+ * 长度不限，长文本在句末标点或 UTF-8 字符边界处切成多次请求，
+ * 下一段的请求在当前段播放时提前发出。返回时全部音频已写入输出流。
  * @param text 要播放的文本 (支持中文)
  * @return ESP_OK 成功
  */
@@ -68,6 +81,7 @@ esp_err_t tts_speak(const char *text);
 
 /**
  * 将文本添加到播放队列 (异步)
+ * 文本被复制到堆上，长度不限，分段方式同 tts_speak
  * @param text 要播放的文本
  * @return ESP_OK 成功
  */
@@ -85,6 +99,13 @@ esp_err_t tts_stop(void);
  */
 bool tts_is_playing(void);
 
+/**
+ * 获取统计信息
+ * @param stats 输出统计
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t tts_get_stats(tts_stats_t *stats);
+
 /**
  * 销毁 TTS 服务
  */
@@ -0,0 +1,219 @@
+/**
+ * UI 更新总线实现
+ */
+
+#include "ui_bus.h"
+#include "ui_ring.h"
+#include <string.h>
+#include <stdatomic.h>
+
+#define UI_BUS_SLOTS        32      // 消息环槽位数 (2 KB)，单条消息最多 896 字节
+#define UI_BUS_MAX_TEXT     (UI_BUS_SLOTS / 2 * UI_RING_SLOT_TEXT)
+#define UI_BUS_STAGE_SIZE   (UI_BUS_MAX_TEXT * 2)
+
+/**
+ * 消息操作
+ */
+enum {
+    UI_BUS_OP_APPEND = 0,
+    UI_BUS_OP_SET,
+    UI_BUS_OP_CLEAR,
+    UI_BUS_OP_COLOR,
+};
+
+/**
+ * 绑定的目标
+ */
+typedef struct {
+    lv_obj_t *obj;              ///< lv_label
+} bus_target_t;
+
+/**
+ * 待写入控件的合并文本 (仅 LVGL 任务访问)
+ */
+typedef struct {
+    bool active;                ///< 有待写入的更新
+    bool reset;                 ///< 先清空控件原有文本
+    uint8_t target;
+    size_t len;
+    char text[UI_BUS_STAGE_SIZE + 1];
+} bus_stage_t;
+
+static ui_ring_slot_t s_slots[UI_BUS_SLOTS];
+static ui_ring_t s_ring;
+static atomic_bool s_ready;
+static lv_timer_t *s_timer = NULL;
+static bus_target_t s_targets[UI_BUS_MAX_TARGETS];
+static bus_stage_t s_stage;
+static uint32_t s_drained = 0;
+static uint32_t s_flushes = 0;
+
+/**
+ * 把合并后的文本一次写入控件
+ */
+static void flush_stage(void) {
+    if (!s_stage.active) {
+        return;
+    }
+    s_stage.active = false;
+    
+    bus_target_t *t = &s_targets[s_stage.target];
+    if (t->obj == NULL) {
+        return;
+    }
+    s_stage.text[s_stage.len] = '\0';
+    if (s_stage.reset) {
+        lv_label_set_text(t->obj, s_stage.text);
+    } else if (s_stage.len > 0) {
+        lv_label_ins_text(t->obj, LV_LABEL_POS_LAST, s_stage.text);
+    }
+    s_flushes++;
+}
+
+/**
+ * 处理一条消息 (首个槽位及其续接槽位)
+ */
+static void drain_message(const ui_ring_slot_t *slot) {
+    uint8_t target = slot->target;
+    uint8_t op = slot->op;
+    s_drained++;
+    
+    if (op == UI_BUS_OP_COLOR) {
+        // 颜色不经过合并缓冲区，直接作用于控件
+        if (slot->len == 3 && s_targets[target].obj != NULL) {
+            uint32_t rgb = ((uint32_t)(uint8_t)slot->text[0] << 16) |
+                           ((uint32_t)(uint8_t)slot->text[1] << 8) |
+                           (uint8_t)slot->text[2];
+            lv_obj_set_style_text_color(s_targets[target].obj, lv_color_hex(rgb), 0);
+        }
+        ui_ring_release(&s_ring);
+        return;
+    }
+    
+    if (s_stage.active && s_stage.target != target) {
+        flush_stage();
+    }
+    if (op == UI_BUS_OP_APPEND) {
+        // 放不下一条最长的消息时先写出已合并的部分
+        if (s_stage.active && s_stage.len > UI_BUS_STAGE_SIZE - UI_BUS_MAX_TEXT) {
+            flush_stage();
+        }
+        if (!s_stage.active) {
+            s_stage.reset = false;
+            s_stage.len = 0;
+        }
+    } else {
+        // 设置和清空会覆盖之前合并的追加
+        s_stage.reset = true;
+        s_stage.len = 0;
+    }
+    s_stage.active = true;
+    s_stage.target = target;
+    
+    // 首个槽位最后发布，看到它时续接槽位都已可见
+    for (;;) {
+        memcpy(s_stage.text + s_stage.len, slot->text, slot->len);
+        s_stage.len += slot->len;
+        ui_ring_release(&s_ring);
+        slot = ui_ring_peek(&s_ring);
+        if (slot == NULL || !slot->cont) {
+            break;
+        }
+    }
+}
+
+/**
+ * 每帧在 LVGL 任务中取空消息环
+ */
+static void drain_cb(lv_timer_t *timer) {
+    // 最多处理约一整环的消息，生产者持续投递时也不会一直占着 LVGL 任务
+    for (uint32_t budget = UI_BUS_SLOTS; budget > 0; budget--) {
+        const ui_ring_slot_t *slot = ui_ring_peek(&s_ring);
+        if (slot == NULL) {
+            break;
+        }
+        if (slot->cont || slot->target >= UI_BUS_MAX_TARGETS) {
+            ui_ring_release(&s_ring);
+            continue;
+        }
+        drain_message(slot);
+    }
+    flush_stage();
+}
+
+/**
+ * 截断到不超过 max 字节，不拆开 UTF-8 字符
+ */
+static size_t utf8_cut(const char *text, size_t len, size_t max) {
+    if (len <= max) {
+        return len;
+    }
+    size_t n = max;
+    while (n > 0 && ((uint8_t)text[n] & 0xC0) == 0x80) {
+        n--;
+    }
+    return n;
+}
+
+static bool post(uint8_t target, uint8_t op, const char *text, size_t len) {
+    if (!atomic_load_explicit(&s_ready, memory_order_acquire) || target >= UI_BUS_MAX_TARGETS) {
+        return false;
+    }
+    return ui_ring_post(&s_ring, target, op, text, len);
+}
+
+esp_err_t ui_bus_init(uint32_t period_ms) {
+    if (s_timer != NULL) {
+        lv_timer_set_period(s_timer, period_ms);
+        return ESP_OK;
+    }
+    ui_ring_init(&s_ring, s_slots, UI_BUS_SLOTS);
+    s_timer = lv_timer_create(drain_cb, period_ms, NULL);
+    if (s_timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    atomic_store_explicit(&s_ready, true, memory_order_release);
+    return ESP_OK;
+}
+
+void ui_bus_bind(uint8_t target, lv_obj_t *obj) {
+    if (target >= UI_BUS_MAX_TARGETS) {
+        return;
+    }
+    s_targets[target].obj = obj;
+}
+
+size_t ui_bus_append(uint8_t target, const char *text, size_t len) {
+    if (text == NULL || len == 0) {
+        return 0;
+    }
+    len = utf8_cut(text, len, UI_BUS_MAX_TEXT);
+    return post(target, UI_BUS_OP_APPEND, text, len) ? len : 0;
+}
+
+bool ui_bus_set_text(uint8_t target, const char *text) {
+    if (text == NULL) {
+        return false;
+    }
+    size_t len = utf8_cut(text, strlen(text), UI_BUS_MAX_TEXT);
+    return post(target, UI_BUS_OP_SET, text, len);
+}
+
+bool ui_bus_clear(uint8_t target) {
+    return post(target, UI_BUS_OP_CLEAR, NULL, 0);
+}
+
+bool ui_bus_set_color(uint8_t target, uint32_t rgb) {
+    char bytes[3] = {(char)(rgb >> 16), (char)(rgb >> 8), (char)rgb};
+    return post(target, UI_BUS_OP_COLOR, bytes, sizeof(bytes));
+}
+
+void ui_bus_get_stats(ui_bus_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    stats->posted = atomic_load_explicit(&s_ring.posted, memory_order_relaxed);
+    stats->dropped = atomic_load_explicit(&s_ring.dropped, memory_order_relaxed);
+    stats->drained = s_drained;
+    stats->flushes = s_flushes;
+}
@@ -0,0 +1,108 @@
+/**
+ * UI 更新总线
+ * 
+ * 网络、WiFi 等任务不再直接持有 LVGL 锁改控件，而是把小的更新消息 (追加文本、设置文本、
+ * 清空、设置颜色) 投递到无锁消息环 (ui_ring)：
+ * - 投递从不阻塞，环满时立即返回失败，网络任务不会等待 LVGL 渲染
+ * - LVGL 任务中的定时器每帧 (LV_DEF_REFR_PERIOD) 取空一次消息环
+ * - 同一目标的连续追加合并为一次控件更新，一帧内到达多少片段都只排版一次
+ * 
+ * 目标编号由使用者定义，用 ui_bus_bind 绑定到 lv_label 控件。
+ */
+
+#ifndef UI_BUS_H
+#define UI_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UI_BUS_MAX_TARGETS  8       // 可绑定的目标数
+
+/**
+ * 总线统计
+ */
+typedef struct {
+    uint32_t posted;            ///< 成功投递的消息数
+    uint32_t dropped;           ///< 因环满被拒绝的消息数 (不含总线初始化前的投递)
+    uint32_t drained;           ///< LVGL 任务处理的消息数
+    uint32_t flushes;           ///< 实际的控件文本更新次数 (合并后)
+} ui_bus_stats_t;
+
+/**
+ * 初始化总线并创建每帧取消息的定时器
+ * 
+ * 须在持有 LVGL 锁时调用，重复调用只修改定时器周期。
+ * 
+ * @param period_ms 取消息周期 (毫秒)，通常为 LV_DEF_REFR_PERIOD
+ * @return ESP_OK 成功，ESP_ERR_NO_MEM 定时器创建失败
+ */
+esp_err_t ui_bus_init(uint32_t period_ms);
+
+/**
+ * 绑定目标编号和控件
+ * 
+ * 须在持有 LVGL 锁时调用。obj 为 NULL 时解除绑定，发往该目标的消息被丢弃。
+ * 
+ * @param target 目标编号 (小于 UI_BUS_MAX_TARGETS)
+ * @param obj lv_label 控件
+ */
+void ui_bus_bind(uint8_t target, lv_obj_t *obj);
+
+/**
+ * 追加文本 (任意任务，不阻塞)
+ * 
+ * 超过单条消息上限的文本只投递前面一段 (在 UTF-8 字符边界截断)，调用者可从返回的
+ * 字节数之后继续投递。
+ * 
+ * @param target 目标编号
+ * @param text 文本片段 (UTF-8，不要求以 '\0' 结尾)
+ * @param len 字节数
+ * @return 已投递的字节数，环满时为 0
+ */
+size_t ui_bus_append(uint8_t target, const char *text, size_t len);
+
+/**
+ * 替换全部文本 (任意任务，不阻塞)
+ * 
+ * @param target 目标编号
+ * @param text 文本 (以 '\0' 结尾，过长时在 UTF-8 字符边界截断)
+ * @return 投递成功返回 true
+ */
+bool ui_bus_set_text(uint8_t target, const char *text);
+
+/**
+ * 清空文本 (任意任务，不阻塞)
+ * 
+ * @param target 目标编号
+ * @return 投递成功返回 true
+ */
+bool ui_bus_clear(uint8_t target);
+
+/**
+ * 设置文本颜色 (任意任务，不阻塞)
+ * 
+ * @param target 目标编号
+ * @param rgb 颜色 (0xRRGGBB)
+ * @return 投递成功返回 true
+ */
+bool ui_bus_set_color(uint8_t target, uint32_t rgb);
+
+/**
+ * 获取统计信息
+ * 
+ * @param stats 输出统计信息
+ */
+void ui_bus_get_stats(ui_bus_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_BUS_H
@@ -0,0 +1,84 @@
+/**
+ * 多生产者单消费者无锁消息环实现
+ */
+
+#include "ui_ring.h"
+#include <string.h>
+
+void ui_ring_init(ui_ring_t *ring, ui_ring_slot_t *slots, uint32_t count) {
+    ring->slots = slots;
+    ring->mask = count - 1;
+    ring->head = 0;
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->posted, 0);
+    atomic_init(&ring->dropped, 0);
+    // 位置 i 的槽位序号等于 i 表示空闲，等于 i + 1 表示已发布
+    for (uint32_t i = 0; i < count; i++) {
+        atomic_init(&slots[i].seq, i);
+    }
+}
+
+size_t ui_ring_max_text(const ui_ring_t *ring) {
+    // 单条消息最多占一半槽位，避免一条长消息挡住其他生产者
+    return (size_t)((ring->mask + 1) / 2) * UI_RING_SLOT_TEXT;
+}
+
+bool ui_ring_post(ui_ring_t *ring, uint8_t target, uint8_t op, const char *text, size_t len) {
+    if (len > ui_ring_max_text(ring)) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+    uint32_t n = len == 0 ? 1 : (uint32_t)((len + UI_RING_SLOT_TEXT - 1) / UI_RING_SLOT_TEXT);
+    
+    // 消费者按顺序释放槽位，所以占用段的最后一个槽位空闲时整段都空闲
+    unsigned int pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    for (;;) {
+        unsigned int last = pos + n - 1;
+        unsigned int seq = atomic_load_explicit(&ring->slots[last & ring->mask].seq, memory_order_acquire);
+        int32_t diff = (int32_t)(seq - last);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos, pos + n,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 槽位还没被消费者释放：环满
+            atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+            return false;
+        } else {
+            pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+    }
+    
+    for (uint32_t i = 0; i < n; i++) {
+        ui_ring_slot_t *slot = &ring->slots[(pos + i) & ring->mask];
+        size_t chunk = len > UI_RING_SLOT_TEXT ? UI_RING_SLOT_TEXT : len;
+        slot->target = target;
+        slot->op = op;
+        slot->len = (uint8_t)chunk;
+        slot->cont = i > 0;
+        if (chunk > 0) {
+            memcpy(slot->text, text, chunk);
+            text += chunk;
+            len -= chunk;
+        }
+    }
+    // 倒序发布：首个槽位最后可见，消费者不会读到半条消息
+    for (uint32_t i = n; i-- > 0;) {
+        atomic_store_explicit(&ring->slots[(pos + i) & ring->mask].seq, pos + i + 1, memory_order_release);
+    }
+    atomic_fetch_add_explicit(&ring->posted, 1, memory_order_relaxed);
+    return true;
+}
+
+const ui_ring_slot_t *ui_ring_peek(ui_ring_t *ring) {
+    const ui_ring_slot_t *slot = &ring->slots[ring->head & ring->mask];
+    unsigned int seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    return seq == ring->head + 1 ? slot : NULL;
+}
+
+void ui_ring_release(ui_ring_t *ring) {
+    ui_ring_slot_t *slot = &ring->slots[ring->head & ring->mask];
+    atomic_store_explicit(&slot->seq, ring->head + ring->mask + 1, memory_order_release);
+    ring->head++;
+}
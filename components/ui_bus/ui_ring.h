@@ -0,0 +1,101 @@
+/**
+ * 多生产者单消费者无锁消息环
+ * 
+ * 固定大小的槽位环 (有界 MPSC 队列，每个槽位带序号)：
+ * - 生产者用一次 CAS 在尾部连续占用 n 个槽位，填好后从最后一个槽位倒序发布，
+ *   消费者因此要么看到整条消息，要么一个槽位都看不到
+ * - 环满时投递立即失败，生产者从不等待消费者
+ * - 只有一个消费者按顺序读取并释放槽位
+ * 
+ * 本模块不依赖 LVGL 和 FreeRTOS，只使用 C11 原子操作。
+ */
+
+#ifndef UI_RING_H
+#define UI_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UI_RING_SLOT_TEXT   56      // 每个槽位携带的文本字节数
+
+/**
+ * 槽位 (64 字节)
+ */
+typedef struct {
+    atomic_uint seq;                ///< 槽位序号，由环维护
+    uint8_t target;                 ///< 消息目标
+    uint8_t op;                     ///< 操作 (续接槽位忽略)
+    uint8_t len;                    ///< 本槽位文本字节数
+    uint8_t cont;                   ///< 1 表示续接上一槽位的同一条消息
+    char text[UI_RING_SLOT_TEXT];
+} ui_ring_slot_t;
+
+/**
+ * 消息环
+ */
+typedef struct {
+    ui_ring_slot_t *slots;
+    uint32_t mask;                  ///< 槽位数 - 1 (槽位数为 2 的幂)
+    atomic_uint tail;               ///< 下一个待占用的位置 (生产者)
+    uint32_t head;                  ///< 下一个待读取的位置 (消费者)
+    atomic_uint posted;             ///< 成功投递的消息数
+    atomic_uint dropped;            ///< 因环满被拒绝的消息数
+} ui_ring_t;
+
+/**
+ * 初始化消息环
+ * 
+ * @param ring 消息环
+ * @param slots 槽位数组
+ * @param count 槽位数，必须是 2 的幂
+ */
+void ui_ring_init(ui_ring_t *ring, ui_ring_slot_t *slots, uint32_t count);
+
+/**
+ * 投递一条消息 (任意任务，不阻塞)
+ * 
+ * 文本按 UI_RING_SLOT_TEXT 分到连续的槽位，整条消息要么全部投递，要么不投递。
+ * 
+ * @param ring 消息环
+ * @param target 消息目标
+ * @param op 操作
+ * @param text 文本 (可为 NULL，len 须为 0)
+ * @param len 文本字节数，不超过槽位数的一半乘以 UI_RING_SLOT_TEXT
+ * @return 成功返回 true，环满或消息过长返回 false
+ */
+bool ui_ring_post(ui_ring_t *ring, uint8_t target, uint8_t op, const char *text, size_t len);
+
+/**
+ * 查看下一个已发布的槽位 (仅消费者)
+ * 
+ * @param ring 消息环
+ * @return 槽位，没有已发布的槽位时返回 NULL
+ */
+const ui_ring_slot_t *ui_ring_peek(ui_ring_t *ring);
+
+/**
+ * 释放 ui_ring_peek 返回的槽位 (仅消费者)
+ * 
+ * @param ring 消息环
+ */
+void ui_ring_release(ui_ring_t *ring);
+
+/**
+ * 单条消息允许的最大文本字节数
+ * 
+ * @param ring 消息环
+ * @return 字节数
+ */
+size_t ui_ring_max_text(const ui_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_RING_H
@@ -0,0 +1,34 @@
+/**
+ * 主机构建用的 esp_heap_caps.h 替身：所有内存都来自 malloc
+ */
+
+#ifndef HOST_ESP_HEAP_CAPS_H
+#define HOST_ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT             (1 << 2)
+#define MALLOC_CAP_DMA              (1 << 3)
+#define MALLOC_CAP_SPIRAM           (1 << 10)
+#define MALLOC_CAP_INTERNAL         (1 << 11)
+#define MALLOC_CAP_DEFAULT          (1 << 12)
+
+static inline void *heap_caps_malloc(size_t size, uint32_t caps) {
+    return malloc(size);
+}
+
+static inline void *heap_caps_malloc_prefer(size_t size, size_t num, ...) {
+    return malloc(size);
+}
+
+static inline void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps) {
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static inline void heap_caps_free(void *ptr) {
+    free(ptr);
+}
+
+#endif // HOST_ESP_HEAP_CAPS_H
@@ -0,0 +1,19 @@
+/**
+ * 主机构建用的 esp_log.h 替身：日志写到 stderr，stdout 只留给基准结果
+ */
+
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+#include <stdio.h>
+#include "esp_err.h"
+
+#define HOST_LOG(level, tag, fmt, ...) fprintf(stderr, level " (%s) " fmt "\n", tag, ##__VA_ARGS__)
+
+#define ESP_LOGE(tag, fmt, ...) HOST_LOG("E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) HOST_LOG("W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) HOST_LOG("I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) do { } while (0)
+#define ESP_LOGV(tag, fmt, ...) do { } while (0)
+
+#endif // HOST_ESP_LOG_H
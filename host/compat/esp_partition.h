@@ -0,0 +1,55 @@
+/**
+ * 主机构建用的 esp_partition.h 替身：没有任何分区，font_manager 使用内置字体
+ */
+
+#ifndef HOST_ESP_PARTITION_H
+#define HOST_ESP_PARTITION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+typedef enum {
+    ESP_PARTITION_MMAP_DATA,
+    ESP_PARTITION_MMAP_INST,
+} esp_partition_mmap_memory_t;
+
+typedef uint32_t esp_partition_mmap_handle_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+} esp_partition_t;
+
+static inline const esp_partition_t *esp_partition_find_first(esp_partition_type_t type,
+                                                              esp_partition_subtype_t subtype, const char *label) {
+    return NULL;
+}
+
+static inline esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst,
+                                           size_t size) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline esp_err_t esp_partition_mmap(const esp_partition_t *partition, size_t offset, size_t size,
+                                           esp_partition_mmap_memory_t memory, const void **out_ptr,
+                                           esp_partition_mmap_handle_t *out_handle) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline void esp_partition_munmap(esp_partition_mmap_handle_t handle) {
+}
+
+#endif // HOST_ESP_PARTITION_H
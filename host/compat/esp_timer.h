@@ -0,0 +1,17 @@
+/**
+ * 主机构建用的 esp_timer.h 替身：esp_timer_get_time 返回单调时钟的微秒数
+ */
+
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <stdint.h>
+#include <time.h>
+
+static inline int64_t esp_timer_get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+#endif // HOST_ESP_TIMER_H
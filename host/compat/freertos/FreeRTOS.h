@@ -0,0 +1,14 @@
+/**
+ * 主机构建用的 FreeRTOS.h 替身：界面代码在单个线程中运行，不需要调度
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#endif // HOST_FREERTOS_H
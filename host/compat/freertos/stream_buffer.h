@@ -0,0 +1,76 @@
+/**
+ * 主机构建用的 stream_buffer.h 替身：单线程环形缓冲区，不阻塞、不加锁
+ * 
+ * 容量、部分写入和部分读取的语义与 FreeRTOS 相同；timeout 被忽略。
+ */
+
+#ifndef HOST_FREERTOS_STREAM_BUFFER_H
+#define HOST_FREERTOS_STREAM_BUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+
+typedef struct {
+    uint8_t *data;
+    size_t size;                        // 容量 + 1，头尾相等表示空
+    size_t head;                        // 下一个写入位置
+    size_t tail;                        // 下一个读取位置
+} host_stream_buffer_t;
+
+typedef host_stream_buffer_t *StreamBufferHandle_t;
+
+static inline StreamBufferHandle_t xStreamBufferCreate(size_t size, size_t trigger_level) {
+    StreamBufferHandle_t sb = calloc(1, sizeof(host_stream_buffer_t));
+    if (sb == NULL) {
+        return NULL;
+    }
+    sb->size = size + 1;
+    sb->data = malloc(sb->size);
+    if (sb->data == NULL) {
+        free(sb);
+        return NULL;
+    }
+    return sb;
+}
+
+static inline void vStreamBufferDelete(StreamBufferHandle_t sb) {
+    free(sb->data);
+    free(sb);
+}
+
+static inline size_t xStreamBufferBytesAvailable(StreamBufferHandle_t sb) {
+    return sb->head >= sb->tail ? sb->head - sb->tail : sb->size - sb->tail + sb->head;
+}
+
+static inline size_t xStreamBufferSpacesAvailable(StreamBufferHandle_t sb) {
+    return sb->size - 1 - xStreamBufferBytesAvailable(sb);
+}
+
+static inline size_t xStreamBufferSend(StreamBufferHandle_t sb, const void *data, size_t len, TickType_t timeout) {
+    size_t space = xStreamBufferSpacesAvailable(sb);
+    if (len > space) {
+        len = space;
+    }
+    size_t first = sb->size - sb->head < len ? sb->size - sb->head : len;
+    memcpy(sb->data + sb->head, data, first);
+    memcpy(sb->data, (const uint8_t *)data + first, len - first);
+    sb->head = (sb->head + len) % sb->size;
+    return len;
+}
+
+static inline size_t xStreamBufferReceive(StreamBufferHandle_t sb, void *data, size_t len, TickType_t timeout) {
+    size_t avail = xStreamBufferBytesAvailable(sb);
+    if (len > avail) {
+        len = avail;
+    }
+    size_t first = sb->size - sb->tail < len ? sb->size - sb->tail : len;
+    memcpy(data, sb->data + sb->tail, first);
+    memcpy((uint8_t *)data + first, sb->data, len - first);
+    sb->tail = (sb->tail + len) % sb->size;
+    return len;
+}
+
+#endif // HOST_FREERTOS_STREAM_BUFFER_H
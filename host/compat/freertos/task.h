@@ -0,0 +1,14 @@
+/**
+ * 主机构建用的 task.h 替身
+ */
+
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+static inline void vTaskDelay(TickType_t ticks) {
+    (void)ticks;
+}
+
+#endif // HOST_FREERTOS_TASK_H
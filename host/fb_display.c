@@ -0,0 +1,75 @@
+/**
+ * 内存帧缓冲区显示驱动实现
+ */
+
+#include "fb_display.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint16_t *s_fb = NULL;
+static int32_t s_width = 0;
+static int32_t s_height = 0;
+static uint32_t s_tick_ms = 0;
+
+static uint32_t tick_cb(void) {
+    return s_tick_ms;
+}
+
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
+    int32_t w = lv_area_get_width(area);
+    const uint16_t *src = (const uint16_t *)px_map;
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(s_fb + (size_t)y * s_width + area->x1, src, (size_t)w * sizeof(uint16_t));
+        src += w;
+    }
+    lv_display_flush_ready(disp);
+}
+
+lv_display_t *fb_display_create(int32_t width, int32_t height, int32_t buffer_lines, bool double_buffer) {
+    size_t buf_size = (size_t)width * buffer_lines * sizeof(uint16_t);
+    s_fb = calloc((size_t)width * height, sizeof(uint16_t));
+    void *buf1 = malloc(buf_size);
+    void *buf2 = double_buffer ? malloc(buf_size) : NULL;
+    if (s_fb == NULL || buf1 == NULL || (double_buffer && buf2 == NULL)) {
+        free(s_fb);
+        free(buf1);
+        free(buf2);
+        s_fb = NULL;
+        return NULL;
+    }
+    s_width = width;
+    s_height = height;
+    
+    lv_tick_set_cb(tick_cb);
+    lv_display_t *disp = lv_display_create(width, height);
+    if (disp == NULL) {
+        return NULL;
+    }
+    lv_display_set_color_format(disp, LV_COLOR_FORMAT_RGB565);
+    lv_display_set_buffers(disp, buf1, buf2, (uint32_t)buf_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_cb(disp, flush_cb);
+    return disp;
+}
+
+void fb_display_advance(uint32_t ms) {
+    s_tick_ms += ms;
+}
+
+bool fb_display_save_ppm(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return false;
+    }
+    fprintf(f, "P6\n%ld %ld\n255\n", (long)s_width, (long)s_height);
+    for (size_t i = 0; i < (size_t)s_width * s_height; i++) {
+        uint16_t c = s_fb[i];
+        uint8_t rgb[3] = {
+            (uint8_t)(((c >> 11) & 0x1F) * 255 / 31),
+            (uint8_t)(((c >> 5) & 0x3F) * 255 / 63),
+            (uint8_t)((c & 0x1F) * 255 / 31),
+        };
+        fwrite(rgb, 1, sizeof(rgb), f);
+    }
+    return fclose(f) == 0;
+}
@@ -0,0 +1,52 @@
+/**
+ * 内存帧缓冲区显示驱动
+ * 
+ * 代替设备上的 ST7789 + esp_lvgl_port：LVGL 按设备上相同的分块方式渲染到 N 行的缓冲区，
+ * flush_cb 把每一块复制到 RGB565 帧缓冲区后立即完成。LVGL 的时钟由 fb_display_advance
+ * 推进，基准按固定的帧间隔运行，结果与主机负载无关。
+ */
+
+#ifndef FB_DISPLAY_H
+#define FB_DISPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 创建显示器并设为默认显示器
+ * 
+ * 须在 lv_init 之后调用，只能调用一次。
+ * 
+ * @param width 水平分辨率
+ * @param height 垂直分辨率
+ * @param buffer_lines 每个渲染缓冲区的行数
+ * @param double_buffer 是否使用两个渲染缓冲区
+ * @return 显示器，内存不足时返回 NULL
+ */
+lv_display_t *fb_display_create(int32_t width, int32_t height, int32_t buffer_lines, bool double_buffer);
+
+/**
+ * 推进 LVGL 时钟
+ * 
+ * @param ms 毫秒数
+ */
+void fb_display_advance(uint32_t ms);
+
+/**
+ * 把当前帧缓冲区保存为 PPM 图片
+ * 
+ * @param path 文件路径
+ * @return 是否成功
+ */
+bool fb_display_save_ppm(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FB_DISPLAY_H
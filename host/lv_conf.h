@@ -0,0 +1,47 @@
+/**
+ * 主机构建的 LVGL 配置
+ * 
+ * 与设备上 sdkconfig 中的 LVGL 选项保持一致 (RGB565、33 ms 刷新周期、单个软件绘制单元、
+ * 压缩字体、换行字符)，渲染结果和每帧的绘制工作量与设备相同。对象内存改用 malloc：64 位主机上
+ * 指针更大，设备上的 64 KB 内置堆不够用。其余选项使用 LVGL 9.3 的默认值。
+ */
+
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH                  16
+
+#define LV_USE_STDLIB_MALLOC            LV_STDLIB_CLIB
+#define LV_USE_STDLIB_STRING            LV_STDLIB_BUILTIN
+#define LV_USE_STDLIB_SPRINTF           LV_STDLIB_BUILTIN
+
+#define LV_DEF_REFR_PERIOD              33
+#define LV_DPI_DEF                      130
+
+#define LV_USE_OS                       LV_OS_NONE
+
+#define LV_USE_DRAW_SW                  1
+#define LV_DRAW_SW_DRAW_UNIT_CNT        1
+#define LV_DRAW_SW_COMPLEX              1
+#define LV_DRAW_LAYER_SIMPLE_BUF_SIZE   (24 * 1024)
+#define LV_CACHE_DEF_SIZE               0
+#define LV_IMAGE_HEADER_CACHE_DEF_CNT   0
+
+#define LV_USE_LOG                      0
+#define LV_USE_ASSERT_NULL              1
+#define LV_USE_ASSERT_MALLOC            1
+
+#define LV_FONT_MONTSERRAT_14           1
+#define LV_FONT_DEFAULT                 &lv_font_montserrat_14
+#define LV_FONT_FMT_TXT_LARGE           1
+#define LV_USE_FONT_COMPRESSED          1
+#define LV_TXT_BREAK_CHARS              " ,.;:-_)}"    // sdkconfig 的值，比默认值少 ']'
+
+#define LV_USE_THEME_DEFAULT            1
+#define LV_USE_FLEX                     1
+#define LV_USE_GRID                     1
+
+#define LV_BUILD_EXAMPLES               0
+#define LV_BUILD_DEMOS                  0
+
+#endif // LV_CONF_H
@@ -0,0 +1,341 @@
+/**
+ * 对话界面主机基准
+ * 
+ * 在内存帧缓冲区上运行设备上的同一份界面代码 (mario_ui、font_manager、chat_view、ui_bus)，
+ * 按脚本模拟智能体的回复，LVGL 时钟每帧推进 LV_DEF_REFR_PERIOD。每个场景输出：
+ * - 渲染的帧数和每帧渲染耗时 (平均、中位数、99 分位、最大；主机上的墙钟时间，只用于相互比较)
+ * - 每帧无效区域像素数 (合并前) 和实际渲染的像素数
+ * - 每帧取字形位图的次数 (链接时包装 lv_font_get_glyph_bitmap 计数；跨越多个渲染分块的字形每块计一次)
+ * - UI 总线 (状态栏) 的控件更新次数和因消息环满被拒绝的消息数；对话历史由 mario_ui 每帧直接拉取，不经过总线
+ * 
+ * 场景：
+ * - stream_N：中英混合的回复按每秒 N 个片段流式到达，每个片段 3 个字符
+ * - long_zh：约 6 KB 的长中文回复，超出 4 KB 回复缓冲区的部分只显示不播报
+ * - status_flicker：对话历史不变，状态栏每帧切换文本
+ * 
+ * 构建见 CMakeLists.txt，运行：
+ *   ui_bench [--lines N] [--single] [--ppm DIR] [场景名...]
+ * --lines/--single 选择渲染缓冲区布局 (默认与设备相同：10 行双缓冲)，
+ * --ppm 把每个场景结束时的画面保存为 DIR/<场景名>.ppm。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lvgl.h"
+#include "fb_display.h"
+#include "font_manager.h"
+#include "mario_ui.h"
+#include "ui_bus.h"
+#include "disp_perf.h"
+
+#define LCD_H_RES       320
+#define LCD_V_RES       240
+#define FRAGMENT_CHARS  3
+#define SETTLE_FRAMES   300
+#define FLICKER_FRAMES  300
+
+/**
+ * 基准场景
+ */
+typedef struct {
+    const char *name;
+    uint32_t rate;              ///< 每秒到达的片段数，0 表示状态栏闪烁
+    size_t answer_len;          ///< 回复字节数
+    bool chinese_only;          ///< 只用中文句子
+} scenario_t;
+
+static const scenario_t s_scenarios[] = {
+    {"stream_10", 10, 1500, false},
+    {"stream_30", 30, 1500, false},
+    {"stream_100", 100, 1500, false},
+    {"stream_1000", 1000, 1500, false},     // 一帧内到达三十多个片段
+    {"long_zh", 50, 6144, true},
+    {"status_flicker", 0, 0, false},
+};
+
+/**
+ * 一个场景的统计
+ */
+typedef struct {
+    uint32_t frames;            ///< 推进的帧数
+    uint32_t *render_us;        ///< 每个渲染了内容的帧的耗时
+    size_t rendered;
+    size_t cap;
+    uint64_t inv_px;
+    uint64_t flush_px;
+    uint64_t glyphs;
+} run_stats_t;
+
+static uint64_t s_glyphs = 0;
+
+// 链接时以 -Wl,--wrap=lv_font_get_glyph_bitmap 替换 LVGL 绘制文字时取字形位图的调用。
+// --wrap 只重定向目标文件之间的未定义引用：LVGL 为共享库、开启 LTO，或调用方与 lv_font.c
+// 在同一个编译单元时计数恒为 0，main 在第一次渲染后检查并提示。
+const void *__real_lv_font_get_glyph_bitmap(lv_font_glyph_dsc_t *g_dsc, lv_draw_buf_t *draw_buf);
+
+const void *__wrap_lv_font_get_glyph_bitmap(lv_font_glyph_dsc_t *g_dsc, lv_draw_buf_t *draw_buf) {
+    s_glyphs++;
+    return __real_lv_font_get_glyph_bitmap(g_dsc, draw_buf);
+}
+
+/**
+ * 推进一帧并记录这一帧的开销
+ */
+static void step(run_stats_t *rs) {
+    disp_perf_stats_t before;
+    disp_perf_stats_t after;
+    disp_perf_get_stats(&before);
+    uint64_t glyphs = s_glyphs;
+    
+    fb_display_advance(LV_DEF_REFR_PERIOD);
+    lv_timer_handler();
+    
+    disp_perf_get_stats(&after);
+    rs->frames++;
+    rs->inv_px += after.inv_px - before.inv_px;
+    rs->flush_px += after.flush_px - before.flush_px;
+    rs->glyphs += s_glyphs - glyphs;
+    if (after.frames == before.frames) {
+        return;
+    }
+    if (rs->rendered == rs->cap) {
+        rs->cap = rs->cap ? rs->cap * 2 : 256;
+        rs->render_us = realloc(rs->render_us, rs->cap * sizeof(uint32_t));
+        if (rs->render_us == NULL) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    rs->render_us[rs->rendered++] = (uint32_t)(after.frame_us - before.frame_us);
+}
+
+/**
+ * 推进到消息环取空、连续几帧没有内容需要渲染为止
+ */
+static void settle(run_stats_t *rs) {
+    int quiet = 0;
+    for (int i = 0; i < SETTLE_FRAMES && quiet < 3; i++) {
+        size_t rendered = rs->rendered;
+        step(rs);
+        quiet = rs->rendered == rendered ? quiet + 1 : 0;
+    }
+}
+
+/**
+ * 生成回复文本，在完整的句子或单词处结束
+ */
+static size_t make_answer(char *out, size_t len, bool chinese_only, unsigned seed) {
+    static const char *const zh[] = {
+        "今天天气晴朗，适合出门散步。", "人工智能正在改变我们的生活方式。", "马里奥是任天堂最著名的游戏角色之一。",
+        "请注意保暖，早晚温差比较大。", "这道菜需要先把鸡蛋打散，再用小火慢慢炒熟。", "长城是中国古代伟大的防御工程。",
+        "学习编程最重要的是多动手实践。", "春眠不觉晓，处处闻啼鸟。", "地球绕太阳公转一周大约需要三百六十五天。",
+        "祝你今天心情愉快，工作顺利！", "\n",
+    };
+    static const char *const latin[] = {"ESP32-S3 ", "LVGL 9.3 ", "WiFi ", "API ", "OK, ", "2024 年"};
+    size_t pos = 0;
+    for (;;) {
+        seed = seed * 1103515245 + 12345;
+        unsigned r = seed >> 16;
+        const char *w = (!chinese_only && r % 3 == 0) ? latin[r / 3 % (sizeof(latin) / sizeof(latin[0]))]
+                                                      : zh[r % (sizeof(zh) / sizeof(zh[0]))];
+        size_t wl = strlen(w);
+        if (pos + wl > len) {
+            break;
+        }
+        memcpy(out + pos, w, wl);
+        pos += wl;
+    }
+    return pos;
+}
+
+/**
+ * 从 pos 开始取 FRAGMENT_CHARS 个 UTF-8 字符
+ */
+static size_t next_fragment(const char *text, size_t len, size_t pos) {
+    size_t end = pos;
+    for (int c = 0; c < FRAGMENT_CHARS && end < len; c++) {
+        end++;
+        while (end < len && ((uint8_t)text[end] & 0xC0) == 0x80) {
+            end++;
+        }
+    }
+    return end - pos;
+}
+
+static void run_stream(const scenario_t *sc, run_stats_t *rs) {
+    char *answer = malloc(sc->answer_len);
+    if (answer == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    size_t len = make_answer(answer, sc->answer_len, sc->chinese_only, 1);
+    
+    mario_ui_question("给我讲讲今天有什么新鲜事？");
+    mario_ui_reply_started();
+    size_t pos = 0;
+    uint64_t sent = 0;
+    uint64_t t_ms = 0;
+    while (pos < len) {
+        t_ms += LV_DEF_REFR_PERIOD;
+        // 到这一帧为止应该到达的片段
+        while (pos < len && sent * 1000 < t_ms * sc->rate) {
+            size_t n = next_fragment(answer, len, pos);
+            mario_ui_reply_fragment(answer + pos, n);
+            pos += n;
+            sent++;
+        }
+        step(rs);
+    }
+    mario_ui_reply_finished(NULL);
+    settle(rs);
+    free(answer);
+}
+
+static void run_status_flicker(run_stats_t *rs) {
+    static const char *const texts[] = {"发送中...", "回答中...", "回答结束", "WiFi 已连接"};
+    for (int i = 0; i < FLICKER_FRAMES; i++) {
+        mario_ui_set_status(texts[i % (sizeof(texts) / sizeof(texts[0]))]);
+        step(rs);
+    }
+    settle(rs);
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void report(const char *name, run_stats_t *rs, const ui_bus_stats_t *bus, bool glyphs_counted) {
+    size_t n = rs->rendered;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += rs->render_us[i];
+    }
+    if (n > 0) {
+        qsort(rs->render_us, n, sizeof(uint32_t), cmp_u32);
+    }
+    size_t div = n > 0 ? n : 1;
+    char glyphs[16];
+    if (glyphs_counted) {
+        snprintf(glyphs, sizeof(glyphs), "%.1f", (double)rs->glyphs / div);
+    } else {
+        snprintf(glyphs, sizeof(glyphs), "n/a");
+    }
+    printf("%-16s %7u %7zu %8.1f %7u %7u %7u %9llu %9llu %8s %7u %7u\n", name, rs->frames, n,
+           (double)sum / div,
+           n > 0 ? rs->render_us[n / 2] : 0,
+           n > 0 ? rs->render_us[n * 99 / 100] : 0,
+           n > 0 ? rs->render_us[n - 1] : 0,
+           (unsigned long long)(rs->inv_px / div),
+           (unsigned long long)(rs->flush_px / div),
+           glyphs,
+           bus->flushes, bus->dropped);
+}
+
+/**
+ * 每个场景在新的屏幕上从空的对话历史开始
+ */
+static void new_screen(void) {
+    lv_obj_t *old = lv_screen_active();
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_screen_load(scr);
+    mario_ui_create(scr);
+    lv_obj_delete(old);
+    
+    run_stats_t rs = {0};
+    settle(&rs);
+    free(rs.render_us);
+}
+
+static bool selected(const char *name, int argc, char **argv, int first) {
+    if (first >= argc) {
+        return true;
+    }
+    for (int i = first; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    int32_t lines = 10;
+    bool double_buffer = true;
+    const char *ppm_dir = NULL;
+    int first = 1;
+    while (first < argc && strncmp(argv[first], "--", 2) == 0) {
+        if (strcmp(argv[first], "--lines") == 0 && first + 1 < argc) {
+            lines = atoi(argv[first + 1]);
+            first += 2;
+        } else if (strcmp(argv[first], "--single") == 0) {
+            double_buffer = false;
+            first++;
+        } else if (strcmp(argv[first], "--ppm") == 0 && first + 1 < argc) {
+            ppm_dir = argv[first + 1];
+            first += 2;
+        } else {
+            fprintf(stderr, "usage: %s [--lines N] [--single] [--ppm DIR] [scenario...]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (lines < 1 || lines > LCD_V_RES) {
+        fprintf(stderr, "--lines must be 1..%d\n", LCD_V_RES);
+        return 2;
+    }
+    
+    lv_init();
+    lv_display_t *disp = fb_display_create(LCD_H_RES, LCD_V_RES, lines, double_buffer);
+    if (disp == NULL) {
+        fprintf(stderr, "display creation failed\n");
+        return 1;
+    }
+    font_manager_init();
+    disp_perf_init(disp);
+    
+    printf("display %dx%d, render buffer %ld lines x %d, frame period %d ms\n\n", LCD_H_RES, LCD_V_RES,
+           (long)lines, double_buffer ? 2 : 1, LV_DEF_REFR_PERIOD);
+    printf("%-16s %7s %7s %8s %7s %7s %7s %9s %9s %8s %7s %7s\n", "scenario", "frames", "drawn", "avg us",
+           "p50 us", "p99 us", "max us", "inv px", "drawn px", "glyphs", "updates", "dropped");
+    
+    bool glyphs_counted = true;
+    for (size_t i = 0; i < sizeof(s_scenarios) / sizeof(s_scenarios[0]); i++) {
+        const scenario_t *sc = &s_scenarios[i];
+        if (!selected(sc->name, argc, argv, first)) {
+            continue;
+        }
+        new_screen();
+        // 新屏幕上的标题和状态栏已经渲染过，包装生效时计数不为 0
+        if (glyphs_counted && s_glyphs == 0) {
+            fprintf(stderr, "warning: no glyph bitmap fetches counted, -Wl,--wrap=lv_font_get_glyph_bitmap "
+                            "did not take effect (shared or LTO LVGL build?)\n");
+            glyphs_counted = false;
+        }
+        
+        ui_bus_stats_t bus_before;
+        ui_bus_stats_t bus_after;
+        ui_bus_get_stats(&bus_before);
+        run_stats_t rs = {0};
+        if (sc->rate > 0) {
+            run_stream(sc, &rs);
+        } else {
+            run_status_flicker(&rs);
+        }
+        ui_bus_get_stats(&bus_after);
+        bus_after.flushes -= bus_before.flushes;
+        bus_after.dropped -= bus_before.dropped;
+        report(sc->name, &rs, &bus_after, glyphs_counted);
+        free(rs.render_us);
+        
+        if (ppm_dir != NULL) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s/%s.ppm", ppm_dir, sc->name);
+            if (!fb_display_save_ppm(path)) {
+                fprintf(stderr, "cannot write %s\n", path);
+            }
+        }
+    }
+    return 0;
+}
@@ -16,10 +16,15 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "lvgl.h"
+#include "pca9557.h"
 #include "baidu_agent_client.h"
 #include "wifi_manager.h"
 #include "font_manager.h"
+#include "char_usage.h"
+#include "mario_ui.h"
 #include "tts_service.h"
+#include "audio_output.h"
+#include "disp_perf.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -29,7 +34,6 @@ static const char *TAG = "MARIO_AI";
 #define I2C_MASTER_NUM I2C_NUM_1
 #define I2C_MASTER_SDA_IO 1
 #define I2C_MASTER_SCL_IO 2
-#define PCA9557_ADDR 0x19
 
 // ST7789 显示屏配置 - 立创实战派 ESP32-S3
 #define LCD_HOST SPI3_HOST
@@ -54,55 +58,36 @@ static const char *TAG = "MARIO_AI";
 #define DISPLAY_SWAP_XY true
 #define DISPLAY_INVERT_COLOR true
 
+// LVGL 渲染缓冲区布局（menuconfig → Mario AI Display）
+#if CONFIG_DISPLAY_BUFFER_FULL_FRAME
+#define DISPLAY_BUFFER_LINES LCD_V_RES
+#elif CONFIG_DISPLAY_BUFFER_HALF_FRAME
+#define DISPLAY_BUFFER_LINES (LCD_V_RES / 2)
+#else
+#define DISPLAY_BUFFER_LINES CONFIG_DISPLAY_BUFFER_STRIP_LINES
+#endif
+#if CONFIG_DISPLAY_BUFFER_SPIRAM
+// PSRAM 中的缓冲区经内部 DMA 中转缓冲区分块发送
+#define DISPLAY_BOUNCE_LINES CONFIG_DISPLAY_BUFFER_BOUNCE_LINES
+#else
+#define DISPLAY_BOUNCE_LINES 0
+#endif
+#if CONFIG_DISPLAY_BUFFER_DOUBLE
+#define DISPLAY_DOUBLE_BUFFER true
+#else
+#define DISPLAY_DOUBLE_BUFFER false
+#endif
+
 static lv_display_t *lvgl_disp = NULL;
 static esp_lcd_panel_io_handle_t panel_io = NULL;
 static esp_lcd_panel_handle_t panel = NULL;
 static i2c_master_bus_handle_t i2c_bus = NULL;
-static i2c_master_dev_handle_t pca9557_dev = NULL;
 
 // 百度智能体客户端
 static baidu_agent_handle_t agent_handle = NULL;
-static lv_obj_t *title_label = NULL;        // 顶部标题
-static lv_obj_t *user_input_label = NULL;   // 用户输入（右对齐）
-static lv_obj_t *response_label = NULL;     // AI 响应（左对齐）
-static lv_obj_t *status_label = NULL;       // 底部状态（右下角）
-
-// 响应文本累积缓冲区（用于屏幕显示和 TTS 播报）
-#define RESPONSE_BUFFER_SIZE 4096
-static char response_buffer[RESPONSE_BUFFER_SIZE] = {0};
-static size_t response_buffer_len = 0;
-
 // 当前用户输入
 static char current_user_input[256] = {0};
 
-// PCA9557 寄存器地址
-#define PCA9557_REG_INPUT 0x00
-#define PCA9557_REG_OUTPUT 0x01
-#define PCA9557_REG_POLARITY 0x02
-#define PCA9557_REG_CONFIG 0x03
-
-// PCA9557 写寄存器
-static esp_err_t pca9557_write_reg(uint8_t reg, uint8_t data) {
-  uint8_t write_buf[2] = {reg, data};
-  return i2c_master_transmit(pca9557_dev, write_buf, 2, -1);
-}
-
-// PCA9557 读寄存器
-static esp_err_t pca9557_read_reg(uint8_t reg, uint8_t *data) {
-  return i2c_master_transmit_receive(pca9557_dev, &reg, 1, data, 1, -1);
-}
-
-// PCA9557 设置输出引脚状态
-static esp_err_t pca9557_set_output(uint8_t bit, uint8_t level) {
-  uint8_t data;
-  esp_err_t ret = pca9557_read_reg(PCA9557_REG_OUTPUT, &data);
-  if (ret != ESP_OK) {
-    return ret;
-  }
-  data = (data & ~(1 << bit)) | (level << bit);
-  return pca9557_write_reg(PCA9557_REG_OUTPUT, data);
-}
-
 // 初始化 I2C 和 PCA9557
 static void init_i2c_and_pca9557(void) {
   ESP_LOGI(TAG, "初始化 I2C 总线...");
@@ -117,18 +102,10 @@ static void init_i2c_and_pca9557(void) {
   ESP_ERROR_CHECK(i2c_new_master_bus(&i2c_bus_cfg, &i2c_bus));
   ESP_LOGI(TAG, "✓ I2C 总线初始化完成");
 
+  // 配置 PCA9557: 设置输出方向和初始状态 (音频输出共用同一驱动实例)
   ESP_LOGI(TAG, "初始化 PCA9557 IO 扩展芯片...");
-  i2c_device_config_t pca9557_cfg = {
-      .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-      .device_address = PCA9557_ADDR,
-      .scl_speed_hz = 100000,
-  };
-  ESP_ERROR_CHECK(
-      i2c_master_bus_add_device(i2c_bus, &pca9557_cfg, &pca9557_dev));
-
-  // 配置 PCA9557: 设置输出方向和初始状态
-  ESP_ERROR_CHECK(pca9557_write_reg(PCA9557_REG_OUTPUT, 0x03));
-  ESP_ERROR_CHECK(pca9557_write_reg(PCA9557_REG_CONFIG, 0xf8));
+  ESP_ERROR_CHECK(pca9557_init(i2c_bus, PCA9557_DEFAULT_OUTPUT,
+                               PCA9557_DEFAULT_CONFIG));
   ESP_LOGI(TAG, "✓ PCA9557 初始化完成");
 }
 
@@ -192,7 +169,7 @@ static void init_lcd_panel(void) {
 
   // 通过 PCA9557 控制显示屏复位 (bit 0)
   ESP_LOGI(TAG, "通过 PCA9557 控制显示屏使能...");
-  ESP_ERROR_CHECK(pca9557_set_output(0, 0));
+  ESP_ERROR_CHECK(pca9557_set_output(PCA9557_PIN_LCD_CS, 0));
   vTaskDelay(pdMS_TO_TICKS(10));
 
   ESP_ERROR_CHECK(esp_lcd_panel_init(panel));
@@ -228,14 +205,15 @@ static void init_lvgl(void) {
   ESP_ERROR_CHECK(lvgl_port_init(&port_cfg));
   ESP_LOGI(TAG, "✓ LVGL 端口初始化完成");
 
-  ESP_LOGI(TAG, "添加 LCD 显示器...");
+  ESP_LOGI(TAG, "添加 LCD 显示器 (渲染缓冲区 %d 行 x %d%s)...", DISPLAY_BUFFER_LINES,
+           DISPLAY_DOUBLE_BUFFER ? 2 : 1, DISPLAY_BOUNCE_LINES > 0 ? "，PSRAM" : "");
   const lvgl_port_display_cfg_t display_cfg = {
       .io_handle = panel_io,
       .panel_handle = panel,
       .control_handle = NULL,
-      .buffer_size = LCD_H_RES * 10, // 减小缓冲区到10行，避免看门狗超时
-      .double_buffer = true,  // 启用双缓冲提高性能
-      .trans_size = 0,
+      .buffer_size = LCD_H_RES * DISPLAY_BUFFER_LINES,
+      .double_buffer = DISPLAY_DOUBLE_BUFFER,  // 渲染下一块的同时 DMA 发送上一块
+      .trans_size = LCD_H_RES * DISPLAY_BOUNCE_LINES,
       .hres = LCD_H_RES,
       .vres = LCD_V_RES,
       .monochrome = false,
@@ -248,8 +226,8 @@ static void init_lvgl(void) {
       .color_format = LV_COLOR_FORMAT_RGB565,
       .flags =
           {
-              .buff_dma = 1,
-              .buff_spiram = 0,
+              .buff_dma = DISPLAY_BOUNCE_LINES == 0,
+              .buff_spiram = DISPLAY_BOUNCE_LINES > 0,
               .sw_rotate = 0,
               .swap_bytes = 1,
               .full_refresh = 0,
@@ -259,7 +237,7 @@ static void init_lvgl(void) {
 
   lvgl_disp = lvgl_port_add_disp(&display_cfg);
   if (lvgl_disp == NULL) {
-    ESP_LOGE(TAG, "✗ 添加显示器失败");
+    ESP_LOGE(TAG, "✗ 添加显示器失败（渲染缓冲区内存不足？）");
     return;
   }
 
@@ -267,6 +245,12 @@ static void init_lvgl(void) {
     lv_display_set_offset(lvgl_disp, DISPLAY_OFFSET_X, DISPLAY_OFFSET_Y);
   }
 
+  // 刷新统计（CONFIG_DISP_PERF_MONITOR / CONFIG_DISP_PERF_BENCH 关闭时为空操作）
+  if (lvgl_port_lock(0)) {
+    disp_perf_init(lvgl_disp);
+    lvgl_port_unlock();
+  }
+
   ESP_LOGI(TAG, "✓ LCD 显示器添加完成");
 }
 
@@ -280,68 +264,38 @@ static void agent_event_callback(
   switch (event_type) {
     case BAIDU_AGENT_EVENT_CONNECTED:
       ESP_LOGI(TAG, "百度智能体已连接");
-      if (lvgl_port_lock(100)) {
-        if (status_label != NULL) {
-          const char *status_text = "回答中...";
-          lv_label_set_text(status_label, status_text);
-          lv_obj_set_style_text_font(status_label, font_manager_get_font(status_text, 10), 0);
-        }
-        lvgl_port_unlock();
-      }
+      // 回复即将到达，提前打开功放
+      audio_output_pa_prewarm();
+      mario_ui_reply_started();
       break;
       
     case BAIDU_AGENT_EVENT_MESSAGE:
       ESP_LOGI(TAG, "收到回复片段: %.*s", (int)data_len, data);
-      
-      // 追加到响应缓冲区（用于显示和最终 TTS 播报）
-      if (response_buffer_len + data_len < RESPONSE_BUFFER_SIZE - 1) {
-        memcpy(response_buffer + response_buffer_len, data, data_len);
-        response_buffer_len += data_len;
-        response_buffer[response_buffer_len] = '\0';
-      }
-      
-      // 更新屏幕显示
-      if (lvgl_port_lock(100)) {
-        if (response_label != NULL) {
-          lv_label_set_text(response_label, response_buffer);
-          lv_obj_set_style_text_font(response_label, font_manager_get_font(response_buffer, 14), 0);
-        }
-        lvgl_port_unlock();
-      }
-      // 注意：不再实时进行 TTS 播报，等所有数据返回后统一播报
+      // 追加到回复缓冲区并显示；不再实时进行 TTS 播报，等所有数据返回后统一播报
+      mario_ui_reply_fragment(data, data_len);
       break;
       
     case BAIDU_AGENT_EVENT_ERROR:
       ESP_LOGE(TAG, "错误: %s", data);
-      if (lvgl_port_lock(100)) {
-        if (status_label != NULL) {
-          char error_text[64];
-          snprintf(error_text, sizeof(error_text), "错误: %s", data);
-          lv_label_set_text(status_label, error_text);
-          lv_obj_set_style_text_font(status_label, font_manager_get_font(error_text, 10), 0);
-          lv_obj_set_style_text_color(status_label, lv_color_hex(0xFF0000), 0);
-        }
-        lvgl_port_unlock();
-      }
+      mario_ui_error(data);
       break;
       
     case BAIDU_AGENT_EVENT_DISCONNECTED:
       ESP_LOGI(TAG, "百度智能体已断开，SSE 数据接收完成");
-      
-      // 所有 SSE 数据接收完成后，调用一次 TTS 播报（边下载边播放）
-      if (response_buffer_len > 0) {
-        ESP_LOGI(TAG, "开始 TTS 播报 (%d 字节): %s", (int)response_buffer_len, response_buffer);
-        tts_speak_async(response_buffer);
-      }
-      
-      if (lvgl_port_lock(100)) {
-        if (status_label != NULL) {
-          const char *done_text = "回答结束";
-          lv_label_set_text(status_label, done_text);
-          lv_obj_set_style_text_font(status_label, font_manager_get_font(done_text, 10), 0);
-          lv_obj_set_style_text_color(status_label, lv_color_hex(0xFFD700), 0);
+      {
+        size_t response_len = 0;
+        const char *response = mario_ui_reply_finished(&response_len);
+        
+        // 所有 SSE 数据接收完成后，调用一次 TTS 播报（边下载边播放）
+        if (response_len > 0) {
+          ESP_LOGI(TAG, "开始 TTS 播报 (%d 字节): %s", (int)response_len, response);
+          tts_speak_async(response);
         }
-        lvgl_port_unlock();
+        
+        // 统计本轮显示的中文字符，用于裁剪字体（CONFIG_FONT_MANAGER_CHAR_USAGE 关闭时为空操作）
+        char_usage_add(current_user_input, strlen(current_user_input));
+        char_usage_add(response, response_len);
+        char_usage_dump();
       }
       break;
       
@@ -356,59 +310,7 @@ static void create_mario_ui(void) {
 
   // 锁定 LVGL
   if (lvgl_port_lock(0)) {
-    // 获取活动屏幕
-    lv_obj_t *scr = lv_screen_active();
-
-    // 设置背景色为纯黑色
-    ESP_LOGI(TAG, "  - 设置背景色");
-    lv_obj_set_style_bg_color(scr, lv_color_hex(0x000000), LV_PART_MAIN);
-
-    // 顶部标题 "百度智能体"
-    ESP_LOGI(TAG, "  - 创建顶部标题");
-    title_label = lv_label_create(scr);
-    const char *title_text = "百度智能体";
-    lv_label_set_text(title_label, title_text);
-    lv_obj_set_style_text_color(title_label, lv_color_white(), 0);
-    lv_obj_set_style_text_font(title_label, font_manager_get_font(title_text, 16), 0);
-    lv_obj_align(title_label, LV_ALIGN_TOP_MID, 0, 5);
-
-    // 用户输入标签（第二行，右对齐）
-    ESP_LOGI(TAG, "  - 创建用户输入标签");
-    user_input_label = lv_label_create(scr);
-    lv_label_set_text(user_input_label, "");
-    lv_obj_set_style_text_color(user_input_label, lv_color_hex(0x4CAF50), 0);  // 绿色
-    lv_obj_set_style_text_font(user_input_label, font_manager_get_font("", 12), 0);
-    lv_obj_set_width(user_input_label, LCD_H_RES - 20);
-    lv_label_set_long_mode(user_input_label, LV_LABEL_LONG_WRAP);
-    lv_obj_set_style_text_align(user_input_label, LV_TEXT_ALIGN_RIGHT, 0);
-    lv_obj_align(user_input_label, LV_ALIGN_TOP_RIGHT, -10, 30);
-
-    // AI 响应标签（左对齐，占据大部分空间）
-    ESP_LOGI(TAG, "  - 创建响应标签");
-    response_label = lv_label_create(scr);
-    const char *wait_text = "等待消息...";
-    lv_label_set_text(response_label, wait_text);
-    lv_obj_set_style_text_color(response_label, lv_color_white(), 0);
-    lv_obj_set_style_text_font(response_label, font_manager_get_font(wait_text, 12), 0);
-    lv_obj_set_width(response_label, LCD_H_RES - 20);
-    lv_obj_set_height(response_label, LCD_V_RES - 80);  // 留出顶部和底部空间
-    lv_label_set_long_mode(response_label, LV_LABEL_LONG_WRAP);
-    lv_obj_set_style_text_align(response_label, LV_TEXT_ALIGN_LEFT, 0);
-    lv_obj_align(response_label, LV_ALIGN_TOP_LEFT, 10, 55);
-
-    // 底部状态标签（右下角）
-    ESP_LOGI(TAG, "  - 创建状态标签");
-    status_label = lv_label_create(scr);
-    const char *ready_text = "准备就绪";
-    lv_label_set_text(status_label, ready_text);
-    lv_obj_set_style_text_color(status_label, lv_color_hex(0xFFD700), 0);  // 金色
-    lv_obj_set_style_text_font(status_label, font_manager_get_font(ready_text, 10), 0);
-    lv_obj_align(status_label, LV_ALIGN_BOTTOM_RIGHT, -5, -5);
-
-    // 强制刷新屏幕
-    lv_obj_invalidate(scr);
-    lv_refr_now(NULL);
-
+    mario_ui_create(lv_screen_active());
     lvgl_port_unlock();
     ESP_LOGI(TAG, "✓ 对话 UI 创建完成");
   } else {
@@ -420,20 +322,10 @@ static void create_mario_ui(void) {
 static void wifi_status_callback(bool connected) {
   if (connected) {
     ESP_LOGI(TAG, "WiFi 已连接");
-    if (lvgl_port_lock(0)) {
-      if (status_label != NULL) {
-        lv_label_set_text(status_label, "WiFi 已连接");
-      }
-      lvgl_port_unlock();
-    }
+    mario_ui_set_status("WiFi 已连接");
   } else {
     ESP_LOGI(TAG, "WiFi 断开连接");
-    if (lvgl_port_lock(0)) {
-      if (status_label != NULL) {
-        lv_label_set_text(status_label, "WiFi 断开");
-      }
-      lvgl_port_unlock();
-    }
+    mario_ui_set_status("WiFi 断开");
   }
 }
 
@@ -467,30 +359,13 @@ static esp_err_t send_message_to_agent(const char *message) {
   strncpy(current_user_input, message, sizeof(current_user_input) - 1);
   current_user_input[sizeof(current_user_input) - 1] = '\0';
   
-  // 清空响应缓冲区
-  response_buffer_len = 0;
-  response_buffer[0] = '\0';
-  
   // 停止当前 TTS 播放并清空队列
   tts_stop();
   
   ESP_LOGI(TAG, "发送消息: %s", message);
   
-  // 更新 UI 显示用户输入
-  if (lvgl_port_lock(100)) {
-    if (user_input_label != NULL) {
-      lv_label_set_text(user_input_label, current_user_input);
-      lv_obj_set_style_text_font(user_input_label, font_manager_get_font(current_user_input, 12), 0);
-    }
-    if (status_label != NULL) {
-      lv_label_set_text(status_label, "发送中...");
-      lv_obj_set_style_text_font(status_label, font_manager_get_font("发送中...", 10), 0);
-    }
-    if (response_label != NULL) {
-      lv_label_set_text(response_label, "");
-    }
-    lvgl_port_unlock();
-  }
+  // 清空回复缓冲区，用户输入作为新的一轮加入对话历史，随后的回复属于智能体的一轮
+  mario_ui_question(current_user_input);
   
   return baidu_agent_send_message(agent_handle, message, 0);
 }
@@ -596,6 +471,12 @@ void app_main(void) {
   // 步骤 6: 创建 Mario UI
   create_mario_ui();
 
+  // 步骤 6.5: 刷新基准（仅 CONFIG_DISP_PERF_BENCH 打开时运行）
+  if (lvgl_port_lock(0)) {
+    disp_perf_run_bench();
+    lvgl_port_unlock();
+  }
+
   // 步骤 7: 初始化 WiFi
   init_wifi();
 